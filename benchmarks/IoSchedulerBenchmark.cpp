@@ -0,0 +1,140 @@
+#include <recpp/async/ThreadPool.h>
+#include <recpp/filesystem/FileSystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	constexpr std::size_t directoryCount = 16;
+	constexpr std::size_t filesPerDirectory = 256;
+	constexpr std::size_t fileSize = 16 * 1024;
+	constexpr std::size_t smallOperationCount = 500;
+	constexpr auto		  smallOperationInterval = std::chrono::milliseconds(2);
+
+	class Latch
+	{
+	public:
+		Latch(std::size_t count)
+			: m_count(count)
+		{
+		}
+
+		void countDown()
+		{
+			std::lock_guard lock(m_mutex);
+			if (--m_count == 0)
+				m_condition.notify_all();
+		}
+
+		void wait()
+		{
+			std::unique_lock lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_count == 0; });
+		}
+
+	private:
+		std::size_t				m_count;
+		std::mutex				m_mutex;
+		std::condition_variable m_condition;
+	};
+
+	void createSourceTree(const std::filesystem::path &root)
+	{
+		const std::string content(fileSize, 'x');
+		for (std::size_t i = 0; i < directoryCount; i++)
+		{
+			const auto directory = root / std::to_string(i);
+			std::filesystem::create_directories(directory);
+			for (std::size_t j = 0; j < filesPerDirectory; j++)
+				std::ofstream(directory / (std::to_string(j) + ".bin"), std::ios::binary) << content;
+		}
+	}
+
+	double percentile(std::vector<double> values, double ratio)
+	{
+		std::sort(values.begin(), values.end());
+		const auto index = static_cast<std::size_t>(ratio * static_cast<double>(values.size() - 1));
+		return values[index];
+	}
+
+	void run(const std::string &name, const recpp::filesystem::FileSystem &fileSystem, const std::filesystem::path &root)
+	{
+		const auto			bulkCount = std::max<std::size_t>(4, 2 * std::thread::hardware_concurrency());
+		Latch				bulkLatch(bulkCount);
+		Latch				smallLatch(smallOperationCount);
+		std::mutex			latenciesMutex;
+		std::vector<double>	latencies;
+		latencies.reserve(smallOperationCount);
+
+		for (std::size_t i = 0; i < bulkCount; i++)
+		{
+			const auto destination = root / ("copy-" + std::to_string(i));
+			fileSystem.rxCopy(root / "source", destination, std::filesystem::copy_options::recursive)
+				.subscribe([&bulkLatch]() { bulkLatch.countDown(); }, [&bulkLatch](const std::exception_ptr &) { bulkLatch.countDown(); });
+		}
+
+		for (std::size_t i = 0; i < smallOperationCount; i++)
+		{
+			const auto start = Clock::now();
+			auto	   onDone = [&, start]()
+			{
+				const std::chrono::duration<double, std::milli> latency = Clock::now() - start;
+				{
+					std::lock_guard lock(latenciesMutex);
+					latencies.push_back(latency.count());
+				}
+				smallLatch.countDown();
+			};
+			fileSystem.rxExists(root / "source" / "0" / "0.bin")
+				.subscribe([onDone](bool) { onDone(); }, [onDone](const std::exception_ptr &) { onDone(); });
+			std::this_thread::sleep_for(smallOperationInterval);
+		}
+
+		smallLatch.wait();
+		bulkLatch.wait();
+
+		std::cout << std::left << std::setw(24) << name << std::fixed << std::setprecision(3) << " p50=" << percentile(latencies, 0.5) << "ms"
+				  << " p99=" << percentile(latencies, 0.99) << "ms"
+				  << " max=" << percentile(latencies, 1.0) << "ms" << std::endl;
+
+		for (std::size_t i = 0; i < bulkCount; i++)
+			std::filesystem::remove_all(root / ("copy-" + std::to_string(i)));
+	}
+} // namespace
+
+int main()
+{
+	const auto root = std::filesystem::temp_directory_path() / "recpp-filesystem-io-scheduler-benchmark";
+	std::filesystem::remove_all(root);
+	createSourceTree(root / "source");
+
+	{
+		recpp::async::ThreadPool	  threadPool;
+		recpp::filesystem::FileSystem fileSystem(threadPool);
+		run("shared scheduler", fileSystem, root);
+	}
+
+	{
+		recpp::async::ThreadPool	   bulkPool;
+		recpp::async::ThreadPool	   interactivePool;
+		recpp::filesystem::IoScheduler ioScheduler(bulkPool);
+		ioScheduler.setScheduler(recpp::filesystem::IoPriority::interactive, interactivePool);
+		recpp::filesystem::FileSystem fileSystem(ioScheduler);
+		run("io scheduler", fileSystem, root);
+	}
+
+	std::filesystem::remove_all(root);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+#include <recpp/filesystem/LexicalPath.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	constexpr std::size_t syntheticPathCount = 1000000;
+	constexpr int		  repetitions = 3;
+
+	// Paths shaped like those of build manifests: a few levels of source directories, with some "./", "../" and doubled separators
+	std::vector<std::string> syntheticCorpus()
+	{
+		static const char *const directories[] = {"src", "include", "lib", "third_party", "build", "generated", "tests", "common", "platform", "utils"};
+		static const char *const extensions[] = {".cpp", ".h", ".o", ".d", ".json", ".txt"};
+
+		std::mt19937			 random(42);
+		std::vector<std::string> paths;
+		paths.reserve(syntheticPathCount);
+		for (std::size_t i = 0; i < syntheticPathCount; i++)
+		{
+			std::string path = random() % 4 == 0 ? "/home/user/project/" : "./";
+			const auto	depth = 2 + random() % 6;
+			for (std::size_t level = 0; level < depth; level++)
+			{
+				const auto kind = random() % 16;
+				if (kind == 0)
+					path += "../";
+				else if (kind == 1)
+					path += "./";
+				else if (kind == 2)
+					path += "/";
+				path += directories[random() % std::size(directories)];
+				path += '/';
+			}
+			path += "file" + std::to_string(random() % 1000) + extensions[random() % std::size(extensions)];
+			paths.push_back(std::move(path));
+		}
+		return paths;
+	}
+
+	// The paths of an existing tree, as a file list would give them
+	std::vector<std::string> treeCorpus(const std::filesystem::path &root)
+	{
+		std::vector<std::string> paths;
+		for (const auto &entry : std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied))
+			paths.push_back(entry.path().generic_string());
+		return paths;
+	}
+
+	template <typename Function>
+	void measure(const std::string &name, const std::vector<std::string> &paths, const Function &function)
+	{
+		std::size_t checksum = 0;
+		auto		best = Clock::duration::max();
+		for (int repetition = 0; repetition < repetitions; repetition++)
+		{
+			const auto start = Clock::now();
+			for (const auto &path : paths)
+				checksum += function(path).size();
+			best = std::min(best, Clock::now() - start);
+		}
+
+		const std::chrono::duration<double, std::nano> duration = best;
+		std::cout << std::left << std::setw(36) << name << std::fixed << std::setprecision(1) << std::setw(8) << duration.count() / paths.size()
+				  << " ns/path (checksum " << checksum << ")" << std::endl;
+	}
+
+	void run(const std::string &corpusName, const std::vector<std::string> &paths)
+	{
+		std::cout << corpusName << ": " << paths.size() << " paths" << std::endl;
+		if (paths.empty())
+			return;
+
+		// Relative paths are computed against the directory of the first path, like the paths of a manifest against its own directory
+		const std::string base(recpp::filesystem::lexical::parent(paths.front()));
+		measure("  std lexically_normal", paths,
+				[](const std::string &path)
+				{
+					return std::filesystem::path(path).lexically_normal().generic_string();
+				});
+		measure("  lexical::normalize", paths,
+				[](const std::string &path)
+				{
+					return recpp::filesystem::lexical::normalize(path);
+				});
+		measure("  std lexically_relative", paths,
+				[&base](const std::string &path)
+				{
+					return std::filesystem::path(path).lexically_relative(base).generic_string();
+				});
+		measure("  lexical::relative", paths,
+				[&base](const std::string &path)
+				{
+					return recpp::filesystem::lexical::relative(path, base);
+				});
+		measure("  std parent_path + extension", paths,
+				[](const std::string &path)
+				{
+					const std::filesystem::path value(path);
+					return value.parent_path().generic_string() + value.extension().generic_string();
+				});
+		measure("  lexical::parent + extension", paths,
+				[](const std::string &path)
+				{
+					return std::string(recpp::filesystem::lexical::parent(path)) += recpp::filesystem::lexical::extension(path);
+				});
+	}
+} // namespace
+
+int main(int argc, char **argv)
+{
+	run("synthetic manifest", syntheticCorpus());
+	if (argc > 1)
+		run(std::string("tree of ") + argv[1], treeCorpus(argv[1]));
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief What rxAllocate does to the blocks of a range of a file.
+	 */
+	enum class AllocationMode
+	{
+		/// Allocate the blocks of the range that are not yet, extending the file if the range ends past its end
+		allocate,
+		/// Allocate the blocks of the range that are not yet, without changing the size of the file
+		keepSize,
+		/// Deallocate the blocks of the range, which then reads as zeros, without changing the size of the file
+		punchHole,
+		/// Make the range read as zeros with its blocks allocated, extending the file if the range ends past its end
+		zeroRange
+	};
+
+	/**
+	 * @brief A range of a file holding data, listed by rxDataSegments. The ranges between the segments of a file are holes, which read as zeros.
+	 */
+	struct DataSegment
+	{
+		/// The offset of the first byte of the segment
+		std::uintmax_t offset = 0;
+		/// The number of bytes of the segment
+		std::uintmax_t length = 0;
+	};
+} // namespace recpp::filesystem
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <recpp/filesystem/CancellationToken.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief An entry packed into or unpacked from an archive.
+	 */
+	struct ArchiveEntry
+	{
+		/// The path of the entry in the archive, relative to its root
+		std::filesystem::path	   path;
+		/// The type of the entry, hard links being regular files with a target
+		std::filesystem::file_type type = std::filesystem::file_type::regular;
+		/// The target of a symlink, or the path in the archive of the file a hard link shares its contents with, empty for other entries
+		std::filesystem::path	   target;
+		/// The size of the contents of the entry, 0 for directories, symlinks and hard links
+		std::uintmax_t			   size = 0;
+	};
+
+	/**
+	 * @brief The options of rxPackTar, rxUnpackTar and rxUnpackZip.
+	 */
+	struct ArchiveOptions
+	{
+		/// The number of threads reading or writing files, 0 for one per hardware thread
+		unsigned						 threads = 0;
+		/// The number of bytes of file contents read ahead while packing, the files larger than a share of it for each thread being streamed instead
+		std::size_t						 memoryLimit = 64 << 20;
+		/// Restore the permissions and modification times of the entries when unpacking, owners being never restored
+		bool							 restoreAttributes = true;
+		/// The CancellationToken checked before packing or unpacking each entry
+		std::optional<CancellationToken> token;
+	};
+} // namespace recpp::filesystem
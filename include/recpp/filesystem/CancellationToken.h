@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <system_error>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief Error reported by the operations interrupted through a CancellationToken. Its code is std::errc::timed_out if the deadline of the token
+	 * passed, std::errc::operation_canceled otherwise.
+	 */
+	class OperationCanceledError : public std::system_error
+	{
+	public:
+		/**
+		 * @brief Construct a new OperationCanceledError object.
+		 *
+		 * @param timedOut True if the operation was interrupted because the deadline of its token passed
+		 */
+		OperationCanceledError(bool timedOut);
+	};
+
+	/**
+	 * @brief CancellationToken lets long running operations be interrupted, either explicitly with cancel() or when a deadline passes.
+	 * <p>
+	 * Copies of a CancellationToken share the same state, so that cancelling any of them interrupts the operations using the others. Operations check their
+	 * token before starting and between the entries they process, they cannot interrupt a single blocking system call.
+	 */
+	class CancellationToken
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * @brief Construct a new CancellationToken object without deadline.
+		 */
+		CancellationToken();
+
+		/**
+		 * @brief Construct a new CancellationToken object cancelled once @p deadline passes.
+		 *
+		 * @param deadline The point in time after which the operations using this token are interrupted
+		 * @return The resulting CancellationToken
+		 */
+		static CancellationToken withDeadline(Clock::time_point deadline);
+
+		/**
+		 * @brief Construct a new CancellationToken object cancelled once @p timeout elapsed from now.
+		 *
+		 * @param timeout The duration after which the operations using this token are interrupted
+		 * @return The resulting CancellationToken
+		 */
+		static CancellationToken withTimeout(Clock::duration timeout);
+
+		/**
+		 * @brief Cancel this token, interrupting the operations using it or any of its copies.
+		 */
+		void cancel() const;
+
+		/**
+		 * @brief Check whether this token was cancelled or its deadline passed.
+		 *
+		 * @return True if the operations using this token must stop, false otherwise
+		 */
+		bool isCancelled() const;
+
+		/**
+		 * @brief Get the deadline of this token.
+		 *
+		 * @return The deadline of this token, or std::nullopt if it has none
+		 */
+		std::optional<Clock::time_point> deadline() const;
+
+		/**
+		 * @brief Get the error to report for an operation interrupted by this token.
+		 *
+		 * @return An OperationCanceledError if this token is cancelled, nullptr otherwise
+		 */
+		std::exception_ptr exception() const;
+
+		/**
+		 * @brief Throw an OperationCanceledError if this token is cancelled.
+		 */
+		void throwIfCancelled() const;
+
+	private:
+		struct State
+		{
+			std::atomic<bool>				 cancelled = false;
+			std::optional<Clock::time_point> deadline;
+		};
+
+		std::shared_ptr<State> m_state;
+	};
+} // namespace recpp::filesystem
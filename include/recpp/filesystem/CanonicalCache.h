@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief CanonicalCache canonicalizes paths like std::filesystem::canonical and std::filesystem::weakly_canonical, caching what it learns about each
+	 * component so that paths sharing a prefix do not look it up again.
+	 * <p>
+	 * std::filesystem::canonical does an lstat, and a readlink for symlinks, on every component of every path. The cache instead remembers, for each
+	 * resolved component, its type and the target of symlinks, and only looks up the components it has not seen, so that canonicalizing many paths under a
+	 * few deep roots mostly costs hash lookups. The cache is bounded: each of its shards evicts its least recently used components when it is full.
+	 * <p>
+	 * Cached components can become stale when the tree changes. They are dropped explicitly with invalidate() or clear(), or by revalidate(), which checks
+	 * the modification time of each cached directory: since adding, removing or renaming an entry updates the modification time of its directory, this
+	 * catches the changes under every cached directory with a single stat per directory.
+	 * <p>
+	 * Copies of a CanonicalCache share the same components. A CanonicalCache can be used from several threads at once.
+	 */
+	class CanonicalCache
+	{
+	public:
+		/**
+		 * @brief The number of lookups answered by the cache and of those needing a system call.
+		 */
+		struct Statistics
+		{
+			/// The number of components found in the cache
+			std::uintmax_t hits = 0;
+			/// The number of components looked up on the filesystem
+			std::uintmax_t misses = 0;
+		};
+
+		/**
+		 * @brief Construct a new CanonicalCache object.
+		 *
+		 * @param capacity The maximum number of components to remember
+		 */
+		explicit CanonicalCache(std::size_t capacity = 1 << 18);
+
+		/**
+		 * @brief Get the canonical absolute path of @p path like std::filesystem::canonical: without ".", ".." or symlink components. A
+		 * std::filesystem::filesystem_error is thrown if @p path does not exist, or if resolving it involves too many symlinks.
+		 *
+		 * @param path The path to canonicalize, relative paths being resolved against the current directory
+		 * @return The canonical path of @p path
+		 */
+		std::filesystem::path canonical(const std::filesystem::path &path) const;
+
+		/**
+		 * @brief Get the path of @p path like std::filesystem::weakly_canonical: the canonical path of its longest existing prefix, followed by the lexically
+		 * normal rest of @p path.
+		 *
+		 * @param path The path to canonicalize, relative paths being resolved against the current directory
+		 * @return The weakly canonical path of @p path
+		 */
+		std::filesystem::path weaklyCanonical(const std::filesystem::path &path) const;
+
+		/**
+		 * @brief Forget the components at or under @p path, which is matched lexically against the resolved paths of the components, so that it should be
+		 * canonical.
+		 *
+		 * @param path The canonical path of a file or directory that changed
+		 */
+		void invalidate(const std::filesystem::path &path);
+
+		/**
+		 * @brief Check each cached directory and symlink, and forget those that changed along with the components under them.
+		 * <p>
+		 * A directory changed if its modification time did, or if it is gone, a symlink if its target did. A file replaced in a directory updates the
+		 * modification time of the directory, except for the files directly under a root directory, which are only checked through invalidate().
+		 *
+		 * @return The number of components forgotten
+		 */
+		std::size_t revalidate();
+
+		/**
+		 * @brief Forget every component.
+		 */
+		void clear();
+
+		/**
+		 * @brief Get the number of cached components.
+		 *
+		 * @return The number of components remembered by this cache
+		 */
+		std::size_t size() const;
+
+		/**
+		 * @brief Get the number of lookups answered with and without system calls since this cache was constructed.
+		 *
+		 * @return The statistics of this cache
+		 */
+		Statistics statistics() const;
+
+	private:
+		struct Data;
+
+		std::shared_ptr<Data> m_data;
+	};
+} // namespace recpp::filesystem
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <recpp/filesystem/CancellationToken.h>
+
+#include <cstddef>
+#include <optional>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief The format of the contents of a file read by rxReadFileDecompressed or written by rxWriteFileCompressed.
+	 */
+	enum class CompressionFormat
+	{
+		/// Detect the format: from the first bytes of the file when reading, from its extension (".gz", ".tgz" or ".zst") when writing
+		automatic,
+		/// The contents are stored as they are
+		none,
+		/// The gzip format of RFC 1952, members being concatenated when reading
+		gzip,
+		/// The zstd format of RFC 8878, only available if the library was built with libzstd
+		zstd
+	};
+
+	/**
+	 * @brief The options of rxReadFileDecompressed and rxWriteFileCompressed.
+	 */
+	struct CompressionOptions
+	{
+		/// The format of the file
+		CompressionFormat				 format = CompressionFormat::automatic;
+		/// The compression level, from 1 (fastest) to 9 for gzip and to 19 for zstd, 0 for the default level of the format
+		int								 level = 0;
+		/// The number of threads compressing, 0 for one per hardware thread
+		unsigned						 threads = 0;
+		/// The size of the chunks read from or written to the file, and of the chunks delivered when reading
+		std::size_t						 chunkSize = 1 << 20;
+		/// The number of chunks each stage of the pipeline may hold, reused once the next stage is done with them
+		std::size_t						 queueDepth = 4;
+		/// The CancellationToken checked before each chunk
+		std::optional<CancellationToken> token;
+	};
+} // namespace recpp::filesystem
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <system_error>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief Error reported by the operations rejected by a ConcurrencyLimiter. Its code is std::errc::resource_unavailable_try_again.
+	 */
+	class ConcurrencyLimitError : public std::system_error
+	{
+	public:
+		/**
+		 * @brief Construct a new ConcurrencyLimitError object.
+		 *
+		 * @param mountPoint The mount point whose limit was reached
+		 * @param limit The limit that was reached
+		 */
+		ConcurrencyLimitError(const std::filesystem::path &mountPoint, std::size_t limit);
+
+		/**
+		 * @brief Get the mount point whose limit was reached.
+		 *
+		 * @return The mount point whose limit was reached
+		 */
+		const std::filesystem::path &mountPoint() const;
+
+		/**
+		 * @brief Get the limit that was reached.
+		 *
+		 * @return The number of in-flight operations allowed when the operation was rejected
+		 */
+		std::size_t limit() const;
+
+	private:
+		std::filesystem::path m_mountPoint;
+		std::size_t			  m_limit;
+	};
+
+	/**
+	 * @brief ConcurrencyLimiter bounds the number of in-flight operations on a mount point, and adapts this bound to the latency it observes: the limit
+	 * shrinks when operations slow down and grows back while they stay fast.
+	 * <p>
+	 * Operations exceeding the limit are rejected instead of queued, so that a degraded mount cannot fill the scheduler with blocked threads.
+	 */
+	class ConcurrencyLimiter
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * @brief The algorithms used to adapt the limit.
+		 */
+		enum class Algorithm
+		{
+			/// Additive increase while latency stays under Settings::latencyThreshold, multiplicative decrease by Settings::backoffRatio above it
+			aimd,
+			/// Scale the limit by the ratio between the long term and the recent latency, like Netflix's Gradient2 limiter
+			gradient,
+		};
+
+		/**
+		 * @brief The settings of a ConcurrencyLimiter.
+		 */
+		struct Settings
+		{
+			/// The algorithm used to adapt the limit
+			Algorithm		algorithm = Algorithm::gradient;
+			/// The limit before any operation completed
+			std::size_t		initialLimit = 20;
+			/// The lowest value the limit can shrink to
+			std::size_t		minLimit = 1;
+			/// The highest value the limit can grow to
+			std::size_t		maxLimit = 200;
+			/// Algorithm::aimd only: latency above which the limit shrinks
+			Clock::duration latencyThreshold = std::chrono::milliseconds(100);
+			/// Algorithm::aimd only: ratio applied to the limit when it shrinks
+			double			backoffRatio = 0.9;
+			/// Algorithm::gradient only: ratio of the recent latency over the long term latency tolerated before the limit shrinks
+			double			tolerance = 1.5;
+			/// Algorithm::gradient only: weight of each new estimate in the limit, between 0 and 1
+			double			smoothing = 0.2;
+		};
+
+		/**
+		 * @brief A Permit accounts for one in-flight operation, and records its latency when released or destroyed.
+		 */
+		class Permit
+		{
+		public:
+			Permit(const Permit &) = delete;
+			Permit(Permit &&other) noexcept;
+			~Permit();
+
+			Permit &operator=(const Permit &) = delete;
+			Permit &operator=(Permit &&other) noexcept;
+
+			/**
+			 * @brief Release the permit, recording the latency of the operation.
+			 *
+			 * @param dropped True if the operation timed out or was otherwise lost, which the limiter treats as a congestion signal
+			 */
+			void release(bool dropped = false);
+
+		private:
+			friend class ConcurrencyLimiter;
+
+			Permit(ConcurrencyLimiter &limiter, std::size_t inFlight);
+
+			ConcurrencyLimiter *m_limiter;
+			Clock::time_point	m_start;
+			std::size_t			m_inFlight;
+		};
+
+		/**
+		 * @brief Construct a new ConcurrencyLimiter object with the default Settings.
+		 */
+		ConcurrencyLimiter();
+
+		/**
+		 * @brief Construct a new ConcurrencyLimiter object.
+		 *
+		 * @param settings The settings of the limiter
+		 */
+		ConcurrencyLimiter(const Settings &settings);
+
+		/**
+		 * @brief Try to start a new operation.
+		 *
+		 * @return A Permit to release once the operation completes, or std::nullopt if the limit is reached
+		 */
+		std::optional<Permit> tryAcquire();
+
+		/**
+		 * @brief Get the current limit.
+		 *
+		 * @return The number of operations currently allowed in flight
+		 */
+		std::size_t limit() const;
+
+		/**
+		 * @brief Get the number of operations currently in flight.
+		 *
+		 * @return The number of permits acquired and not yet released
+		 */
+		std::size_t inFlight() const;
+
+	private:
+		void release(Clock::duration latency, std::size_t inFlight, bool dropped);
+
+		const Settings	   m_settings;
+		mutable std::mutex m_mutex;
+		double			   m_limit;
+		std::size_t		   m_inFlight = 0;
+		double			   m_longLatency = 0;
+	};
+} // namespace recpp::filesystem
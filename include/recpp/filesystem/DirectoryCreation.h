@@ -0,0 +1,20 @@
+#pragma once
+
+#include <filesystem>
+#include <system_error>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief The result of creating one of the directories passed to the batch rxCreateDirectories.
+	 */
+	struct DirectoryCreation
+	{
+		/// The path of the directory, as passed to rxCreateDirectories
+		std::filesystem::path path;
+		/// Whether the directory was created by this call, false if it already existed or could not be created
+		bool				  created = false;
+		/// The error that prevented creating the directory or one of its parents, if any
+		std::error_code		  error;
+	};
+} // namespace recpp::filesystem
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <recpp/filesystem/CancellationToken.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief The space used by a directory tree, or by a single file.
+	 */
+	struct DiskUsage
+	{
+		/// The path of the tree
+		std::filesystem::path path;
+		/// The sum of the sizes of the files of the tree, in bytes
+		std::uintmax_t		  apparentSize = 0;
+		/// The sum of the sizes of the blocks allocated to the files of the tree, in bytes, like du reports them
+		std::uintmax_t		  allocatedSize = 0;
+		/// The number of files of the tree that are not directories
+		std::uintmax_t		  fileCount = 0;
+		/// The number of directories of the tree, including its root
+		std::uintmax_t		  directoryCount = 0;
+		/// The number of entries of the tree that could not be measured and were left out, those removed during the scan not being counted
+		std::uintmax_t		  errorCount = 0;
+	};
+
+	/**
+	 * @brief The options of rxDiskUsage.
+	 */
+	struct DiskUsageOptions
+	{
+		/// Only count the first hard link found to each file, like du does, instead of counting each of them
+		bool							   countHardLinksOnce = true;
+		/// The number of threads walking the tree, 0 for one per hardware thread
+		unsigned						   threads = 0;
+		/// The options used to list directories, for instance to skip the directories that cannot be read
+		std::filesystem::directory_options directoryOptions = std::filesystem::directory_options::none;
+		/// The CancellationToken checked before listing each directory
+		std::optional<CancellationToken>   token;
+	};
+} // namespace recpp::filesystem
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <recpp/filesystem/CancellationToken.h>
+#include <recpp/filesystem/Hash.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <system_error>
+#include <vector>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief A group of regular files with the same contents.
+	 */
+	struct DuplicateGroup
+	{
+		/// The size of each file of the group, in bytes
+		std::uintmax_t					   size = 0;
+		/// The digest of the contents of each file of the group
+		Digest							   digest;
+		/// The paths of the files of the group, at least 2 and sorted
+		std::vector<std::filesystem::path> paths;
+	};
+
+	/**
+	 * @brief The options of rxFindDuplicates.
+	 */
+	struct DuplicateOptions
+	{
+		/// The hash function used to compare whole files
+		HashAlgorithm																		 algorithm = HashAlgorithm::blake3;
+		/// The size of the smallest files to compare, files smaller than this are ignored
+		std::uintmax_t																		 minSize = 1;
+		/// Compare the files of each group byte by byte before reporting them, to rule out hash collisions
+		bool																				 verifyContents = false;
+		/// The number of threads walking the trees and hashing files, 0 for one per hardware thread
+		unsigned																			 threads = 0;
+		/// The options used to list directories, for instance to skip the directories that cannot be read
+		std::filesystem::directory_options													 directoryOptions = std::filesystem::directory_options::none;
+		/// The CancellationToken checked before listing each directory and hashing each file
+		std::optional<CancellationToken>													 token;
+		/// The function called with each file or directory that cannot be read, never concurrently, which is left out of the search instead of failing it;
+		/// those removed during the search are left out without calling it
+		std::function<void(const std::filesystem::path &path, const std::error_code &error)> onError;
+	};
+} // namespace recpp::filesystem
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <recpp/filesystem/FileSystemBackend.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief FaultInjectionBackend is a FileSystemBackend decorating another one with injected latency, stalls and errors, to load test the code using a
+	 * FileSystem against a slow or flaky filesystem, and reproduce tail latency incidents without a broken mount.
+	 * <p>
+	 * The faults of each call are drawn from a random number generator seeded by Settings::seed, so that a single threaded scenario is reproduced exactly
+	 * by reusing its seed. The latency and stalls block the calling thread, which is a thread of the scheduler of the FileSystem, like a slow filesystem
+	 * does, so that they are seen by its ConcurrencyLimiter and by the timeouts of its users. An injected error is thrown before the call is forwarded, as a
+	 * std::filesystem::filesystem_error with the paths of the call.
+	 * <p>
+	 * Given to FileSystem::withBackend while decorating a NativeBackend, its faults are injected once per operation of the FileSystem, as
+	 * Operation::operation, in front of the native implementation of the operation rather than of its primitives, so that every operation of the FileSystem
+	 * keeps working on disk the way it does without a backend.
+	 */
+	class FaultInjectionBackend final : public FileSystemBackend
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * @brief The primitives of a FileSystemBackend faults can be injected in, both overloads of a primitive sharing the same value, and the operations
+		 * of a FileSystem decorating the native filesystem.
+		 */
+		enum class Operation
+		{
+			absolute,
+			canonical,
+			weaklyCanonical,
+			copy,
+			copyFile,
+			copySymlink,
+			createDirectory,
+			createDirectories,
+			createHardLink,
+			createSymlink,
+			createDirectorySymlink,
+			currentPath,
+			directoryEntries,
+			equivalent,
+			fileSize,
+			hardLinkCount,
+			isEmpty,
+			lastWriteTime,
+			permissions,
+			readFile,
+			readSymlink,
+			remove,
+			removeAll,
+			rename,
+			resizeFile,
+			space,
+			status,
+			symlinkStatus,
+			tempDirectoryPath,
+			writeFile,
+			/// A whole operation of a FileSystem on the native filesystem, see injectOperation
+			operation,
+		};
+
+		/**
+		 * @brief An error injected with a given probability.
+		 */
+		struct Error
+		{
+			/// The code of the std::filesystem::filesystem_error thrown
+			std::errc code = std::errc::io_error;
+			/// The probability of the error on each call, between 0 and 1
+			double	  probability = 0;
+		};
+
+		/**
+		 * @brief The faults injected in the calls of an operation.
+		 */
+		struct Faults
+		{
+			/// The median of the latency added to each call
+			Clock::duration	   medianLatency = Clock::duration::zero();
+			/// The 99th percentile of the latency added to each call, which is log-normally distributed, and constant if this is not above medianLatency
+			Clock::duration	   p99Latency = Clock::duration::zero();
+			/// The probability of a call stalling, between 0 and 1
+			double			   stallProbability = 0;
+			/// How long a stalled call blocks on top of its latency
+			Clock::duration	   stallDuration = std::chrono::seconds(30);
+			/// The errors injected, each one being drawn independently and the first one drawn being thrown
+			std::vector<Error> errors;
+		};
+
+		/**
+		 * @brief The settings of a FaultInjectionBackend.
+		 */
+		struct Settings
+		{
+			/// The seed of the random number generator the faults are drawn from
+			std::uint64_t				seed = 0;
+			/// The faults of the operations missing from operations
+			Faults						defaults;
+			/// The faults of specific operations
+			std::map<Operation, Faults> operations;
+		};
+
+		/**
+		 * @brief The counts of the faults injected so far.
+		 */
+		struct Statistics
+		{
+			/// The number of calls
+			std::uint64_t	calls = 0;
+			/// The number of calls that stalled
+			std::uint64_t	stalls = 0;
+			/// The number of calls that failed with an injected error
+			std::uint64_t	errors = 0;
+			/// The total latency injected, including stalls
+			Clock::duration latency = Clock::duration::zero();
+		};
+
+		/**
+		 * @brief Construct a new FaultInjectionBackend object.
+		 *
+		 * @param backend The backend the calls are forwarded to, a NativeBackend if nullptr
+		 * @param settings The faults to inject
+		 */
+		FaultInjectionBackend(std::shared_ptr<FileSystemBackend> backend, Settings settings);
+
+		std::filesystem::path			   absolute(const std::filesystem::path &path) const override;
+		std::filesystem::path			   canonical(const std::filesystem::path &path) const override;
+		std::filesystem::path			   weaklyCanonical(const std::filesystem::path &path) const override;
+		void							   copy(const std::filesystem::path &from, const std::filesystem::path &to,
+												std::filesystem::copy_options options) override;
+		bool							   copyFile(const std::filesystem::path &from, const std::filesystem::path &to,
+													std::filesystem::copy_options options) override;
+		void							   copySymlink(const std::filesystem::path &from, const std::filesystem::path &to) override;
+		bool							   createDirectory(const std::filesystem::path &path) override;
+		bool							   createDirectory(const std::filesystem::path &path, const std::filesystem::path &existingPath) override;
+		bool							   createDirectories(const std::filesystem::path &path) override;
+		void							   createHardLink(const std::filesystem::path &target, const std::filesystem::path &link) override;
+		void							   createSymlink(const std::filesystem::path &target, const std::filesystem::path &link) override;
+		void							   createDirectorySymlink(const std::filesystem::path &target, const std::filesystem::path &link) override;
+		std::filesystem::path			   currentPath() const override;
+		std::vector<std::filesystem::path> directoryEntries(const std::filesystem::path &path) const override;
+		bool							   equivalent(const std::filesystem::path &path1, const std::filesystem::path &path2) const override;
+		std::uintmax_t					   fileSize(const std::filesystem::path &path) const override;
+		std::uintmax_t					   hardLinkCount(const std::filesystem::path &path) const override;
+		bool							   isEmpty(const std::filesystem::path &path) const override;
+		std::filesystem::file_time_type	   lastWriteTime(const std::filesystem::path &path) const override;
+		void							   lastWriteTime(const std::filesystem::path &path, std::filesystem::file_time_type newTime) override;
+		void							   permissions(const std::filesystem::path &path, std::filesystem::perms permissions,
+													   std::filesystem::perm_options options) override;
+		std::string						   readFile(const std::filesystem::path &path) const override;
+		std::size_t						   readFile(const std::filesystem::path &path, std::uintmax_t offset, char *data, std::size_t size) const override;
+		std::filesystem::path			   readSymlink(const std::filesystem::path &path) const override;
+		bool							   remove(const std::filesystem::path &path) override;
+		std::uintmax_t					   removeAll(const std::filesystem::path &path) override;
+		void							   rename(const std::filesystem::path &oldPath, const std::filesystem::path &newPath) override;
+		void							   resizeFile(const std::filesystem::path &path, std::uintmax_t newSize) override;
+		std::filesystem::space_info		   space(const std::filesystem::path &path) const override;
+		std::filesystem::file_status	   status(const std::filesystem::path &path) const override;
+		std::filesystem::file_status	   symlinkStatus(const std::filesystem::path &path) const override;
+		std::filesystem::path			   tempDirectoryPath() const override;
+		void							   writeFile(const std::filesystem::path &path, std::string_view content) override;
+
+		/**
+		 * @brief Get the counts of the faults injected so far.
+		 *
+		 * @return The statistics of the calls made through this backend
+		 */
+		Statistics statistics() const;
+
+		/**
+		 * @brief Get the backend the calls are forwarded to.
+		 *
+		 * @return The decorated backend
+		 */
+		const std::shared_ptr<FileSystemBackend> &backend() const;
+
+		/**
+		 * @brief Inject the faults of Operation::operation in an operation of a FileSystem, before its native implementation runs. This is called by the
+		 * FileSystem this backend is given to, on the thread and under the ConcurrencyLimiter permit of the operation.
+		 *
+		 * @param path The path the operation is dispatched for, empty for the operations without path
+		 * @throws std::filesystem::filesystem_error If an error is injected
+		 */
+		void injectOperation(const std::filesystem::path &path) const;
+
+	private:
+		void inject(Operation operation, const std::filesystem::path &path1, const std::filesystem::path &path2 = std::filesystem::path()) const;
+
+		const std::shared_ptr<FileSystemBackend> m_backend;
+		const Settings							 m_settings;
+		mutable std::mutex						 m_mutex;
+		mutable std::mt19937_64					 m_random;
+		mutable Statistics						 m_statistics;
+	};
+} // namespace recpp::filesystem
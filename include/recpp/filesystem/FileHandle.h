@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief An identity of a file that survives its renames, returned by rxFileHandle and resolved back to the current path of the file by
+	 * rxResolveFileHandle.
+	 * <p>
+	 * The handle is made of the handles the filesystem gives to the file and to its directory with name_to_handle_at, which stay valid until the file is
+	 * removed, across remounts and reboots for most filesystems.
+	 */
+	struct FileHandle
+	{
+		/// The opaque bytes of the handle, to persist as they are
+		std::string bytes;
+
+		bool operator==(const FileHandle &other) const
+		{
+			return bytes == other.bytes;
+		}
+
+		bool operator!=(const FileHandle &other) const
+		{
+			return bytes != other.bytes;
+		}
+	};
+} // namespace recpp::filesystem
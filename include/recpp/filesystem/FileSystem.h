@@ -1,19 +1,56 @@
 #pragma once
 
+#include <recpp/filesystem/Allocation.h>
+#include <recpp/filesystem/Archive.h>
+#include <recpp/filesystem/CancellationToken.h>
+#include <recpp/filesystem/CanonicalCache.h>
+#include <recpp/filesystem/Compression.h>
+#include <recpp/filesystem/ConcurrencyLimiter.h>
+#include <recpp/filesystem/DirectoryCreation.h>
+#include <recpp/filesystem/DiskUsage.h>
+#include <recpp/filesystem/Duplicates.h>
+#include <recpp/filesystem/FaultInjectionBackend.h>
+#include <recpp/filesystem/FileHandle.h>
+#include <recpp/filesystem/FileSystemBackend.h>
+#include <recpp/filesystem/FileSystemTransaction.h>
+#include <recpp/filesystem/Glob.h>
+#include <recpp/filesystem/Grep.h>
+#include <recpp/filesystem/Hash.h>
+#include <recpp/filesystem/IoScheduler.h>
+#include <recpp/filesystem/LexicalPath.h>
+#include <recpp/filesystem/MemoryBackend.h>
+#include <recpp/filesystem/MetadataIndex.h>
+#include <recpp/filesystem/OverlayFileSystem.h>
+#include <recpp/filesystem/PathTable.h>
+#include <recpp/filesystem/Records.h>
+#include <recpp/filesystem/Sync.h>
+#include <recpp/filesystem/Tail.h>
+#include <recpp/filesystem/Walk.h>
+#include <recpp/filesystem/Xattr.h>
 #include <recpp/rx/Single.h>
 
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace recpp::filesystem
 {
 	recpp::rx::Single<std::filesystem::path> rxAbsolute(const std::filesystem::path &path);
 	recpp::rx::Single<std::filesystem::path> rxCanonical(const std::filesystem::path &path);
+	recpp::rx::Single<std::filesystem::path> rxCanonical(const std::filesystem::path &path, const CanonicalCache &cache);
 	recpp::rx::Single<std::filesystem::path> rxWeaklyCanonical(const std::filesystem::path &path);
+	recpp::rx::Single<std::filesystem::path> rxWeaklyCanonical(const std::filesystem::path &path, const CanonicalCache &cache);
 	recpp::rx::Single<std::filesystem::path> rxRelative(const std::filesystem::path &path, const std::filesystem::path &base = std::filesystem::current_path());
 	recpp::rx::Single<std::filesystem::path> rxProximate(const std::filesystem::path &path,
 														 const std::filesystem::path &base = std::filesystem::current_path());
 	recpp::rx::Completable					 rxCopy(const std::filesystem::path &from, const std::filesystem::path &to);
 	recpp::rx::Completable					 rxCopy(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options);
+	recpp::rx::Completable					 rxCopy(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options,
+													const CancellationToken &token);
 	recpp::rx::Completable					 rxCopyFile(const std::filesystem::path &from, const std::filesystem::path &to);
 	recpp::rx::Completable	rxCopyFile(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options);
 	recpp::rx::Completable	rxCopySymlink(const std::filesystem::path &from, const std::filesystem::path &to);
@@ -25,10 +62,27 @@ namespace recpp::filesystem
 	recpp::rx::Completable	rxCreateDirectorySymlink(const std::filesystem::path &target, const std::filesystem::path &link);
 	recpp::rx::Single<std::filesystem::path>		   rxCurrentPath();
 	recpp::rx::Completable							   rxCurrentPath(const std::filesystem::path &path);
+	recpp::rx::Single<DiskUsage>					   rxDiskUsage(const std::filesystem::path &root, const DiskUsageOptions &options = DiskUsageOptions());
+	recpp::rx::Single<DiskUsage>					   rxDiskUsage(const std::filesystem::path &root,
+																   const std::function<void(const DiskUsage &usage)> &onDirectory,
+																   const DiskUsageOptions &options = DiskUsageOptions());
 	recpp::rx::Single<bool>							   rxExists(const std::filesystem::path &path);
+	recpp::rx::Single<bool>							   rxExists(const std::filesystem::path &path, const OverlayFileSystem &overlay);
+	recpp::rx::Single<OverlayEntry>					   rxResolve(const std::filesystem::path &path, const OverlayFileSystem &overlay);
 	recpp::rx::Single<bool>							   rxEquivalent(const std::filesystem::path &path1, const std::filesystem::path &path2);
 	recpp::rx::Single<std::uintmax_t>				   rxFileSize(const std::filesystem::path &path);
+	recpp::rx::Completable							   rxFindDuplicates(const std::vector<std::filesystem::path> &roots,
+																		const std::function<void(const DuplicateGroup &group)> &onGroup,
+																		const DuplicateOptions &options = DuplicateOptions());
 	recpp::rx::Single<std::uintmax_t>				   rxHardLinkCount(const std::filesystem::path &path);
+	recpp::rx::Single<Digest>						   rxHashFile(const std::filesystem::path &path, HashAlgorithm algorithm = HashAlgorithm::xxh3);
+	recpp::rx::Single<Digest>						   rxHashTree(const std::filesystem::path &root, HashAlgorithm algorithm = HashAlgorithm::xxh3);
+	recpp::rx::Single<MetadataIndex>				   rxBuildIndex(const std::filesystem::path &root,
+																	const MetadataIndexOptions &options = MetadataIndexOptions());
+	recpp::rx::Single<MetadataIndex>				   rxOpenIndex(const std::filesystem::path &file);
+	recpp::rx::Single<MetadataIndex>				   rxRefreshIndex(const MetadataIndex &index,
+																	  const MetadataIndexOptions &options = MetadataIndexOptions());
+	recpp::rx::Completable							   rxWriteIndex(const MetadataIndex &index, const std::filesystem::path &file);
 	recpp::rx::Single<std::filesystem::file_time_type> rxLastWriteTime(const std::filesystem::path &path);
 	recpp::rx::Completable							   rxLastWriteTime(const std::filesystem::path &path, std::filesystem::file_time_type newTime);
 	recpp::rx::Completable							   rxPermissions(const std::filesystem::path &path, std::filesystem::perms permissions,
@@ -36,11 +90,20 @@ namespace recpp::filesystem
 	recpp::rx::Single<std::filesystem::path>		   rxReadSymlink(const std::filesystem::path &path);
 	recpp::rx::Single<bool>							   rxRemove(const std::filesystem::path &path);
 	recpp::rx::Single<std::uintmax_t>				   rxRemoveAll(const std::filesystem::path &path);
+	recpp::rx::Single<std::uintmax_t>				   rxRemoveAll(const std::filesystem::path &path, const CancellationToken &token);
 	recpp::rx::Completable							   rxRename(const std::filesystem::path &oldPath, const std::filesystem::path &newPath);
 	recpp::rx::Completable							   rxResizeFile(const std::filesystem::path &path, std::uintmax_t newSize);
+	recpp::rx::Completable							   rxAllocate(const std::filesystem::path &path, std::uintmax_t offset, std::uintmax_t length,
+																  AllocationMode mode = AllocationMode::allocate);
+	recpp::rx::Single<std::vector<DataSegment>>		   rxDataSegments(const std::filesystem::path &path);
 	recpp::rx::Single<std::filesystem::space_info>	   rxSpace(const std::filesystem::path &path);
 	recpp::rx::Single<std::filesystem::file_status>	   rxStatus(const std::filesystem::path &path);
 	recpp::rx::Single<std::filesystem::file_status>	   rxSymlinkStatus(const std::filesystem::path &path);
+	recpp::rx::Completable							   rxSync(const std::filesystem::path &source, const std::filesystem::path &destination,
+															  const SyncOptions &options = SyncOptions());
+	recpp::rx::Completable							   rxSync(const std::filesystem::path &source, const std::filesystem::path &destination,
+															  const std::function<void(const SyncAction &action)> &onAction,
+															  const SyncOptions &options = SyncOptions());
 	recpp::rx::Single<std::filesystem::path>		   rxTempDirectoryPath();
 	recpp::rx::Single<bool>							   rxIsBlockFile(const std::filesystem::path &path);
 	recpp::rx::Single<bool>							   rxIsCharacterFile(const std::filesystem::path &path);
@@ -52,6 +115,77 @@ namespace recpp::filesystem
 	recpp::rx::Single<bool>							   rxIsSocket(const std::filesystem::path &path);
 	recpp::rx::Single<bool>							   rxIsSymlink(const std::filesystem::path &path);
 
+	recpp::rx::Completable								  rxCommit(const FileSystemTransaction &transaction,
+																   const TransactionOptions &options = TransactionOptions());
+	recpp::rx::Single<std::vector<DirectoryCreation>>	  rxCreateDirectories(std::vector<std::filesystem::path> paths, unsigned threads = 0);
+	recpp::rx::Single<FileHandle>						  rxFileHandle(const std::filesystem::path &path);
+	recpp::rx::Single<std::string>						  rxGetXattr(const std::filesystem::path &path, const std::string &name);
+	recpp::rx::Single<std::vector<FileXattrs>>			  rxGetXattrs(std::vector<std::filesystem::path> paths, std::vector<std::string> names = {},
+																	  unsigned threads = 0);
+	recpp::rx::Single<std::vector<std::filesystem::path>> rxGlob(const std::string &pattern, const GlobOptions &options = GlobOptions());
+	recpp::rx::Completable								  rxGlob(const std::string &pattern,
+																 const std::function<void(const std::filesystem::path &path)> &onMatch,
+																 const GlobOptions &options = GlobOptions());
+	recpp::rx::Single<std::vector<GrepMatch>>			  rxGrep(const std::filesystem::path &root, const std::string &pattern,
+																 const GrepOptions &options = GrepOptions());
+	recpp::rx::Completable								  rxGrep(const std::filesystem::path &root, const std::string &pattern,
+																 const std::function<void(const GrepMatch &match)> &onMatch,
+																 const GrepOptions &options = GrepOptions());
+	recpp::rx::Single<std::vector<std::string>>			  rxLexicallyNormal(std::vector<std::string> paths, unsigned threads = 0);
+	recpp::rx::Single<std::vector<std::string>>			  rxLexicallyRelative(std::vector<std::string> paths, const std::string &base, unsigned threads = 0);
+	recpp::rx::Single<std::vector<std::string>>			  rxListXattrs(const std::filesystem::path &path);
+	recpp::rx::Completable								  rxPackTar(const std::filesystem::path &root, const std::filesystem::path &archive,
+																	const ArchiveOptions &options = ArchiveOptions());
+	recpp::rx::Completable								  rxPackTar(const std::filesystem::path &root, const std::filesystem::path &archive,
+																	const std::function<void(const ArchiveEntry &entry)> &onEntry,
+																	const ArchiveOptions &options = ArchiveOptions());
+	recpp::rx::Single<std::string>						  rxReadFileDecompressed(const std::filesystem::path &path,
+																				 const CompressionOptions &options = CompressionOptions());
+	recpp::rx::Completable								  rxReadFileDecompressed(const std::filesystem::path &path,
+																				 const std::function<void(std::string_view chunk)> &onChunk,
+																				 const CompressionOptions &options = CompressionOptions());
+	recpp::rx::Completable								  rxReadFixedSizeRecords(const std::filesystem::path &path, std::size_t recordSize,
+																				 const std::function<void(std::string_view record)> &onRecord,
+																				 const RecordOptions &options = RecordOptions());
+	recpp::rx::Completable								  rxReadLines(const std::filesystem::path &path,
+																	  const std::function<void(std::string_view line)> &onLine,
+																	  const RecordOptions &options = RecordOptions());
+	recpp::rx::Completable								  rxReadRecords(const std::filesystem::path &path, char delimiter,
+																		const std::function<void(std::string_view record)> &onRecord,
+																		const RecordOptions &options = RecordOptions());
+	recpp::rx::Completable								  rxRecoverTransaction(const std::filesystem::path &journal);
+	recpp::rx::Completable								  rxRemoveXattr(const std::filesystem::path &path, const std::string &name);
+	recpp::rx::Single<std::filesystem::path>			  rxResolveFileHandle(const FileHandle &handle, const std::filesystem::path &mountPoint);
+	recpp::rx::Completable								  rxSetXattr(const std::filesystem::path &path, const std::string &name, std::string value,
+																	 XattrMode mode = XattrMode::createOrReplace);
+	recpp::rx::Completable								  rxTail(const std::filesystem::path &path, std::uintmax_t startPosition,
+																 const std::function<void(const TailData &data)> &onData,
+																 const TailOptions &options = TailOptions());
+	recpp::rx::Completable								  rxTailLines(const std::filesystem::path &path, std::uintmax_t startPosition,
+																	  const std::function<void(const TailData &line)> &onLine,
+																	  const TailOptions &options = TailOptions());
+	recpp::rx::Completable								  rxUnpackTar(const std::filesystem::path &archive, const std::filesystem::path &destination,
+																	  const ArchiveOptions &options = ArchiveOptions());
+	recpp::rx::Completable								  rxUnpackTar(const std::filesystem::path &archive, const std::filesystem::path &destination,
+																	  const std::function<void(const ArchiveEntry &entry)> &onEntry,
+																	  const ArchiveOptions &options = ArchiveOptions());
+	recpp::rx::Completable								  rxUnpackZip(const std::filesystem::path &archive, const std::filesystem::path &destination,
+																	  const ArchiveOptions &options = ArchiveOptions());
+	recpp::rx::Completable								  rxUnpackZip(const std::filesystem::path &archive, const std::filesystem::path &destination,
+																	  const std::function<void(const ArchiveEntry &entry)> &onEntry,
+																	  const ArchiveOptions &options = ArchiveOptions());
+	recpp::rx::Completable								  rxWalk(const std::filesystem::path &root, PathTable &table,
+																 const std::function<void(PathTable::Id id, std::filesystem::file_type type)> &onEntry,
+																 const WalkOptions &options = WalkOptions());
+	recpp::rx::Completable								  rxWalk(const std::filesystem::path &root, const OverlayFileSystem &overlay,
+																 const std::function<void(const OverlayEntry &entry)> &onEntry,
+																 const std::optional<CancellationToken> &token = std::nullopt);
+	recpp::rx::Completable								  rxWriteFileCompressed(const std::filesystem::path &path, std::string contents,
+																				const CompressionOptions &options = CompressionOptions());
+	recpp::rx::Completable								  rxWriteFileCompressed(const std::filesystem::path &path,
+																				const std::function<std::size_t(char *data, std::size_t size)> &source,
+																				const CompressionOptions &options = CompressionOptions());
+
 	/**
 	 * @brief FileSystem is a convenience class to work with a filesystem in a reactive way, and using a specific recpp::async::Scheduler to use for all
 	 * blocking operations
@@ -66,6 +200,108 @@ namespace recpp::filesystem
 		 */
 		FileSystem(recpp::async::Scheduler &scheduler);
 
+		/**
+		 * @brief Construct a new FileSystem object dispatching its operations through an IoScheduler.
+		 * <p>
+		 * Operations are routed according to the device of their source path and to their priority class: recursive copies, file copies and recursive
+		 * removals are IoPriority::bulk operations, every other operation is IoPriority::interactive.
+		 *
+		 * @param ioScheduler The IoScheduler to use for all blocking operations, which must outlive this object
+		 */
+		FileSystem(IoScheduler &ioScheduler);
+
+		/**
+		 * @brief Get a copy of this FileSystem dispatching all of its operations with the @p priority class, regardless of their default class.
+		 * <p>
+		 * This has no effect if this FileSystem was not constructed with an IoScheduler.
+		 *
+		 * @param priority The priority class to use for all operations
+		 * @return The resulting FileSystem
+		 */
+		FileSystem withPriority(IoPriority priority) const;
+
+		/**
+		 * @brief Get a copy of this FileSystem limiting the number of in-flight operations on paths under @p mountPoint with @p limiter.
+		 * <p>
+		 * Operations are matched to a mount point lexically from their source path, and the deepest matching mount point wins. Operations exceeding the
+		 * limit are rejected with a ConcurrencyLimitError as soon as they reach the scheduler, so that a degraded mount does not fill it with blocked
+		 * threads. The limiter is shared with this FileSystem and its other copies.
+		 * <p>
+		 * The operations working on several files at once, such as rxHashTree or rxFindDuplicates, spread their work over tasks of the same scheduler, each
+		 * holding a permit of the limiter: the tasks the limiter rejects are not run, the operation going on with fewer of them instead of failing.
+		 *
+		 * @param mountPoint The root of the paths to limit
+		 * @param limiter The ConcurrencyLimiter to use for these paths, or nullptr to remove the limiter of @p mountPoint
+		 * @return The resulting FileSystem
+		 */
+		FileSystem withConcurrencyLimiter(const std::filesystem::path &mountPoint, const std::shared_ptr<ConcurrencyLimiter> &limiter) const;
+
+		/**
+		 * @brief Get a copy of this FileSystem whose operations are interrupted through @p token.
+		 * <p>
+		 * Every operation checks @p token when it reaches the scheduler and fails with an OperationCanceledError instead of running if it is cancelled or
+		 * if its deadline passed, so that work queued behind a slow operation does not run past its deadline. Recursive copies and removals also check it
+		 * between entries.
+		 *
+		 * @param token The CancellationToken to use for all operations
+		 * @return The resulting FileSystem
+		 */
+		FileSystem withCancellation(const CancellationToken &token) const;
+
+		/**
+		 * @brief Get a copy of this FileSystem resolving rxCanonical and rxWeaklyCanonical through @p cache.
+		 * <p>
+		 * The components resolved by previous calls are then not looked up again, which makes canonicalizing many paths sharing a few prefixes much
+		 * cheaper, but the results can be stale until @p cache is invalidated or revalidated after the tree changed. The cache is shared with this FileSystem
+		 * and its other copies.
+		 *
+		 * @param cache The CanonicalCache to use for canonicalization
+		 * @return The resulting FileSystem
+		 */
+		FileSystem withCanonicalCache(const CanonicalCache &cache) const;
+
+		/**
+		 * @brief Get a copy of this FileSystem delivering the results of its operations on @p scheduler, typically the recpp::async::EventLoop of the
+		 * caller.
+		 * <p>
+		 * Operations still run on the scheduler chosen for their path and priority, but their results are then handed directly to @p scheduler, so that
+		 * consumers do not have to hop back to their own thread with another queue. Callbacks receiving entries while an operation runs, like those of rxWalk
+		 * or rxGrep, are still invoked on the threads running the operation. @p scheduler must outlive this FileSystem and its copies.
+		 *
+		 * @param scheduler The recpp::async::Scheduler to deliver results on
+		 * @return The resulting FileSystem
+		 */
+		FileSystem withCompletionScheduler(recpp::async::Scheduler &scheduler) const;
+
+		/**
+		 * @brief Get a copy of this FileSystem working on @p backend instead of the filesystem of the operating system, such as a MemoryBackend.
+		 * <p>
+		 * The operations mirroring std::filesystem are made of the primitives of @p backend, still dispatched on the schedulers of this FileSystem, and so are
+		 * rxWalk with a PathTable, rxGlob, rxGrep, rxHashFile, rxHashTree, rxDiskUsage and rxCreateDirectories with a batch of paths, which list directories
+		 * with FileSystemBackend::directoryEntries and read files by chunks with FileSystemBackend::readFile. rxReadFileDecompressed, rxReadLines,
+		 * rxReadRecords and rxReadFixedSizeRecords read the file by chunks too, and rxWriteFileCompressed writes the file once compressed. rxCommit renames,
+		 * removes and changes the permissions of the files of @p backend. On a backend, rxDiskUsage counts the allocated size of a file as its size and
+		 * directories as empty, and finds hard links with FileSystemBackend::equivalent since there are no inode numbers. rxCurrentPath and
+		 * rxTempDirectoryPath get the directories of @p backend.
+		 * <p>
+		 * The operations that need native metadata, durable writes or OS-specific calls are outside of the contract of FileSystemBackend, and fail right away
+		 * with std::errc::operation_not_supported on a backend: changing the current directory with rxCurrentPath, rxExists, rxResolve and rxWalk with an
+		 * OverlayFileSystem, rxFindDuplicates, rxSync, rxCommit with a TransactionOptions::journal, rxRecoverTransaction, rxPackTar, rxUnpackTar,
+		 * rxUnpackZip, rxTail, rxTailLines, rxAllocate, rxDataSegments, rxBuildIndex, rxOpenIndex, rxRefreshIndex, rxWriteIndex, rxFileHandle,
+		 * rxResolveFileHandle and the extended attribute operations. The code using them cannot be tested against a MemoryBackend. The
+		 * CanonicalCache of this FileSystem, if any, is not used. Cancellation is checked between the entries of walks, but not between those of recursive
+		 * copies and removals. A NativeBackend, or nullptr, restores the default behavior.
+		 * <p>
+		 * A FaultInjectionBackend decorating a NativeBackend is not used as a backend: every operation keeps its native implementation, with the faults of
+		 * FaultInjectionBackend::Operation::operation injected once in front of it, on its scheduler and under its ConcurrencyLimiter permit, to see how
+		 * the callers of this FileSystem and its ConcurrencyLimiter behave on a degraded filesystem. Decorating another backend injects the faults in each
+		 * of its primitives instead.
+		 *
+		 * @param backend The FileSystemBackend to use for all operations, shared with this FileSystem and its other copies
+		 * @return The resulting FileSystem
+		 */
+		FileSystem withBackend(std::shared_ptr<FileSystemBackend> backend) const;
+
 		/**
 		 * @brief Asynchronously retrieve a path referencing the same file system location as @p path, for which filesystem::path::is_absolute() is true.
 		 *
@@ -118,6 +354,29 @@ namespace recpp::filesystem
 		recpp::rx::Single<std::filesystem::path> rxProximate(const std::filesystem::path &path,
 															 const std::filesystem::path &base = std::filesystem::current_path()) const;
 
+		/**
+		 * @brief Asynchronously normalizes each of @p paths with recpp::filesystem::lexical::normalize, on several threads.
+		 * <p>
+		 * Unlike rxWeaklyCanonical, the filesystem is never accessed: paths are processed as strings with '/' separators, which makes normalizing the
+		 * millions of paths of a manifest much faster than with std::filesystem::path::lexically_normal.
+		 *
+		 * @param paths The paths to normalize, moved in to be normalized in place
+		 * @param threads The number of threads normalizing the paths, 0 for one per hardware thread
+		 * @return The normalized paths as a recpp::rx::Single, in the order of @p paths
+		 */
+		recpp::rx::Single<std::vector<std::string>> rxLexicallyNormal(std::vector<std::string> paths, unsigned threads = 0) const;
+
+		/**
+		 * @brief Asynchronously makes each of @p paths relative to @p base with recpp::filesystem::lexical::relative, on several threads, without accessing
+		 * the filesystem.
+		 *
+		 * @param paths The paths to make relative, moved in to be replaced in place
+		 * @param base The path they are made relative to
+		 * @param threads The number of threads processing the paths, 0 for one per hardware thread
+		 * @return The relative paths as a recpp::rx::Single, in the order of @p paths, empty for those that cannot be made relative to @p base lexically
+		 */
+		recpp::rx::Single<std::vector<std::string>> rxLexicallyRelative(std::vector<std::string> paths, const std::string &base, unsigned threads = 0) const;
+
 		/**
 		 * @brief Asynchronously copies files and directories, equivalent to rxCopy with std::filesystem::copy_options::none used as options.
 		 * <p>
@@ -143,6 +402,20 @@ namespace recpp::filesystem
 		 */
 		recpp::rx::Completable rxCopy(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options) const;
 
+		/**
+		 * @brief Same as rxCopy with @p options, except that the copy can be interrupted through @p token. The token is checked before the copy starts and
+		 * before each entry of the copied directories, so that a cancelled or timed out copy releases its scheduler thread without waiting for the whole tree.
+		 * Entries already copied are left in place.
+		 *
+		 * @param from Path to the source file, directory, or symlink
+		 * @param to Path to the target file, directory, or symlink
+		 * @param options The copy options
+		 * @param token The CancellationToken used to interrupt the copy, reported as an OperationCanceledError
+		 * @return The resulting recpp::rx::Completable
+		 */
+		recpp::rx::Completable rxCopy(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options,
+									  const CancellationToken &token) const;
+
 		/**
 		 * @brief Asynchronously copies a single file from @p from to @p to, equivalent to rxCopyFile with std::filesystem::copy_options::none used as options.
 		 * <p>
@@ -205,6 +478,21 @@ namespace recpp::filesystem
 		 */
 		recpp::rx::Single<bool> rxCreateDirectories(const std::filesystem::path &path) const;
 
+		/**
+		 * @brief Asynchronously creates the directories at @p paths and all their missing parents, like rxCreateDirectories for each of them but with each
+		 * unique directory looked up and created only once.
+		 * <p>
+		 * The paths are made absolute and lexically normalized, then merged into a prefix tree which is created top-down: each directory is created and opened
+		 * relatively to its parent with mkdirat and openat, so that no path is resolved twice, and independent subtrees are created in parallel. Creating
+		 * many nested directories thus costs about one system call per unique directory instead of one per parent of each path.
+		 *
+		 * @param paths The paths of the directories to create
+		 * @param threads The number of threads creating directories, 0 for one per hardware thread
+		 * @return The result of each path of @p paths, in the same order, as a recpp::rx::Single. A directory that cannot be created makes all the paths under
+		 * it fail with the same error, but does not fail the operation
+		 */
+		recpp::rx::Single<std::vector<DirectoryCreation>> rxCreateDirectories(std::vector<std::filesystem::path> paths, unsigned threads = 0) const;
+
 		/**
 		 * @brief Asynchronously creates a hard link @p link with its target set to @p target as if by POSIX link(): the pathname @p target must exist.
 		 * <p>
@@ -254,6 +542,33 @@ namespace recpp::filesystem
 		 */
 		recpp::rx::Completable rxCurrentPath(const std::filesystem::path &path) const;
 
+		/**
+		 * @brief Asynchronously measures the space used by the tree rooted at @p root, like du does (symlinks are not followed).
+		 * <p>
+		 * The tree is walked on several threads. Both the apparent size of the files and the size of the blocks allocated to them are summed, and a file with
+		 * several hard links in the tree is only counted once unless @p options says otherwise. The entries removed during the walk are left out, and those
+		 * that cannot be measured, including the directories that cannot be listed, are counted in DiskUsage::errorCount rather than failing the walk.
+		 *
+		 * @param root Path of the tree to measure
+		 * @param options The options of the walk
+		 * @return The usage of the whole tree as a recpp::rx::Single
+		 */
+		recpp::rx::Single<DiskUsage> rxDiskUsage(const std::filesystem::path &root, const DiskUsageOptions &options = DiskUsageOptions()) const;
+
+		/**
+		 * @brief Asynchronously measures the space used by the tree rooted at @p root like rxDiskUsage(root, options), also reporting the usage of each
+		 * directory of the tree.
+		 * <p>
+		 * A directory is reported as soon as every directory under it was measured, so directories are reported bottom-up and @p root last.
+		 *
+		 * @param root Path of the tree to measure
+		 * @param onDirectory The function called with the usage of each directory, from the threads of the walk but never concurrently
+		 * @param options The options of the walk
+		 * @return The usage of the whole tree as a recpp::rx::Single, emitted once every directory was reported
+		 */
+		recpp::rx::Single<DiskUsage> rxDiskUsage(const std::filesystem::path &root, const std::function<void(const DiskUsage &usage)> &onDirectory,
+												 const DiskUsageOptions &options = DiskUsageOptions()) const;
+
 		/**
 		 * @brief Asynchronously checks if the given file status or path corresponds to an existing file or directory.
 		 * <p>
@@ -265,6 +580,26 @@ namespace recpp::filesystem
 		 */
 		recpp::rx::Single<bool> rxExists(const std::filesystem::path &path) const;
 
+		/**
+		 * @brief Asynchronously checks whether @p path exists in the merged view of @p overlay, with a lookup in its cached listings instead of a stat of
+		 * each of its layers.
+		 *
+		 * @param path The path in the overlay
+		 * @param overlay The overlay to look @p path up in
+		 * @return The resulting boolean as a recpp::rx::Single. True if a layer of @p overlay has @p path, false otherwise
+		 */
+		recpp::rx::Single<bool> rxExists(const std::filesystem::path &path, const OverlayFileSystem &overlay) const;
+
+		/**
+		 * @brief Asynchronously finds the layer of @p overlay providing @p path, like OverlayFileSystem::resolve, reporting an error with
+		 * std::errc::no_such_file_or_directory if no layer has it.
+		 *
+		 * @param path The path in the overlay
+		 * @param overlay The overlay to look @p path up in
+		 * @return The entry of @p path in the merged view as a recpp::rx::Single, with the path of the file providing it
+		 */
+		recpp::rx::Single<OverlayEntry> rxResolve(const std::filesystem::path &path, const OverlayFileSystem &overlay) const;
+
 		/**
 		 * @brief Asynchronously checks whether the paths @p path1 and @p path2 resolve to the same file system entity.
 		 * <p>
@@ -291,6 +626,465 @@ namespace recpp::filesystem
 		 */
 		recpp::rx::Single<std::uintmax_t> rxFileSize(const std::filesystem::path &path) const;
 
+		/**
+		 * @brief Asynchronously finds the regular files with the same contents under @p roots (symlinks are not followed), calling @p onGroup for each group
+		 * of duplicates as soon as it is confirmed.
+		 * <p>
+		 * Files are first grouped by size from a parallel walk, then by a hash of their first and last 4 KiB, and only then by a hash of their whole
+		 * contents: files with a unique size are never read, and files with a unique head or tail are never read entirely. Each stage hashes several files
+		 * at once. Hard links to the same file are reported once. The files removed during the search are left out, and so are those that cannot be read,
+		 * which are reported to DuplicateOptions::onError rather than failing the search.
+		 *
+		 * @param roots The directories or files to search
+		 * @param onGroup The function called with each group of duplicates, from the threads of the search but never concurrently
+		 * @param options The options of the search
+		 * @return The resulting recpp::rx::Completable, completing once every group was reported
+		 */
+		recpp::rx::Completable rxFindDuplicates(const std::vector<std::filesystem::path> &roots,
+												const std::function<void(const DuplicateGroup &group)> &onGroup,
+												const DuplicateOptions &options = DuplicateOptions()) const;
+
+		/**
+		 * @brief Asynchronously finds the paths matching the glob @p pattern, like rxGlob with a callback, and returns them sorted.
+		 *
+		 * @param pattern The pattern to match, with '/' separators
+		 * @param options The options of the search
+		 * @return The sorted paths matching @p pattern as a recpp::rx::Single
+		 */
+		recpp::rx::Single<std::vector<std::filesystem::path>> rxGlob(const std::string &pattern, const GlobOptions &options = GlobOptions()) const;
+
+		/**
+		 * @brief Asynchronously finds the paths matching the glob @p pattern, calling @p onMatch for each of them as soon as its directory is listed.
+		 * <p>
+		 * '*' matches any part of a name, '?' any character, "[abc]", "[a-z]" and "[!abc]" a character of a set, "{a,b}" either alternative, and a "**" segment
+		 * any number of directories, a pattern ending with a '/' only matching directories. Wildcards do not match the names starting with a dot unless
+		 * GlobOptions::matchHidden is set. The literal segments leading the pattern give the directory where the walk starts, and directories that cannot
+		 * contain a match are not descended into, so that a pattern starting with "src/" only lists the directories under src. Relative patterns give paths
+		 * relative to the current directory.
+		 *
+		 * @param pattern The pattern to match, with '/' separators
+		 * @param onMatch The function called with each matching path, from the threads of the walk but never concurrently
+		 * @param options The options of the search
+		 * @return The resulting recpp::rx::Completable, completing once every match was reported
+		 */
+		recpp::rx::Completable rxGlob(const std::string &pattern, const std::function<void(const std::filesystem::path &path)> &onMatch,
+									  const GlobOptions &options = GlobOptions()) const;
+
+		/**
+		 * @brief Asynchronously finds the lines matching @p pattern in the regular files under @p root, like rxGrep with a callback, and returns them
+		 * sorted by path and line.
+		 *
+		 * @param root The directory or file to search
+		 * @param pattern The literal string or regular expression to find
+		 * @param options The options of the search
+		 * @return The matching lines as a recpp::rx::Single
+		 */
+		recpp::rx::Single<std::vector<GrepMatch>> rxGrep(const std::filesystem::path &root, const std::string &pattern,
+														 const GrepOptions &options = GrepOptions()) const;
+
+		/**
+		 * @brief Asynchronously finds the lines matching @p pattern in the regular files under @p root (symlinks are not followed), calling @p onMatch for
+		 * each of them.
+		 * <p>
+		 * The files are searched in parallel as the tree is walked, each one being read by chunks. Rather than splitting every line, the search looks for a
+		 * literal string the matches must contain with memchr, on its rarest byte, and only extracts the lines around its occurrences: that string is
+		 * @p pattern itself, or when GrepOptions::regex is set the longest literal run the regular expression requires, the regular expression then only
+		 * being matched against those lines. Files with a NUL byte in their first 8 KiB are skipped as binary unless GrepOptions::skipBinary is cleared.
+		 * <p>
+		 * The matches of a file are reported in order, as soon as the chunk of the file they are in is searched, so that only the matches of one chunk per
+		 * thread are held however large the file. @p onMatch blocks the thread that searched the chunk until it returns, so that a slow consumer slows the
+		 * search down rather than letting matches pile up. The search is stopped by cancelling its CancellationToken, which is checked before each chunk.
+		 *
+		 * @param root The directory or file to search
+		 * @param pattern The literal string or regular expression to find
+		 * @param onMatch The function called with each matching line, from the threads of the search but never concurrently
+		 * @param options The options of the search
+		 * @return The resulting recpp::rx::Completable, completing once every match was reported
+		 */
+		recpp::rx::Completable rxGrep(const std::filesystem::path &root, const std::string &pattern, const std::function<void(const GrepMatch &match)> &onMatch,
+									  const GrepOptions &options = GrepOptions()) const;
+
+		/**
+		 * @brief Asynchronously walks the tree rooted at @p root in parallel (symlinks are not followed), interning the path of each entry under it into
+		 * @p table and calling @p onEntry with its handle and its type.
+		 * <p>
+		 * The entries of each directory are interned by their name, as children of the handle of the directory, so that the paths of the tree share their
+		 * prefixes in @p table and are only stored once. The walk still lists directories with std::filesystem::directory_iterator, which gives each entry
+		 * its full path for the time its directory is handled. The handle of @p root itself is table.intern(root).
+		 *
+		 * @param root The directory to walk
+		 * @param table The table receiving the paths, shared with the walk
+		 * @param onEntry The function called with each entry, from the threads of the walk but never concurrently
+		 * @param options The options of the walk
+		 * @return The resulting recpp::rx::Completable, completing once every entry was reported
+		 */
+		recpp::rx::Completable rxWalk(const std::filesystem::path &root, PathTable &table,
+									  const std::function<void(PathTable::Id id, std::filesystem::file_type type)> &onEntry,
+									  const WalkOptions &options = WalkOptions()) const;
+
+		/**
+		 * @brief Asynchronously walks the merged view of @p overlay under @p root, calling @p onEntry with each entry in depth first order, the entries of
+		 * each directory being sorted by name.
+		 * <p>
+		 * The directories are listed from the cache of @p overlay, which merges the entries of every layer and reports each path once, with the layer
+		 * providing it. Symlinks to directories are walked like directories, except those leading back to a directory being walked, which are only reported.
+		 * The CancellationToken of this FileSystem, if any, is checked before listing each directory.
+		 *
+		 * @param root The directory of the overlay to walk, whose own entry is not reported
+		 * @param overlay The overlay to walk
+		 * @param onEntry The function called with each entry, from the thread of the walk
+		 * @return The resulting recpp::rx::Completable, completing once every entry was reported
+		 */
+		recpp::rx::Completable rxWalk(const std::filesystem::path &root, const OverlayFileSystem &overlay,
+									  const std::function<void(const OverlayEntry &entry)> &onEntry) const;
+
+		/**
+		 * @brief Asynchronously applies the operations of @p transaction as a whole: if one of them fails, those already applied are undone before the error
+		 * is reported.
+		 * <p>
+		 * Operations on unrelated paths are applied in parallel, the others in the order they were added to @p transaction. Files replaced by a rename or
+		 * removed are kept under a hidden name next to their path until every operation succeeded. If some operations cannot be undone, the error is a
+		 * TransactionRollbackError and the journal, if any, is kept for rxRecoverTransaction. Each record of the journal is flushed to disk before its
+		 * operation is applied. Once the transaction is committed, deleting the files it replaced or removed is best effort: those left are deleted by
+		 * rxRecoverTransaction with the journal, which is kept for it.
+		 *
+		 * @param transaction The operations to apply
+		 * @param options The options of the transaction
+		 * @return The resulting recpp::rx::Completable, completing once every operation was applied
+		 */
+		recpp::rx::Completable rxCommit(const FileSystemTransaction &transaction, const TransactionOptions &options = TransactionOptions()) const;
+
+		/**
+		 * @brief Asynchronously finishes the transaction recorded in @p journal by a process that crashed while committing it: the transaction is rolled back
+		 * unless it was committed, in which case only the files it replaced or removed are deleted. The journal is then removed.
+		 *
+		 * @param journal The journal passed to rxCommit, nothing being done if it does not exist
+		 * @return The resulting recpp::rx::Completable
+		 */
+		recpp::rx::Completable rxRecoverTransaction(const std::filesystem::path &journal) const;
+
+		/**
+		 * @brief Asynchronously packs the tree rooted at @p root into the tar archive @p archive, like rxPackTar with a callback.
+		 *
+		 * @param root The directory to pack, whose entries are stored relative to it
+		 * @param archive The path of the archive, replaced if it exists
+		 * @param options The options of the packing
+		 * @return The resulting recpp::rx::Completable
+		 */
+		recpp::rx::Completable rxPackTar(const std::filesystem::path &root, const std::filesystem::path &archive,
+										 const ArchiveOptions &options = ArchiveOptions()) const;
+
+		/**
+		 * @brief Asynchronously packs the tree rooted at @p root into the tar archive @p archive (symlinks are stored, not followed), calling @p onEntry with
+		 * each entry once it is written.
+		 * <p>
+		 * The entries are stored sorted by path in the POSIX pax format, with their permissions, owners and modification times, files with several hard
+		 * links being stored once. Reader threads load the next files in archive order, up to ArchiveOptions::memoryLimit bytes ahead, while a single
+		 * writer appends them to the archive, so that reading and writing overlap without the memory used growing with the tree. Files too large to be read
+		 * ahead are streamed by the writer. Special files, such as fifos and sockets, are skipped, and so is @p archive itself when it is under @p root. The
+		 * archive is removed if packing fails.
+		 *
+		 * @param root The directory to pack, whose entries are stored relative to it
+		 * @param archive The path of the archive, replaced if it exists
+		 * @param onEntry The function called with each entry once it is written, from the writing thread
+		 * @param options The options of the packing
+		 * @return The resulting recpp::rx::Completable, completing once the archive is written
+		 */
+		recpp::rx::Completable rxPackTar(const std::filesystem::path &root, const std::filesystem::path &archive,
+										 const std::function<void(const ArchiveEntry &entry)> &onEntry, const ArchiveOptions &options = ArchiveOptions()) const;
+
+		/**
+		 * @brief Asynchronously unpacks the tar archive @p archive into @p destination, like rxUnpackTar with a callback.
+		 *
+		 * @param archive The archive to unpack
+		 * @param destination The directory receiving the entries, created if needed
+		 * @param options The options of the unpacking
+		 * @return The resulting recpp::rx::Completable
+		 */
+		recpp::rx::Completable rxUnpackTar(const std::filesystem::path &archive, const std::filesystem::path &destination,
+										   const ArchiveOptions &options = ArchiveOptions()) const;
+
+		/**
+		 * @brief Asynchronously unpacks the tar archive @p archive into @p destination, calling @p onEntry with each entry once it is created.
+		 * <p>
+		 * The ustar, pax and GNU formats are read. The headers of the archive are scanned first: the directories of every entry are then created in one batch,
+		 * like the batch rxCreateDirectories does, the files are read from the archive and written on several threads, and the links are created last, the hard
+		 * links before the symlinks. Existing files are replaced. Entries whose path leads out of @p destination, and hard links whose target does not resolve
+		 * to a file under it, fail with std::errc::permission_denied, and since symlinks are only created once every file and hard link is, nothing is written
+		 * or linked through a symlink of the archive. An archive truncated while it is unpacked fails with std::errc::bad_message. Devices and fifos are
+		 * skipped.
+		 *
+		 * @param archive The archive to unpack
+		 * @param destination The directory receiving the entries, created if needed
+		 * @param onEntry The function called with each entry once it is created, from the threads of the unpacking but never concurrently
+		 * @param options The options of the unpacking
+		 * @return The resulting recpp::rx::Completable, completing once every entry is created
+		 */
+		recpp::rx::Completable rxUnpackTar(const std::filesystem::path &archive, const std::filesystem::path &destination,
+										   const std::function<void(const ArchiveEntry &entry)> &onEntry,
+										   const ArchiveOptions &options = ArchiveOptions()) const;
+
+		/**
+		 * @brief Asynchronously unpacks the zip archive @p archive into @p destination, like rxUnpackZip with a callback.
+		 *
+		 * @param archive The archive to unpack
+		 * @param destination The directory receiving the entries, created if needed
+		 * @param options The options of the unpacking
+		 * @return The resulting recpp::rx::Completable
+		 */
+		recpp::rx::Completable rxUnpackZip(const std::filesystem::path &archive, const std::filesystem::path &destination,
+										   const ArchiveOptions &options = ArchiveOptions()) const;
+
+		/**
+		 * @brief Asynchronously unpacks the zip archive @p archive into @p destination, calling @p onEntry with each entry once it is created.
+		 * <p>
+		 * Like rxUnpackTar, except that the entries are read from the central directory of the archive, zip64 included. Stored and deflated entries are
+		 * supported, the deflated ones being decompressed by the threads writing them, and the CRC of each file is checked. Encrypted entries and other
+		 * compression methods fail with std::errc::not_supported. Permissions and symlinks are only known for archives made on Unix.
+		 *
+		 * @param archive The archive to unpack
+		 * @param destination The directory receiving the entries, created if needed
+		 * @param onEntry The function called with each entry once it is created, from the threads of the unpacking but never concurrently
+		 * @param options The options of the unpacking
+		 * @return The resulting recpp::rx::Completable, completing once every entry is created
+		 */
+		recpp::rx::Completable rxUnpackZip(const std::filesystem::path &archive, const std::filesystem::path &destination,
+										   const std::function<void(const ArchiveEntry &entry)> &onEntry,
+										   const ArchiveOptions &options = ArchiveOptions()) const;
+
+		/**
+		 * @brief Asynchronously reads the file @p path, decompressing it, like rxReadFileDecompressed with a callback, and returns its whole decompressed
+		 * contents.
+		 *
+		 * @param path The file to read
+		 * @param options The options of the decompression
+		 * @return The decompressed contents of the file as a recpp::rx::Single
+		 */
+		recpp::rx::Single<std::string> rxReadFileDecompressed(const std::filesystem::path &path,
+															  const CompressionOptions &options = CompressionOptions()) const;
+
+		/**
+		 * @brief Asynchronously reads the file @p path (symlinks are followed), decompressing it, and calls @p onChunk with each chunk of its decompressed
+		 * contents, in order.
+		 * <p>
+		 * Reading the file, decompressing it and delivering the chunks run on three threads, connected by queues of CompressionOptions::queueDepth chunks
+		 * of CompressionOptions::chunkSize bytes, which are reused once the next stage is done with them: the disk, the decompression and @p onChunk work at
+		 * the same time, and the memory used does not depend on the size of the file. gzip files made of several members are read whole, as gzip does, and
+		 * the CRC of each member is checked. zstd frames are decompressed by libzstd on a single thread, their format not allowing more. A file that is
+		 * not in the expected format, or that is truncated, fails with std::errc::bad_message, and zstd files fail with std::errc::not_supported if the
+		 * library was built without libzstd.
+		 *
+		 * @param path The file to read
+		 * @param onChunk The function called with each chunk, from a single thread of the reading, the chunk being only valid until it returns
+		 * @param options The options of the decompression
+		 * @return The resulting recpp::rx::Completable, completing once every chunk was delivered
+		 */
+		recpp::rx::Completable rxReadFileDecompressed(const std::filesystem::path &path, const std::function<void(std::string_view chunk)> &onChunk,
+													  const CompressionOptions &options = CompressionOptions()) const;
+
+		/**
+		 * @brief Asynchronously writes @p contents to the file @p path, compressing them, like rxWriteFileCompressed with a source.
+		 *
+		 * @param path The file to write, replaced if it exists
+		 * @param contents The data to compress
+		 * @param options The options of the compression
+		 * @return The resulting recpp::rx::Completable
+		 */
+		recpp::rx::Completable rxWriteFileCompressed(const std::filesystem::path &path, std::string contents,
+													 const CompressionOptions &options = CompressionOptions()) const;
+
+		/**
+		 * @brief Asynchronously writes the data filled by @p source to the file @p path, compressing it.
+		 * <p>
+		 * @p source fills chunks of CompressionOptions::chunkSize bytes, taken from a pool of chunks reused once written, while other threads compress the
+		 * previous chunks and a writer thread appends them to the file in order. gzip chunks are compressed on CompressionOptions::threads threads at once,
+		 * each chunk using the end of the previous one as its dictionary and ending with a sync flush, so that they form a single gzip member that any gzip
+		 * reader accepts. zstd chunks are compressed into a single frame by the worker threads of libzstd. The file is removed if writing fails.
+		 *
+		 * @param path The file to write, replaced if it exists
+		 * @param source The function filling the buffer of size bytes at data, returning how many bytes it filled, 0 at the end of the data, called from
+		 * a single thread of the writing
+		 * @param options The options of the compression
+		 * @return The resulting recpp::rx::Completable, completing once the file is written
+		 */
+		recpp::rx::Completable rxWriteFileCompressed(const std::filesystem::path &path,
+													 const std::function<std::size_t(char *data, std::size_t size)> &source,
+													 const CompressionOptions &options = CompressionOptions()) const;
+
+		/**
+		 * @brief Asynchronously reads the file @p path (symlinks are followed) and calls @p onLine with each of its lines, in order.
+		 * <p>
+		 * The file is read into a pool of RecordOptions::queueDepth buffers of RecordOptions::chunkSize bytes by a thread of its own, and the lines within
+		 * a buffer are delivered as views into it, with no allocation per line: only a line spanning two buffers is copied, into a buffer reused from one
+		 * such line to the next. Lines end with '\n', which is removed along with a '\r' before it, and the last line is only delivered if it is not empty.
+		 * Setting RecordOptions::format to CompressionFormat::automatic also reads the lines of gzip and zstd files, like rxReadFileDecompressed.
+		 *
+		 * @param path The file to read
+		 * @param onLine The function called with each line, from a single thread of the reading, the line being only valid until it returns
+		 * @param options The options of the reading
+		 * @return The resulting recpp::rx::Completable, completing once every line was delivered
+		 */
+		recpp::rx::Completable rxReadLines(const std::filesystem::path &path, const std::function<void(std::string_view line)> &onLine,
+										   const RecordOptions &options = RecordOptions()) const;
+
+		/**
+		 * @brief Asynchronously reads the file @p path (symlinks are followed) and calls @p onRecord with each of its records ended by @p delimiter, in
+		 * order, like rxReadLines.
+		 * <p>
+		 * The delimiter is removed from the records, and the last record is only delivered if it is not empty.
+		 *
+		 * @param path The file to read
+		 * @param delimiter The byte ending each record
+		 * @param onRecord The function called with each record, from a single thread of the reading, the record being only valid until it returns
+		 * @param options The options of the reading
+		 * @return The resulting recpp::rx::Completable, completing once every record was delivered
+		 */
+		recpp::rx::Completable rxReadRecords(const std::filesystem::path &path, char delimiter, const std::function<void(std::string_view record)> &onRecord,
+											 const RecordOptions &options = RecordOptions()) const;
+
+		/**
+		 * @brief Asynchronously reads the file @p path (symlinks are followed) and calls @p onRecord with each of its records of @p recordSize bytes, in
+		 * order, like rxReadLines.
+		 * <p>
+		 * The last record is shorter if the size of the file is not a multiple of @p recordSize, and a @p recordSize of 0 fails with a
+		 * std::invalid_argument.
+		 *
+		 * @param path The file to read
+		 * @param recordSize The size of each record, in bytes
+		 * @param onRecord The function called with each record, from a single thread of the reading, the record being only valid until it returns
+		 * @param options The options of the reading
+		 * @return The resulting recpp::rx::Completable, completing once every record was delivered
+		 */
+		recpp::rx::Completable rxReadFixedSizeRecords(const std::filesystem::path &path, std::size_t recordSize,
+													  const std::function<void(std::string_view record)> &onRecord,
+													  const RecordOptions &options = RecordOptions()) const;
+
+		/**
+		 * @brief Asynchronously follows the file @p path (symlinks are followed) from @p startPosition, calling @p onData with the data appended to it,
+		 * until the token of @p options is cancelled.
+		 * <p>
+		 * On Linux, the directory of the file is watched with inotify, so that the data is delivered as soon as it is written without polling, and the file
+		 * is polled every TailOptions::pollInterval elsewhere or if inotify cannot be used. A rotated file, renamed or removed and replaced by a new file at
+		 * @p path, is read to its end before the new file is followed from its start, and a truncated file is followed again from its start, TailData::rotated
+		 * being set on the first data of either. Passing the TailData::end of the last data handled as @p startPosition resumes following the file where it
+		 * was left, a position beyond the end of the file meaning it was truncated or rotated since. Rotations are detected by the inode of the file, which
+		 * Windows does not have: only truncations are detected there. The file must exist when the following starts.
+		 * <p>
+		 * Since it only ends when its token is cancelled, failing with an OperationCanceledError, the following holds a thread of the scheduler for as long
+		 * as it lasts. It therefore requires a token: when neither @p options nor this FileSystem (see withCancellation) provide one, it fails right away
+		 * with std::errc::invalid_argument. Unlike the other operations, it does not hold a permit of the ConcurrencyLimiter of its mount (see
+		 * withConcurrencyLimiter), since it mostly waits for the file to change and would otherwise take a permit, and skew the latency the limiter adapts
+		 * to, for as long as it lasts.
+		 *
+		 * @param path The file to follow
+		 * @param startPosition The offset to start following the file from, usually 0 or its size
+		 * @param onData The function called with the data appended to the file, from a single thread of the following
+		 * @param options The options of the following
+		 * @return The resulting recpp::rx::Completable, failing without a token, when the token is cancelled or reading the file fails
+		 */
+		recpp::rx::Completable rxTail(const std::filesystem::path &path, std::uintmax_t startPosition, const std::function<void(const TailData &data)> &onData,
+									  const TailOptions &options = TailOptions()) const;
+
+		/**
+		 * @brief Asynchronously follows the file @p path like rxTail, calling @p onLine with each line appended to it, without its line terminator.
+		 * <p>
+		 * A line is delivered once its '\n' is written, and the last line of a rotated file once the new file is found. A line longer than
+		 * TailOptions::chunkSize is delivered in pieces of that size.
+		 *
+		 * @param path The file to follow
+		 * @param startPosition The offset to start following the file from, which should be the start of a line
+		 * @param onLine The function called with each line, from a single thread of the following
+		 * @param options The options of the following
+		 * @return The resulting recpp::rx::Completable, failing without a token, when the token is cancelled or reading the file fails
+		 */
+		recpp::rx::Completable rxTailLines(const std::filesystem::path &path, std::uintmax_t startPosition,
+										   const std::function<void(const TailData &line)> &onLine, const TailOptions &options = TailOptions()) const;
+
+		/**
+		 * @brief Asynchronously gets the value of the extended attribute @p name of the file @p path (symlinks are followed), as if by getxattr.
+		 * <p>
+		 * Extended attributes are supported on Linux and macOS, and fail with std::errc::operation_not_supported elsewhere. The value is first read into a
+		 * buffer large enough for most values, so that getting it usually costs a single system call.
+		 *
+		 * @param path Path to the file
+		 * @param name The name of the attribute, including its namespace on Linux, such as "user.checksum"
+		 * @return The value of the attribute as a recpp::rx::Single, failing if the file does not have it
+		 */
+		recpp::rx::Single<std::string> rxGetXattr(const std::filesystem::path &path, const std::string &name) const;
+
+		/**
+		 * @brief Asynchronously sets the extended attribute @p name of the file @p path (symlinks are followed) to @p value, as if by setxattr.
+		 *
+		 * @param path Path to the file
+		 * @param name The name of the attribute, including its namespace on Linux, such as "user.checksum"
+		 * @param value The value of the attribute, which may hold any bytes
+		 * @param mode How to treat an existing attribute of the same name
+		 * @return The resulting recpp::rx::Completable
+		 */
+		recpp::rx::Completable rxSetXattr(const std::filesystem::path &path, const std::string &name, std::string value,
+										  XattrMode mode = XattrMode::createOrReplace) const;
+
+		/**
+		 * @brief Asynchronously removes the extended attribute @p name of the file @p path (symlinks are followed), as if by removexattr.
+		 *
+		 * @param path Path to the file
+		 * @param name The name of the attribute
+		 * @return The resulting recpp::rx::Completable, failing if the file does not have the attribute
+		 */
+		recpp::rx::Completable rxRemoveXattr(const std::filesystem::path &path, const std::string &name) const;
+
+		/**
+		 * @brief Asynchronously lists the names of the extended attributes of the file @p path (symlinks are followed), as if by listxattr.
+		 *
+		 * @param path Path to the file
+		 * @return The names of the attributes as a recpp::rx::Single
+		 */
+		recpp::rx::Single<std::vector<std::string>> rxListXattrs(const std::filesystem::path &path) const;
+
+		/**
+		 * @brief Asynchronously gets the extended attributes @p names of each of @p paths, or all their attributes if @p names is empty, on up to
+		 * @p threads threads (0 meaning the number of hardware threads).
+		 * <p>
+		 * Reading the attributes of many files, such as the tags or checksums an indexer keeps in them, one rxGetXattr at a time costs a scheduling for each
+		 * attribute: this batches them into a single operation. The attributes a file does not have are left out of its FileXattrs, and the other errors of
+		 * a file are reported in FileXattrs::error rather than failing the whole batch.
+		 *
+		 * @param paths Paths to the files
+		 * @param names The names of the attributes to get, all of them if empty
+		 * @param threads The maximum number of threads reading the attributes
+		 * @return The attributes of each file, in the order of @p paths, as a recpp::rx::Single
+		 */
+		recpp::rx::Single<std::vector<FileXattrs>> rxGetXattrs(std::vector<std::filesystem::path> paths, std::vector<std::string> names = {},
+															   unsigned threads = 0) const;
+
+		/**
+		 * @brief Asynchronously gets a handle of the file @p path (symlinks are not followed) that identifies it across its renames, as if by
+		 * name_to_handle_at.
+		 * <p>
+		 * A handle is small enough to persist in place of a path, in an index or a journal, and rxResolveFileHandle opens the file it identifies wherever
+		 * it was moved to on its filesystem. Its path is not always known though: when the kernel cannot tell it, such as with a cold cache, only the
+		 * directory the file was in when its handle was taken is searched, so a file that also moved to another directory is not found. File handles are
+		 * only supported on Linux, and fail with std::errc::operation_not_supported elsewhere and on the filesystems that cannot export handles.
+		 *
+		 * @param path Path to the file
+		 * @return The handle of the file as a recpp::rx::Single
+		 */
+		recpp::rx::Single<FileHandle> rxFileHandle(const std::filesystem::path &path) const;
+
+		/**
+		 * @brief Asynchronously finds the current path of the file identified by @p handle on the filesystem mounted at @p mountPoint, as if by
+		 * open_by_handle_at.
+		 * <p>
+		 * The kernel usually knows the path of the file it opens by handle, but not always, such as after the file was renamed with a cold cache: its
+		 * directory at the time of rxFileHandle is then searched for it, which finds it unless it also moved to another directory. Opening a file by handle
+		 * requires the CAP_DAC_READ_SEARCH capability, and fails with std::errc::operation_not_permitted without it.
+		 *
+		 * @param handle The handle returned by rxFileHandle
+		 * @param mountPoint Any path on the filesystem of the file, usually its mount point
+		 * @return The path of the file as a recpp::rx::Single, failing if the file was removed or cannot be found
+		 */
+		recpp::rx::Single<std::filesystem::path> rxResolveFileHandle(const FileHandle &handle, const std::filesystem::path &mountPoint) const;
+
 		/**
 		 * @brief Returns the number of hard links for the filesystem object identified by path @p path.
 		 *
@@ -299,6 +1093,65 @@ namespace recpp::filesystem
 		 */
 		recpp::rx::Single<std::uintmax_t> rxHardLinkCount(const std::filesystem::path &path) const;
 
+		/**
+		 * @brief Asynchronously hashes the contents of the file @p path (symlinks are followed). The file is read in large aligned blocks, the next block
+		 * being read while the current one is hashed.
+		 *
+		 * @param path Path of the file to hash
+		 * @param algorithm The hash function to use
+		 * @return The digest of the contents of @p path as a recpp::rx::Single
+		 */
+		recpp::rx::Single<Digest> rxHashFile(const std::filesystem::path &path, HashAlgorithm algorithm = HashAlgorithm::xxh3) const;
+
+		/**
+		 * @brief Asynchronously computes a Merkle digest of the tree rooted at @p root (symlinks are not followed), so that two trees with the same contents
+		 * have the same digest wherever they are.
+		 * <p>
+		 * The digest of a regular file is the digest of its contents, the digest of a symlink is the digest of its target, and the digest of a directory is
+		 * the digest of the type, name and digest of each of its entries sorted by name. Other files only contribute their type and name. Regular files are
+		 * hashed on several threads.
+		 *
+		 * @param root Path of the tree to hash
+		 * @param algorithm The hash function to use
+		 * @return The digest of the tree as a recpp::rx::Single
+		 */
+		recpp::rx::Single<Digest> rxHashTree(const std::filesystem::path &root, HashAlgorithm algorithm = HashAlgorithm::xxh3) const;
+
+		/**
+		 * @brief Asynchronously builds the MetadataIndex of the tree rooted at @p root from a parallel walk (symlinks are not followed).
+		 *
+		 * @param root Path of the tree to index
+		 * @param options The options of the walk
+		 * @return The index of @p root as a recpp::rx::Single
+		 */
+		recpp::rx::Single<MetadataIndex> rxBuildIndex(const std::filesystem::path &root, const MetadataIndexOptions &options = MetadataIndexOptions()) const;
+
+		/**
+		 * @brief Asynchronously maps the MetadataIndex written to @p file, which only reads its header whatever the size of the index.
+		 *
+		 * @param file Path of the index file
+		 * @return The index written to @p file as a recpp::rx::Single
+		 */
+		recpp::rx::Single<MetadataIndex> rxOpenIndex(const std::filesystem::path &file) const;
+
+		/**
+		 * @brief Asynchronously brings @p index up to date with its tree, only listing again the directories whose modification time changed.
+		 *
+		 * @param index The index to refresh
+		 * @param options The options of the walk
+		 * @return The refreshed index as a recpp::rx::Single
+		 */
+		recpp::rx::Single<MetadataIndex> rxRefreshIndex(const MetadataIndex &index, const MetadataIndexOptions &options = MetadataIndexOptions()) const;
+
+		/**
+		 * @brief Asynchronously writes @p index to @p file, so that it can be opened again with rxOpenIndex.
+		 *
+		 * @param index The index to write
+		 * @param file Path of the index file
+		 * @return The resulting recpp::rx::Completable
+		 */
+		recpp::rx::Completable rxWriteIndex(const MetadataIndex &index, const std::filesystem::path &file) const;
+
 		/**
 		 * @brief Asynchronously returns the time of the last modification of @p path, determined as if by accessing the member st_mtime of the POSIX stat
 		 * (symlinks are followed). The non-throwing overload returns std::filesystem::file_time_type::min() on errors.
@@ -359,6 +1212,18 @@ namespace recpp::filesystem
 		 */
 		recpp::rx::Single<std::uintmax_t> rxRemoveAll(const std::filesystem::path &path) const;
 
+		/**
+		 * @brief Same as rxRemoveAll, except that the removal can be interrupted through @p token. The token is checked before the removal starts and before
+		 * each removed entry, so that a cancelled or timed out removal releases its scheduler thread without waiting for the whole tree. Entries already
+		 * removed are not restored.
+		 *
+		 * @param path Path to delete
+		 * @param token The CancellationToken used to interrupt the removal, reported as an OperationCanceledError
+		 * @return Returns the number of files and directories that were deleted (which may be zero if @p path did not exist to begin with) as a
+		 * recpp::rx::Single
+		 */
+		recpp::rx::Single<std::uintmax_t> rxRemoveAll(const std::filesystem::path &path, const CancellationToken &token) const;
+
 		/**
 		 * @brief Asynchronously moves or renames the filesystem object identified by @p oldPath to @p newPath as if by the POSIX rename.
 		 *
@@ -379,6 +1244,37 @@ namespace recpp::filesystem
 		 */
 		recpp::rx::Completable rxResizeFile(const std::filesystem::path &path, std::uintmax_t newSize) const;
 
+		/**
+		 * @brief Asynchronously changes the blocks allocated to the @p length bytes of the regular file named by @p path from @p offset, as if by Linux
+		 * fallocate.
+		 * <p>
+		 * Allocating the blocks of a file before writing it lets the filesystem lay them out contiguously, unlike rxResizeFile which only extends it
+		 * logically, and makes running out of space fail here rather than in the middle of the writes. AllocationMode::zeroRange falls back to punching a
+		 * hole and allocating it again on the filesystems that cannot zero a range. Other systems than Linux only support AllocationMode::allocate, through
+		 * posix_fallocate where it exists, and the unsupported modes fail with std::errc::operation_not_supported, as do the filesystems that do not
+		 * support a mode. A @p length of 0 does nothing.
+		 *
+		 * @param path Path to the file
+		 * @param offset The offset of the first byte of the range
+		 * @param length The number of bytes of the range
+		 * @param mode What to do to the blocks of the range
+		 * @return The resulting recpp::rx::Completable
+		 */
+		recpp::rx::Completable rxAllocate(const std::filesystem::path &path, std::uintmax_t offset, std::uintmax_t length,
+										  AllocationMode mode = AllocationMode::allocate) const;
+
+		/**
+		 * @brief Asynchronously lists the segments of the regular file named by @p path holding data, in order, as if by lseek with SEEK_DATA and SEEK_HOLE.
+		 * <p>
+		 * The ranges between the segments are holes, which read as zeros without taking space on the disk, and which the copies and the hashes of sparse
+		 * files can skip: rxHashFile and rxHashTree hash the holes of the files with fewer blocks than their size needs without reading them. The whole
+		 * file is a single segment where holes cannot be found, and an empty file has no segment.
+		 *
+		 * @param path Path to the file
+		 * @return The segments of the file as a recpp::rx::Single
+		 */
+		recpp::rx::Single<std::vector<DataSegment>> rxDataSegments(const std::filesystem::path &path) const;
+
 		/**
 		 * @brief Asynchronously determines the information about the filesystem on which the pathname @p path is located, as if by POSIX statvfs.
 		 *
@@ -404,6 +1300,38 @@ namespace recpp::filesystem
 		 */
 		recpp::rx::Single<std::filesystem::file_status> rxSymlinkStatus(const std::filesystem::path &path) const;
 
+		/**
+		 * @brief Asynchronously makes the tree rooted at @p destination a copy of the tree rooted at @p source, only changing what differs between them,
+		 * like rsync does. @p destination is created if it does not exist.
+		 * <p>
+		 * Both trees are listed into compact snapshots on several threads and compared: regular files are compared by size and modification time, or by
+		 * contents if @p options asks so, and symlinks by target. Only then are the changes made, the copies being spread over several threads. Files
+		 * that only moved within the tree are renamed instead of copied again. Copied files keep the modification time of their source, so that the next
+		 * synchronization of an unchanged tree has nothing to copy. Each copy is written to a hidden temporary file next to its destination, named
+		 * ".<name>.recpp-sync-<random>-<index>" and unique to the synchronization, before being renamed over it: the files named so are skipped in both
+		 * trees, so that synchronizations running at once never copy nor remove the temporary files of each other.
+		 *
+		 * @param source Path of the tree to copy
+		 * @param destination Path of the copy
+		 * @param options The options of the synchronization
+		 * @return The resulting recpp::rx::Completable
+		 */
+		recpp::rx::Completable rxSync(const std::filesystem::path &source, const std::filesystem::path &destination,
+									  const SyncOptions &options = SyncOptions()) const;
+
+		/**
+		 * @brief Same as rxSync(source, destination, options), also reporting each change made to @p destination, or each change that would be made if
+		 * @p options asks for a dry run.
+		 *
+		 * @param source Path of the tree to copy
+		 * @param destination Path of the copy
+		 * @param onAction The function called with each change once it is made, from the threads of the synchronization but never concurrently
+		 * @param options The options of the synchronization
+		 * @return The resulting recpp::rx::Completable
+		 */
+		recpp::rx::Completable rxSync(const std::filesystem::path &source, const std::filesystem::path &destination,
+									  const std::function<void(const SyncAction &action)> &onAction, const SyncOptions &options = SyncOptions()) const;
+
 		/**
 		 * @brief Asynchronously returns the directory location suitable for temporary files.
 		 *
@@ -492,6 +1420,31 @@ namespace recpp::filesystem
 		recpp::rx::Single<bool> rxIsSymlink(const std::filesystem::path &path) const;
 
 	private:
-		recpp::async::Scheduler &m_scheduler;
+		struct MountLimiter
+		{
+			std::string							mountPoint;
+			std::shared_ptr<ConcurrencyLimiter> limiter;
+		};
+
+		template <typename T>
+		recpp::rx::Single<T>		deliver(const recpp::rx::Single<T> &single) const;
+		recpp::rx::Completable		deliver(const recpp::rx::Completable &completable) const;
+		template <typename T>
+		recpp::rx::Single<T>		dispatch(const std::filesystem::path &path, IoPriority priority, const recpp::rx::Single<T> &single,
+											 bool limited = true) const;
+		recpp::rx::Completable		dispatch(const std::filesystem::path &path, IoPriority priority, const recpp::rx::Completable &completable,
+											 bool limited = true) const;
+		std::optional<MountLimiter> limiter(const std::filesystem::path &path) const;
+		recpp::async::Scheduler	   &scheduler(const std::filesystem::path &path, IoPriority priority) const;
+
+		recpp::async::Scheduler						&m_scheduler;
+		IoScheduler									*m_ioScheduler = nullptr;
+		std::optional<IoPriority>					 m_priority;
+		std::vector<MountLimiter>					 m_limiters;
+		std::optional<CancellationToken>			 m_cancellationToken;
+		std::optional<CanonicalCache>				 m_canonicalCache;
+		recpp::async::Scheduler						*m_completionScheduler = nullptr;
+		std::shared_ptr<FileSystemBackend>			 m_backend;
+		std::shared_ptr<const FaultInjectionBackend> m_faultInjection;
 	};
 } // namespace recpp::filesystem
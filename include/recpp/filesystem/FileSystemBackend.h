@@ -0,0 +1,346 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief FileSystemBackend is the interface of the filesystems a FileSystem can work on, with the blocking primitives its operations are made of.
+	 * <p>
+	 * Each primitive behaves like the std::filesystem function of the same name, and reports its errors by throwing a std::filesystem::filesystem_error with
+	 * the same error codes. The backends provided are NativeBackend, which is the filesystem of the operating system, and MemoryBackend. A backend is used
+	 * from the threads of the schedulers of the FileSystem objects using it, so that its primitives must be safe to call concurrently.
+	 * <p>
+	 * The primitives only cover the portable structure and contents of a tree. The FileSystem operations that need more, such as extended attributes, file
+	 * handles, preallocation, sparse segments, following a file, durable journals, archives or indexes, are not part of this contract, and fail with
+	 * std::errc::operation_not_supported on a FileSystem using a backend (see FileSystem::withBackend for the full list).
+	 */
+	class FileSystemBackend
+	{
+	public:
+		virtual ~FileSystemBackend() = default;
+
+		/**
+		 * @brief Get the absolute form of @p path, like std::filesystem::absolute.
+		 *
+		 * @param path The path to convert
+		 * @return The absolute path
+		 */
+		virtual std::filesystem::path absolute(const std::filesystem::path &path) const = 0;
+
+		/**
+		 * @brief Get the canonical path of @p path, like std::filesystem::canonical.
+		 *
+		 * @param path The path to canonicalize, which must exist
+		 * @return The canonical path
+		 */
+		virtual std::filesystem::path canonical(const std::filesystem::path &path) const = 0;
+
+		/**
+		 * @brief Get the canonical path of the longest existing prefix of @p path followed by the rest of it, like std::filesystem::weakly_canonical.
+		 *
+		 * @param path The path to canonicalize
+		 * @return The weakly canonical path
+		 */
+		virtual std::filesystem::path weaklyCanonical(const std::filesystem::path &path) const = 0;
+
+		/**
+		 * @brief Copy files or directories, like std::filesystem::copy.
+		 *
+		 * @param from The file or directory to copy
+		 * @param to The destination
+		 * @param options How to copy
+		 */
+		virtual void copy(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options) = 0;
+
+		/**
+		 * @brief Copy the content and permissions of a regular file, like std::filesystem::copy_file.
+		 *
+		 * @param from The file to copy
+		 * @param to The destination
+		 * @param options What to do if @p to exists
+		 * @return Whether the file was copied
+		 */
+		virtual bool copyFile(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options) = 0;
+
+		/**
+		 * @brief Create a symlink with the target of another, like std::filesystem::copy_symlink.
+		 *
+		 * @param from The symlink to copy
+		 * @param to The symlink to create
+		 */
+		virtual void copySymlink(const std::filesystem::path &from, const std::filesystem::path &to) = 0;
+
+		/**
+		 * @brief Create a directory whose parent exists, like std::filesystem::create_directory.
+		 *
+		 * @param path The directory to create
+		 * @return Whether the directory was created, false if it already existed
+		 */
+		virtual bool createDirectory(const std::filesystem::path &path) = 0;
+
+		/**
+		 * @brief Create a directory with the attributes of another, like std::filesystem::create_directory.
+		 *
+		 * @param path The directory to create
+		 * @param existingPath The directory to copy the attributes of
+		 * @return Whether the directory was created, false if it already existed
+		 */
+		virtual bool createDirectory(const std::filesystem::path &path, const std::filesystem::path &existingPath) = 0;
+
+		/**
+		 * @brief Create a directory and its missing parents, like std::filesystem::create_directories.
+		 *
+		 * @param path The directory to create
+		 * @return Whether a directory was created
+		 */
+		virtual bool createDirectories(const std::filesystem::path &path) = 0;
+
+		/**
+		 * @brief Create a hard link, like std::filesystem::create_hard_link.
+		 *
+		 * @param target The file to link to
+		 * @param link The new link
+		 */
+		virtual void createHardLink(const std::filesystem::path &target, const std::filesystem::path &link) = 0;
+
+		/**
+		 * @brief Create a symlink, like std::filesystem::create_symlink.
+		 *
+		 * @param target The target of the symlink
+		 * @param link The symlink to create
+		 */
+		virtual void createSymlink(const std::filesystem::path &target, const std::filesystem::path &link) = 0;
+
+		/**
+		 * @brief Create a symlink to a directory, like std::filesystem::create_directory_symlink.
+		 *
+		 * @param target The target of the symlink
+		 * @param link The symlink to create
+		 */
+		virtual void createDirectorySymlink(const std::filesystem::path &target, const std::filesystem::path &link) = 0;
+
+		/**
+		 * @brief Get the current working directory, like std::filesystem::current_path.
+		 *
+		 * @return The absolute path relative paths are resolved against
+		 */
+		virtual std::filesystem::path currentPath() const = 0;
+
+		/**
+		 * @brief List the entries of a directory, like std::filesystem::directory_iterator.
+		 *
+		 * @param path The directory to list
+		 * @return The paths of its entries, @p path followed by their names, sorted by name
+		 */
+		virtual std::vector<std::filesystem::path> directoryEntries(const std::filesystem::path &path) const = 0;
+
+		/**
+		 * @brief Check whether two paths resolve to the same file, like std::filesystem::equivalent.
+		 *
+		 * @param path1 The first path
+		 * @param path2 The second path
+		 * @return Whether they are the same file
+		 */
+		virtual bool equivalent(const std::filesystem::path &path1, const std::filesystem::path &path2) const = 0;
+
+		/**
+		 * @brief Get the size of a regular file, like std::filesystem::file_size.
+		 *
+		 * @param path The file
+		 * @return Its size in bytes
+		 */
+		virtual std::uintmax_t fileSize(const std::filesystem::path &path) const = 0;
+
+		/**
+		 * @brief Get the number of hard links of a file, like std::filesystem::hard_link_count.
+		 *
+		 * @param path The file
+		 * @return Its number of hard links
+		 */
+		virtual std::uintmax_t hardLinkCount(const std::filesystem::path &path) const = 0;
+
+		/**
+		 * @brief Check whether a file or directory is empty, like std::filesystem::is_empty.
+		 *
+		 * @param path The file or directory
+		 * @return Whether it is empty
+		 */
+		virtual bool isEmpty(const std::filesystem::path &path) const = 0;
+
+		/**
+		 * @brief Get the modification time of a file, like std::filesystem::last_write_time.
+		 *
+		 * @param path The file
+		 * @return Its modification time
+		 */
+		virtual std::filesystem::file_time_type lastWriteTime(const std::filesystem::path &path) const = 0;
+
+		/**
+		 * @brief Change the modification time of a file, like std::filesystem::last_write_time.
+		 *
+		 * @param path The file
+		 * @param newTime Its new modification time
+		 */
+		virtual void lastWriteTime(const std::filesystem::path &path, std::filesystem::file_time_type newTime) = 0;
+
+		/**
+		 * @brief Change the permissions of a file, like std::filesystem::permissions.
+		 *
+		 * @param path The file
+		 * @param permissions The permissions to apply
+		 * @param options Whether @p permissions replace, are added to or are removed from the current permissions, and whether symlinks are followed
+		 */
+		virtual void permissions(const std::filesystem::path &path, std::filesystem::perms permissions, std::filesystem::perm_options options) = 0;
+
+		/**
+		 * @brief Read the whole content of a regular file.
+		 *
+		 * @param path The file
+		 * @return Its content
+		 */
+		virtual std::string readFile(const std::filesystem::path &path) const = 0;
+
+		/**
+		 * @brief Read up to @p size bytes of a regular file from @p offset, so that a large file can be read by chunks rather than whole.
+		 *
+		 * @param path The file
+		 * @param offset The position of the first byte to read
+		 * @param data The buffer to read into
+		 * @param size The size of @p data
+		 * @return The number of bytes read, less than @p size only at the end of the file
+		 */
+		virtual std::size_t readFile(const std::filesystem::path &path, std::uintmax_t offset, char *data, std::size_t size) const = 0;
+
+		/**
+		 * @brief Get the target of a symlink, like std::filesystem::read_symlink.
+		 *
+		 * @param path The symlink
+		 * @return Its target
+		 */
+		virtual std::filesystem::path readSymlink(const std::filesystem::path &path) const = 0;
+
+		/**
+		 * @brief Remove a file or an empty directory, like std::filesystem::remove.
+		 *
+		 * @param path The file or directory
+		 * @return Whether it was removed, false if it did not exist
+		 */
+		virtual bool remove(const std::filesystem::path &path) = 0;
+
+		/**
+		 * @brief Remove a file or a directory and everything under it, like std::filesystem::remove_all.
+		 *
+		 * @param path The file or directory
+		 * @return The number of files and directories removed
+		 */
+		virtual std::uintmax_t removeAll(const std::filesystem::path &path) = 0;
+
+		/**
+		 * @brief Move a file or directory, like std::filesystem::rename.
+		 *
+		 * @param oldPath The file or directory to move
+		 * @param newPath Its new path, replaced if it exists
+		 */
+		virtual void rename(const std::filesystem::path &oldPath, const std::filesystem::path &newPath) = 0;
+
+		/**
+		 * @brief Change the size of a regular file, like std::filesystem::resize_file.
+		 *
+		 * @param path The file
+		 * @param newSize Its new size, the added bytes being zeros
+		 */
+		virtual void resizeFile(const std::filesystem::path &path, std::uintmax_t newSize) = 0;
+
+		/**
+		 * @brief Get the space of the filesystem of a path, like std::filesystem::space.
+		 *
+		 * @param path A path on the filesystem
+		 * @return Its capacity, free and available space
+		 */
+		virtual std::filesystem::space_info space(const std::filesystem::path &path) const = 0;
+
+		/**
+		 * @brief Get the type and permissions of a file, following symlinks, like std::filesystem::status.
+		 *
+		 * @param path The file
+		 * @return Its status, of type std::filesystem::file_type::not_found if it does not exist
+		 */
+		virtual std::filesystem::file_status status(const std::filesystem::path &path) const = 0;
+
+		/**
+		 * @brief Get the type and permissions of a file, without following symlinks, like std::filesystem::symlink_status.
+		 *
+		 * @param path The file
+		 * @return Its status, of type std::filesystem::file_type::not_found if it does not exist
+		 */
+		virtual std::filesystem::file_status symlinkStatus(const std::filesystem::path &path) const = 0;
+
+		/**
+		 * @brief Get the directory for temporary files, like std::filesystem::temp_directory_path.
+		 *
+		 * @return Its path, which is a directory
+		 */
+		virtual std::filesystem::path tempDirectoryPath() const = 0;
+
+		/**
+		 * @brief Replace the content of a regular file, creating it if it does not exist.
+		 *
+		 * @param path The file, whose parent must exist
+		 * @param content Its new content
+		 */
+		virtual void writeFile(const std::filesystem::path &path, std::string_view content) = 0;
+	};
+
+	/**
+	 * @brief NativeBackend is the FileSystemBackend of the filesystem of the operating system, forwarding each primitive to std::filesystem.
+	 * <p>
+	 * A FileSystem given a NativeBackend keeps working as if it had none, with its own implementations of the operations, which also support cancellation
+	 * and the operations that are not made of these primitives.
+	 */
+	class NativeBackend final : public FileSystemBackend
+	{
+	public:
+		std::filesystem::path			   absolute(const std::filesystem::path &path) const override;
+		std::filesystem::path			   canonical(const std::filesystem::path &path) const override;
+		std::filesystem::path			   weaklyCanonical(const std::filesystem::path &path) const override;
+		void							   copy(const std::filesystem::path &from, const std::filesystem::path &to,
+												std::filesystem::copy_options options) override;
+		bool							   copyFile(const std::filesystem::path &from, const std::filesystem::path &to,
+													std::filesystem::copy_options options) override;
+		void							   copySymlink(const std::filesystem::path &from, const std::filesystem::path &to) override;
+		bool							   createDirectory(const std::filesystem::path &path) override;
+		bool							   createDirectory(const std::filesystem::path &path, const std::filesystem::path &existingPath) override;
+		bool							   createDirectories(const std::filesystem::path &path) override;
+		void							   createHardLink(const std::filesystem::path &target, const std::filesystem::path &link) override;
+		void							   createSymlink(const std::filesystem::path &target, const std::filesystem::path &link) override;
+		void							   createDirectorySymlink(const std::filesystem::path &target, const std::filesystem::path &link) override;
+		std::filesystem::path			   currentPath() const override;
+		std::vector<std::filesystem::path> directoryEntries(const std::filesystem::path &path) const override;
+		bool							   equivalent(const std::filesystem::path &path1, const std::filesystem::path &path2) const override;
+		std::uintmax_t					   fileSize(const std::filesystem::path &path) const override;
+		std::uintmax_t					   hardLinkCount(const std::filesystem::path &path) const override;
+		bool							   isEmpty(const std::filesystem::path &path) const override;
+		std::filesystem::file_time_type	   lastWriteTime(const std::filesystem::path &path) const override;
+		void							   lastWriteTime(const std::filesystem::path &path, std::filesystem::file_time_type newTime) override;
+		void							   permissions(const std::filesystem::path &path, std::filesystem::perms permissions,
+													   std::filesystem::perm_options options) override;
+		std::string						   readFile(const std::filesystem::path &path) const override;
+		std::size_t						   readFile(const std::filesystem::path &path, std::uintmax_t offset, char *data, std::size_t size) const override;
+		std::filesystem::path			   readSymlink(const std::filesystem::path &path) const override;
+		bool							   remove(const std::filesystem::path &path) override;
+		std::uintmax_t					   removeAll(const std::filesystem::path &path) override;
+		void							   rename(const std::filesystem::path &oldPath, const std::filesystem::path &newPath) override;
+		void							   resizeFile(const std::filesystem::path &path, std::uintmax_t newSize) override;
+		std::filesystem::space_info		   space(const std::filesystem::path &path) const override;
+		std::filesystem::file_status	   status(const std::filesystem::path &path) const override;
+		std::filesystem::file_status	   symlinkStatus(const std::filesystem::path &path) const override;
+		std::filesystem::path			   tempDirectoryPath() const override;
+		void							   writeFile(const std::filesystem::path &path, std::string_view content) override;
+	};
+} // namespace recpp::filesystem
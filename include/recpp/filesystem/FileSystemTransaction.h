@@ -0,0 +1,150 @@
+#pragma once
+
+#include <recpp/filesystem/CancellationToken.h>
+
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief The kinds of operations a FileSystemTransaction can apply.
+	 */
+	enum class TransactionOperationType
+	{
+		/// A directory is created, its parent having to exist, like std::filesystem::create_directory
+		createDirectory,
+		/// A file or directory is moved, replacing its destination if any, like std::filesystem::rename
+		rename,
+		/// A file or a whole directory is removed, nothing being done if it does not exist
+		remove,
+		/// The permissions of a file are changed, like std::filesystem::permissions
+		permissions,
+	};
+
+	/**
+	 * @brief An operation of a FileSystemTransaction.
+	 */
+	struct TransactionOperation
+	{
+		TransactionOperationType	  type = TransactionOperationType::createDirectory;
+		/// The file the operation applies to, the source of a rename
+		std::filesystem::path		  path;
+		/// The destination of a rename
+		std::filesystem::path		  target;
+		/// The permissions to apply
+		std::filesystem::perms		  permissions = std::filesystem::perms::none;
+		/// How to apply the permissions
+		std::filesystem::perm_options options = std::filesystem::perm_options::replace;
+	};
+
+	/**
+	 * @brief The options of rxCommit.
+	 */
+	struct TransactionOptions
+	{
+		/// The number of threads applying independent operations, 0 for one per hardware thread
+		unsigned						 threads = 0;
+		/// The file recording the progress of the transaction, which must not exist, for rxRecoverTransaction to finish it after a crash, empty for none
+		std::filesystem::path			 journal;
+		/// The CancellationToken checked before each operation, cancelling the transaction rolling back the operations already applied
+		std::optional<CancellationToken> token;
+	};
+
+	/**
+	 * @brief Error reported when a transaction failed and some of its operations could not be rolled back. The journal of the transaction, if any, is kept
+	 * so that rxRecoverTransaction can be retried once the problem is fixed.
+	 */
+	class TransactionRollbackError : public std::runtime_error
+	{
+	public:
+		/**
+		 * @brief Construct a new TransactionRollbackError object.
+		 *
+		 * @param failure The error that made the transaction fail
+		 * @param rollbackFailure The first error met while rolling it back
+		 */
+		TransactionRollbackError(std::exception_ptr failure, std::exception_ptr rollbackFailure);
+
+		/**
+		 * @brief Get the error that made the transaction fail.
+		 *
+		 * @return The error of the failed operation
+		 */
+		const std::exception_ptr &failure() const;
+
+		/**
+		 * @brief Get the first error met while rolling the transaction back.
+		 *
+		 * @return The error of the operation that could not be undone
+		 */
+		const std::exception_ptr &rollbackFailure() const;
+
+	private:
+		std::exception_ptr m_failure;
+		std::exception_ptr m_rollbackFailure;
+	};
+
+	/**
+	 * @brief FileSystemTransaction collects filesystem mutations to apply as a whole with rxCommit: either every operation is applied, or the ones applied
+	 * before a failure are undone.
+	 * <p>
+	 * Operations are applied in the order they were added, except that operations on unrelated paths, none of them being the same as or under the other, are
+	 * independent and applied in parallel. Files replaced by a rename or removed are first moved next to their path under a hidden name, and only deleted once
+	 * every operation succeeded, so that undoing an operation never needs to copy anything. Each operation is written to the journal of the transaction, if
+	 * any, before it is applied.
+	 */
+	class FileSystemTransaction
+	{
+	public:
+		/**
+		 * @brief Create the directory @p path, whose parent must exist or be created by a previous operation.
+		 *
+		 * @param path The directory to create
+		 * @return This transaction
+		 */
+		FileSystemTransaction &createDirectory(const std::filesystem::path &path);
+
+		/**
+		 * @brief Move @p from to @p to, replacing @p to if it exists.
+		 *
+		 * @param from The file or directory to move
+		 * @param to Its new path
+		 * @return This transaction
+		 */
+		FileSystemTransaction &rename(const std::filesystem::path &from, const std::filesystem::path &to);
+
+		/**
+		 * @brief Remove @p path, and everything under it if it is a directory. Nothing is done if it does not exist.
+		 *
+		 * @param path The file or directory to remove
+		 * @return This transaction
+		 */
+		FileSystemTransaction &remove(const std::filesystem::path &path);
+
+		/**
+		 * @brief Change the permissions of @p path, following symlinks.
+		 *
+		 * @param path The file whose permissions change
+		 * @param permissions The permissions to apply
+		 * @param options Whether @p permissions replace, are added to or are removed from the current permissions
+		 * @return This transaction
+		 */
+		FileSystemTransaction &permissions(const std::filesystem::path &path, std::filesystem::perms permissions,
+										   std::filesystem::perm_options options = std::filesystem::perm_options::replace);
+
+		/**
+		 * @brief Get the operations of this transaction.
+		 *
+		 * @return The operations, in the order they were added
+		 */
+		const std::vector<TransactionOperation> &operations() const;
+
+	private:
+		std::vector<TransactionOperation> m_operations;
+	};
+} // namespace recpp::filesystem
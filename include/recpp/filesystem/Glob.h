@@ -0,0 +1,24 @@
+#pragma once
+
+#include <recpp/filesystem/CancellationToken.h>
+
+#include <filesystem>
+#include <optional>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief The options of rxGlob.
+	 */
+	struct GlobOptions
+	{
+		/// Let wildcards match the names starting with a dot, which otherwise only match a pattern starting with a literal dot
+		bool							   matchHidden = false;
+		/// The number of threads walking the directories, 0 for one per hardware thread
+		unsigned						   threads = 0;
+		/// The options used to list directories, for instance to skip the directories that cannot be read
+		std::filesystem::directory_options directoryOptions = std::filesystem::directory_options::none;
+		/// The CancellationToken checked before listing each directory
+		std::optional<CancellationToken>   token;
+	};
+} // namespace recpp::filesystem
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <recpp/filesystem/CancellationToken.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief A line matching the pattern of rxGrep.
+	 */
+	struct GrepMatch
+	{
+		/// The path of the file containing the line
+		std::filesystem::path path;
+		/// The number of the line in the file, starting at 1
+		std::uintmax_t		  lineNumber = 0;
+		/// The offset of the first byte of the line in the file
+		std::uintmax_t		  offset = 0;
+		/// The contents of the line, without its line terminator
+		std::string			  line;
+	};
+
+	/**
+	 * @brief The options of rxGrep.
+	 */
+	struct GrepOptions
+	{
+		/// Treat the pattern as an ECMAScript regular expression rather than as a literal string
+		bool							   regex = false;
+		/// Match the letters of the pattern regardless of their case
+		bool							   ignoreCase = false;
+		/// Skip the files with a NUL byte in their first 8 KiB, which are most likely binary
+		bool							   skipBinary = true;
+		/// The number of matching lines after which the rest of a file is skipped, 0 for no limit
+		std::size_t						   maxMatchesPerFile = 0;
+		/// The number of threads walking the directories and searching the files, 0 for one per hardware thread
+		unsigned						   threads = 0;
+		/// The options used to list directories, for instance to skip the directories that cannot be read
+		std::filesystem::directory_options directoryOptions = std::filesystem::directory_options::none;
+		/// The CancellationToken checked before listing each directory and searching each file
+		std::optional<CancellationToken>   token;
+	};
+} // namespace recpp::filesystem
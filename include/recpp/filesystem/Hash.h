@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief The hash functions available to hash file contents.
+	 */
+	enum class HashAlgorithm
+	{
+		/// 64 bits XXH3, very fast but not cryptographic: suited for cache keys and change detection
+		xxh3,
+		/// 256 bits BLAKE3, cryptographic and still fast, hashing large inputs on several threads: suited for deduplication and content addressing
+		blake3,
+	};
+
+	/**
+	 * @brief Digest is the value produced by a hash function, along with the algorithm that produced it.
+	 * <p>
+	 * XXH3 digests are stored in big endian order, so that their hexadecimal form matches the one printed by the reference xxhsum tool.
+	 */
+	class Digest
+	{
+	public:
+		/// The size of the largest digest, in bytes
+		static constexpr std::size_t maxSize = 32;
+
+		/**
+		 * @brief Construct a new empty Digest object.
+		 */
+		Digest() = default;
+
+		/**
+		 * @brief Construct a new Digest object.
+		 *
+		 * @param algorithm The algorithm that produced the digest
+		 * @param data The bytes of the digest
+		 * @param size The number of bytes of the digest, at most maxSize
+		 */
+		Digest(HashAlgorithm algorithm, const std::uint8_t *data, std::size_t size);
+
+		/**
+		 * @brief Get the algorithm that produced this digest.
+		 *
+		 * @return The algorithm that produced this digest
+		 */
+		HashAlgorithm algorithm() const;
+
+		/**
+		 * @brief Get the bytes of this digest.
+		 *
+		 * @return A pointer to the size() bytes of this digest
+		 */
+		const std::uint8_t *data() const;
+
+		/**
+		 * @brief Get the number of bytes of this digest.
+		 *
+		 * @return The number of bytes of this digest, 0 if it is empty
+		 */
+		std::size_t size() const;
+
+		/**
+		 * @brief Get the hexadecimal representation of this digest.
+		 *
+		 * @return The bytes of this digest as lowercase hexadecimal digits
+		 */
+		std::string toString() const;
+
+		bool operator==(const Digest &other) const;
+		bool operator!=(const Digest &other) const;
+		bool operator<(const Digest &other) const;
+
+	private:
+		HashAlgorithm					  m_algorithm = HashAlgorithm::xxh3;
+		std::array<std::uint8_t, maxSize> m_bytes = {};
+		std::size_t						  m_size = 0;
+	};
+
+	/**
+	 * @brief Hasher computes the Digest of data appended incrementally.
+	 */
+	class Hasher
+	{
+	public:
+		/**
+		 * @brief Construct a new Hasher object.
+		 *
+		 * @param algorithm The algorithm to use
+		 */
+		Hasher(HashAlgorithm algorithm = HashAlgorithm::xxh3);
+
+		Hasher(const Hasher &) = delete;
+		Hasher(Hasher &&other) noexcept;
+		~Hasher();
+
+		Hasher &operator=(const Hasher &) = delete;
+		Hasher &operator=(Hasher &&other) noexcept;
+
+		/**
+		 * @brief Get the algorithm used by this hasher.
+		 *
+		 * @return The algorithm used by this hasher
+		 */
+		HashAlgorithm algorithm() const;
+
+		/**
+		 * @brief Append data to the hashed input. With HashAlgorithm::blake3, large updates are hashed on several threads, so appending data in blocks of a
+		 * few megabytes is much faster than in small pieces.
+		 *
+		 * @param data The data to append
+		 * @param size The number of bytes to append
+		 */
+		void update(const void *data, std::size_t size);
+
+		/**
+		 * @brief Get the digest of the data appended so far. More data can still be appended afterwards.
+		 *
+		 * @return The digest of the data appended so far
+		 */
+		Digest digest() const;
+
+		/**
+		 * @brief Discard the data appended so far, to hash a new input.
+		 */
+		void reset();
+
+	private:
+		struct State;
+
+		HashAlgorithm		   m_algorithm;
+		std::unique_ptr<State> m_state;
+	};
+} // namespace recpp::filesystem
+
+namespace std
+{
+	template <>
+	struct hash<recpp::filesystem::Digest>
+	{
+		std::size_t operator()(const recpp::filesystem::Digest &digest) const noexcept
+		{
+			// Digests are already uniformly distributed, so their leading bytes make a good hash
+			std::size_t hash = 0;
+			std::memcpy(&hash, digest.data(), std::min(sizeof(hash), digest.size()));
+			return hash;
+		}
+	};
+} // namespace std
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <recpp/async/Scheduler.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief Priority classes used by IoScheduler to keep latency-critical operations away from long running ones.
+	 */
+	enum class IoPriority
+	{
+		/// Short operations a caller is usually waiting on, such as rxExists or rxStatus
+		interactive,
+		/// Long running operations, such as recursive copies or removals
+		bulk,
+		/// Maintenance work, kept on its own schedulers so that it can be given fewer threads than the other classes; it is not preempted by them
+		background,
+	};
+
+	/**
+	 * @brief IoScheduler routes filesystem operations to a recpp::async::Scheduler chosen from the device (st_dev) the operation targets and from its
+	 * IoPriority.
+	 * <p>
+	 * Every device registered with addDevice gets its own set of schedulers, one per priority class, so that a slow network mount cannot starve operations on
+	 * local disks, and so that bulk operations cannot starve interactive ones. The concurrency of a device for a given priority class is the concurrency of
+	 * the scheduler registered for it, typically a recpp::async::ThreadPool sized for that device.
+	 * <p>
+	 * Paths are matched against the registered mount points lexically, so that routing an operation never performs any blocking call on the calling thread.
+	 * Operations targeting paths outside of every registered mount point use the default scheduler of their priority class.
+	 */
+	class IoScheduler
+	{
+	public:
+		/**
+		 * @brief Construct a new IoScheduler object.
+		 *
+		 * @param defaultScheduler The recpp::async::Scheduler to use for every priority class and device until configured otherwise
+		 */
+		IoScheduler(recpp::async::Scheduler &defaultScheduler);
+
+		/**
+		 * @brief Set the scheduler used for @p priority operations targeting paths outside of every registered device.
+		 *
+		 * @param priority The priority class to configure
+		 * @param scheduler The recpp::async::Scheduler to use for this priority class
+		 */
+		void setScheduler(IoPriority priority, recpp::async::Scheduler &scheduler);
+
+		/**
+		 * @brief Register the device mounted on @p mountPoint, so that operations targeting paths under @p mountPoint with the @p priority class are
+		 * dispatched to @p scheduler.
+		 * <p>
+		 * Mount points resolving to an already registered device share its schedulers. The priority classes that were not configured for a device use the
+		 * scheduler configured for the device's interactive class if any, or the default scheduler of the class otherwise.
+		 * <p>
+		 * This method calls POSIX stat on @p mountPoint and throws std::filesystem::filesystem_error on failure.
+		 *
+		 * @param mountPoint A path to the root directory of the device
+		 * @param priority The priority class to configure
+		 * @param scheduler The recpp::async::Scheduler to use for this device and priority class
+		 */
+		void addDevice(const std::filesystem::path &mountPoint, IoPriority priority, recpp::async::Scheduler &scheduler);
+
+		/**
+		 * @brief Get the scheduler to use for a @p priority operation targeting @p path.
+		 *
+		 * @param path The path targeted by the operation, which does not have to exist
+		 * @param priority The priority class of the operation
+		 * @return The recpp::async::Scheduler to subscribe the operation on
+		 */
+		recpp::async::Scheduler &scheduler(const std::filesystem::path &path, IoPriority priority) const;
+
+		/**
+		 * @brief Get the scheduler to use for a @p priority operation that does not target a specific path.
+		 *
+		 * @param priority The priority class of the operation
+		 * @return The recpp::async::Scheduler to subscribe the operation on
+		 */
+		recpp::async::Scheduler &scheduler(IoPriority priority) const;
+
+	private:
+		static constexpr std::size_t priorityCount = 3;
+
+		using Schedulers = std::array<recpp::async::Scheduler *, priorityCount>;
+
+		struct Device
+		{
+			std::uintmax_t id;
+			Schedulers	   schedulers;
+		};
+
+		struct MountPoint
+		{
+			std::string mountPoint;
+			std::size_t device;
+		};
+
+		recpp::async::Scheduler &resolve(const Schedulers &schedulers, IoPriority priority) const;
+
+		mutable std::shared_mutex m_mutex;
+		Schedulers				  m_defaults;
+		std::vector<Device>		  m_devices;
+		std::vector<MountPoint>	  m_mountPoints;
+	};
+} // namespace recpp::filesystem
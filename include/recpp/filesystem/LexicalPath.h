@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Lexical operations on paths held as strings, much faster than their std::filesystem::path counterparts when processing many paths.
+ * <p>
+ * These functions follow the POSIX grammar of paths, with '/' as the only separator and no root name. Separators are found with memchr, which the C
+ * library vectorizes, components are handled as views of their input, and each function returning a std::string allocates it only once. Each function
+ * gives the result of its std::filesystem::path counterpart, in generic format, except that several leading separators always make a single root
+ * directory.
+ */
+namespace recpp::filesystem::lexical
+{
+	/**
+	 * @brief Normalize @p path like std::filesystem::path::lexically_normal: separators are collapsed, "." components are removed, and each ".." removes
+	 * the preceding component, if any. The result is "." when nothing is left of a relative path.
+	 *
+	 * @param path The path to normalize
+	 * @return The normal form of @p path, empty if @p path is
+	 */
+	std::string normalize(std::string_view path);
+
+	/**
+	 * @brief Get @p path relative to @p base like std::filesystem::path::lexically_relative, without normalizing them first.
+	 *
+	 * @param path The path to make relative
+	 * @param base The path it is made relative to
+	 * @return The relative path, or an empty string if it cannot be told lexically, for instance when only one of the paths is absolute
+	 */
+	std::string relative(std::string_view path, std::string_view base);
+
+	/**
+	 * @brief Get @p path relative to @p base like std::filesystem::path::lexically_proximate: as relative() would, or @p path itself if it cannot be told.
+	 *
+	 * @param path The path to make relative
+	 * @param base The path it is made relative to
+	 * @return The relative path, or @p path
+	 */
+	std::string proximate(std::string_view path, std::string_view base);
+
+	/**
+	 * @brief Append @p path to @p base like std::filesystem::path::operator/: an absolute @p path replaces @p base, and a separator is inserted unless
+	 * @p base is empty or already ends with one.
+	 *
+	 * @param base The path to append to
+	 * @param path The path to append
+	 * @return The joined path
+	 */
+	std::string join(std::string_view base, std::string_view path);
+
+	/**
+	 * @brief Split @p path into its components like std::filesystem::path::iterator: the root directory "/" if there is one, each filename, and an empty
+	 * filename if @p path ends with a separator.
+	 *
+	 * @param path The path to split
+	 * @return Views of the components of @p path
+	 */
+	std::vector<std::string_view> split(std::string_view path);
+
+	/**
+	 * @brief Get the parent of @p path like std::filesystem::path::parent_path, without its trailing separators.
+	 *
+	 * @param path The path to examine
+	 * @return A view of the parent of @p path, @p path itself if it is a root directory
+	 */
+	std::string_view parent(std::string_view path);
+
+	/**
+	 * @brief Get the last component of @p path like std::filesystem::path::filename.
+	 *
+	 * @param path The path to examine
+	 * @return A view of the filename of @p path, empty if it ends with a separator
+	 */
+	std::string_view filename(std::string_view path);
+
+	/**
+	 * @brief Get the filename of @p path without its extension, like std::filesystem::path::stem.
+	 *
+	 * @param path The path to examine
+	 * @return A view of the stem of @p path
+	 */
+	std::string_view stem(std::string_view path);
+
+	/**
+	 * @brief Get the extension of the filename of @p path like std::filesystem::path::extension: from its last '.', unless the filename starts with it or
+	 * is "..".
+	 *
+	 * @param path The path to examine
+	 * @return A view of the extension of @p path, including its '.'
+	 */
+	std::string_view extension(std::string_view path);
+
+	/**
+	 * @brief Compare @p path1 and @p path2 component by component like std::filesystem::path::compare, so that "a/b" sorts before "a-b" and "a//b" equals
+	 * "a/b".
+	 *
+	 * @param path1 The first path
+	 * @param path2 The second path
+	 * @return A negative value if @p path1 sorts before @p path2, a positive value if it sorts after, 0 if they are equal
+	 */
+	int compare(std::string_view path1, std::string_view path2);
+} // namespace recpp::filesystem::lexical
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <recpp/filesystem/FileSystemBackend.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief MemoryBackend is a FileSystemBackend keeping a whole POSIX-like tree in memory: directories, regular files with their content, symlinks and hard
+	 * links, with their permissions and modification times.
+	 * <p>
+	 * Its paths are absolute from its own root directory "/", relative paths being resolved against it as its current directory, and the tree starts with that
+	 * directory only. Its temporary directory is "/tmp", which tempDirectoryPath() only returns once it was created. It is meant for tests, which get a fresh
+	 * and fast filesystem without touching the disk, and as a staging area for generated trees, which are then written to disk in one go with materialize().
+	 * <p>
+	 * The tree can be used from several threads at once: lookups and file contents share a lock on the structure of the tree, which is only taken exclusively
+	 * to add, remove or move entries, and the content and attributes of each file are protected by one of a set of sharded locks, so that reading and writing
+	 * different files does not contend. Copies of a MemoryBackend share the same tree.
+	 */
+	class MemoryBackend final : public FileSystemBackend
+	{
+	public:
+		/**
+		 * @brief Construct a new MemoryBackend object with an empty root directory.
+		 *
+		 * @param capacity The number of bytes reported as the capacity of the filesystem by space(), which is not enforced
+		 */
+		explicit MemoryBackend(std::uintmax_t capacity = std::numeric_limits<std::uintmax_t>::max());
+
+		std::filesystem::path			   absolute(const std::filesystem::path &path) const override;
+		std::filesystem::path			   canonical(const std::filesystem::path &path) const override;
+		std::filesystem::path			   weaklyCanonical(const std::filesystem::path &path) const override;
+		void							   copy(const std::filesystem::path &from, const std::filesystem::path &to,
+												std::filesystem::copy_options options) override;
+		bool							   copyFile(const std::filesystem::path &from, const std::filesystem::path &to,
+													std::filesystem::copy_options options) override;
+		void							   copySymlink(const std::filesystem::path &from, const std::filesystem::path &to) override;
+		bool							   createDirectory(const std::filesystem::path &path) override;
+		bool							   createDirectory(const std::filesystem::path &path, const std::filesystem::path &existingPath) override;
+		bool							   createDirectories(const std::filesystem::path &path) override;
+		void							   createHardLink(const std::filesystem::path &target, const std::filesystem::path &link) override;
+		void							   createSymlink(const std::filesystem::path &target, const std::filesystem::path &link) override;
+		void							   createDirectorySymlink(const std::filesystem::path &target, const std::filesystem::path &link) override;
+		std::filesystem::path			   currentPath() const override;
+		std::vector<std::filesystem::path> directoryEntries(const std::filesystem::path &path) const override;
+		bool							   equivalent(const std::filesystem::path &path1, const std::filesystem::path &path2) const override;
+		std::uintmax_t					   fileSize(const std::filesystem::path &path) const override;
+		std::uintmax_t					   hardLinkCount(const std::filesystem::path &path) const override;
+		bool							   isEmpty(const std::filesystem::path &path) const override;
+		std::filesystem::file_time_type	   lastWriteTime(const std::filesystem::path &path) const override;
+		void							   lastWriteTime(const std::filesystem::path &path, std::filesystem::file_time_type newTime) override;
+		void							   permissions(const std::filesystem::path &path, std::filesystem::perms permissions,
+													   std::filesystem::perm_options options) override;
+		std::string						   readFile(const std::filesystem::path &path) const override;
+		std::size_t						   readFile(const std::filesystem::path &path, std::uintmax_t offset, char *data, std::size_t size) const override;
+		std::filesystem::path			   readSymlink(const std::filesystem::path &path) const override;
+		bool							   remove(const std::filesystem::path &path) override;
+		std::uintmax_t					   removeAll(const std::filesystem::path &path) override;
+		void							   rename(const std::filesystem::path &oldPath, const std::filesystem::path &newPath) override;
+		void							   resizeFile(const std::filesystem::path &path, std::uintmax_t newSize) override;
+		std::filesystem::space_info		   space(const std::filesystem::path &path) const override;
+		std::filesystem::file_status	   status(const std::filesystem::path &path) const override;
+		std::filesystem::file_status	   symlinkStatus(const std::filesystem::path &path) const override;
+		std::filesystem::path			   tempDirectoryPath() const override;
+		void							   writeFile(const std::filesystem::path &path, std::string_view content) override;
+
+		/**
+		 * @brief Write the tree at @p root to @p destination on the filesystem of the operating system.
+		 * <p>
+		 * The directories are created first with the batch directory creation of rxCreateDirectories, then the files, symlinks and hard links are written on
+		 * up to @p threads threads, and the permissions and modification times of the directories are applied last, from the deepest up, so that they are
+		 * not changed by writing their entries. Existing directories are merged into, and existing files are replaced. The structure of the tree cannot
+		 * change while it is written.
+		 *
+		 * @param root The file or directory of this backend to write
+		 * @param destination Where to write it on disk
+		 * @param threads The number of threads writing files, 0 for one per hardware thread
+		 */
+		void materialize(const std::filesystem::path &root, const std::filesystem::path &destination, unsigned threads = 0) const;
+
+	private:
+		struct Data;
+
+		std::shared_ptr<Data> m_data;
+	};
+} // namespace recpp::filesystem
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <recpp/filesystem/CancellationToken.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief The metadata of a file recorded in a MetadataIndex.
+	 */
+	struct IndexEntry
+	{
+		/// The path of the file, relative to the root of the index
+		std::filesystem::path	   path;
+		std::filesystem::file_type type = std::filesystem::file_type::none;
+		/// The apparent size of the file, in bytes
+		std::uintmax_t			   size = 0;
+		/// The time of the last modification of the file, in nanoseconds since the Unix epoch
+		std::int64_t			   modificationTime = 0;
+	};
+
+	/**
+	 * @brief The options used to walk a tree when building or refreshing a MetadataIndex.
+	 */
+	struct MetadataIndexOptions
+	{
+		/// The number of threads walking the tree, 0 for one per hardware thread
+		unsigned						   threads = 0;
+		/// The options used to list directories, for instance to skip the directories that cannot be read
+		std::filesystem::directory_options directoryOptions = std::filesystem::directory_options::none;
+		/// The CancellationToken checked before listing each directory
+		std::optional<CancellationToken>   token;
+	};
+
+	/**
+	 * @brief MetadataIndex records the type, size and modification time of every file of a tree (symlinks are not followed), in a compact format that can
+	 * be written to a file and memory-mapped back, so that a tree does not need to be walked again each time a program starts.
+	 * <p>
+	 * Paths are sorted so that the entries under a directory are contiguous, and front-coded by blocks of 16: each block stores its first path entirely,
+	 * and only the suffix each other path does not share with the previous one. A table of the offsets of the blocks allows binary searches over their
+	 * first paths. The other attributes are stored in fixed-width columns. Opening an index only maps the file and checks its header, its pages being
+	 * read as queries access them.
+	 * <p>
+	 * A MetadataIndex is immutable, copies share the same data. It can be used from several threads at once.
+	 */
+	class MetadataIndex
+	{
+	public:
+		/**
+		 * @brief Construct an empty MetadataIndex object, with no root.
+		 */
+		MetadataIndex();
+
+		/**
+		 * @brief Build the index of the tree rooted at @p root from a parallel walk.
+		 *
+		 * @param root Path of the tree to index
+		 * @param options The options of the walk
+		 * @return The index of @p root
+		 */
+		static MetadataIndex build(const std::filesystem::path &root, const MetadataIndexOptions &options = MetadataIndexOptions());
+
+		/**
+		 * @brief Map the index written to @p file. Only the header is checked, a std::runtime_error being thrown if it is not valid.
+		 *
+		 * @param file Path of the file written by write()
+		 * @return The index written to @p file
+		 */
+		static MetadataIndex open(const std::filesystem::path &file);
+
+		/**
+		 * @brief Bring this index up to date with its tree, only listing again the directories whose modification time changed and walking the new ones.
+		 * <p>
+		 * Every indexed directory is checked, on several threads. Since adding, removing or renaming an entry updates the modification time of its
+		 * directory, but writing to a file does not, files modified in place in an unchanged directory keep their former size and modification time.
+		 *
+		 * @param options The options of the walk
+		 * @return The refreshed index
+		 */
+		MetadataIndex refresh(const MetadataIndexOptions &options = MetadataIndexOptions()) const;
+
+		/**
+		 * @brief Write this index to @p file, through a temporary file renamed over @p file so that readers never see a partial index.
+		 *
+		 * @param file Path of the file to write
+		 */
+		void write(const std::filesystem::path &file) const;
+
+		/**
+		 * @brief Get the root of the indexed tree.
+		 *
+		 * @return The path of the indexed tree
+		 */
+		std::filesystem::path root() const;
+
+		/**
+		 * @brief Get the number of files of the index, the root excluded.
+		 *
+		 * @return The number of entries of the index
+		 */
+		std::size_t size() const;
+
+		/**
+		 * @brief Find the entry of a file.
+		 *
+		 * @param path The path of the file, relative to the root
+		 * @return The entry of @p path, if it is indexed
+		 */
+		std::optional<IndexEntry> find(const std::filesystem::path &path) const;
+
+		/**
+		 * @brief Call @p visitor with each entry under the directory @p prefix, in the order of the index where directories directly precede their
+		 * entries.
+		 *
+		 * @param prefix The path of a directory relative to the root, or an empty path for every entry
+		 * @param visitor The function called with each entry
+		 */
+		void forEach(const std::filesystem::path &prefix, const std::function<void(const IndexEntry &entry)> &visitor) const;
+
+	private:
+		struct Data;
+
+		explicit MetadataIndex(std::shared_ptr<const Data> data);
+
+		std::shared_ptr<const Data> m_data;
+	};
+} // namespace recpp::filesystem
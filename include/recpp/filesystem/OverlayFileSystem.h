@@ -0,0 +1,135 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief An entry of the merged view of an OverlayFileSystem.
+	 */
+	struct OverlayEntry
+	{
+		/// The path of the entry in the overlay, relative to its root
+		std::filesystem::path	   path;
+		/// The path of the file in the layer providing it, the highest one for directories merged from several layers
+		std::filesystem::path	   source;
+		/// The index of the layer providing the entry, 0 being the layer with the highest precedence
+		std::size_t				   layer = 0;
+		/// The type of the entry, symlinks being followed unless they are dangling
+		std::filesystem::file_type type = std::filesystem::file_type::none;
+	};
+
+	/**
+	 * @brief OverlayFileSystem presents a stack of directories, the layers, as a single tree, like a union mount: each path of the overlay is the file of
+	 * the first layer that has it, and directories found in several layers are merged.
+	 * <p>
+	 * As with overlayfs, a file hides the files and directories of the same path in the layers below it, and a directory only merges with the directories
+	 * below it until a layer has a file at its path. Symlinks are followed, so that a symlink to a directory merges like a directory.
+	 * <p>
+	 * The merged listing of each directory is cached once read, with the layer providing each of its entries, so that resolving a path costs one hash
+	 * lookup per component instead of a stat of each layer. A cached directory is checked again after Settings::revalidationInterval, by comparing its
+	 * modification time in each layer with the one it had when it was listed: since adding, removing or renaming an entry updates the modification time of
+	 * its directory, a change in any layer is seen by the next lookup after that interval. The directories under a directory listed again are listed again
+	 * too. invalidate() forgets a directory right away.
+	 * <p>
+	 * Copies of an OverlayFileSystem share the same cache. An OverlayFileSystem can be used from several threads at once, lookups in fresh directories
+	 * only sharing a read lock.
+	 */
+	class OverlayFileSystem
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * @brief The settings of an OverlayFileSystem.
+		 */
+		struct Settings
+		{
+			/// How long a cached directory is used without checking whether it changed, zero to check it on every lookup
+			Clock::duration revalidationInterval = std::chrono::seconds(1);
+		};
+
+		/**
+		 * @brief The number of directories read from the cache and from the layers.
+		 */
+		struct Statistics
+		{
+			/// The number of lookups of directories answered from the cache
+			std::uintmax_t hits = 0;
+			/// The number of directories checked against their modification times
+			std::uintmax_t revalidations = 0;
+			/// The number of directories listed from the layers
+			std::uintmax_t misses = 0;
+		};
+
+		/**
+		 * @brief Construct a new OverlayFileSystem object with the default Settings.
+		 *
+		 * @param layers The directories to stack, from the highest precedence to the lowest, some of which may not exist
+		 */
+		explicit OverlayFileSystem(std::vector<std::filesystem::path> layers);
+
+		/**
+		 * @brief Construct a new OverlayFileSystem object.
+		 *
+		 * @param layers The directories to stack, from the highest precedence to the lowest, some of which may not exist
+		 * @param settings The settings of the overlay
+		 */
+		OverlayFileSystem(std::vector<std::filesystem::path> layers, const Settings &settings);
+
+		/**
+		 * @brief Get the layers of this overlay.
+		 *
+		 * @return The directories stacked by this overlay, from the highest precedence to the lowest
+		 */
+		const std::vector<std::filesystem::path> &layers() const;
+
+		/**
+		 * @brief Find the entry at @p path in the merged view. A std::filesystem::filesystem_error is thrown if a layer cannot be read.
+		 *
+		 * @param path The path in the overlay, relative to its root, absolute paths being taken from the root of the overlay and paths going above it not
+		 * existing
+		 * @return The entry at @p path, or std::nullopt if no layer has it
+		 */
+		std::optional<OverlayEntry> resolve(const std::filesystem::path &path) const;
+
+		/**
+		 * @brief List the merged entries of a directory of the overlay. A std::filesystem::filesystem_error is thrown if @p path is not a directory of the
+		 * overlay, or if a layer cannot be read.
+		 *
+		 * @param path The path of the directory in the overlay
+		 * @return The entries of the directory, sorted by name
+		 */
+		std::vector<OverlayEntry> list(const std::filesystem::path &path) const;
+
+		/**
+		 * @brief Forget the cached listing of @p path, or of its parent if it is not a cached directory, and of the directories under it.
+		 *
+		 * @param path The path in the overlay of a file or directory that changed
+		 */
+		void invalidate(const std::filesystem::path &path);
+
+		/**
+		 * @brief Forget every cached directory.
+		 */
+		void clear();
+
+		/**
+		 * @brief Get the number of directories read from the cache and from the layers since this overlay was constructed.
+		 *
+		 * @return The statistics of this overlay
+		 */
+		Statistics statistics() const;
+
+	private:
+		struct Data;
+
+		std::shared_ptr<Data> m_data;
+	};
+} // namespace recpp::filesystem
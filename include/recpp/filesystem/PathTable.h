@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief PathTable interns paths, giving each distinct path a stable integer handle, so that large sets of paths share their directory prefixes.
+	 * <p>
+	 * Each interned path is stored once as the handle of its parent and its last component, the components being copied into an arena of large blocks.
+	 * An interned path therefore costs about 20 bytes plus the length of its last component, however deep it is, instead of a std::filesystem::path
+	 * holding its whole string. Two handles of the same table are equal if and only if their paths are, so that handles can be compared and hashed in
+	 * constant time.
+	 * <p>
+	 * Paths are interned as they are given, component by component, without being normalized: "a/./b" and "a/b" have different handles. The handle of
+	 * the empty path is PathTable::empty.
+	 * <p>
+	 * Copies of a PathTable share the same paths. A PathTable can be used from several threads at once, and the views returned by name() remain valid as
+	 * long as one of its copies exists.
+	 */
+	class PathTable
+	{
+	public:
+		using Id = std::uint32_t;
+		using NameView = std::basic_string_view<std::filesystem::path::value_type>;
+
+		/// The handle of the empty path, the parent of the first component of every path
+		static constexpr Id empty = 0;
+
+		/**
+		 * @brief Construct an empty PathTable object, holding only the empty path.
+		 */
+		PathTable();
+
+		/**
+		 * @brief Intern @p path and each of its parents, throwing std::length_error if one of its components is longer than 65536 characters.
+		 *
+		 * @param path The path to intern
+		 * @return The handle of @p path
+		 */
+		Id intern(const std::filesystem::path &path);
+
+		/**
+		 * @brief Intern the path made of the path of @p parent and @p name, without parsing @p name, throwing std::length_error if it is longer than 65536
+		 * characters.
+		 *
+		 * @param parent The handle of the parent path
+		 * @param name A single component, like the filename of a directory entry
+		 * @return The handle of the child path
+		 */
+		Id child(Id parent, NameView name);
+
+		/**
+		 * @brief Find the handle of @p path, without interning it.
+		 *
+		 * @param path The path to find
+		 * @return The handle of @p path, or std::nullopt if it was never interned
+		 */
+		std::optional<Id> find(const std::filesystem::path &path) const;
+
+		/**
+		 * @brief Get the handle of the parent of a path.
+		 *
+		 * @param id The handle of an interned path
+		 * @return The handle of the path without its last component, PathTable::empty for a single component and for the empty path itself
+		 */
+		Id parent(Id id) const;
+
+		/**
+		 * @brief Get the last component of a path.
+		 *
+		 * @param id The handle of an interned path
+		 * @return A view of the last component of the path, empty for the empty path
+		 */
+		NameView name(Id id) const;
+
+		/**
+		 * @brief Materialize an interned path.
+		 *
+		 * @param id The handle of an interned path
+		 * @return The path with the handle @p id
+		 */
+		std::filesystem::path path(Id id) const;
+
+		/**
+		 * @brief Get the number of interned paths, the empty path included, every handle being lower than it.
+		 *
+		 * @return The number of paths of this table
+		 */
+		std::size_t size() const;
+
+		/**
+		 * @brief Get the number of bytes allocated by this table.
+		 *
+		 * @return The memory used by this table, in bytes
+		 */
+		std::size_t memoryUsage() const;
+
+	private:
+		struct Data;
+
+		std::shared_ptr<Data> m_data;
+	};
+} // namespace recpp::filesystem
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <recpp/filesystem/CancellationToken.h>
+#include <recpp/filesystem/Compression.h>
+
+#include <cstddef>
+#include <optional>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief The options of rxReadLines, rxReadRecords and rxReadFixedSizeRecords.
+	 */
+	struct RecordOptions
+	{
+		/// The format of the file, CompressionFormat::automatic to also read gzip and zstd files transparently
+		CompressionFormat				 format = CompressionFormat::none;
+		/// The size of the buffers the file is read into, the records within a buffer being delivered without being copied
+		std::size_t						 chunkSize = 1 << 20;
+		/// The number of buffers read ahead of the records being delivered
+		std::size_t						 queueDepth = 4;
+		/// The CancellationToken checked before each buffer
+		std::optional<CancellationToken> token;
+	};
+} // namespace recpp::filesystem
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <recpp/filesystem/CancellationToken.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief The kinds of changes rxSync makes to the destination tree.
+	 */
+	enum class SyncActionType
+	{
+		/// A directory of the source is created in the destination
+		createDirectory,
+		/// A regular file of the source missing from the destination is copied
+		copyFile,
+		/// A regular file of the destination that differs from the source is replaced by a copy of the source
+		updateFile,
+		/// A regular file of the destination with the contents of the source only gets the modification time of the source
+		updateTime,
+		/// A symlink of the source is created in the destination, replacing the destination symlink if any
+		createSymlink,
+		/// A regular file of the destination is moved where the source has a file with the same contents
+		rename,
+		/// A file or a whole directory of the destination missing from the source, or of another type than in the source, is removed
+		remove,
+	};
+
+	/**
+	 * @brief A change made to the destination tree by rxSync.
+	 */
+	struct SyncAction
+	{
+		SyncActionType		  type = SyncActionType::copyFile;
+		/// The file of the source tree the change comes from, the former path of the destination file for a rename, or empty for a removal
+		std::filesystem::path source;
+		/// The file of the destination tree that is changed
+		std::filesystem::path destination;
+		/// The number of bytes copied by the change
+		std::uintmax_t		  size = 0;
+	};
+
+	/**
+	 * @brief The options of rxSync.
+	 */
+	struct SyncOptions
+	{
+		/// Remove the files of the destination missing from the source
+		bool							   deleteExtraneous = true;
+		/// Compare the contents of the regular files with the same size instead of trusting their modification times
+		bool							   compareContents = false;
+		/// Move the files of the destination that only moved in the source instead of copying them again, when deleteExtraneous is set
+		bool							   detectRenames = true;
+		/// Only report the changes that would be made, without making them
+		bool							   dryRun = false;
+		/// The largest difference between two modification times that are still considered equal, for filesystems storing coarser times
+		std::chrono::nanoseconds		   modifyWindow = std::chrono::nanoseconds::zero();
+		/// The number of threads walking the trees and copying files, 0 for one per hardware thread
+		unsigned						   threads = 0;
+		/// The options used to list directories, for instance to skip the directories that cannot be read
+		std::filesystem::directory_options directoryOptions = std::filesystem::directory_options::none;
+		/// The CancellationToken checked before listing each directory and making each change
+		std::optional<CancellationToken>   token;
+	};
+} // namespace recpp::filesystem
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <recpp/filesystem/CancellationToken.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief Data appended to a file followed by rxTail or rxTailLines.
+	 */
+	struct TailData
+	{
+		/// The data appended to the file, or a line without its line terminator for rxTailLines, only valid until the callback returns
+		std::string_view data;
+		/// The offset of the data in the file
+		std::uintmax_t	 offset = 0;
+		/// The offset following the data, and its line terminator for rxTailLines: the position to resume following the file from after the data
+		std::uintmax_t	 end = 0;
+		/// True for the first data of a file that replaced the file followed, or that was truncated, its offsets restarting from 0
+		bool			 rotated = false;
+	};
+
+	/**
+	 * @brief The options of rxTail and rxTailLines.
+	 */
+	struct TailOptions
+	{
+		/// Only deliver whole lines, the end of a line being written being held back until its '\n' is written, the file is replaced or it fills chunkSize
+		bool							 wholeLines = false;
+		/// The size of the buffer the appended data is read into, and so the most data delivered at once
+		std::size_t						 chunkSize = 1 << 16;
+		/// The interval at which the file is checked if it cannot be watched with inotify, and at which the token is checked otherwise
+		std::chrono::milliseconds		 pollInterval = std::chrono::milliseconds(100);
+		/// The CancellationToken stopping the following of the file, which only ends with it, and so is required unless the FileSystem provides one
+		std::optional<CancellationToken> token;
+	};
+} // namespace recpp::filesystem
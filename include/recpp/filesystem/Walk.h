@@ -0,0 +1,23 @@
+#pragma once
+
+#include <recpp/filesystem/CancellationToken.h>
+#include <recpp/filesystem/PathTable.h>
+
+#include <filesystem>
+#include <optional>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief The options of rxWalk.
+	 */
+	struct WalkOptions
+	{
+		/// The number of threads walking the tree, 0 for one per hardware thread
+		unsigned						   threads = 0;
+		/// The options used to list directories, for instance to skip the directories that cannot be read
+		std::filesystem::directory_options directoryOptions = std::filesystem::directory_options::none;
+		/// The CancellationToken checked before listing each directory
+		std::optional<CancellationToken>   token;
+	};
+} // namespace recpp::filesystem
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace recpp::filesystem
+{
+	/**
+	 * @brief How rxSetXattr treats an existing attribute of the same name.
+	 */
+	enum class XattrMode
+	{
+		/// Create the attribute, or replace its value if it exists
+		createOrReplace,
+		/// Only create the attribute, failing with std::errc::file_exists if it exists
+		create,
+		/// Only replace the value of the attribute, failing if it does not exist
+		replace
+	};
+
+	/**
+	 * @brief The extended attributes of one of the files passed to rxGetXattrs.
+	 */
+	struct FileXattrs
+	{
+		/// The path of the file, as passed to rxGetXattrs
+		std::filesystem::path							 path;
+		/// The names and values of the attributes the file has, in the order of the names asked for, or of the list of the file if none were
+		std::vector<std::pair<std::string, std::string>> attributes;
+		/// The error that prevented reading the attributes of the file, if any
+		std::error_code									 error;
+	};
+} // namespace recpp::filesystem
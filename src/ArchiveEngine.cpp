@@ -0,0 +1,1187 @@
+#include "ArchiveEngine.h"
+#include "Crc32.h"
+#include "DirectoryCreator.h"
+#include "DirectoryWalker.h"
+#include "File.h"
+#include "FileInfo.h"
+#include "Inflater.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <chrono>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	using EntryCallback = std::function<void(const ArchiveEntry &entry)>;
+
+	constexpr std::size_t blockSize = 512;
+	// Size of the blocks in which the files too large to be held in memory are copied
+	constexpr std::size_t chunkSize = 1 << 20;
+	constexpr std::int64_t nanosecondsPerSecond = 1000000000;
+
+	// The header of an entry of a tar archive, in the ustar format
+	struct TarHeader
+	{
+		char name[100];
+		char mode[8];
+		char owner[8];
+		char group[8];
+		char size[12];
+		char modificationTime[12];
+		char checksum[8];
+		char type;
+		char linkName[100];
+		char magic[6];
+		char version[2];
+		char ownerName[32];
+		char groupName[32];
+		char deviceMajor[8];
+		char deviceMinor[8];
+		char prefix[155];
+		char padding[12];
+	};
+	static_assert(sizeof(TarHeader) == blockSize, "a tar header must fill a block");
+
+	[[noreturn]] void malformed(const char *operation, const std::filesystem::path &archive)
+	{
+		throw std::filesystem::filesystem_error(operation, archive, std::make_error_code(std::errc::bad_message));
+	}
+
+	// Read the size bytes at offset of the archive read from input. The archive is read rather than mapped, so that it being truncated while it is unpacked
+	// makes it malformed rather than faulting
+	void readAt(const char *operation, const std::filesystem::path &archive, File &input, std::uintmax_t offset, void *data, std::size_t size)
+	{
+		input.seek(offset);
+		if (input.read(data, size) != size)
+			malformed(operation, archive);
+	}
+
+	// Set the permissions, if any, and the modification time of the file at path, without following it if it is a symlink
+	void restoreAttributes(const std::filesystem::path &path, const std::optional<std::filesystem::perms> &permissions, std::int64_t modificationTime,
+						   bool symlink)
+	{
+		if (permissions && !symlink)
+			std::filesystem::permissions(path, *permissions);
+#ifdef _WIN32
+		// Windows symlinks get the time of their target
+		if (symlink)
+			return;
+		const auto now = std::chrono::system_clock::now().time_since_epoch();
+		std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() +
+												   std::chrono::duration_cast<std::filesystem::file_time_type::duration>(
+													   std::chrono::nanoseconds(modificationTime) - now));
+#else
+		auto seconds = modificationTime / nanosecondsPerSecond;
+		auto nanoseconds = modificationTime % nanosecondsPerSecond;
+		if (nanoseconds < 0)
+		{
+			seconds--;
+			nanoseconds += nanosecondsPerSecond;
+		}
+		const timespec times[2] = {{0, UTIME_OMIT}, {static_cast<time_t>(seconds), static_cast<long>(nanoseconds)}};
+		if (::utimensat(AT_FDCWD, path.c_str(), times, symlink ? AT_SYMLINK_NOFOLLOW : 0) != 0)
+			throw std::filesystem::filesystem_error("utimensat", path, std::error_code(errno, std::generic_category()));
+#endif
+	}
+
+	// Write value as octal digits into the size bytes of field, followed by a NUL, returning false if it does not fit
+	bool writeOctal(char *field, std::size_t size, std::uintmax_t value)
+	{
+		field[size - 1] = 0;
+		for (auto i = size - 1; i-- > 0; value >>= 3)
+			field[i] = static_cast<char>('0' + (value & 7));
+		return value == 0;
+	}
+
+	// Read a numeric field, in octal or in the base-256 encoding of GNU tar for the values octal cannot hold
+	std::uintmax_t readNumber(const char *field, std::size_t size)
+	{
+		std::uintmax_t value = 0;
+		if (static_cast<unsigned char>(field[0]) & 0x80)
+		{
+			value = static_cast<unsigned char>(field[0]) & 0x7F;
+			for (std::size_t i = 1; i < size; i++)
+				value = value << 8 | static_cast<unsigned char>(field[i]);
+			return value;
+		}
+		std::size_t i = 0;
+		while (i < size && (field[i] == ' ' || field[i] == 0))
+			i++;
+		for (; i < size && field[i] >= '0' && field[i] <= '7'; i++)
+			value = value << 3 | static_cast<std::uintmax_t>(field[i] - '0');
+		return value;
+	}
+
+	std::string readString(const char *field, std::size_t size)
+	{
+		return std::string(field, std::find(field, field + size, 0));
+	}
+
+	void writeString(char *field, std::size_t size, const std::string &value)
+	{
+		std::memcpy(field, value.data(), std::min(size, value.size()));
+	}
+
+	unsigned checksum(const TarHeader &header)
+	{
+		const auto bytes = reinterpret_cast<const unsigned char *>(&header);
+		unsigned   sum = 0;
+		for (std::size_t i = 0; i < blockSize; i++)
+			sum += i >= offsetof(TarHeader, checksum) && i < offsetof(TarHeader, type) ? ' ' : bytes[i];
+		return sum;
+	}
+
+	// Some old archivers summed signed bytes, which still has to be accepted
+	unsigned signedChecksum(const TarHeader &header)
+	{
+		const auto bytes = reinterpret_cast<const signed char *>(&header);
+		int		   sum = 0;
+		for (std::size_t i = 0; i < blockSize; i++)
+			sum += i >= offsetof(TarHeader, checksum) && i < offsetof(TarHeader, type) ? ' ' : bytes[i];
+		return static_cast<unsigned>(sum);
+	}
+
+	void sealHeader(TarHeader &header)
+	{
+		std::memcpy(header.magic, "ustar", 6);
+		std::memcpy(header.version, "00", 2);
+		std::snprintf(header.checksum, sizeof(header.checksum), "%06o", checksum(header));
+		header.checksum[7] = ' ';
+	}
+
+	// Add a record of a pax extended header, whose length counts its own digits
+	void addRecord(std::string &records, const char *key, const std::string &value)
+	{
+		const auto body = std::string(" ") + key + "=" + value + "\n";
+		auto	   length = body.size() + 1;
+		while (std::to_string(length).size() + body.size() != length)
+			length = std::to_string(length).size() + body.size();
+		records += std::to_string(length) + body;
+	}
+
+	// Split name between the name and prefix fields of header, returning false if it is too long for them
+	bool splitName(TarHeader &header, const std::string &name)
+	{
+		if (name.size() <= sizeof(header.name))
+		{
+			writeString(header.name, sizeof(header.name), name);
+			return true;
+		}
+		const auto first = name.size() - sizeof(header.name) - 1;
+		for (auto separator = name.find('/', first); separator != std::string::npos && separator <= sizeof(header.prefix);
+			 separator = name.find('/', separator + 1))
+		{
+			if (separator + 1 == name.size())
+				break;
+			writeString(header.prefix, sizeof(header.prefix), name.substr(0, separator));
+			writeString(header.name, sizeof(header.name), name.substr(separator + 1));
+			return true;
+		}
+		writeString(header.name, sizeof(header.name), name);
+		return false;
+	}
+
+	// A file of the tree being packed
+	struct PackEntry
+	{
+		std::filesystem::path path;
+		/// The path of the entry in the archive, with '/' separators
+		std::string			  name;
+		FileInfo			  info;
+		/// The target of a symlink, or the name of the entry a hard link shares its contents with
+		std::string			  target;
+		bool				  hardLink = false;
+	};
+
+	// Separators sort before any other character, so that the entries under a directory directly follow it, before any of its siblings
+	bool nameLess(const PackEntry &entry1, const PackEntry &entry2)
+	{
+		return std::lexicographical_compare(entry1.name.begin(), entry1.name.end(), entry2.name.begin(), entry2.name.end(),
+											[](char character1, char character2)
+											{
+												return std::make_pair(character1 != '/', static_cast<unsigned char>(character1)) <
+													   std::make_pair(character2 != '/', static_cast<unsigned char>(character2));
+											});
+	}
+
+	// The root without any trailing separator, as a prefix of the paths of the entries listed under it
+	std::filesystem::path normalRoot(const std::filesystem::path &root)
+	{
+		auto normal = root.lexically_normal();
+		if (!normal.has_filename() && normal.has_relative_path())
+			normal = normal.parent_path();
+		return normal;
+	}
+
+	class TarPacker
+	{
+	public:
+		TarPacker(const std::filesystem::path &root, const std::filesystem::path &archive, const EntryCallback &onEntry, const ArchiveOptions &options)
+			: m_root(normalRoot(root))
+			, m_archive(archive)
+			, m_onEntry(onEntry)
+			, m_options(options)
+			, m_readers(threadCount(options.threads))
+			, m_readAheadLimit(options.memoryLimit / m_readers)
+		{
+		}
+
+		void run()
+		{
+			checkToken();
+			const auto type = std::filesystem::status(m_root).type();
+			if (type == std::filesystem::file_type::not_found)
+				throw std::filesystem::filesystem_error("pack tar", m_root, std::make_error_code(std::errc::no_such_file_or_directory));
+			if (type != std::filesystem::file_type::directory)
+				throw std::filesystem::filesystem_error("pack tar", m_root, std::make_error_code(std::errc::not_a_directory));
+
+			std::optional<File> output;
+			// The headers and small files are gathered into large writes
+			output.emplace(m_archive, true, chunkSize);
+			try
+			{
+				list(fileInfo(m_archive, true));
+				// One worker writes the archive while the others read ahead. Within a FileSystem operation the readers are tasks of its scheduler, which
+				// may not all start, the writer reading the files no reader took up itself
+				std::atomic<bool>  writing = false;
+				std::exception_ptr error;
+				runWorkers(m_readers + 1,
+						   [this, &writing, &error, &output]()
+						   {
+							   if (writing.exchange(true))
+							   {
+								   readAhead();
+								   return;
+							   }
+							   try
+							   {
+								   write(*output);
+							   }
+							   catch (...)
+							   {
+								   error = std::current_exception();
+							   }
+							   stop();
+						   });
+				if (error)
+					std::rethrow_exception(error);
+				output->close();
+			}
+			catch (...)
+			{
+				// A partial archive is worse than none
+				output.reset();
+				std::error_code error;
+				std::filesystem::remove(m_archive, error);
+				throw;
+			}
+		}
+
+	private:
+		void checkToken() const
+		{
+			if (m_options.token)
+				m_options.token->throwIfCancelled();
+		}
+
+		void list(const FileInfo &archive)
+		{
+			const auto prefix = m_root.native().size() + 1;
+			std::mutex mutex;
+			// The directories and regular files are listed, other files having no meaning once unpacked elsewhere
+			DirectoryWalker walker(m_options.threads, std::filesystem::directory_options::none, m_options.token);
+			walker.walk({m_root},
+						[this, &mutex, &archive, prefix](const std::filesystem::path &directory, const std::vector<std::filesystem::directory_entry> &listing)
+						{
+							if (directory.empty())
+								return;
+							std::vector<PackEntry> local;
+							for (const auto &entry : listing)
+							{
+								const auto info = fileInfo(entry.path());
+								if (info.type != std::filesystem::file_type::directory && info.type != std::filesystem::file_type::regular &&
+									info.type != std::filesystem::file_type::symlink)
+									continue;
+								// The archive is not packed into itself when it is written under the root
+								if (info.device == archive.device && info.inode == archive.inode && info.inode != 0)
+									continue;
+								const auto name = std::filesystem::path(entry.path().native().substr(prefix)).generic_string();
+								local.push_back(PackEntry{entry.path(), name, info, {}});
+								if (info.type == std::filesystem::file_type::symlink)
+									local.back().target = std::filesystem::read_symlink(entry.path()).generic_string();
+							}
+							std::lock_guard lock(mutex);
+							m_entries.insert(m_entries.end(), std::make_move_iterator(local.begin()), std::make_move_iterator(local.end()));
+						});
+			std::sort(m_entries.begin(), m_entries.end(), nameLess);
+
+			// The first path of a file with several hard links carries its contents, the others only refer to it
+			std::map<std::pair<std::uintmax_t, std::uintmax_t>, std::size_t> linked;
+			for (std::size_t i = 0; i < m_entries.size(); i++)
+			{
+				auto &entry = m_entries[i];
+				if (entry.info.type != std::filesystem::file_type::regular || entry.info.hardLinkCount < 2 || entry.info.inode == 0)
+					continue;
+				const auto [found, inserted] = linked.emplace(std::make_pair(entry.info.device, entry.info.inode), i);
+				if (!inserted)
+				{
+					entry.hardLink = true;
+					entry.target = m_entries[found->second].name;
+				}
+			}
+		}
+
+		bool readsAhead(const PackEntry &entry) const
+		{
+			return entry.info.type == std::filesystem::file_type::regular && !entry.hardLink && entry.info.size <= m_readAheadLimit;
+		}
+
+		// Load the next files into memory in archive order, as long as they fit in the memory limit. A file is always loaded when none is, so that the
+		// writer never waits for a file that cannot be loaded
+		void readAhead()
+		{
+			try
+			{
+				std::unique_lock lock(m_mutex);
+				for (;;)
+				{
+					while (m_next < m_entries.size() && !readsAhead(m_entries[m_next]))
+						m_next++;
+					if (m_stopped || m_next == m_entries.size())
+						return;
+					const auto &entry = m_entries[m_next];
+					if (m_used > 0 && m_used + entry.info.size > m_options.memoryLimit)
+					{
+						m_condition.wait(lock);
+						continue;
+					}
+					const auto index = m_next++;
+					m_used += entry.info.size;
+					lock.unlock();
+
+					checkToken();
+					// Files that changed since they were listed are cut or padded with zeros to the size in their header, as tar does
+					std::string contents(entry.info.size, '\0');
+					File		input(entry.path, false);
+					for (std::size_t done = 0, read = 1; done < contents.size() && read > 0; done += read)
+						read = input.read(contents.data() + done, contents.size() - done);
+
+					lock.lock();
+					m_loaded.emplace(index, std::move(contents));
+					m_condition.notify_all();
+				}
+			}
+			catch (...)
+			{
+				std::lock_guard lock(m_mutex);
+				if (!m_error)
+					m_error = std::current_exception();
+				m_stopped = true;
+				m_condition.notify_all();
+			}
+		}
+
+		void stop()
+		{
+			{
+				std::lock_guard lock(m_mutex);
+				m_stopped = true;
+			}
+			m_condition.notify_all();
+		}
+
+		void write(File &output)
+		{
+			std::vector<char> chunk;
+			for (std::size_t i = 0; i < m_entries.size(); i++)
+			{
+				checkToken();
+				const auto &entry = m_entries[i];
+				const auto	regular = entry.info.type == std::filesystem::file_type::regular && !entry.hardLink;
+				const auto	size = regular ? entry.info.size : 0;
+				writeHeader(output, entry, size);
+
+				const auto loaded = readsAhead(entry) && takeLoaded(output, i);
+				if (regular && !loaded)
+				{
+					chunk.resize(chunkSize);
+					File input(entry.path, false);
+					for (auto left = size; left > 0;)
+					{
+						const auto wanted = static_cast<std::size_t>(std::min<std::uintmax_t>(left, chunk.size()));
+						const auto read = input.read(chunk.data(), wanted);
+						std::fill(chunk.begin() + static_cast<std::ptrdiff_t>(read), chunk.begin() + static_cast<std::ptrdiff_t>(wanted), 0);
+						output.write(chunk.data(), wanted);
+						left -= wanted;
+					}
+				}
+				pad(output, size);
+
+				m_onEntry(ArchiveEntry{entry.name, entry.info.type, entry.target, size});
+			}
+			// The end of the archive is marked by two empty blocks
+			const char empty[blockSize * 2] = {};
+			output.write(empty, sizeof(empty));
+		}
+
+		// Write the contents of the entry at index read ahead, waiting for the reader that took it up. Returns false without waiting if no reader took it
+		// up yet, in which case it is left to the writer
+		bool takeLoaded(File &output, std::size_t index)
+		{
+			std::string contents;
+			{
+				std::unique_lock lock(m_mutex);
+				if (!m_loaded.count(index) && m_next <= index)
+				{
+					m_next = index + 1;
+					return false;
+				}
+				m_condition.wait(lock,
+								 [this, index]()
+								 {
+									 return m_error || m_loaded.count(index);
+								 });
+				if (m_error)
+					std::rethrow_exception(m_error);
+				auto found = m_loaded.find(index);
+				contents = std::move(found->second);
+				m_loaded.erase(found);
+			}
+			output.write(contents.data(), contents.size());
+			{
+				std::lock_guard lock(m_mutex);
+				m_used -= contents.size();
+			}
+			m_condition.notify_all();
+			return true;
+		}
+
+		void writeHeader(File &output, const PackEntry &entry, std::uintmax_t size)
+		{
+			TarHeader	header = {};
+			std::string records;
+			const auto	isDirectory = entry.info.type == std::filesystem::file_type::directory;
+			const auto	name = isDirectory ? entry.name + '/' : entry.name;
+			if (!splitName(header, name))
+				addRecord(records, "path", name);
+			writeString(header.linkName, sizeof(header.linkName), entry.target);
+			if (entry.target.size() > sizeof(header.linkName))
+				addRecord(records, "linkpath", entry.target);
+			if (!writeOctal(header.size, sizeof(header.size), size))
+			{
+				addRecord(records, "size", std::to_string(size));
+				writeOctal(header.size, sizeof(header.size), 0);
+			}
+			if (!writeOctal(header.owner, sizeof(header.owner), entry.info.owner))
+			{
+				addRecord(records, "uid", std::to_string(entry.info.owner));
+				writeOctal(header.owner, sizeof(header.owner), 0);
+			}
+			if (!writeOctal(header.group, sizeof(header.group), entry.info.group))
+			{
+				addRecord(records, "gid", std::to_string(entry.info.group));
+				writeOctal(header.group, sizeof(header.group), 0);
+			}
+			writeOctal(header.mode, sizeof(header.mode), static_cast<std::uintmax_t>(entry.info.permissions) & 07777);
+			const auto seconds = std::max<std::int64_t>(entry.info.modificationTime / nanosecondsPerSecond, 0);
+			writeOctal(header.modificationTime, sizeof(header.modificationTime), static_cast<std::uintmax_t>(seconds));
+			if (entry.hardLink)
+				header.type = '1';
+			else if (entry.info.type == std::filesystem::file_type::symlink)
+				header.type = '2';
+			else if (isDirectory)
+				header.type = '5';
+			else
+				header.type = '0';
+			sealHeader(header);
+
+			// What the ustar header cannot hold is stored in a pax extended header just before it
+			if (!records.empty())
+			{
+				TarHeader extended = {};
+				writeString(extended.name, sizeof(extended.name), "PaxHeaders/" + std::filesystem::path(entry.name).filename().string());
+				writeOctal(extended.mode, sizeof(extended.mode), 0644);
+				writeOctal(extended.owner, sizeof(extended.owner), 0);
+				writeOctal(extended.group, sizeof(extended.group), 0);
+				writeOctal(extended.size, sizeof(extended.size), records.size());
+				writeOctal(extended.modificationTime, sizeof(extended.modificationTime), static_cast<std::uintmax_t>(seconds));
+				extended.type = 'x';
+				sealHeader(extended);
+				output.write(&extended, sizeof(extended));
+				output.write(records.data(), records.size());
+				pad(output, records.size());
+			}
+			output.write(&header, sizeof(header));
+		}
+
+		static void pad(File &output, std::uintmax_t size)
+		{
+			const char empty[blockSize] = {};
+			if (size % blockSize)
+				output.write(empty, blockSize - size % blockSize);
+		}
+
+		const std::filesystem::path m_root;
+		const std::filesystem::path m_archive;
+		const EntryCallback		   &m_onEntry;
+		const ArchiveOptions	   &m_options;
+		const unsigned				m_readers;
+		/// The largest file read ahead, the larger ones being streamed by the writer
+		const std::uintmax_t		m_readAheadLimit;
+		std::vector<PackEntry>		m_entries;
+
+		std::mutex									 m_mutex;
+		std::condition_variable						 m_condition;
+		/// The index of the next entry to read ahead
+		std::size_t									 m_next = 0;
+		/// The number of bytes read ahead and not written yet
+		std::uintmax_t								 m_used = 0;
+		std::unordered_map<std::size_t, std::string> m_loaded;
+		bool										 m_stopped = false;
+		std::exception_ptr							 m_error;
+	};
+
+	// An entry of an archive being unpacked
+	struct Member
+	{
+		/// The path of the entry relative to the destination
+		std::filesystem::path				  path;
+		std::filesystem::file_type			  type = std::filesystem::file_type::regular;
+		bool								  hardLink = false;
+		/// The target of a symlink, or the path relative to the destination of the file a hard link shares its contents with
+		std::filesystem::path				  target;
+		/// The offset of the contents in the archive
+		std::uintmax_t						  offset = 0;
+		/// The size of the contents in the archive
+		std::uintmax_t						  storedSize = 0;
+		std::uintmax_t						  size = 0;
+		/// Whether the contents are deflated rather than stored
+		bool								  deflated = false;
+		std::optional<std::uint32_t>		  crc;
+		std::optional<std::filesystem::perms> permissions;
+		/// The time of the last modification of the entry, in nanoseconds since the Unix epoch
+		std::int64_t						  modificationTime = 0;
+	};
+
+	// Get the path relative to the destination of the entry named name, rejecting the names leading out of the destination. Leading separators are
+	// dropped, as tar does
+	std::filesystem::path memberPath(const char *operation, const std::filesystem::path &archive, const std::string &name)
+	{
+		std::filesystem::path path;
+		for (std::size_t begin = 0; begin <= name.size();)
+		{
+			auto end = name.find('/', begin);
+			if (end == std::string::npos)
+				end = name.size();
+			const auto component = name.substr(begin, end - begin);
+			begin = end + 1;
+			if (component.empty() || component == ".")
+				continue;
+			if (component == ".." || component.find('\\') != std::string::npos || component.find(':') != std::string::npos)
+				throw std::filesystem::filesystem_error(operation, archive, std::filesystem::path(name), std::make_error_code(std::errc::permission_denied));
+			path /= component;
+		}
+		return path;
+	}
+
+	// Whether path is directory or one of its descendants, both being canonical
+	bool isWithin(const std::filesystem::path &directory, const std::filesystem::path &path)
+	{
+		return std::mismatch(directory.begin(), directory.end(), path.begin(), path.end()).first == directory.end();
+	}
+
+	ArchiveEntry archiveEntry(const Member &member)
+	{
+		return ArchiveEntry{member.path.generic_string(), member.type, member.target.generic_string(), member.hardLink ? 0 : member.size};
+	}
+
+	// Decompress the deflated contents of member, passing them to sink, and return their size
+	std::uintmax_t inflateMember(const char *operation, const std::filesystem::path &archive, File &input, const Member &member,
+								 const Inflater::Sink &sink)
+	{
+		input.seek(member.offset);
+		std::uintmax_t position = 0;
+		Inflater	   inflater(
+			  [operation, &archive, &input, &member, &position](std::uint8_t *data, std::size_t size)
+			  {
+				  const auto count = static_cast<std::size_t>(std::min<std::uintmax_t>(size, member.storedSize - position));
+				  if (input.read(data, count) != count)
+					  malformed(operation, archive);
+				  position += count;
+				  return count;
+			  });
+		return inflater.inflate(sink);
+	}
+
+	void writeMember(const char *operation, const std::filesystem::path &archive, const Member &member, const std::filesystem::path &path)
+	{
+		// Whatever is at path is replaced rather than written through, in case it is a link
+		std::error_code error;
+		const auto		existing = std::filesystem::symlink_status(path, error);
+		if (std::filesystem::exists(existing) && !std::filesystem::is_directory(existing))
+			std::filesystem::remove(path);
+
+		File  input(archive, false);
+		File  output(path, true);
+		Crc32 crc;
+		if (!member.deflated)
+		{
+			std::vector<std::uint8_t> buffer(static_cast<std::size_t>(std::min<std::uintmax_t>(chunkSize, member.storedSize)));
+			input.seek(member.offset);
+			for (auto remaining = member.storedSize; remaining > 0;)
+			{
+				const auto count = static_cast<std::size_t>(std::min<std::uintmax_t>(buffer.size(), remaining));
+				if (input.read(buffer.data(), count) != count)
+					malformed(operation, archive);
+				if (member.crc)
+					crc.update(buffer.data(), count);
+				output.write(buffer.data(), count);
+				remaining -= count;
+			}
+		}
+		else
+		{
+			try
+			{
+				const auto size = inflateMember(operation, archive, input, member,
+												[&output, &crc](const std::uint8_t *data, std::size_t count)
+												{
+													crc.update(data, count);
+													output.write(data, count);
+												});
+				if (size != member.size)
+					malformed(operation, archive);
+			}
+			catch (const std::filesystem::filesystem_error &)
+			{
+				throw;
+			}
+			catch (const std::system_error &exception)
+			{
+				throw std::filesystem::filesystem_error(operation, archive, path, exception.code());
+			}
+		}
+		if (member.crc && crc.value() != *member.crc)
+			throw std::filesystem::filesystem_error(operation, archive, path, std::make_error_code(std::errc::bad_message));
+		output.close();
+	}
+
+	// Create the entries of an archive under destination. The directories are created first, in bulk, then the files in parallel, and the links last
+	void extract(const char *operation, const std::filesystem::path &archive, const std::vector<Member> &members, const std::filesystem::path &destination,
+				 const EntryCallback &onEntry, const ArchiveOptions &options)
+	{
+		const auto checkToken = [&options]()
+		{
+			if (options.token)
+				options.token->throwIfCancelled();
+		};
+
+		// An entry replaces the entries of the same path before it, as if they were unpacked in order
+		std::unordered_map<std::string, std::size_t> last;
+		for (std::size_t i = 0; i < members.size(); i++)
+			last[members[i].path.generic_string()] = i;
+		std::vector<std::size_t>		   directories;
+		std::vector<std::size_t>		   files;
+		std::vector<std::size_t>		   hardLinks;
+		std::vector<std::size_t>		   symlinks;
+		std::vector<std::filesystem::path> paths{destination};
+		for (std::size_t i = 0; i < members.size(); i++)
+		{
+			const auto &member = members[i];
+			if (last[member.path.generic_string()] != i)
+				continue;
+			if (member.type == std::filesystem::file_type::directory)
+			{
+				directories.push_back(i);
+				paths.push_back(destination / member.path);
+				continue;
+			}
+			if (member.hardLink)
+				hardLinks.push_back(i);
+			else if (member.type == std::filesystem::file_type::regular)
+				files.push_back(i);
+			else
+				symlinks.push_back(i);
+			if (member.path.has_parent_path())
+				paths.push_back(destination / member.path.parent_path());
+		}
+
+		checkToken();
+		std::sort(paths.begin(), paths.end());
+		paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+		for (const auto &creation : createDirectories(paths, options.threads))
+		{
+			if (creation.error)
+				throw std::filesystem::filesystem_error("create_directories", creation.path, creation.error);
+		}
+		for (const auto i : directories)
+			onEntry(archiveEntry(members[i]));
+
+		std::mutex mutex;
+		parallelFor(
+			files.size(),
+			[&](std::size_t i)
+			{
+				checkToken();
+				const auto &member = members[files[i]];
+				const auto	path = destination / member.path;
+				writeMember(operation, archive, member, path);
+				if (options.restoreAttributes)
+					restoreAttributes(path, member.permissions, member.modificationTime, false);
+				std::lock_guard lock(mutex);
+				onEntry(archiveEntry(member));
+			},
+			options.threads);
+
+		// Links are created once their targets exist, and after the files so that no file is written through a symlink of the archive. Hard links come
+		// first, so that their targets are not resolved through one either, and must still resolve to a file under the destination
+		const auto root = std::filesystem::canonical(destination);
+		const auto replace = [](const std::filesystem::path &path)
+		{
+			std::error_code error;
+			const auto		existing = std::filesystem::symlink_status(path, error);
+			if (std::filesystem::exists(existing) && !std::filesystem::is_directory(existing))
+				std::filesystem::remove(path);
+		};
+		for (const auto i : hardLinks)
+		{
+			checkToken();
+			const auto &member = members[i];
+			const auto	path = destination / member.path;
+			const auto	target = std::filesystem::canonical(destination / member.target);
+			if (!isWithin(root, target))
+				throw std::filesystem::filesystem_error(operation, archive, member.target, std::make_error_code(std::errc::permission_denied));
+			replace(path);
+			std::filesystem::create_hard_link(target, path);
+			onEntry(archiveEntry(member));
+		}
+		for (const auto i : symlinks)
+		{
+			checkToken();
+			const auto &member = members[i];
+			const auto	path = destination / member.path;
+			replace(path);
+			std::filesystem::create_symlink(member.target, path);
+			if (options.restoreAttributes)
+				restoreAttributes(path, std::nullopt, member.modificationTime, true);
+			onEntry(archiveEntry(member));
+		}
+
+		// Directories get their attributes last, the deepest first, so that creating their entries neither changes their modification times nor is
+		// prevented by their permissions
+		if (options.restoreAttributes)
+		{
+			std::sort(directories.begin(), directories.end(),
+					  [&members](std::size_t i, std::size_t j)
+					  {
+						  return members[j].path < members[i].path;
+					  });
+			for (const auto i : directories)
+				restoreAttributes(destination / members[i].path, members[i].permissions, members[i].modificationTime, false);
+		}
+	}
+
+	// Parse the records of a pax extended header
+	void parseRecords(const std::filesystem::path &archive, const char *data, std::size_t size, std::map<std::string, std::string> &records)
+	{
+		for (std::size_t position = 0; position < size && data[position];)
+		{
+			std::size_t length = 0;
+			auto		cursor = position;
+			for (; cursor < size && data[cursor] >= '0' && data[cursor] <= '9'; cursor++)
+				length = length * 10 + static_cast<std::size_t>(data[cursor] - '0');
+			if (cursor == position || cursor >= size || data[cursor] != ' ' || length > size - position || length < cursor - position + 2)
+				malformed("unpack tar", archive);
+			const std::string record(data + cursor + 1, data + position + length - 1);
+			const auto		  equal = record.find('=');
+			if (equal == std::string::npos || data[position + length - 1] != '\n')
+				malformed("unpack tar", archive);
+			records[record.substr(0, equal)] = record.substr(equal + 1);
+			position += length;
+		}
+	}
+
+	// Parse a time of a pax extended header, in seconds with an optional fraction
+	std::int64_t parseTime(const std::string &value)
+	{
+		const auto negative = !value.empty() && value[0] == '-';
+		std::int64_t seconds = 0;
+		std::int64_t nanoseconds = 0;
+		auto		 i = negative ? std::size_t(1) : std::size_t(0);
+		for (; i < value.size() && value[i] >= '0' && value[i] <= '9'; i++)
+			seconds = seconds * 10 + (value[i] - '0');
+		if (i < value.size() && value[i] == '.')
+		{
+			std::int64_t scale = nanosecondsPerSecond;
+			for (i++; i < value.size() && value[i] >= '0' && value[i] <= '9' && scale > 1; i++)
+			{
+				scale /= 10;
+				nanoseconds += (value[i] - '0') * scale;
+			}
+		}
+		const auto time = seconds * nanosecondsPerSecond + nanoseconds;
+		return negative ? -time : time;
+	}
+
+	std::vector<Member> scanTar(const std::filesystem::path &archive)
+	{
+		File							   input(archive, false);
+		const auto						   archiveSize = std::filesystem::file_size(archive);
+		std::vector<Member>				   members;
+		std::map<std::string, std::string> records;
+		std::optional<std::string>		   longName;
+		std::optional<std::string>		   longLinkName;
+		for (std::uintmax_t offset = 0; offset + blockSize <= archiveSize;)
+		{
+			TarHeader header;
+			readAt("unpack tar", archive, input, offset, &header, sizeof(header));
+			const auto bytes = reinterpret_cast<const std::uint8_t *>(&header);
+			if (std::all_of(bytes, bytes + blockSize,
+							[](std::uint8_t byte)
+							{
+								return byte == 0;
+							}))
+				break;
+			const auto expected = readNumber(header.checksum, sizeof(header.checksum));
+			if (expected != checksum(header) && expected != signedChecksum(header))
+				malformed("unpack tar", archive);
+
+			auto size = readNumber(header.size, sizeof(header.size));
+			if (const auto found = records.find("size"); found != records.end())
+				size = std::stoull(found->second);
+			const auto contents = offset + blockSize;
+			if (size > archiveSize - contents)
+				malformed("unpack tar", archive);
+			offset = contents + (size + blockSize - 1) / blockSize * blockSize;
+
+			// Extended headers and the long names of GNU tar apply to the next entry, and are the only contents read while scanning
+			std::string data;
+			if (header.type == 'x' || header.type == 'L' || header.type == 'K')
+			{
+				data.resize(static_cast<std::size_t>(size));
+				readAt("unpack tar", archive, input, contents, data.data(), data.size());
+			}
+			switch (header.type)
+			{
+			case 'x':
+				parseRecords(archive, data.data(), data.size(), records);
+				continue;
+			case 'g':
+				continue;
+			case 'L':
+				longName = readString(data.data(), data.size());
+				continue;
+			case 'K':
+				longLinkName = readString(data.data(), data.size());
+				continue;
+			default:
+				break;
+			}
+
+			auto name = readString(header.name, sizeof(header.name));
+			if (std::memcmp(header.magic, "ustar", 5) == 0 && header.prefix[0])
+				name = readString(header.prefix, sizeof(header.prefix)) + '/' + name;
+			auto linkName = readString(header.linkName, sizeof(header.linkName));
+			if (longName)
+				name = *longName;
+			if (longLinkName)
+				linkName = *longLinkName;
+			if (const auto found = records.find("path"); found != records.end())
+				name = found->second;
+			if (const auto found = records.find("linkpath"); found != records.end())
+				linkName = found->second;
+			auto modificationTime = static_cast<std::int64_t>(readNumber(header.modificationTime, sizeof(header.modificationTime))) * nanosecondsPerSecond;
+			if (const auto found = records.find("mtime"); found != records.end())
+				modificationTime = parseTime(found->second);
+			records.clear();
+			longName.reset();
+			longLinkName.reset();
+
+			Member member;
+			switch (header.type)
+			{
+			case '0':
+			case '7':
+			case 0:
+				// Archivers older than ustar marked directories with a trailing separator only
+				if (!name.empty() && name.back() == '/')
+					member.type = std::filesystem::file_type::directory;
+				break;
+			case '1':
+				member.hardLink = true;
+				break;
+			case '2':
+				member.type = std::filesystem::file_type::symlink;
+				break;
+			case '5':
+				member.type = std::filesystem::file_type::directory;
+				break;
+			default:
+				// Devices, fifos and the other special entries are not unpacked
+				continue;
+			}
+			member.path = memberPath("unpack tar", archive, name);
+			if (member.path.empty())
+				continue;
+			if (member.hardLink)
+			{
+				member.target = memberPath("unpack tar", archive, linkName);
+				if (member.target.empty())
+					malformed("unpack tar", archive);
+			}
+			else if (member.type == std::filesystem::file_type::symlink)
+				member.target = linkName;
+			if (member.type == std::filesystem::file_type::regular && !member.hardLink)
+			{
+				member.offset = contents;
+				member.storedSize = size;
+				member.size = size;
+			}
+			member.permissions = static_cast<std::filesystem::perms>(readNumber(header.mode, sizeof(header.mode)) & 0777);
+			member.modificationTime = modificationTime;
+			members.push_back(std::move(member));
+		}
+		return members;
+	}
+
+	std::uint16_t read16(const std::uint8_t *data)
+	{
+		return static_cast<std::uint16_t>(data[0] | data[1] << 8);
+	}
+
+	std::uint32_t read32(const std::uint8_t *data)
+	{
+		return static_cast<std::uint32_t>(read16(data)) | static_cast<std::uint32_t>(read16(data + 2)) << 16;
+	}
+
+	std::uint64_t read64(const std::uint8_t *data)
+	{
+		return static_cast<std::uint64_t>(read32(data)) | static_cast<std::uint64_t>(read32(data + 4)) << 32;
+	}
+
+	// Convert an MS-DOS date and time, in local time, to nanoseconds since the Unix epoch
+	std::int64_t dosTime(std::uint16_t date, std::uint16_t time)
+	{
+		std::tm parts = {};
+		parts.tm_year = (date >> 9) + 80;
+		parts.tm_mon = ((date >> 5) & 15) - 1;
+		parts.tm_mday = date & 31;
+		parts.tm_hour = time >> 11;
+		parts.tm_min = (time >> 5) & 63;
+		parts.tm_sec = (time & 31) * 2;
+		parts.tm_isdst = -1;
+		return static_cast<std::int64_t>(std::mktime(&parts)) * nanosecondsPerSecond;
+	}
+
+	std::vector<Member> scanZip(const std::filesystem::path &archive)
+	{
+		File	   input(archive, false);
+		const auto size = static_cast<std::uint64_t>(std::filesystem::file_size(archive));
+		const auto require = [&archive](std::uint64_t offset, std::uint64_t length, std::uint64_t limit)
+		{
+			if (offset > limit || length > limit - offset)
+				malformed("unpack zip", archive);
+		};
+
+		// The end of central directory record is at the end of the archive, only followed by a comment of up to 65535 bytes, and preceded by the locator
+		// of the zip64 record if any: the end of the archive is read once for both
+		constexpr std::uint64_t endSize = 22;
+		constexpr std::uint64_t locatorSize = 20;
+		require(0, endSize, size);
+		const auto				  tailOffset = size - std::min<std::uint64_t>(size, locatorSize + endSize + 0xFFFF);
+		std::vector<std::uint8_t> tail(static_cast<std::size_t>(size - tailOffset));
+		readAt("unpack zip", archive, input, tailOffset, tail.data(), tail.size());
+		const auto at = [&tail, tailOffset](std::uint64_t offset)
+		{
+			return tail.data() + (offset - tailOffset);
+		};
+		auto	   end = size - endSize;
+		const auto lowest = size > endSize + 0xFFFF ? size - endSize - 0xFFFF : 0;
+		while (read32(at(end)) != 0x06054B50)
+		{
+			if (end == lowest)
+				malformed("unpack zip", archive);
+			end--;
+		}
+		std::uint64_t count = read16(at(end) + 10);
+		std::uint64_t directorySize = read32(at(end) + 12);
+		std::uint64_t directoryOffset = read32(at(end) + 16);
+		// Zip64 archives store the actual values in another record, found through a locator right before
+		if (end >= tailOffset + locatorSize && read32(at(end - locatorSize)) == 0x07064B50)
+		{
+			const auto	 offset = read64(at(end - locatorSize) + 8);
+			std::uint8_t record[56];
+			require(offset, sizeof(record), size);
+			readAt("unpack zip", archive, input, offset, record, sizeof(record));
+			if (read32(record) != 0x06064B50)
+				malformed("unpack zip", archive);
+			count = read64(record + 32);
+			directorySize = read64(record + 40);
+			directoryOffset = read64(record + 48);
+		}
+		require(directoryOffset, directorySize, size);
+		std::vector<std::uint8_t> directory(static_cast<std::size_t>(directorySize));
+		readAt("unpack zip", archive, input, directoryOffset, directory.data(), directory.size());
+
+		std::vector<Member> members;
+		members.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(count, directorySize / 46)));
+		std::uint64_t position = 0;
+		for (std::uint64_t i = 0; i < count; i++)
+		{
+			require(position, 46, directorySize);
+			const auto header = directory.data() + position;
+			if (read32(header) != 0x02014B50)
+				malformed("unpack zip", archive);
+			const auto	  creator = read16(header + 4);
+			const auto	  flags = read16(header + 8);
+			const auto	  method = read16(header + 10);
+			const auto	  crc = read32(header + 16);
+			std::uint64_t storedSize = read32(header + 20);
+			std::uint64_t fileSize = read32(header + 24);
+			const auto	  nameLength = read16(header + 28);
+			const auto	  extraLength = read16(header + 30);
+			const auto	  commentLength = read16(header + 32);
+			const auto	  attributes = read32(header + 38);
+			std::uint64_t localOffset = read32(header + 42);
+			require(position, 46 + nameLength + extraLength + commentLength, directorySize);
+			const std::string name(reinterpret_cast<const char *>(header + 46), nameLength);
+			auto			  modificationTime = dosTime(read16(header + 14), read16(header + 12));
+
+			// The zip64 extra field holds the values too large for their fields, in this order, and the extended timestamp the Unix time
+			const auto extra = header + 46 + nameLength;
+			for (std::size_t offset = 0; offset + 4 <= extraLength;)
+			{
+				const auto id = read16(extra + offset);
+				const auto length = read16(extra + offset + 2);
+				const auto field = extra + offset + 4;
+				offset += 4 + length;
+				if (offset > extraLength)
+					break;
+				if (id == 0x0001)
+				{
+					std::size_t used = 0;
+					for (auto value : {&fileSize, &storedSize, &localOffset})
+					{
+						if (*value == 0xFFFFFFFF && used + 8 <= length)
+						{
+							*value = read64(field + used);
+							used += 8;
+						}
+					}
+				}
+				else if (id == 0x5455 && length >= 5 && (field[0] & 1))
+					modificationTime = static_cast<std::int64_t>(static_cast<std::int32_t>(read32(field + 1))) * nanosecondsPerSecond;
+			}
+			position += 46 + nameLength + extraLength + commentLength;
+
+			if (flags & 1)
+				throw std::filesystem::filesystem_error("unpack zip", archive, std::filesystem::path(name), std::make_error_code(std::errc::not_supported));
+			if (method != 0 && method != 8)
+				throw std::filesystem::filesystem_error("unpack zip", archive, std::filesystem::path(name), std::make_error_code(std::errc::not_supported));
+
+			Member member;
+			member.path = memberPath("unpack zip", archive, name);
+			if (member.path.empty())
+				continue;
+			// The Unix mode, when the archive was made on Unix, is in the high half of the external attributes
+			const auto mode = (creator >> 8) == 3 ? attributes >> 16 : 0;
+			if (!name.empty() && name.back() == '/')
+				member.type = std::filesystem::file_type::directory;
+			else if ((mode & 0170000) == 0120000)
+				member.type = std::filesystem::file_type::symlink;
+			else if ((mode & 0170000) == 0040000)
+				member.type = std::filesystem::file_type::directory;
+			if (mode & 0777)
+				member.permissions = static_cast<std::filesystem::perms>(mode & 0777);
+			member.modificationTime = modificationTime;
+
+			std::uint8_t local[30];
+			require(localOffset, sizeof(local), size);
+			readAt("unpack zip", archive, input, localOffset, local, sizeof(local));
+			if (read32(local) != 0x04034B50)
+				malformed("unpack zip", archive);
+			member.offset = localOffset + sizeof(local) + read16(local + 26) + read16(local + 28);
+			require(member.offset, storedSize, size);
+			member.storedSize = storedSize;
+			member.size = fileSize;
+			member.deflated = method == 8;
+			member.crc = crc;
+
+			// The target of a symlink is its contents
+			if (member.type == std::filesystem::file_type::symlink)
+			{
+				std::string target;
+				if (!member.deflated)
+				{
+					target.resize(static_cast<std::size_t>(storedSize));
+					readAt("unpack zip", archive, input, member.offset, target.data(), target.size());
+				}
+				else
+				{
+					try
+					{
+						inflateMember("unpack zip", archive, input, member,
+									  [&target](const std::uint8_t *buffer, std::size_t length)
+									  {
+										  target.append(reinterpret_cast<const char *>(buffer), length);
+									  });
+					}
+					catch (const std::system_error &exception)
+					{
+						throw std::filesystem::filesystem_error("unpack zip", archive, std::filesystem::path(name), exception.code());
+					}
+				}
+				member.target = target;
+				member.size = 0;
+			}
+			else if (member.type == std::filesystem::file_type::directory)
+				member.size = 0;
+			members.push_back(std::move(member));
+		}
+		return members;
+	}
+} // namespace
+
+void recpp::filesystem::detail::packTar(const std::filesystem::path &root, const std::filesystem::path &archive, const EntryCallback &onEntry,
+										const ArchiveOptions &options)
+{
+	TarPacker(root, archive, onEntry, options).run();
+}
+
+void recpp::filesystem::detail::unpackTar(const std::filesystem::path &archive, const std::filesystem::path &destination, const EntryCallback &onEntry,
+										  const ArchiveOptions &options)
+{
+	extract("unpack tar", archive, scanTar(archive), destination, onEntry, options);
+}
+
+void recpp::filesystem::detail::unpackZip(const std::filesystem::path &archive, const std::filesystem::path &destination, const EntryCallback &onEntry,
+										  const ArchiveOptions &options)
+{
+	extract("unpack zip", archive, scanZip(archive), destination, onEntry, options);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <recpp/filesystem/Archive.h>
+
+#include <filesystem>
+#include <functional>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Pack the tree rooted at @p root into the tar archive @p archive, calling @p onEntry with each entry once it is written.
+	 * <p>
+	 * The tree is listed on several threads and packed sorted by path, in the POSIX pax format. Reader threads load the next files into memory, in
+	 * archive order and up to ArchiveOptions::memoryLimit bytes ahead, while the calling thread writes them to the archive, so that reading files and
+	 * writing the archive overlap. Files too large to be read ahead are streamed by the writer instead. @p onEntry is called from the calling thread.
+	 */
+	void packTar(const std::filesystem::path &root, const std::filesystem::path &archive, const std::function<void(const ArchiveEntry &entry)> &onEntry,
+				 const ArchiveOptions &options);
+
+	/**
+	 * @brief Unpack the tar archive @p archive into @p destination, calling @p onEntry with each entry once it is created.
+	 * <p>
+	 * The headers of the archive are scanned first. The directories of every entry are then created in bulk, the files are read from the archive and
+	 * written on several threads, and the links are created last, once their targets exist, the hard links before the symlinks. @p onEntry is called from
+	 * the worker threads, one entry at a time.
+	 */
+	void unpackTar(const std::filesystem::path &archive, const std::filesystem::path &destination,
+				   const std::function<void(const ArchiveEntry &entry)> &onEntry, const ArchiveOptions &options);
+
+	/**
+	 * @brief Unpack the zip archive @p archive into @p destination, calling @p onEntry with each entry once it is created.
+	 * <p>
+	 * Like unpackTar, except that the entries are found in the central directory of the archive, and that the deflated ones are decompressed by the
+	 * threads writing them, their CRC being checked.
+	 */
+	void unpackZip(const std::filesystem::path &archive, const std::filesystem::path &destination,
+				   const std::function<void(const ArchiveEntry &entry)> &onEntry, const ArchiveOptions &options);
+} // namespace recpp::filesystem::detail
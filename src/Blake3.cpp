@@ -0,0 +1,453 @@
+#include "Blake3.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RECPP_FILESYSTEM_BLAKE3_SSE2
+#endif
+
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	constexpr std::size_t blockSize = 64;
+	constexpr std::size_t chunkSize = 1024;
+	// Subtrees smaller than this are hashed on the calling thread, since starting a background call costs more than hashing them
+	constexpr std::size_t parallelSize = 1 << 20;
+	// Number of chunks whose chaining values are computed at once before being merged, which must be a power of 2
+	constexpr std::size_t leafChunks = 16;
+
+	constexpr std::uint32_t iv[8] = {0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+
+	constexpr std::uint8_t messageSchedule[7][16] = {
+		{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}, {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8},
+		{3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1}, {10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6},
+		{12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4}, {9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7},
+		{11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13},
+	};
+
+	enum Flags : std::uint8_t
+	{
+		chunkStart = 1 << 0,
+		chunkEnd = 1 << 1,
+		parent = 1 << 2,
+		root = 1 << 3,
+	};
+
+	inline std::uint32_t read32(const std::uint8_t *data)
+	{
+		return static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8 | static_cast<std::uint32_t>(data[2]) << 16 |
+			   static_cast<std::uint32_t>(data[3]) << 24;
+	}
+
+	inline void write32(std::uint8_t *data, std::uint32_t value)
+	{
+		data[0] = static_cast<std::uint8_t>(value);
+		data[1] = static_cast<std::uint8_t>(value >> 8);
+		data[2] = static_cast<std::uint8_t>(value >> 16);
+		data[3] = static_cast<std::uint8_t>(value >> 24);
+	}
+
+	inline std::uint32_t rotr(std::uint32_t value, int bits)
+	{
+		return (value >> bits) | (value << (32 - bits));
+	}
+
+	inline void mix(std::uint32_t *state, int a, int b, int c, int d, std::uint32_t x, std::uint32_t y)
+	{
+		state[a] = state[a] + state[b] + x;
+		state[d] = rotr(state[d] ^ state[a], 16);
+		state[c] = state[c] + state[d];
+		state[b] = rotr(state[b] ^ state[c], 12);
+		state[a] = state[a] + state[b] + y;
+		state[d] = rotr(state[d] ^ state[a], 8);
+		state[c] = state[c] + state[d];
+		state[b] = rotr(state[b] ^ state[c], 7);
+	}
+
+	void compress(const std::uint32_t *cv, const std::uint8_t *block, std::size_t size, std::uint64_t counter, std::uint8_t flags, std::uint32_t *state)
+	{
+		std::uint32_t message[16];
+		for (std::size_t i = 0; i < 16; i++)
+			message[i] = read32(block + 4 * i);
+
+		std::memcpy(state, cv, 8 * sizeof(std::uint32_t));
+		std::memcpy(state + 8, iv, 4 * sizeof(std::uint32_t));
+		state[12] = static_cast<std::uint32_t>(counter);
+		state[13] = static_cast<std::uint32_t>(counter >> 32);
+		state[14] = static_cast<std::uint32_t>(size);
+		state[15] = flags;
+		for (const auto &schedule : messageSchedule)
+		{
+			mix(state, 0, 4, 8, 12, message[schedule[0]], message[schedule[1]]);
+			mix(state, 1, 5, 9, 13, message[schedule[2]], message[schedule[3]]);
+			mix(state, 2, 6, 10, 14, message[schedule[4]], message[schedule[5]]);
+			mix(state, 3, 7, 11, 15, message[schedule[6]], message[schedule[7]]);
+			mix(state, 0, 5, 10, 15, message[schedule[8]], message[schedule[9]]);
+			mix(state, 1, 6, 11, 12, message[schedule[10]], message[schedule[11]]);
+			mix(state, 2, 7, 8, 13, message[schedule[12]], message[schedule[13]]);
+			mix(state, 3, 4, 9, 14, message[schedule[14]], message[schedule[15]]);
+		}
+		for (std::size_t i = 0; i < 8; i++)
+			state[i] ^= state[i + 8];
+	}
+
+	void compressInPlace(std::uint32_t *cv, const std::uint8_t *block, std::size_t size, std::uint64_t counter, std::uint8_t flags)
+	{
+		std::uint32_t state[16];
+		compress(cv, block, size, counter, flags, state);
+		std::memcpy(cv, state, 8 * sizeof(std::uint32_t));
+	}
+
+	void parentCv(const std::uint32_t *left, const std::uint32_t *right, std::uint32_t *cv, std::uint8_t flags = 0)
+	{
+		std::uint8_t block[blockSize];
+		for (std::size_t i = 0; i < 8; i++)
+		{
+			write32(block + 4 * i, left[i]);
+			write32(block + 32 + 4 * i, right[i]);
+		}
+		std::memcpy(cv, iv, sizeof(iv));
+		compressInPlace(cv, block, blockSize, 0, parent | flags);
+	}
+
+	void chunkCv(const std::uint8_t *input, std::uint64_t counter, std::uint32_t *cv)
+	{
+		std::memcpy(cv, iv, sizeof(iv));
+		for (std::size_t block = 0; block < chunkSize / blockSize; block++)
+		{
+			std::uint8_t flags = block == 0 ? chunkStart : 0;
+			if (block == chunkSize / blockSize - 1)
+				flags |= chunkEnd;
+			compressInPlace(cv, input + block * blockSize, blockSize, counter, flags);
+		}
+	}
+
+#ifdef RECPP_FILESYSTEM_BLAKE3_SSE2
+	template <int Bits>
+	inline __m128i rotr4(__m128i value)
+	{
+		return _mm_or_si128(_mm_srli_epi32(value, Bits), _mm_slli_epi32(value, 32 - Bits));
+	}
+
+	inline void mix4(__m128i *state, int a, int b, int c, int d, __m128i x, __m128i y)
+	{
+		state[a] = _mm_add_epi32(_mm_add_epi32(state[a], state[b]), x);
+		state[d] = rotr4<16>(_mm_xor_si128(state[d], state[a]));
+		state[c] = _mm_add_epi32(state[c], state[d]);
+		state[b] = rotr4<12>(_mm_xor_si128(state[b], state[c]));
+		state[a] = _mm_add_epi32(_mm_add_epi32(state[a], state[b]), y);
+		state[d] = rotr4<8>(_mm_xor_si128(state[d], state[a]));
+		state[c] = _mm_add_epi32(state[c], state[d]);
+		state[b] = rotr4<7>(_mm_xor_si128(state[b], state[c]));
+	}
+
+	// Compute the chaining values of 4 consecutive full chunks at once, each 32 bits lane of the vectors holding the state of one chunk
+	void chunkCv4(const std::uint8_t *input, std::uint64_t counter, std::uint32_t (*cvs)[8])
+	{
+		__m128i cv[8];
+		for (std::size_t i = 0; i < 8; i++)
+			cv[i] = _mm_set1_epi32(static_cast<int>(iv[i]));
+		const auto counterLow = _mm_set_epi32(static_cast<int>(counter + 3), static_cast<int>(counter + 2), static_cast<int>(counter + 1),
+											  static_cast<int>(counter));
+		const auto counterHigh = _mm_set_epi32(static_cast<int>((counter + 3) >> 32), static_cast<int>((counter + 2) >> 32),
+											   static_cast<int>((counter + 1) >> 32), static_cast<int>(counter >> 32));
+
+		for (std::size_t block = 0; block < chunkSize / blockSize; block++)
+		{
+			// Transpose the message words so that each vector holds the same word of the 4 chunks
+			__m128i message[16];
+			for (std::size_t quarter = 0; quarter < 4; quarter++)
+			{
+				const auto offset = block * blockSize + quarter * 16;
+				const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + offset));
+				const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + chunkSize + offset));
+				const auto c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + 2 * chunkSize + offset));
+				const auto d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + 3 * chunkSize + offset));
+				const auto abLow = _mm_unpacklo_epi32(a, b);
+				const auto cdLow = _mm_unpacklo_epi32(c, d);
+				const auto abHigh = _mm_unpackhi_epi32(a, b);
+				const auto cdHigh = _mm_unpackhi_epi32(c, d);
+				message[4 * quarter] = _mm_unpacklo_epi64(abLow, cdLow);
+				message[4 * quarter + 1] = _mm_unpackhi_epi64(abLow, cdLow);
+				message[4 * quarter + 2] = _mm_unpacklo_epi64(abHigh, cdHigh);
+				message[4 * quarter + 3] = _mm_unpackhi_epi64(abHigh, cdHigh);
+			}
+
+			std::uint8_t flags = block == 0 ? chunkStart : 0;
+			if (block == chunkSize / blockSize - 1)
+				flags |= chunkEnd;
+			__m128i state[16];
+			for (std::size_t i = 0; i < 8; i++)
+				state[i] = cv[i];
+			for (std::size_t i = 0; i < 4; i++)
+				state[8 + i] = _mm_set1_epi32(static_cast<int>(iv[i]));
+			state[12] = counterLow;
+			state[13] = counterHigh;
+			state[14] = _mm_set1_epi32(static_cast<int>(blockSize));
+			state[15] = _mm_set1_epi32(flags);
+			for (const auto &schedule : messageSchedule)
+			{
+				mix4(state, 0, 4, 8, 12, message[schedule[0]], message[schedule[1]]);
+				mix4(state, 1, 5, 9, 13, message[schedule[2]], message[schedule[3]]);
+				mix4(state, 2, 6, 10, 14, message[schedule[4]], message[schedule[5]]);
+				mix4(state, 3, 7, 11, 15, message[schedule[6]], message[schedule[7]]);
+				mix4(state, 0, 5, 10, 15, message[schedule[8]], message[schedule[9]]);
+				mix4(state, 1, 6, 11, 12, message[schedule[10]], message[schedule[11]]);
+				mix4(state, 2, 7, 8, 13, message[schedule[12]], message[schedule[13]]);
+				mix4(state, 3, 4, 9, 14, message[schedule[14]], message[schedule[15]]);
+			}
+			for (std::size_t i = 0; i < 8; i++)
+				cv[i] = _mm_xor_si128(state[i], state[i + 8]);
+		}
+
+		for (std::size_t i = 0; i < 8; i++)
+		{
+			alignas(16) std::uint32_t lanes[4];
+			_mm_store_si128(reinterpret_cast<__m128i *>(lanes), cv[i]);
+			for (std::size_t lane = 0; lane < 4; lane++)
+				cvs[lane][i] = lanes[lane];
+		}
+	}
+#endif
+
+	void chunkCvs(const std::uint8_t *input, std::size_t chunks, std::uint64_t counter, std::uint32_t (*cvs)[8])
+	{
+		std::size_t chunk = 0;
+#ifdef RECPP_FILESYSTEM_BLAKE3_SSE2
+		for (; chunk + 4 <= chunks; chunk += 4)
+			chunkCv4(input + chunk * chunkSize, counter + chunk, cvs + chunk);
+#endif
+		for (; chunk < chunks; chunk++)
+			chunkCv(input + chunk * chunkSize, counter + chunk, cvs[chunk]);
+	}
+
+	void subtreeCv(const std::uint8_t *input, std::size_t chunks, std::uint64_t counter, unsigned threads, std::uint32_t *cv);
+
+	// Compute the chaining values of the two halves of a subtree of full chunks, whose number is a power of 2
+	void subtreeChildren(const std::uint8_t *input, std::size_t chunks, std::uint64_t counter, unsigned threads, std::uint32_t *left, std::uint32_t *right)
+	{
+		const auto half = chunks / 2;
+		if (threads < 2 || chunks * chunkSize < parallelSize)
+		{
+			subtreeCv(input, half, counter, 1, left);
+			subtreeCv(input + half * chunkSize, half, counter + half, 1, right);
+			return;
+		}
+
+		// The left half is hashed in the background, on the scheduler and under the limiter of the FileSystem operation if there is one, and on the
+		// calling thread once it is done with the right half if it did not start by then
+		BackgroundCall<std::array<std::uint32_t, 8>> task(
+			[input, half, counter, threads]()
+			{
+				std::array<std::uint32_t, 8> cv;
+				subtreeCv(input, half, counter, threads / 2, cv.data());
+				return cv;
+			});
+		subtreeCv(input + half * chunkSize, half, counter + half, threads - threads / 2, right);
+		const auto cv = task.get();
+		std::memcpy(left, cv.data(), sizeof(cv));
+	}
+
+	void subtreeCv(const std::uint8_t *input, std::size_t chunks, std::uint64_t counter, unsigned threads, std::uint32_t *cv)
+	{
+		if (chunks > leafChunks)
+		{
+			std::uint32_t left[8];
+			std::uint32_t right[8];
+			subtreeChildren(input, chunks, counter, threads, left, right);
+			parentCv(left, right, cv);
+			return;
+		}
+
+		std::uint32_t cvs[leafChunks][8];
+		chunkCvs(input, chunks, counter, cvs);
+		for (auto count = chunks; count > 1; count /= 2)
+		{
+			for (std::size_t i = 0; i < count / 2; i++)
+				parentCv(cvs[2 * i], cvs[2 * i + 1], cvs[i]);
+		}
+		std::memcpy(cv, cvs[0], sizeof(cvs[0]));
+	}
+
+	std::size_t popCount(std::uint64_t value)
+	{
+		std::size_t count = 0;
+		for (; value; value &= value - 1)
+			count++;
+		return count;
+	}
+} // namespace
+
+recpp::filesystem::detail::Blake3::Blake3()
+{
+	reset();
+}
+
+void recpp::filesystem::detail::Blake3::reset()
+{
+	resetChunk(0);
+	m_cvStackSize = 0;
+}
+
+void recpp::filesystem::detail::Blake3::update(const std::uint8_t *data, std::size_t size)
+{
+	// Finish the pending chunk first, but only compress it once more input shows that it is not the last one
+	if (m_chunk.blocksCompressed * blockSize + m_chunk.blockSize > 0)
+	{
+		const auto taken = std::min(chunkSize - (m_chunk.blocksCompressed * blockSize + m_chunk.blockSize), size);
+		updateChunk(data, taken);
+		data += taken;
+		size -= taken;
+		if (size == 0)
+			return;
+
+		std::uint32_t cv[8];
+		std::memcpy(cv, m_chunk.cv, sizeof(cv));
+		compressInPlace(cv, m_chunk.block, m_chunk.blockSize, m_chunk.counter, (m_chunk.blocksCompressed == 0 ? chunkStart : 0) | chunkEnd);
+		pushCv(cv, m_chunk.counter);
+		resetChunk(m_chunk.counter + 1);
+	}
+
+	// Hash the largest complete subtrees aligned on the chunks hashed so far directly from the input, without going through the chunk state
+	const auto threads = threadCount();
+	while (size > chunkSize)
+	{
+		std::size_t subtreeSize = chunkSize;
+		while (subtreeSize * 2 <= size && (m_chunk.counter & (subtreeSize * 2 / chunkSize - 1)) == 0)
+			subtreeSize *= 2;
+		const auto chunks = subtreeSize / chunkSize;
+
+		if (chunks == 1)
+		{
+			std::uint32_t cv[8];
+			chunkCv(data, m_chunk.counter, cv);
+			pushCv(cv, m_chunk.counter);
+		}
+		else
+		{
+			std::uint32_t left[8];
+			std::uint32_t right[8];
+			subtreeChildren(data, chunks, m_chunk.counter, threads, left, right);
+			pushCv(left, m_chunk.counter);
+			pushCv(right, m_chunk.counter + chunks / 2);
+		}
+		m_chunk.counter += chunks;
+		data += subtreeSize;
+		size -= subtreeSize;
+	}
+
+	if (size > 0)
+	{
+		updateChunk(data, size);
+		mergeCvStack(m_chunk.counter);
+	}
+}
+
+void recpp::filesystem::detail::Blake3::digest(std::uint8_t *digest) const
+{
+	// The root node is the pending chunk if nothing else was pushed, or the parent of every chaining value of the stack and of the pending chunk
+	std::uint32_t		cv[8];
+	std::uint8_t		block[blockSize];
+	const std::uint8_t *rootBlock;
+	std::size_t			rootBlockSize;
+	std::uint64_t		rootCounter = 0;
+	std::uint8_t		rootFlags;
+	std::size_t			remaining;
+
+	if (m_chunk.blocksCompressed * blockSize + m_chunk.blockSize > 0 || m_cvStackSize == 0)
+	{
+		std::memcpy(cv, m_chunk.cv, sizeof(cv));
+		rootBlock = m_chunk.block;
+		rootBlockSize = m_chunk.blockSize;
+		rootCounter = m_chunk.counter;
+		rootFlags = (m_chunk.blocksCompressed == 0 ? chunkStart : 0) | chunkEnd;
+		remaining = m_cvStackSize;
+	}
+	else
+	{
+		remaining = m_cvStackSize - 2;
+		for (std::size_t i = 0; i < 8; i++)
+		{
+			write32(block + 4 * i, m_cvStack[remaining][i]);
+			write32(block + 32 + 4 * i, m_cvStack[remaining + 1][i]);
+		}
+		std::memcpy(cv, iv, sizeof(iv));
+		rootBlock = block;
+		rootBlockSize = blockSize;
+		rootFlags = parent;
+	}
+
+	while (remaining > 0)
+	{
+		remaining--;
+		std::uint32_t child[8];
+		std::memcpy(child, cv, sizeof(child));
+		compressInPlace(child, rootBlock, rootBlockSize, rootCounter, rootFlags);
+		for (std::size_t i = 0; i < 8; i++)
+		{
+			write32(block + 4 * i, m_cvStack[remaining][i]);
+			write32(block + 32 + 4 * i, child[i]);
+		}
+		std::memcpy(cv, iv, sizeof(iv));
+		rootBlock = block;
+		rootBlockSize = blockSize;
+		rootCounter = 0;
+		rootFlags = parent;
+	}
+
+	std::uint32_t state[16];
+	compress(cv, rootBlock, rootBlockSize, 0, rootFlags | root, state);
+	for (std::size_t i = 0; i < digestSize / 4; i++)
+		write32(digest + 4 * i, state[i]);
+}
+
+void recpp::filesystem::detail::Blake3::resetChunk(std::uint64_t counter)
+{
+	std::memcpy(m_chunk.cv, iv, sizeof(iv));
+	m_chunk.counter = counter;
+	std::memset(m_chunk.block, 0, sizeof(m_chunk.block));
+	m_chunk.blockSize = 0;
+	m_chunk.blocksCompressed = 0;
+}
+
+void recpp::filesystem::detail::Blake3::updateChunk(const std::uint8_t *data, std::size_t size)
+{
+	while (size > 0)
+	{
+		// The buffered block is only compressed once more input follows, since the last block of the chunk needs the chunkEnd flag
+		if (m_chunk.blockSize == blockSize)
+		{
+			compressInPlace(m_chunk.cv, m_chunk.block, blockSize, m_chunk.counter, m_chunk.blocksCompressed == 0 ? chunkStart : 0);
+			m_chunk.blocksCompressed++;
+			m_chunk.blockSize = 0;
+			std::memset(m_chunk.block, 0, sizeof(m_chunk.block));
+		}
+		const auto taken = std::min(blockSize - m_chunk.blockSize, size);
+		std::memcpy(m_chunk.block + m_chunk.blockSize, data, taken);
+		m_chunk.blockSize += taken;
+		data += taken;
+		size -= taken;
+	}
+}
+
+void recpp::filesystem::detail::Blake3::pushCv(const std::uint32_t *cv, std::uint64_t totalChunks)
+{
+	mergeCvStack(totalChunks);
+	std::memcpy(m_cvStack[m_cvStackSize++], cv, sizeof(m_cvStack[0]));
+}
+
+void recpp::filesystem::detail::Blake3::mergeCvStack(std::uint64_t totalChunks)
+{
+	// Subtrees are merged lazily, once a later chaining value shows that they are not on the right edge of the tree
+	const auto mergedSize = popCount(totalChunks);
+	while (m_cvStackSize > mergedSize)
+	{
+		parentCv(m_cvStack[m_cvStackSize - 2], m_cvStack[m_cvStackSize - 1], m_cvStack[m_cvStackSize - 2]);
+		m_cvStackSize--;
+	}
+}
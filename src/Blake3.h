@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Streaming implementation of the BLAKE3 hash function in its default (unkeyed) mode, producing 32 bytes digests.
+	 * <p>
+	 * Chunks are compressed four at a time with SSE2 when the target supports it, and large updates are split into subtrees hashed in parallel
+	 * as BackgroundCall tasks.
+	 */
+	class Blake3
+	{
+	public:
+		static constexpr std::size_t digestSize = 32;
+
+		/**
+		 * @brief Construct a new Blake3 object, ready to hash a new input.
+		 */
+		Blake3();
+
+		/**
+		 * @brief Reset this object to hash a new input.
+		 */
+		void reset();
+
+		/**
+		 * @brief Append @p size bytes from @p data to the hashed input.
+		 */
+		void update(const std::uint8_t *data, std::size_t size);
+
+		/**
+		 * @brief Write the hash of the input appended so far to @p digest. More input can still be appended afterwards.
+		 */
+		void digest(std::uint8_t *digest) const;
+
+	private:
+		struct ChunkState
+		{
+			std::uint32_t cv[8];
+			std::uint64_t counter;
+			std::uint8_t  block[64];
+			std::size_t	  blockSize;
+			std::size_t	  blocksCompressed;
+		};
+
+		void resetChunk(std::uint64_t counter);
+		void updateChunk(const std::uint8_t *data, std::size_t size);
+		void pushCv(const std::uint32_t *cv, std::uint64_t totalChunks);
+		void mergeCvStack(std::uint64_t totalChunks);
+
+		ChunkState	  m_chunk;
+		std::uint32_t m_cvStack[55][8];
+		std::size_t	  m_cvStackSize;
+	};
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,54 @@
+#include "recpp/filesystem/CancellationToken.h"
+
+recpp::filesystem::OperationCanceledError::OperationCanceledError(bool timedOut)
+	: std::system_error(std::make_error_code(timedOut ? std::errc::timed_out : std::errc::operation_canceled),
+						timedOut ? "operation deadline exceeded" : "operation cancelled")
+{
+}
+
+recpp::filesystem::CancellationToken::CancellationToken()
+	: m_state(std::make_shared<State>())
+{
+}
+
+recpp::filesystem::CancellationToken recpp::filesystem::CancellationToken::withDeadline(Clock::time_point deadline)
+{
+	CancellationToken token;
+	token.m_state->deadline = deadline;
+	return token;
+}
+
+recpp::filesystem::CancellationToken recpp::filesystem::CancellationToken::withTimeout(Clock::duration timeout)
+{
+	return withDeadline(Clock::now() + timeout);
+}
+
+void recpp::filesystem::CancellationToken::cancel() const
+{
+	m_state->cancelled = true;
+}
+
+bool recpp::filesystem::CancellationToken::isCancelled() const
+{
+	return m_state->cancelled || (m_state->deadline && Clock::now() >= *m_state->deadline);
+}
+
+std::optional<recpp::filesystem::CancellationToken::Clock::time_point> recpp::filesystem::CancellationToken::deadline() const
+{
+	return m_state->deadline;
+}
+
+std::exception_ptr recpp::filesystem::CancellationToken::exception() const
+{
+	if (m_state->cancelled)
+		return std::make_exception_ptr(OperationCanceledError(false));
+	if (m_state->deadline && Clock::now() >= *m_state->deadline)
+		return std::make_exception_ptr(OperationCanceledError(true));
+	return nullptr;
+}
+
+void recpp::filesystem::CancellationToken::throwIfCancelled() const
+{
+	if (auto exception = this->exception())
+		std::rethrow_exception(exception);
+}
@@ -0,0 +1,398 @@
+#include "recpp/filesystem/CanonicalCache.h"
+#include "FileInfo.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	using Key = std::filesystem::path::string_type;
+
+	constexpr std::size_t shardCount = 16;
+	// The number of symlinks followed while resolving a path before giving up, like the SYMLOOP_MAX of Linux
+	constexpr int		  maxSymlinks = 40;
+
+	struct Component
+	{
+		std::filesystem::file_type type;
+		/// The target of a symlink
+		Key						   target;
+		/// The modification time of a directory when it was cached, in nanoseconds since the Unix epoch
+		std::int64_t			   modificationTime;
+	};
+
+	// A least recently used cache of components, the keys being the resolved paths of the components
+	class Shard
+	{
+	public:
+		bool find(const Key &key, Component &component)
+		{
+			std::lock_guard lock(m_mutex);
+			const auto		node = m_index.find(key);
+			if (node == m_index.end())
+				return false;
+			m_order.splice(m_order.begin(), m_order, node->second.position);
+			component = node->second.component;
+			return true;
+		}
+
+		void insert(const Key &key, const Component &component, std::size_t capacity)
+		{
+			std::lock_guard lock(m_mutex);
+			const auto [node, inserted] = m_index.try_emplace(key, Node{component, {}});
+			if (!inserted)
+			{
+				node->second.component = component;
+				m_order.splice(m_order.begin(), m_order, node->second.position);
+				return;
+			}
+			m_order.push_front(&node->first);
+			node->second.position = m_order.begin();
+			while (m_index.size() > capacity)
+			{
+				m_index.erase(*m_order.back());
+				m_order.pop_back();
+			}
+		}
+
+		template <typename Visitor>
+		void forEach(const Visitor &visitor)
+		{
+			std::lock_guard lock(m_mutex);
+			for (const auto &[key, node] : m_index)
+				visitor(key, node.component);
+		}
+
+		template <typename Predicate>
+		std::size_t removeIf(const Predicate &predicate)
+		{
+			std::lock_guard lock(m_mutex);
+			std::size_t		count = 0;
+			for (auto node = m_index.begin(); node != m_index.end();)
+			{
+				if (!predicate(node->first))
+				{
+					++node;
+					continue;
+				}
+				m_order.erase(node->second.position);
+				node = m_index.erase(node);
+				count++;
+			}
+			return count;
+		}
+
+		std::size_t size()
+		{
+			std::lock_guard lock(m_mutex);
+			return m_index.size();
+		}
+
+	private:
+		// The order only points to the keys of the index, which stay in place when it grows
+		using Order = std::list<const Key *>;
+
+		struct Node
+		{
+			Component		component;
+			Order::iterator position;
+		};
+
+		std::mutex						m_mutex;
+		std::unordered_map<Key, Node>	m_index;
+		Order							m_order;
+	};
+
+	bool isSeparator(std::filesystem::path::value_type character)
+	{
+		return character == '/' || character == std::filesystem::path::preferred_separator;
+	}
+
+	std::size_t skipSeparators(const Key &path, std::size_t position)
+	{
+		while (position < path.size() && isSeparator(path[position]))
+			position++;
+		return position;
+	}
+
+	bool isUnder(const Key &key, const Key &prefix)
+	{
+		if (key.compare(0, prefix.size(), prefix) != 0)
+			return false;
+		return key.size() == prefix.size() || prefix.back() == std::filesystem::path::preferred_separator ||
+			   key[prefix.size()] == std::filesystem::path::preferred_separator;
+	}
+} // namespace
+
+struct recpp::filesystem::CanonicalCache::Data
+{
+	explicit Data(std::size_t capacity)
+		: shardCapacity(std::max<std::size_t>(1, capacity / shardCount))
+	{
+	}
+
+	Shard &shard(const Key &key)
+	{
+		return shards[std::hash<Key>()(key) % shardCount];
+	}
+
+	// Get the component at path, from the cache or with an lstat, or std::nullopt with error set if it does not exist
+	std::optional<Component> component(const Key &path, std::error_code &error)
+	{
+		auto	 &pathShard = shard(path);
+		Component result;
+		if (pathShard.find(path, result))
+		{
+			hits++;
+			return result;
+		}
+
+		misses++;
+		try
+		{
+			const auto info = fileInfo(path);
+			result = Component{info.type, {}, info.modificationTime};
+		}
+		catch (const std::filesystem::filesystem_error &exception)
+		{
+			error = exception.code();
+			return std::nullopt;
+		}
+		if (result.type == std::filesystem::file_type::symlink)
+			result.target = std::filesystem::read_symlink(path).native();
+		pathShard.insert(path, result, shardCapacity);
+		return result;
+	}
+
+	// Resolve the components of path one by one, following symlinks, or set error and stop at the first one that cannot be resolved. The components are
+	// handled as parts of the native strings, which is much cheaper than iterating std::filesystem::path objects
+	Key resolve(const std::filesystem::path &path, std::error_code &error)
+	{
+		// An absolute path always has a root directory, and the root name, if any, is kept as is
+		const auto absolute = path.is_absolute() ? path : std::filesystem::absolute(path);
+		auto	   pending = absolute.native();
+		auto	   resolved = pending.substr(0, absolute.root_name().native().size()) + std::filesystem::path::preferred_separator;
+		const auto rootSize = resolved.size();
+		auto	   type = std::filesystem::file_type::directory;
+		auto	   symlinks = 0;
+		Key		   candidate;
+		for (auto position = skipSeparators(pending, rootSize - 1); position < pending.size();)
+		{
+			auto end = position;
+			while (end < pending.size() && !isSeparator(pending[end]))
+				end++;
+			const auto size = end - position;
+			const auto dots = (size == 1 || size == 2) && pending[position] == '.' && pending[end - 1] == '.';
+
+			// Like realpath, "." and ".." are only valid after a directory
+			if (dots && type != std::filesystem::file_type::directory)
+			{
+				error = std::make_error_code(std::errc::not_a_directory);
+				return resolved;
+			}
+			if (dots)
+			{
+				if (size == 2)
+				{
+					auto parent = resolved.size();
+					while (parent > rootSize && !isSeparator(resolved[parent - 1]))
+						parent--;
+					resolved.resize(parent > rootSize ? parent - 1 : rootSize);
+				}
+				position = skipSeparators(pending, end);
+				continue;
+			}
+
+			candidate = resolved;
+			if (!candidate.empty() && !isSeparator(candidate.back()))
+				candidate += std::filesystem::path::preferred_separator;
+			candidate.append(pending, position, size);
+			const auto found = component(candidate, error);
+			if (!found)
+				return resolved;
+
+			if (found->type != std::filesystem::file_type::symlink)
+			{
+				resolved.swap(candidate);
+				type = found->type;
+				position = skipSeparators(pending, end);
+				continue;
+			}
+
+			// The target replaces the symlink in the pending components, an absolute target restarting from its root
+			if (++symlinks > maxSymlinks)
+			{
+				error = std::make_error_code(std::errc::too_many_symbolic_link_levels);
+				return resolved;
+			}
+			const std::filesystem::path target(found->target);
+			if (target.is_absolute())
+			{
+				resolved = target.root_path().native();
+				type = std::filesystem::file_type::directory;
+			}
+			pending = target.relative_path().native() + pending.substr(end);
+			position = skipSeparators(pending, 0);
+		}
+
+		// A trailing separator requires a directory
+		if (!pending.empty() && isSeparator(pending.back()) && type != std::filesystem::file_type::directory)
+			error = std::make_error_code(std::errc::not_a_directory);
+		return resolved;
+	}
+
+	std::array<Shard, shardCount> shards;
+	const std::size_t			  shardCapacity;
+	std::atomic<std::uintmax_t>	  hits = 0;
+	std::atomic<std::uintmax_t>	  misses = 0;
+};
+
+recpp::filesystem::CanonicalCache::CanonicalCache(std::size_t capacity)
+	: m_data(std::make_shared<Data>(capacity))
+{
+}
+
+std::filesystem::path recpp::filesystem::CanonicalCache::canonical(const std::filesystem::path &path) const
+{
+	std::error_code error;
+	auto			resolved = m_data->resolve(path, error);
+	if (error)
+		throw std::filesystem::filesystem_error("canonical", path, error);
+	return resolved;
+}
+
+std::filesystem::path recpp::filesystem::CanonicalCache::weaklyCanonical(const std::filesystem::path &path) const
+{
+	std::error_code error;
+	auto			resolved = m_data->resolve(path, error);
+	if (!error)
+		return resolved;
+
+	// Like std::filesystem::weakly_canonical, the longest existing prefix of path is canonicalized, and the rest is appended as is. Shorter prefixes are
+	// tried one by one, mostly hitting the components cached by the first attempt
+	const std::vector<std::filesystem::path> elements(path.begin(), path.end());
+	for (auto count = elements.size(); count > 0; count--)
+	{
+		if (error != std::errc::no_such_file_or_directory && error != std::errc::not_a_directory)
+			throw std::filesystem::filesystem_error("weakly_canonical", path, error);
+
+		std::filesystem::path prefix;
+		for (std::size_t i = 0; i + 1 < count; i++)
+			prefix /= elements[i];
+		if (prefix.empty())
+			break;
+
+		error.clear();
+		std::filesystem::path existing = m_data->resolve(prefix, error);
+		if (!error)
+		{
+			for (auto i = count - 1; i < elements.size(); i++)
+				existing /= elements[i];
+			return existing.lexically_normal();
+		}
+	}
+	return path.lexically_normal();
+}
+
+void recpp::filesystem::CanonicalCache::invalidate(const std::filesystem::path &path)
+{
+	const auto &prefix = path.native();
+	for (auto &shard : m_data->shards)
+	{
+		shard.removeIf(
+			[&prefix](const Key &key)
+			{
+				return isUnder(key, prefix);
+			});
+	}
+}
+
+std::size_t recpp::filesystem::CanonicalCache::revalidate()
+{
+	// The directories and symlinks are collected first, so that no lock is held while checking them
+	std::vector<std::pair<Key, Component>> checked;
+	for (auto &shard : m_data->shards)
+	{
+		shard.forEach(
+			[&checked](const Key &key, const Component &component)
+			{
+				if (component.type == std::filesystem::file_type::directory || component.type == std::filesystem::file_type::symlink)
+					checked.emplace_back(key, component);
+			});
+	}
+
+	std::unordered_set<Key> changed;
+	for (const auto &[key, component] : checked)
+	{
+		try
+		{
+			const auto info = fileInfo(key);
+			if (info.type != component.type)
+				changed.insert(key);
+			else if (info.type == std::filesystem::file_type::directory && info.modificationTime != component.modificationTime)
+				changed.insert(key);
+			else if (info.type == std::filesystem::file_type::symlink && std::filesystem::read_symlink(key).native() != component.target)
+				changed.insert(key);
+		}
+		catch (const std::filesystem::filesystem_error &)
+		{
+			changed.insert(key);
+		}
+	}
+	if (changed.empty())
+		return 0;
+
+	// A component is forgotten if it or one of its parents changed
+	std::size_t count = 0;
+	for (auto &shard : m_data->shards)
+	{
+		count += shard.removeIf(
+			[&changed](const Key &key)
+			{
+				for (auto end = key.size(); end != Key::npos && end > 0; end = key.rfind(std::filesystem::path::preferred_separator, end - 1))
+				{
+					if (changed.count(key.substr(0, end)))
+						return true;
+				}
+				return false;
+			});
+	}
+	return count;
+}
+
+void recpp::filesystem::CanonicalCache::clear()
+{
+	for (auto &shard : m_data->shards)
+	{
+		shard.removeIf(
+			[](const Key &)
+			{
+				return true;
+			});
+	}
+}
+
+std::size_t recpp::filesystem::CanonicalCache::size() const
+{
+	std::size_t size = 0;
+	for (auto &shard : m_data->shards)
+		size += shard.size();
+	return size;
+}
+
+recpp::filesystem::CanonicalCache::Statistics recpp::filesystem::CanonicalCache::statistics() const
+{
+	return Statistics{m_data->hits, m_data->misses};
+}
@@ -0,0 +1,838 @@
+#include "CompressionEngine.h"
+#include "Crc32.h"
+#include "Deflater.h"
+#include "File.h"
+#include "Inflater.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef RECPP_FILESYSTEM_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	// The largest distance a deflate match can refer back to, which is how much of the previous chunk is kept as the dictionary of the next one
+	constexpr std::size_t  historySize = 32768;
+	constexpr int		   defaultGzipLevel = 6;
+	constexpr std::uint8_t gzipMagic[] = {0x1F, 0x8B};
+	constexpr std::uint8_t zstdMagic[] = {0x28, 0xB5, 0x2F, 0xFD};
+	constexpr std::uint8_t deflateMethod = 8;
+	// The flags of a gzip header
+	constexpr std::uint8_t headerCrcFlag = 0x02;
+	constexpr std::uint8_t extraFlag = 0x04;
+	constexpr std::uint8_t nameFlag = 0x08;
+	constexpr std::uint8_t commentFlag = 0x10;
+	constexpr std::uint8_t reservedFlags = 0xE0;
+
+	[[noreturn]] void malformed(const std::filesystem::path &path)
+	{
+		throw std::filesystem::filesystem_error("decompress", path, std::make_error_code(std::errc::bad_message));
+	}
+
+#ifndef RECPP_FILESYSTEM_ZSTD
+	[[noreturn]] void unsupported(const char *operation, const std::filesystem::path &path)
+	{
+		throw std::filesystem::filesystem_error(operation, path, std::make_error_code(std::errc::not_supported));
+	}
+#endif
+
+	std::uint32_t readLittleEndian(const std::uint8_t *data)
+	{
+		return static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8 | static_cast<std::uint32_t>(data[2]) << 16 |
+			   static_cast<std::uint32_t>(data[3]) << 24;
+	}
+
+	void writeLittleEndian(std::uint32_t value, std::uint8_t *data)
+	{
+		for (auto i = 0; i < 4; i++, value >>= 8)
+			data[i] = static_cast<std::uint8_t>(value);
+	}
+
+	// A buffer handed from one stage of a pipeline to the next, allocated on its first use and reused afterwards
+	struct Chunk
+	{
+		std::unique_ptr<std::uint8_t[]> data;
+		std::size_t						capacity = 0;
+		/// The number of bytes before the contents of the chunk, the end of the previous chunk being copied there as a dictionary when compressing gzip
+		std::size_t						offset = 0;
+		/// The size of the contents of the chunk
+		std::size_t						size = 0;
+		/// The position of the chunk in the stream, since the chunks compressed in parallel complete out of order
+		std::size_t						index = 0;
+		std::vector<std::uint8_t>		compressed;
+
+		// Make data hold at least bytes bytes and empty the chunk, its previous contents being lost
+		void reserve(std::size_t bytes)
+		{
+			if (capacity < bytes)
+			{
+				data.reset(new std::uint8_t[bytes]);
+				capacity = bytes;
+			}
+			offset = 0;
+			size = 0;
+		}
+	};
+
+	// Thrown in the stages of a pipeline after another stage failed, to stop them without replacing the original error
+	struct Stopped
+	{
+	};
+
+	// Threads connected by queues of chunks. A single mutex guards every queue, since the chunks handed over are large and few, and the first error of a
+	// stage stops the others
+	class Pipeline
+	{
+	public:
+		class Queue
+		{
+		public:
+			explicit Queue(Pipeline &pipeline)
+				: m_pipeline(pipeline)
+			{
+			}
+
+			void push(Chunk chunk)
+			{
+				std::lock_guard lock(m_pipeline.m_mutex);
+				m_chunks.push_back(std::move(chunk));
+				m_pipeline.m_condition.notify_all();
+			}
+
+			// Pop the next chunk, waiting for one, or return false once the queue is closed and empty
+			bool pop(Chunk &chunk)
+			{
+				std::unique_lock lock(m_pipeline.m_mutex);
+				m_pipeline.m_condition.wait(lock,
+											[this]()
+											{
+												return m_pipeline.m_error || !m_chunks.empty() || m_closed;
+											});
+				if (m_pipeline.m_error)
+					throw Stopped();
+				if (m_chunks.empty())
+					return false;
+				chunk = std::move(m_chunks.front());
+				m_chunks.pop_front();
+				return true;
+			}
+
+			void close()
+			{
+				std::lock_guard lock(m_pipeline.m_mutex);
+				m_closed = true;
+				m_pipeline.m_condition.notify_all();
+			}
+
+		private:
+			Pipeline		 &m_pipeline;
+			std::deque<Chunk> m_chunks;
+			bool			  m_closed = false;
+		};
+
+		Pipeline() = default;
+		Pipeline(const Pipeline &) = delete;
+		Pipeline &operator=(const Pipeline &) = delete;
+
+		~Pipeline()
+		{
+			if (m_threads.empty())
+				return;
+			fail(std::make_exception_ptr(Stopped()));
+			for (auto &thread : m_threads)
+				thread.join();
+		}
+
+		template <typename Function>
+		void spawn(Function function)
+		{
+			m_threads.emplace_back(
+				[this, function = std::move(function)]()
+				{
+					run(function);
+				});
+		}
+
+		// Run a stage on the calling thread
+		template <typename Function>
+		void run(const Function &function)
+		{
+			try
+			{
+				function();
+			}
+			catch (const Stopped &)
+			{
+			}
+			catch (...)
+			{
+				fail(std::current_exception());
+			}
+		}
+
+		// Wait for the threads of the stages, and rethrow the first error of the stages if any
+		void join()
+		{
+			for (auto &thread : m_threads)
+				thread.join();
+			m_threads.clear();
+			if (m_error)
+				std::rethrow_exception(m_error);
+		}
+
+	private:
+		void fail(std::exception_ptr error)
+		{
+			std::lock_guard lock(m_mutex);
+			if (!m_error)
+				m_error = std::move(error);
+			m_condition.notify_all();
+		}
+
+		std::mutex				 m_mutex;
+		std::condition_variable	 m_condition;
+		std::exception_ptr		 m_error;
+		std::vector<std::thread> m_threads;
+	};
+
+	// Reads the chunks of a queue as a continuous stream, handing each chunk back to its pool once consumed
+	class ChunkReader
+	{
+	public:
+		ChunkReader(Pipeline::Queue &chunks, Pipeline::Queue &pool)
+			: m_chunks(chunks)
+			, m_pool(pool)
+		{
+		}
+
+		// Make the current chunk have bytes left, returning false at the end of the stream
+		bool next()
+		{
+			while (m_position == m_chunk.size)
+			{
+				if (m_ended)
+					return false;
+				if (m_chunk.data)
+					m_pool.push(std::move(m_chunk));
+				m_chunk = Chunk();
+				m_position = 0;
+				if (!m_chunks.pop(m_chunk))
+				{
+					m_ended = true;
+					return false;
+				}
+			}
+			return true;
+		}
+
+		const std::uint8_t *data() const
+		{
+			return m_chunk.data.get() + m_chunk.offset + m_position;
+		}
+
+		std::size_t available() const
+		{
+			return m_chunk.size - m_position;
+		}
+
+		void consume(std::size_t count)
+		{
+			m_position += count;
+		}
+
+		std::size_t read(std::uint8_t *data, std::size_t size)
+		{
+			if (!next())
+				return 0;
+			const auto count = std::min(size, available());
+			std::memcpy(data, this->data(), count);
+			consume(count);
+			return count;
+		}
+
+	private:
+		Pipeline::Queue &m_chunks;
+		Pipeline::Queue &m_pool;
+		Chunk			 m_chunk;
+		std::size_t		 m_position = 0;
+		bool			 m_ended = false;
+	};
+
+	// Writes a continuous stream into chunks taken from a pool, pushing each one to a queue once full
+	class ChunkWriter
+	{
+	public:
+		ChunkWriter(Pipeline::Queue &chunks, Pipeline::Queue &pool, std::size_t chunkSize)
+			: m_chunks(chunks)
+			, m_pool(pool)
+			, m_chunkSize(chunkSize)
+		{
+		}
+
+		// Get the free space of the current chunk, of available() bytes, waiting for a chunk of the pool if needed
+		std::uint8_t *space()
+		{
+			if (!m_active)
+			{
+				m_pool.pop(m_chunk);
+				m_chunk.reserve(m_chunkSize);
+				m_active = true;
+			}
+			return m_chunk.data.get() + m_chunk.size;
+		}
+
+		std::size_t available() const
+		{
+			return m_chunkSize - m_chunk.size;
+		}
+
+		// Add the next count bytes of the free space to the contents of the current chunk
+		void commit(std::size_t count)
+		{
+			m_chunk.size += count;
+			if (m_chunk.size == m_chunkSize)
+			{
+				m_chunks.push(std::move(m_chunk));
+				m_active = false;
+			}
+		}
+
+		void write(const std::uint8_t *data, std::size_t size)
+		{
+			while (size > 0)
+			{
+				const auto destination = space();
+				const auto count = std::min(size, available());
+				std::memcpy(destination, data, count);
+				commit(count);
+				data += count;
+				size -= count;
+			}
+		}
+
+		// Push the last chunk, and close the queue
+		void close()
+		{
+			if (m_active && m_chunk.size > 0)
+				m_chunks.push(std::move(m_chunk));
+			m_active = false;
+			m_chunks.close();
+		}
+
+	private:
+		Pipeline::Queue	 &m_chunks;
+		Pipeline::Queue	 &m_pool;
+		const std::size_t m_chunkSize;
+		Chunk			  m_chunk;
+		bool			  m_active = false;
+	};
+
+	CompressionFormat detectFormat(const Chunk &chunk)
+	{
+		const auto startsWith = [&chunk](const std::uint8_t *magic, std::size_t size)
+		{
+			return chunk.size >= size && std::equal(magic, magic + size, chunk.data.get());
+		};
+		if (startsWith(gzipMagic, sizeof(gzipMagic)))
+			return CompressionFormat::gzip;
+		if (startsWith(zstdMagic, sizeof(zstdMagic)))
+			return CompressionFormat::zstd;
+		return CompressionFormat::none;
+	}
+
+	CompressionFormat formatOf(const std::filesystem::path &path)
+	{
+		const auto extension = path.extension();
+		if (extension == ".gz" || extension == ".tgz")
+			return CompressionFormat::gzip;
+		if (extension == ".zst")
+			return CompressionFormat::zstd;
+		return CompressionFormat::none;
+	}
+
+	void readExactly(Inflater &inflater, std::uint8_t *data, std::size_t size, const std::filesystem::path &path)
+	{
+		if (inflater.read(data, size) != size)
+			malformed(path);
+	}
+
+	// Skip the zero terminated string of a gzip header
+	void skipString(Inflater &inflater, const std::filesystem::path &path)
+	{
+		std::uint8_t byte = 0;
+		do
+			readExactly(inflater, &byte, 1, path);
+		while (byte != 0);
+	}
+
+	// Decompress every member of a gzip stream, as gzip does with concatenated files, checking the CRC and the size of each one
+	void inflateGzip(const std::filesystem::path &path, ChunkReader &reader, ChunkWriter &writer)
+	{
+		Inflater inflater(
+			[&reader](std::uint8_t *data, std::size_t size)
+			{
+				return reader.read(data, size);
+			});
+		for (auto first = true;; first = false)
+		{
+			std::uint8_t header[10];
+			const auto	 count = inflater.read(header, sizeof(header));
+			if (count == 0 && !first)
+				return;
+			if (count < sizeof(header) || header[0] != gzipMagic[0] || header[1] != gzipMagic[1] || header[2] != deflateMethod || (header[3] & reservedFlags))
+				malformed(path);
+
+			const auto flags = header[3];
+			if (flags & extraFlag)
+			{
+				std::uint8_t size[2];
+				readExactly(inflater, size, sizeof(size), path);
+				std::vector<std::uint8_t> extra(size[0] | size[1] << 8);
+				readExactly(inflater, extra.data(), extra.size(), path);
+			}
+			if (flags & nameFlag)
+				skipString(inflater, path);
+			if (flags & commentFlag)
+				skipString(inflater, path);
+			if (flags & headerCrcFlag)
+			{
+				std::uint8_t crc[2];
+				readExactly(inflater, crc, sizeof(crc), path);
+			}
+
+			Crc32		  crc;
+			std::uint32_t size = 0;
+			inflater.inflate(
+				[&crc, &size, &writer](const std::uint8_t *data, std::size_t length)
+				{
+					crc.update(data, length);
+					size += static_cast<std::uint32_t>(length);
+					writer.write(data, length);
+				});
+			std::uint8_t trailer[8];
+			readExactly(inflater, trailer, sizeof(trailer), path);
+			if (readLittleEndian(trailer) != crc.value() || readLittleEndian(trailer + 4) != size)
+				malformed(path);
+		}
+	}
+
+	// Compress the chunks of pending, in parallel with the other threads running this function, into the deflate stream of a gzip member
+	void deflateChunks(int level, Pipeline::Queue &pending, Pipeline::Queue &compressed)
+	{
+		Deflater deflater(level);
+		Chunk	 chunk;
+		while (pending.pop(chunk))
+		{
+			chunk.compressed.clear();
+			deflater.deflate(chunk.data.get() + chunk.offset, chunk.size, chunk.offset, false, chunk.compressed);
+			compressed.push(std::move(chunk));
+		}
+	}
+
+#ifdef RECPP_FILESYSTEM_ZSTD
+	void decompressZstd(const std::filesystem::path &path, ChunkReader &reader, ChunkWriter &writer)
+	{
+		const std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context(ZSTD_createDCtx(), ZSTD_freeDCtx);
+		if (!context)
+			throw std::bad_alloc();
+
+		// Concatenated frames are decompressed one after the other, the result being 0 only once a frame was decompressed and flushed, which an empty
+		// file is not
+		std::size_t result = 1;
+		while (reader.next())
+		{
+			ZSTD_inBuffer input = {reader.data(), reader.available(), 0};
+			auto		  full = false;
+			do
+			{
+				const auto	   destination = writer.space();
+				const auto	   available = writer.available();
+				ZSTD_outBuffer output = {destination, available, 0};
+				result = ZSTD_decompressStream(context.get(), &output, &input);
+				if (ZSTD_isError(result))
+					malformed(path);
+				writer.commit(output.pos);
+				// A full output may leave decompressed data in the context
+				full = output.pos == available;
+			} while (input.pos < input.size || (full && result != 0));
+			reader.consume(input.pos);
+		}
+		if (result != 0)
+			malformed(path);
+	}
+
+	// Compress the chunks of pending into a zstd frame, libzstd spreading the work over threads workers
+	void compressZstd(const std::filesystem::path &path, int level, unsigned threads, Pipeline::Queue &pool, Pipeline::Queue &pending,
+					  Pipeline::Queue &compressed)
+	{
+		const std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context(ZSTD_createCCtx(), ZSTD_freeCCtx);
+		if (!context)
+			throw std::bad_alloc();
+		ZSTD_CCtx_setParameter(context.get(), ZSTD_c_compressionLevel, level ? level : ZSTD_CLEVEL_DEFAULT);
+		ZSTD_CCtx_setParameter(context.get(), ZSTD_c_checksumFlag, 1);
+		// Builds of libzstd without threads reject this parameter, and compress on this thread instead
+		if (threads > 1)
+			ZSTD_CCtx_setParameter(context.get(), ZSTD_c_nbWorkers, static_cast<int>(threads));
+
+		const auto compress = [&path, &context](Chunk &chunk, ZSTD_EndDirective mode)
+		{
+			ZSTD_inBuffer input = {chunk.data.get() + chunk.offset, chunk.size, 0};
+			chunk.compressed.clear();
+			for (;;)
+			{
+				const auto used = chunk.compressed.size();
+				chunk.compressed.resize(used + ZSTD_CStreamOutSize());
+				ZSTD_outBuffer output = {chunk.compressed.data() + used, ZSTD_CStreamOutSize(), 0};
+				const auto	   left = ZSTD_compressStream2(context.get(), &output, &input, mode);
+				if (ZSTD_isError(left))
+					throw std::filesystem::filesystem_error("compress", path, std::make_error_code(std::errc::io_error));
+				chunk.compressed.resize(used + output.pos);
+				if (mode == ZSTD_e_end ? left == 0 : input.pos == input.size)
+					return;
+			}
+		};
+
+		Chunk		chunk;
+		std::size_t index = 0;
+		while (pending.pop(chunk))
+		{
+			compress(chunk, ZSTD_e_continue);
+			index = chunk.index + 1;
+			compressed.push(std::move(chunk));
+		}
+		// The end of the frame goes in a chunk of its own, since the last chunk is only known once the data ended
+		pool.pop(chunk);
+		chunk.reserve(0);
+		chunk.index = index;
+		compress(chunk, ZSTD_e_end);
+		compressed.push(std::move(chunk));
+	}
+#endif
+
+	using Read = std::function<std::size_t(void *data, std::size_t size)>;
+	using Write = std::function<void(const void *data, std::size_t size)>;
+
+	// Decompress the file path, whose contents are read by input, like readDecompressed
+	void decompress(const std::filesystem::path &path, const Read &input, const std::function<void(std::string_view chunk)> &onChunk,
+					const CompressionOptions &options)
+	{
+		const auto chunkSize = std::max<std::size_t>(options.chunkSize, 1);
+		const auto depth = std::max<std::size_t>(options.queueDepth, 1);
+
+		// The first chunk is read before starting the pipeline, to detect the format, and holds at least the longest magic number
+		const auto firstSize = std::max(chunkSize, sizeof(zstdMagic));
+		Chunk	   first;
+		first.reserve(firstSize);
+		first.size = input(first.data.get(), firstSize);
+		const auto format = options.format == CompressionFormat::automatic ? detectFormat(first) : options.format;
+#ifndef RECPP_FILESYSTEM_ZSTD
+		if (format == CompressionFormat::zstd)
+			unsupported("decompress", path);
+#endif
+
+		Pipeline		pipeline;
+		Pipeline::Queue readPool(pipeline);
+		Pipeline::Queue read(pipeline);
+		Pipeline::Queue decodedPool(pipeline);
+		Pipeline::Queue decoded(pipeline);
+		for (std::size_t i = 0; i < depth; i++)
+		{
+			readPool.push(Chunk());
+			decodedPool.push(Chunk());
+		}
+
+		// Files that are not compressed are delivered as they are read
+		const auto raw = format == CompressionFormat::none;
+		auto	  &readChunks = raw ? decoded : read;
+		auto	  &readChunksPool = raw ? decodedPool : readPool;
+		const auto ended = first.size == 0;
+		if (ended)
+			readChunks.close();
+		else
+			readChunks.push(std::move(first));
+
+		if (!ended)
+		{
+			pipeline.spawn(
+				[&input, &options, &readChunks, &readChunksPool, chunkSize]()
+				{
+					Chunk chunk;
+					for (;;)
+					{
+						if (options.token)
+							options.token->throwIfCancelled();
+						readChunksPool.pop(chunk);
+						chunk.reserve(chunkSize);
+						chunk.size = input(chunk.data.get(), chunkSize);
+						if (chunk.size == 0)
+							break;
+						readChunks.push(std::move(chunk));
+					}
+					readChunks.close();
+				});
+		}
+		if (!raw)
+		{
+			pipeline.spawn(
+				[&path, &read, &readPool, &decoded, &decodedPool, format, chunkSize]()
+				{
+					ChunkReader reader(read, readPool);
+					ChunkWriter writer(decoded, decodedPool, chunkSize);
+					try
+					{
+#ifdef RECPP_FILESYSTEM_ZSTD
+						if (format == CompressionFormat::zstd)
+							decompressZstd(path, reader, writer);
+						else
+#endif
+							inflateGzip(path, reader, writer);
+					}
+					catch (const std::filesystem::filesystem_error &)
+					{
+						throw;
+					}
+					catch (const std::system_error &exception)
+					{
+						// The errors of the inflater do not know the file
+						throw std::filesystem::filesystem_error("decompress", path, exception.code());
+					}
+					writer.close();
+				});
+		}
+
+		pipeline.run(
+			[&onChunk, &options, &decoded, &decodedPool]()
+			{
+				Chunk chunk;
+				while (decoded.pop(chunk))
+				{
+					if (options.token)
+						options.token->throwIfCancelled();
+					onChunk(std::string_view(reinterpret_cast<const char *>(chunk.data.get() + chunk.offset), chunk.size));
+					decodedPool.push(std::move(chunk));
+				}
+			});
+		pipeline.join();
+	}
+
+	// Get the format of the file path written with options, throwing if it is not supported
+	CompressionFormat writtenFormat(const std::filesystem::path &path, const CompressionOptions &options)
+	{
+		const auto format = options.format == CompressionFormat::automatic ? formatOf(path) : options.format;
+#ifndef RECPP_FILESYSTEM_ZSTD
+		if (format == CompressionFormat::zstd)
+			unsupported("compress", path);
+#endif
+		return format;
+	}
+
+	// Compress the data filled by source in format, like writeCompressed, passing the compressed stream to write in order
+	void compress(const std::filesystem::path &path, CompressionFormat format, const Write &write,
+				  const std::function<std::size_t(char *data, std::size_t size)> &source, const CompressionOptions &options)
+	{
+		const auto chunkSize = std::max<std::size_t>(options.chunkSize, 1);
+		const auto depth = std::max<std::size_t>(options.queueDepth, 1);
+		const auto threads = threadCount(options.threads);
+		// zstd compresses on a single thread of ours, its own workers doing the work
+		const auto workers = format == CompressionFormat::gzip ? threads : format == CompressionFormat::zstd ? 1U : 0U;
+		const auto level = format == CompressionFormat::gzip && options.level == 0 ? defaultGzipLevel : options.level;
+
+		Pipeline		pipeline;
+		Pipeline::Queue pool(pipeline);
+		Pipeline::Queue pending(pipeline);
+		Pipeline::Queue compressed(pipeline);
+		for (std::size_t i = 0; i < depth + workers; i++)
+			pool.push(Chunk());
+
+		// The checksum and the size of the data are written by the calling thread before it closes its queue, and only read once the last chunk is written
+		Crc32				  crc;
+		std::uint32_t		  size = 0;
+		std::atomic<unsigned> running = workers;
+		for (unsigned i = 0; i < workers; i++)
+		{
+			pipeline.spawn(
+				[&path, &pool, &pending, &compressed, &running, format, level, threads]()
+				{
+#ifdef RECPP_FILESYSTEM_ZSTD
+					if (format == CompressionFormat::zstd)
+						compressZstd(path, level, threads, pool, pending, compressed);
+					else
+#endif
+						deflateChunks(level, pending, compressed);
+					if (--running == 0)
+						compressed.close();
+				});
+		}
+
+		// The writer appends the chunks in order, keeping those compressed ahead of the next one until it is
+		pipeline.spawn(
+			[&write, &pool, &compressed, &crc, &size, format, level]()
+			{
+				if (format == CompressionFormat::gzip)
+				{
+					// No name nor modification time is stored, so that compressing the same data always gives the same file
+					const std::uint8_t header[] = {
+						gzipMagic[0], gzipMagic[1], deflateMethod, 0, 0, 0, 0, 0, static_cast<std::uint8_t>(level >= 9 ? 2 : level <= 1 ? 4 : 0), 0xFF};
+					write(header, sizeof(header));
+				}
+
+				std::map<std::size_t, Chunk> ahead;
+				std::size_t					 next = 0;
+				Chunk						 chunk;
+				while (compressed.pop(chunk))
+				{
+					const auto index = chunk.index;
+					ahead.emplace(index, std::move(chunk));
+					for (auto found = ahead.find(next); found != ahead.end(); found = ahead.find(++next))
+					{
+						auto &ready = found->second;
+						if (format == CompressionFormat::none)
+							write(ready.data.get() + ready.offset, ready.size);
+						else
+							write(ready.compressed.data(), ready.compressed.size());
+						pool.push(std::move(ready));
+						ahead.erase(found);
+					}
+				}
+
+				if (format == CompressionFormat::gzip)
+				{
+					// An empty final block with the fixed codes ends the deflate stream, whose chunks all ended with a sync flush
+					std::uint8_t trailer[] = {0x03, 0x00, 0, 0, 0, 0, 0, 0, 0, 0};
+					writeLittleEndian(crc.value(), trailer + 2);
+					writeLittleEndian(size, trailer + 6);
+					write(trailer, sizeof(trailer));
+				}
+			});
+
+		pipeline.run(
+			[&source, &options, &pool, &pending, &compressed, &crc, &size, format, workers, chunkSize]()
+			{
+				auto					 &next = workers ? pending : compressed;
+				std::vector<std::uint8_t> history;
+				Chunk					  chunk;
+				for (std::size_t index = 0;; index++)
+				{
+					if (options.token)
+						options.token->throwIfCancelled();
+					pool.pop(chunk);
+					chunk.reserve(history.size() + chunkSize);
+					// The end of the previous chunk precedes the data, as the dictionary of its compression
+					std::copy(history.begin(), history.end(), chunk.data.get());
+					chunk.offset = history.size();
+					chunk.index = index;
+					auto ended = false;
+					while (!ended && chunk.size < chunkSize)
+					{
+						const auto count = source(reinterpret_cast<char *>(chunk.data.get() + chunk.offset + chunk.size), chunkSize - chunk.size);
+						chunk.size += count;
+						ended = count == 0;
+					}
+					if (chunk.size == 0)
+						break;
+
+					if (format == CompressionFormat::gzip)
+					{
+						crc.update(chunk.data.get() + chunk.offset, chunk.size);
+						size += static_cast<std::uint32_t>(chunk.size);
+						const auto kept = std::min(historySize, chunk.offset + chunk.size);
+						history.assign(chunk.data.get() + chunk.offset + chunk.size - kept, chunk.data.get() + chunk.offset + chunk.size);
+					}
+					next.push(std::move(chunk));
+					if (ended)
+						break;
+				}
+				next.close();
+			});
+		pipeline.join();
+	}
+} // namespace
+
+void recpp::filesystem::detail::readDecompressed(const std::filesystem::path &path, const std::function<void(std::string_view chunk)> &onChunk,
+												 const CompressionOptions &options)
+{
+	File file(path, false);
+	decompress(
+		path,
+		[&file](void *data, std::size_t size)
+		{
+			return file.read(data, size);
+		},
+		onChunk, options);
+}
+
+void recpp::filesystem::detail::readDecompressed(const FileSystemBackend &backend, const std::filesystem::path &path,
+												 const std::function<void(std::string_view chunk)> &onChunk, const CompressionOptions &options)
+{
+	std::uintmax_t offset = 0;
+	decompress(
+		path,
+		[&backend, &path, &offset](void *data, std::size_t size)
+		{
+			const auto count = backend.readFile(path, offset, static_cast<char *>(data), size);
+			offset += count;
+			return count;
+		},
+		onChunk, options);
+}
+
+void recpp::filesystem::detail::writeCompressed(const std::filesystem::path &path, const std::function<std::size_t(char *data, std::size_t size)> &source,
+												const CompressionOptions &options)
+{
+	const auto			format = writtenFormat(path, options);
+	std::optional<File> file;
+	file.emplace(path, true);
+	try
+	{
+		compress(
+			path, format,
+			[&file](const void *data, std::size_t size)
+			{
+				file->write(data, size);
+			},
+			source, options);
+		file->close();
+	}
+	catch (...)
+	{
+		// A partial file is worse than none
+		file.reset();
+		std::error_code error;
+		std::filesystem::remove(path, error);
+		throw;
+	}
+}
+
+void recpp::filesystem::detail::writeCompressed(FileSystemBackend &backend, const std::filesystem::path &path,
+												const std::function<std::size_t(char *data, std::size_t size)> &source, const CompressionOptions &options)
+{
+	// The file is only written once compressed, so that no partial file is ever left
+	std::string contents;
+	compress(
+		path, writtenFormat(path, options),
+		[&contents](const void *data, std::size_t size)
+		{
+			contents.append(static_cast<const char *>(data), size);
+		},
+		source, options);
+	backend.writeFile(path, contents);
+}
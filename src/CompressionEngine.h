@@ -0,0 +1,48 @@
+#pragma once
+
+#include <recpp/filesystem/Compression.h>
+#include <recpp/filesystem/FileSystemBackend.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <string_view>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Read the file @p path, decompressing it, and call @p onChunk with each chunk of its decompressed contents, in order.
+	 * <p>
+	 * Reading the file, decompressing it and delivering the chunks run on three threads, connected by queues of CompressionOptions::queueDepth buffers that
+	 * are reused once the next stage is done with them, so that the disk, the decompression and the consumer work at the same time. @p onChunk is called
+	 * from the calling thread, the chunk being only valid until it returns.
+	 */
+	void readDecompressed(const std::filesystem::path &path, const std::function<void(std::string_view chunk)> &onChunk, const CompressionOptions &options);
+
+	/**
+	 * @brief Read the file @p path of @p backend, decompressing it, like readDecompressed.
+	 * <p>
+	 * The file is read by chunks with FileSystemBackend::readFile, through the same pipeline as on the filesystem of the operating system.
+	 */
+	void readDecompressed(const FileSystemBackend &backend, const std::filesystem::path &path, const std::function<void(std::string_view chunk)> &onChunk,
+						  const CompressionOptions &options);
+
+	/**
+	 * @brief Write the file @p path, compressing the data filled by @p source.
+	 * <p>
+	 * @p source is called from the calling thread with buffers of CompressionOptions::chunkSize bytes to fill, and returns how many bytes it filled, 0 at
+	 * the end of the data. gzip chunks are compressed by CompressionOptions::threads threads at once, each chunk using the end of the previous one as a
+	 * dictionary, and zstd chunks by a single thread running the workers of libzstd. A writer thread appends the compressed chunks to the file in order.
+	 * The file is removed if writing fails.
+	 */
+	void writeCompressed(const std::filesystem::path &path, const std::function<std::size_t(char *data, std::size_t size)> &source,
+						 const CompressionOptions &options);
+
+	/**
+	 * @brief Write the file @p path of @p backend, compressing the data filled by @p source, like writeCompressed.
+	 * <p>
+	 * The compressed data is kept in memory and written whole with FileSystemBackend::writeFile, so that no partial file is left if compressing fails.
+	 */
+	void writeCompressed(FileSystemBackend &backend, const std::filesystem::path &path, const std::function<std::size_t(char *data, std::size_t size)> &source,
+						 const CompressionOptions &options);
+} // namespace recpp::filesystem::detail
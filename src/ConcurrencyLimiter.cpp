@@ -0,0 +1,140 @@
+#include "recpp/filesystem/ConcurrencyLimiter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace
+{
+	// Weight of each sample in the long term latency of the gradient algorithm, which roughly averages the last 600 samples like Gradient2
+	constexpr double longLatencyWeight = 1.0 / 600;
+} // namespace
+
+recpp::filesystem::ConcurrencyLimitError::ConcurrencyLimitError(const std::filesystem::path &mountPoint, std::size_t limit)
+	: std::system_error(std::make_error_code(std::errc::resource_unavailable_try_again),
+						"concurrency limit of " + std::to_string(limit) + " in-flight operations reached for " + mountPoint.string())
+	, m_mountPoint(mountPoint)
+	, m_limit(limit)
+{
+}
+
+const std::filesystem::path &recpp::filesystem::ConcurrencyLimitError::mountPoint() const
+{
+	return m_mountPoint;
+}
+
+std::size_t recpp::filesystem::ConcurrencyLimitError::limit() const
+{
+	return m_limit;
+}
+
+recpp::filesystem::ConcurrencyLimiter::Permit::Permit(ConcurrencyLimiter &limiter, std::size_t inFlight)
+	: m_limiter(&limiter)
+	, m_start(Clock::now())
+	, m_inFlight(inFlight)
+{
+}
+
+recpp::filesystem::ConcurrencyLimiter::Permit::Permit(Permit &&other) noexcept
+	: m_limiter(other.m_limiter)
+	, m_start(other.m_start)
+	, m_inFlight(other.m_inFlight)
+{
+	other.m_limiter = nullptr;
+}
+
+recpp::filesystem::ConcurrencyLimiter::Permit::~Permit()
+{
+	release();
+}
+
+recpp::filesystem::ConcurrencyLimiter::Permit &recpp::filesystem::ConcurrencyLimiter::Permit::operator=(Permit &&other) noexcept
+{
+	if (this != &other)
+	{
+		release();
+		m_limiter = other.m_limiter;
+		m_start = other.m_start;
+		m_inFlight = other.m_inFlight;
+		other.m_limiter = nullptr;
+	}
+	return *this;
+}
+
+void recpp::filesystem::ConcurrencyLimiter::Permit::release(bool dropped)
+{
+	if (!m_limiter)
+		return;
+	m_limiter->release(Clock::now() - m_start, m_inFlight, dropped);
+	m_limiter = nullptr;
+}
+
+recpp::filesystem::ConcurrencyLimiter::ConcurrencyLimiter()
+	: ConcurrencyLimiter(Settings())
+{
+}
+
+recpp::filesystem::ConcurrencyLimiter::ConcurrencyLimiter(const Settings &settings)
+	: m_settings(settings)
+	, m_limit(static_cast<double>(std::clamp(settings.initialLimit, settings.minLimit, settings.maxLimit)))
+{
+}
+
+std::optional<recpp::filesystem::ConcurrencyLimiter::Permit> recpp::filesystem::ConcurrencyLimiter::tryAcquire()
+{
+	std::lock_guard lock(m_mutex);
+	if (static_cast<double>(m_inFlight) >= std::floor(m_limit))
+		return std::nullopt;
+	return Permit(*this, ++m_inFlight);
+}
+
+std::size_t recpp::filesystem::ConcurrencyLimiter::limit() const
+{
+	std::lock_guard lock(m_mutex);
+	return static_cast<std::size_t>(m_limit);
+}
+
+std::size_t recpp::filesystem::ConcurrencyLimiter::inFlight() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_inFlight;
+}
+
+void recpp::filesystem::ConcurrencyLimiter::release(Clock::duration latency, std::size_t inFlight, bool dropped)
+{
+	std::lock_guard lock(m_mutex);
+	m_inFlight--;
+
+	const auto sample = std::max(std::chrono::duration<double>(latency).count(), 1e-9);
+	// Operations that did not use at least half of the limit say nothing about whether it could grow
+	const auto applicationLimited = static_cast<double>(inFlight) * 2 < m_limit;
+	auto	   limit = m_limit;
+
+	if (m_settings.algorithm == Algorithm::aimd)
+	{
+		if (dropped || latency > m_settings.latencyThreshold)
+			limit *= m_settings.backoffRatio;
+		else if (!applicationLimited)
+			limit += 1;
+	}
+	else
+	{
+		if (m_longLatency == 0)
+			m_longLatency = sample;
+		else
+			m_longLatency += (sample - m_longLatency) * longLatencyWeight;
+
+		// Let the long term latency recover quickly once the mount is healthy again, instead of keeping the limit low for hundreds of samples
+		if (m_longLatency > 2 * sample)
+			m_longLatency *= 0.95;
+
+		const auto gradient = dropped ? 0.5 : std::clamp(m_settings.tolerance * m_longLatency / sample, 0.5, 1.0);
+		if (gradient < 1.0 || !applicationLimited)
+		{
+			const auto estimate = limit * gradient + std::sqrt(limit);
+			limit += (estimate - limit) * m_settings.smoothing;
+		}
+	}
+
+	m_limit = std::clamp(limit, static_cast<double>(m_settings.minLimit), static_cast<double>(m_settings.maxLimit));
+}
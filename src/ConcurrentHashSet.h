@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief A hash set that several threads can insert into at once, split into shards each guarded by its own mutex so that threads inserting different
+	 * keys rarely wait for each other.
+	 */
+	template <typename Key, typename Hash = std::hash<Key>, std::size_t ShardCount = 64>
+	class ConcurrentHashSet
+	{
+	public:
+		/**
+		 * @brief Insert @p key into the set.
+		 *
+		 * @return true if @p key was not already in the set
+		 */
+		bool insert(const Key &key)
+		{
+			// The low bits of the hash select the bucket inside the shard, the shard is selected by the high bits so that both stay well distributed
+			auto &shard = m_shards[(Hash()(key) >> (sizeof(std::size_t) * 4)) % ShardCount];
+
+			std::lock_guard lock(shard.mutex);
+			return shard.keys.insert(key).second;
+		}
+
+	private:
+		struct Shard
+		{
+			std::mutex					  mutex;
+			std::unordered_set<Key, Hash> keys;
+		};
+
+		std::array<Shard, ShardCount> m_shards;
+	};
+} // namespace recpp::filesystem::detail
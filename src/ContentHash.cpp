@@ -0,0 +1,260 @@
+#include "ContentHash.h"
+#include "File.h"
+#include "Parallel.h"
+#include "SparseFile.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	// Alignment of the read buffers, matching the page size so that the kernel can copy whole pages
+	constexpr std::size_t alignment = 4096;
+	// Size of the blocks read from each file of a tree, smaller than for a single file since several files are hashed at once
+	constexpr std::size_t treeBlockSize = 1 << 20;
+
+	class Buffer
+	{
+	public:
+		explicit Buffer(std::size_t size)
+			: m_storage(new std::uint8_t[size + alignment])
+		{
+			const auto address = reinterpret_cast<std::uintptr_t>(m_storage.get());
+			m_data = m_storage.get() + (alignment - address % alignment) % alignment;
+		}
+
+		std::uint8_t *data() const
+		{
+			return m_data;
+		}
+
+	private:
+		std::unique_ptr<std::uint8_t[]> m_storage;
+		std::uint8_t				   *m_data;
+	};
+
+	struct Node
+	{
+		std::filesystem::path	   path;
+		std::string				   name;
+		std::filesystem::file_type type;
+		Digest					   digest;
+		std::vector<std::size_t>   children;
+	};
+
+	char typeTag(std::filesystem::file_type type)
+	{
+		switch (type)
+		{
+		case std::filesystem::file_type::regular:
+			return 'f';
+		case std::filesystem::file_type::directory:
+			return 'd';
+		case std::filesystem::file_type::symlink:
+			return 'l';
+		default:
+			return 'o';
+		}
+	}
+
+	// Add the node of path and those under it, read from backend, or from the filesystem of the operating system if it is nullptr
+	std::size_t addNode(std::vector<Node> &nodes, std::vector<std::size_t> &files, const FileSystemBackend *backend, const std::filesystem::path &path,
+						std::string name, HashAlgorithm algorithm)
+	{
+		const auto index = nodes.size();
+		const auto type = backend ? backend->symlinkStatus(path).type() : std::filesystem::symlink_status(path).type();
+		nodes.push_back(Node{path, std::move(name), type, {}, {}});
+
+		if (type == std::filesystem::file_type::regular)
+			files.push_back(index);
+		else if (type == std::filesystem::file_type::symlink)
+		{
+			const auto target = (backend ? backend->readSymlink(path) : std::filesystem::read_symlink(path)).generic_u8string();
+			Hasher	   hasher(algorithm);
+			hasher.update(target.data(), target.size());
+			nodes[index].digest = hasher.digest();
+		}
+		else if (type == std::filesystem::file_type::directory)
+		{
+			std::vector<std::pair<std::string, std::filesystem::path>> entries;
+			if (backend)
+			{
+				for (auto &entry : backend->directoryEntries(path))
+					entries.emplace_back(entry.filename().u8string(), std::move(entry));
+			}
+			else
+			{
+				for (const auto &entry : std::filesystem::directory_iterator(path))
+					entries.emplace_back(entry.path().filename().u8string(), entry.path());
+			}
+			std::sort(entries.begin(), entries.end());
+			for (auto &entry : entries)
+			{
+				const auto child = addNode(nodes, files, backend, entry.second, std::move(entry.first), algorithm);
+				nodes[index].children.push_back(child);
+			}
+		}
+		return index;
+	}
+
+	// Hash the file whose data is only in segments, the holes between them being hashed as the zeros they read as without reading them
+	void hashSegments(File &file, Hasher &hasher, const std::vector<DataSegment> &segments, std::uintmax_t size, std::size_t blockSize)
+	{
+		const std::vector<std::uint8_t> zeros(blockSize);
+		Buffer							buffer(blockSize);
+		std::uintmax_t					position = 0;
+		const auto						hashZeros = [&hasher, &zeros, &position, blockSize](std::uintmax_t end)
+		{
+			for (; position < end; position += std::min<std::uintmax_t>(blockSize, end - position))
+				hasher.update(zeros.data(), static_cast<std::size_t>(std::min<std::uintmax_t>(blockSize, end - position)));
+		};
+
+		for (const auto &segment : segments)
+		{
+			hashZeros(segment.offset);
+			file.seek(segment.offset);
+			const auto end = segment.offset + segment.length;
+			while (position < end)
+			{
+				const auto count = file.read(buffer.data(), static_cast<std::size_t>(std::min<std::uintmax_t>(blockSize, end - position)));
+				// A file truncated since its size was taken reads short, the rest of its size being hashed as zeros like its holes
+				if (count == 0)
+					break;
+				hasher.update(buffer.data(), count);
+				position += count;
+			}
+		}
+		hashZeros(size);
+	}
+
+	void appendEntry(Hasher &hasher, const Node &node)
+	{
+		std::uint8_t header[9];
+		header[0] = static_cast<std::uint8_t>(typeTag(node.type));
+		for (std::size_t i = 0; i < 8; i++)
+			header[1 + i] = static_cast<std::uint8_t>(static_cast<std::uint64_t>(node.name.size()) >> (8 * i));
+		const auto digestSize = static_cast<std::uint8_t>(node.digest.size());
+
+		hasher.update(header, sizeof(header));
+		hasher.update(node.name.data(), node.name.size());
+		hasher.update(&digestSize, sizeof(digestSize));
+		hasher.update(node.digest.data(), node.digest.size());
+	}
+
+	// Compute the Merkle digest of the tree rooted at root like hashTree, read from backend, or from the filesystem of the operating system if it is nullptr
+	Digest hashTreeWith(const FileSystemBackend *backend, const std::filesystem::path &root, HashAlgorithm algorithm)
+	{
+		std::vector<Node>		 nodes;
+		std::vector<std::size_t> files;
+		// The name of the root is not part of the digest, so that copies of a tree have the same digest wherever they are
+		addNode(nodes, files, backend, root, {}, algorithm);
+		parallelFor(files.size(),
+					[&nodes, &files, backend, algorithm](std::size_t i)
+					{
+						auto &node = nodes[files[i]];
+						node.digest = backend ? hashFile(*backend, node.path, algorithm) : hashFile(node.path, algorithm, treeBlockSize);
+					});
+
+		// Children are always added after their parent, so walking the nodes backwards computes the digests of the children first
+		for (auto index = nodes.size(); index-- > 0;)
+		{
+			auto &node = nodes[index];
+			if (node.type != std::filesystem::file_type::directory)
+				continue;
+
+			Hasher hasher(algorithm);
+			for (const auto child : node.children)
+				appendEntry(hasher, nodes[child]);
+			node.digest = hasher.digest();
+		}
+		return nodes.front().digest;
+	}
+} // namespace
+
+Digest recpp::filesystem::detail::hashFile(const std::filesystem::path &path, HashAlgorithm algorithm, std::size_t blockSize)
+{
+	File	   file(path);
+	Hasher	   hasher(algorithm);
+	const auto info = file.info();
+	file.adviseSequential();
+
+	// Size the buffers after the file so that small files do not allocate large buffers, the extra byte letting the first read reach the end of file
+	blockSize = static_cast<std::size_t>(std::min<std::uintmax_t>(blockSize, (info.size / alignment + 1) * alignment));
+	// Fewer blocks allocated to the file than its size needs means that it has holes, or is compressed by its filesystem
+	if (info.allocatedSize < info.size)
+	{
+		hashSegments(file, hasher, dataSegments(path), info.size, blockSize);
+		return hasher.digest();
+	}
+	Buffer current(blockSize);
+	auto   size = file.read(current.data(), blockSize);
+	if (size == blockSize)
+	{
+		// Read the next block in the background while hashing the current one, so that the disk and the processor work at the same time
+		Buffer next(blockSize);
+		while (size == blockSize)
+		{
+			BackgroundCall<std::size_t> reading(
+				[&file, &next, blockSize]()
+				{
+					return file.read(next.data(), blockSize);
+				});
+			hasher.update(current.data(), size);
+			size = reading.get();
+			std::swap(current, next);
+		}
+	}
+	hasher.update(current.data(), size);
+	return hasher.digest();
+}
+
+Digest recpp::filesystem::detail::hashFile(const FileSystemBackend &backend, const std::filesystem::path &path, HashAlgorithm algorithm)
+{
+	Hasher			  hasher(algorithm);
+	std::vector<char> buffer(treeBlockSize);
+	std::uintmax_t	  offset = 0;
+	for (;;)
+	{
+		const auto count = backend.readFile(path, offset, buffer.data(), buffer.size());
+		hasher.update(buffer.data(), count);
+		offset += count;
+		if (count < buffer.size())
+			break;
+	}
+	return hasher.digest();
+}
+
+Digest recpp::filesystem::detail::hashSample(const std::filesystem::path &path, std::size_t sampleSize)
+{
+	File	   file(path);
+	const auto size = file.size();
+	Buffer	   buffer(2 * sampleSize);
+
+	auto read = file.read(buffer.data(), static_cast<std::size_t>(std::min<std::uintmax_t>(size, sampleSize)));
+	if (size > sampleSize)
+	{
+		// The head and the tail overlap for files smaller than two samples, in which case the whole file is read once
+		file.seek(std::max<std::uintmax_t>(sampleSize, size - sampleSize));
+		read += file.read(buffer.data() + read, sampleSize);
+	}
+
+	Hasher hasher(HashAlgorithm::xxh3);
+	hasher.update(buffer.data(), read);
+	return hasher.digest();
+}
+
+Digest recpp::filesystem::detail::hashTree(const std::filesystem::path &root, HashAlgorithm algorithm)
+{
+	return hashTreeWith(nullptr, root, algorithm);
+}
+
+Digest recpp::filesystem::detail::hashTree(const FileSystemBackend &backend, const std::filesystem::path &root, HashAlgorithm algorithm)
+{
+	return hashTreeWith(&backend, root, algorithm);
+}
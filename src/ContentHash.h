@@ -0,0 +1,39 @@
+#pragma once
+
+#include <recpp/filesystem/FileSystemBackend.h>
+#include <recpp/filesystem/Hash.h>
+
+#include <cstddef>
+#include <filesystem>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Hash the contents of the file at @p path, following symlinks. The next block of the file is read while the current one is hashed.
+	 */
+	Digest hashFile(const std::filesystem::path &path, HashAlgorithm algorithm, std::size_t blockSize = 8 << 20);
+
+	/**
+	 * @brief Hash the contents of the file at @p path of @p backend, following symlinks, which is read by blocks with FileSystemBackend::readFile.
+	 */
+	Digest hashFile(const FileSystemBackend &backend, const std::filesystem::path &path, HashAlgorithm algorithm);
+
+	/**
+	 * @brief Hash the first and the last @p sampleSize bytes of the file at @p path with XXH3, which is enough to tell most files of the same size apart
+	 * without reading them entirely.
+	 */
+	Digest hashSample(const std::filesystem::path &path, std::size_t sampleSize);
+
+	/**
+	 * @brief Compute the Merkle digest of the tree rooted at @p root, without following symlinks. Regular files are hashed on several threads.
+	 * <p>
+	 * The digest of a regular file is the digest of its contents, the digest of a symlink is the digest of its target, and the digest of a directory is
+	 * the digest of the type, name and digest of each of its entries sorted by name. Other files only contribute their type and name.
+	 */
+	Digest hashTree(const std::filesystem::path &root, HashAlgorithm algorithm);
+
+	/**
+	 * @brief Same as hashTree(root, algorithm) on the tree of @p backend, which gives the same digest to the same tree.
+	 */
+	Digest hashTree(const FileSystemBackend &backend, const std::filesystem::path &root, HashAlgorithm algorithm);
+} // namespace recpp::filesystem::detail
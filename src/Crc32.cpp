@@ -0,0 +1,55 @@
+#include "Crc32.h"
+
+#include <array>
+
+namespace
+{
+	using Tables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+	// The table of the k-th slice holds the CRC of each byte followed by k zero bytes
+	Tables makeTables()
+	{
+		Tables tables;
+		for (std::uint32_t byte = 0; byte < 256; byte++)
+		{
+			auto crc = byte;
+			for (auto bit = 0; bit < 8; bit++)
+				crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1)));
+			tables[0][byte] = crc;
+		}
+		for (std::size_t slice = 1; slice < tables.size(); slice++)
+		{
+			for (std::size_t byte = 0; byte < 256; byte++)
+				tables[slice][byte] = (tables[slice - 1][byte] >> 8) ^ tables[0][tables[slice - 1][byte] & 0xFF];
+		}
+		return tables;
+	}
+
+	const Tables tables = makeTables();
+
+	inline std::uint32_t read32(const std::uint8_t *data)
+	{
+		return static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8 | static_cast<std::uint32_t>(data[2]) << 16 |
+			   static_cast<std::uint32_t>(data[3]) << 24;
+	}
+} // namespace
+
+void recpp::filesystem::detail::Crc32::update(const std::uint8_t *data, std::size_t size)
+{
+	auto crc = m_crc;
+	for (; size >= 8; data += 8, size -= 8)
+	{
+		const auto low = crc ^ read32(data);
+		const auto high = read32(data + 4);
+		crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24] ^ tables[3][high & 0xFF] ^
+			  tables[2][(high >> 8) & 0xFF] ^ tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
+	}
+	for (; size > 0; data++, size--)
+		crc = (crc >> 8) ^ tables[0][(crc ^ *data) & 0xFF];
+	m_crc = crc;
+}
+
+std::uint32_t recpp::filesystem::detail::Crc32::value() const
+{
+	return ~m_crc;
+}
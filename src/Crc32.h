@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Streaming implementation of the CRC-32 of ISO 3309, used by zip and gzip, producing the same values as crc32() from zlib.
+	 * <p>
+	 * Eight bytes are folded at a time with slicing-by-8 tables.
+	 */
+	class Crc32
+	{
+	public:
+		/**
+		 * @brief Append @p size bytes from @p data to the checksummed input.
+		 */
+		void update(const std::uint8_t *data, std::size_t size);
+
+		/**
+		 * @brief Get the CRC of the input appended so far. More input can still be appended afterwards.
+		 */
+		std::uint32_t value() const;
+
+	private:
+		std::uint32_t m_crc = 0xFFFFFFFFU;
+	};
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,592 @@
+#include "Deflater.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#ifdef RECPP_FILESYSTEM_ZLIB
+#include <limits>
+#include <new>
+
+#include <zlib.h>
+
+namespace
+{
+	// The largest distance a match can refer back to
+	constexpr std::size_t historySize = 32768;
+	// The memory level zlib uses by default
+	constexpr int		  memoryLevel = 8;
+} // namespace
+
+recpp::filesystem::detail::Deflater::Deflater(int level)
+	: m_stream(std::make_unique<z_stream>())
+{
+	// Negative window bits select raw deflate streams, without the header and the trailer of the zlib format
+	if (deflateInit2(m_stream.get(), std::clamp(level, 1, 9), Z_DEFLATED, -MAX_WBITS, memoryLevel, Z_DEFAULT_STRATEGY) != Z_OK)
+		throw std::bad_alloc();
+}
+
+recpp::filesystem::detail::Deflater::~Deflater()
+{
+	deflateEnd(m_stream.get());
+}
+
+void recpp::filesystem::detail::Deflater::deflate(const std::uint8_t *data, std::size_t size, std::size_t dictionarySize, bool last,
+												  std::vector<std::uint8_t> &output)
+{
+	deflateReset(m_stream.get());
+	dictionarySize = std::min(dictionarySize, historySize);
+	if (dictionarySize)
+		deflateSetDictionary(m_stream.get(), data - dictionarySize, static_cast<uInt>(dictionarySize));
+
+	// A sync flush ends the piece with the empty stored block the next piece is appended after, and the input is split in what zlib can take at once
+	m_stream->next_in = const_cast<std::uint8_t *>(data);
+	auto remaining = size;
+	do
+	{
+		const auto piece = std::min<std::size_t>(remaining, std::numeric_limits<uInt>::max());
+		remaining -= piece;
+		m_stream->avail_in = static_cast<uInt>(piece);
+		const auto flush = remaining ? Z_NO_FLUSH : last ? Z_FINISH : Z_SYNC_FLUSH;
+		do
+		{
+			const auto offset = output.size();
+			output.resize(offset + std::min<std::size_t>(deflateBound(m_stream.get(), m_stream->avail_in) + 16, std::numeric_limits<uInt>::max()));
+			m_stream->next_out = output.data() + offset;
+			m_stream->avail_out = static_cast<uInt>(output.size() - offset);
+			::deflate(m_stream.get(), flush);
+			output.resize(output.size() - m_stream->avail_out);
+		} while (m_stream->avail_out == 0);
+	} while (remaining);
+}
+#else
+
+namespace
+{
+	// The largest distance a match can refer back to
+	constexpr std::size_t historySize = 32768;
+	constexpr std::size_t minimumLength = 4;
+	constexpr std::size_t maximumLength = 258;
+	// The number of symbols after which a block is written, which lets its codes follow the statistics of the data
+	constexpr std::size_t blockSymbols = 1 << 15;
+	constexpr std::size_t maximumStoredSize = 65535;
+	constexpr unsigned	  endOfBlock = 256;
+
+	constexpr std::uint16_t lengthBases[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+	constexpr std::uint8_t	lengthExtraBits[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+	constexpr std::uint16_t distanceBases[] = {1,	2,	 3,	  4,   5,	7,	  9,	13,	  17,	25,	  33,	49,	  65,	 97,	129,
+											   193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+	constexpr std::uint8_t	distanceExtraBits[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+	// The order in which the lengths of the code length codes are stored
+	constexpr std::uint8_t	codeLengthOrder[] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+	// The search parameters of each level, from zlib
+	struct Level
+	{
+		unsigned good;
+		unsigned lazy;
+		unsigned nice;
+		unsigned chain;
+	};
+
+	constexpr Level levels[] = {{4, 4, 8, 4},	   {4, 5, 16, 8},	  {4, 6, 32, 32},		{4, 4, 16, 16},		 {8, 16, 32, 32},
+								{8, 16, 128, 128}, {8, 32, 128, 256}, {32, 128, 258, 1024}, {32, 258, 258, 4096}};
+	// The first level using lazy matching
+	constexpr int firstLazyLevel = 4;
+
+	struct Codes
+	{
+		unsigned					   lengthCount;
+		unsigned					   distanceCount;
+		/// The codes of the literals and lengths, the last two only being part of the fixed code
+		std::array<std::uint8_t, 288>  lengths;
+		std::array<std::uint8_t, 30>   distanceLengths;
+		std::array<std::uint16_t, 288> codes;
+		std::array<std::uint16_t, 30>  distanceCodes;
+	};
+
+	unsigned lengthCode(std::size_t length)
+	{
+		static const auto codes = []()
+		{
+			std::array<std::uint8_t, maximumLength + 1> result = {};
+			for (unsigned code = 0; code < std::size(lengthBases); code++)
+			{
+				for (unsigned value = lengthBases[code]; value < lengthBases[code] + (1U << lengthExtraBits[code]) && value <= maximumLength; value++)
+					result[value] = static_cast<std::uint8_t>(code);
+			}
+			return result;
+		}();
+		return codes[length];
+	}
+
+	unsigned distanceCode(std::size_t distance)
+	{
+		// Past the first four codes, each power of two is split into two codes
+		const auto value = static_cast<unsigned>(distance - 1);
+		if (value < 4)
+			return value;
+		unsigned bit = 2;
+		while (value >> (bit + 1))
+			bit++;
+		return 2 * bit + ((value >> (bit - 1)) & 1);
+	}
+
+	unsigned reverse(unsigned code, unsigned length)
+	{
+		unsigned reversed = 0;
+		for (unsigned i = 0; i < length; i++, code >>= 1)
+			reversed = (reversed << 1) | (code & 1);
+		return reversed;
+	}
+
+	// Compute the lengths of the Huffman code of the symbols with frequencies, none being longer than limit
+	void huffmanLengths(const std::uint32_t *frequencies, std::size_t count, unsigned limit, std::uint8_t *lengths)
+	{
+		std::fill(lengths, lengths + count, 0);
+		std::vector<std::pair<std::uint32_t, std::uint16_t>> leaves;
+		for (std::size_t symbol = 0; symbol < count; symbol++)
+		{
+			if (frequencies[symbol])
+				leaves.emplace_back(frequencies[symbol], static_cast<std::uint16_t>(symbol));
+		}
+		// Decoders expect at least two codes, even if a single symbol is used
+		for (std::uint16_t symbol = 0; leaves.size() < 2; symbol++)
+		{
+			if (!frequencies[symbol])
+				leaves.emplace_back(0, symbol);
+		}
+		std::sort(leaves.begin(), leaves.end());
+
+		// The nodes of the tree are created by increasing weight, from the sorted leaves and the internal nodes already created, which are sorted as well
+		const auto				   leafCount = leaves.size();
+		std::vector<std::uint64_t> weights(2 * leafCount - 1);
+		std::vector<std::size_t>   parents(2 * leafCount - 1);
+		for (std::size_t i = 0; i < leafCount; i++)
+			weights[i] = leaves[i].first;
+		std::size_t nextLeaf = 0;
+		std::size_t nextNode = leafCount;
+		for (auto node = leafCount; node < weights.size(); node++)
+		{
+			std::uint64_t weight = 0;
+			for (auto child = 0; child < 2; child++)
+			{
+				const auto index = nextLeaf < leafCount && (nextNode == node || weights[nextLeaf] <= weights[nextNode]) ? nextLeaf++ : nextNode++;
+				parents[index] = node;
+				weight += weights[index];
+			}
+			weights[node] = weight;
+		}
+		std::vector<unsigned> depths(weights.size());
+		for (auto node = weights.size() - 1; node-- > 0;)
+			depths[node] = depths[parents[node]] + 1;
+
+		// Longer codes are cut to the limit, then codes are lengthened until the code is no longer over-subscribed, as in miniz
+		std::vector<unsigned> counts(limit + 1);
+		for (std::size_t i = 0; i < leafCount; i++)
+			counts[std::min(depths[i], limit)]++;
+		std::uint64_t total = 0;
+		for (unsigned length = 1; length <= limit; length++)
+			total += static_cast<std::uint64_t>(counts[length]) << (limit - length);
+		for (; total > (std::uint64_t(1) << limit); total--)
+		{
+			counts[limit]--;
+			for (auto length = limit - 1; length > 0; length--)
+			{
+				if (counts[length])
+				{
+					counts[length]--;
+					counts[length + 1] += 2;
+					break;
+				}
+			}
+		}
+
+		// The least frequent symbols get the longest codes
+		std::size_t leaf = 0;
+		for (auto length = limit; length > 0; length--)
+		{
+			for (unsigned i = 0; i < counts[length]; i++)
+				lengths[leaves[leaf++].second] = static_cast<std::uint8_t>(length);
+		}
+	}
+
+	// Compute the canonical codes of the lengths, bit reversed since deflate writes them from their most significant bit
+	void canonicalCodes(const std::uint8_t *lengths, std::size_t count, std::uint16_t *codes)
+	{
+		unsigned counts[16] = {};
+		for (std::size_t symbol = 0; symbol < count; symbol++)
+			counts[lengths[symbol]]++;
+		counts[0] = 0;
+		unsigned next[16] = {};
+		for (unsigned length = 1, code = 0; length < 16; length++)
+		{
+			code = (code + counts[length - 1]) << 1;
+			next[length] = code;
+		}
+		for (std::size_t symbol = 0; symbol < count; symbol++)
+		{
+			if (lengths[symbol])
+				codes[symbol] = static_cast<std::uint16_t>(reverse(next[lengths[symbol]]++, lengths[symbol]));
+		}
+	}
+
+	const Codes &fixedCodes()
+	{
+		static const auto codes = []()
+		{
+			Codes result = {};
+			result.lengthCount = 286;
+			result.distanceCount = 30;
+			std::fill(result.lengths.begin(), result.lengths.begin() + 144, 8);
+			std::fill(result.lengths.begin() + 144, result.lengths.begin() + 256, 9);
+			std::fill(result.lengths.begin() + 256, result.lengths.begin() + 280, 7);
+			std::fill(result.lengths.begin() + 280, result.lengths.end(), 8);
+			result.distanceLengths.fill(5);
+			canonicalCodes(result.lengths.data(), result.lengths.size(), result.codes.data());
+			canonicalCodes(result.distanceLengths.data(), result.distanceLengths.size(), result.distanceCodes.data());
+			return result;
+		}();
+		return codes;
+	}
+
+	// A code length of the header of a dynamic block, with the extra bits of the repeat codes
+	struct CodeLength
+	{
+		std::uint8_t symbol;
+		std::uint8_t extra;
+	};
+
+	// Run-length encode the code lengths of a dynamic block with the repeat codes 16, 17 and 18
+	std::vector<CodeLength> encodeLengths(const std::uint8_t *lengths, std::size_t count)
+	{
+		std::vector<CodeLength> result;
+		for (std::size_t i = 0; i < count;)
+		{
+			const auto length = lengths[i];
+			std::size_t run = 1;
+			while (i + run < count && lengths[i + run] == length)
+				run++;
+			i += run;
+			if (length == 0)
+			{
+				for (; run >= 11; run -= std::min<std::size_t>(run, 138))
+					result.push_back({18, static_cast<std::uint8_t>(std::min<std::size_t>(run, 138) - 11)});
+				if (run >= 3)
+				{
+					result.push_back({17, static_cast<std::uint8_t>(run - 3)});
+					run = 0;
+				}
+			}
+			else
+			{
+				result.push_back({length, 0});
+				run--;
+				for (; run >= 3; run -= std::min<std::size_t>(run, 6))
+					result.push_back({16, static_cast<std::uint8_t>(std::min<std::size_t>(run, 6) - 3)});
+			}
+			for (; run > 0; run--)
+				result.push_back({length, 0});
+		}
+		return result;
+	}
+} // namespace
+
+recpp::filesystem::detail::Deflater::Deflater(int level)
+	: m_heads(std::size_t(1) << hashBits)
+	, m_previous(historySize)
+{
+	level = std::clamp(level, 1, static_cast<int>(std::size(levels)));
+	const auto &parameters = levels[level - 1];
+	m_goodLength = parameters.good;
+	m_lazyLength = parameters.lazy;
+	m_niceLength = parameters.nice;
+	m_chainLength = parameters.chain;
+	m_lazy = level >= firstLazyLevel;
+	m_symbols.reserve(blockSymbols);
+}
+
+void recpp::filesystem::detail::Deflater::deflate(const std::uint8_t *data, std::size_t size, std::size_t dictionarySize, bool last,
+												  std::vector<std::uint8_t> &output)
+{
+	dictionarySize = std::min(dictionarySize, historySize);
+	m_base = data - dictionarySize;
+	m_end = dictionarySize + size;
+	m_output = &output;
+	m_bits = 0;
+	m_bitCount = 0;
+	m_symbols.clear();
+	m_lengthFrequencies.fill(0);
+	m_distanceFrequencies.fill(0);
+	std::fill(m_heads.begin(), m_heads.end(), -1);
+
+	for (std::size_t position = 0; position < dictionarySize; position++)
+		insert(position);
+
+	auto blockStart = dictionarySize;
+	auto position = dictionarySize;
+	while (position < m_end)
+	{
+		auto current = find(position);
+		insert(position);
+		if (current.length < minimumLength)
+		{
+			literal(m_base[position++]);
+		}
+		else
+		{
+			// A longer match at the next position is worth a literal
+			while (m_lazy && current.length < m_lazyLength && position + 1 < m_end)
+			{
+				const auto next = find(position + 1);
+				if (next.length <= current.length)
+					break;
+				insert(position + 1);
+				literal(m_base[position++]);
+				current = next;
+			}
+			match(current);
+			// The positions inside long matches are not hashed at the fastest levels
+			const auto end = position + current.length;
+			if (m_lazy || current.length <= m_lazyLength)
+			{
+				for (position++; position < end; position++)
+					insert(position);
+			}
+			position = end;
+		}
+
+		if (m_symbols.size() >= blockSymbols)
+		{
+			flushBlock(blockStart, position, last && position == m_end);
+			blockStart = position;
+		}
+	}
+	if (!m_symbols.empty() || (last && blockStart == dictionarySize))
+		flushBlock(blockStart, m_end, last);
+
+	if (!last)
+	{
+		// An empty stored block, ending the output on a byte boundary
+		writeBits(0, 3);
+		alignToByte();
+		const std::uint8_t empty[] = {0, 0, 0xFF, 0xFF};
+		output.insert(output.end(), std::begin(empty), std::end(empty));
+	}
+	else
+		alignToByte();
+	m_output = nullptr;
+}
+
+recpp::filesystem::detail::Deflater::Match recpp::filesystem::detail::Deflater::find(std::size_t position)
+{
+	Match best;
+	if (position + minimumLength > m_end)
+		return best;
+
+	std::uint32_t key;
+	std::memcpy(&key, m_base + position, sizeof(key));
+	auto		candidate = m_heads[(key * 2654435761U) >> (32 - hashBits)];
+	const auto	limit = std::min(maximumLength, m_end - position);
+	const auto *current = m_base + position;
+	auto		chain = m_chainLength;
+	for (; candidate >= 0 && position - static_cast<std::size_t>(candidate) <= historySize && chain > 0; chain--)
+	{
+		const auto *previous = m_base + candidate;
+		// The byte that would make the match longer than the best one is checked first
+		if (previous[best.length] == current[best.length])
+		{
+			std::size_t length = 0;
+			for (; length + sizeof(std::uint64_t) <= limit; length += sizeof(std::uint64_t))
+			{
+				std::uint64_t word1;
+				std::uint64_t word2;
+				std::memcpy(&word1, previous + length, sizeof(word1));
+				std::memcpy(&word2, current + length, sizeof(word2));
+				if (word1 != word2)
+					break;
+			}
+			while (length < limit && previous[length] == current[length])
+				length++;
+			if (length > best.length)
+			{
+				best = Match{length, position - static_cast<std::size_t>(candidate)};
+				if (length >= m_niceLength || length == limit)
+					break;
+				if (length >= m_goodLength)
+					chain = chain / 4 + 1;
+			}
+		}
+		candidate = m_previous[static_cast<std::size_t>(candidate) % historySize];
+	}
+	return best;
+}
+
+void recpp::filesystem::detail::Deflater::insert(std::size_t position)
+{
+	if (position + minimumLength > m_end)
+		return;
+	std::uint32_t key;
+	std::memcpy(&key, m_base + position, sizeof(key));
+	auto &head = m_heads[(key * 2654435761U) >> (32 - hashBits)];
+	m_previous[position % historySize] = head;
+	head = static_cast<std::int32_t>(position);
+}
+
+void recpp::filesystem::detail::Deflater::literal(std::uint8_t byte)
+{
+	m_symbols.push_back(byte);
+	m_lengthFrequencies[byte]++;
+}
+
+void recpp::filesystem::detail::Deflater::match(const Match &match)
+{
+	m_symbols.push_back(static_cast<std::uint32_t>(match.length << 16 | match.distance));
+	m_lengthFrequencies[257 + lengthCode(match.length)]++;
+	m_distanceFrequencies[distanceCode(match.distance)]++;
+}
+
+void recpp::filesystem::detail::Deflater::flushBlock(std::size_t start, std::size_t end, bool last)
+{
+	m_lengthFrequencies[endOfBlock]++;
+
+	Codes dynamic = {};
+	huffmanLengths(m_lengthFrequencies.data(), m_lengthFrequencies.size(), 15, dynamic.lengths.data());
+	huffmanLengths(m_distanceFrequencies.data(), m_distanceFrequencies.size(), 15, dynamic.distanceLengths.data());
+	canonicalCodes(dynamic.lengths.data(), dynamic.lengths.size(), dynamic.codes.data());
+	canonicalCodes(dynamic.distanceLengths.data(), dynamic.distanceLengths.size(), dynamic.distanceCodes.data());
+	dynamic.lengthCount = 286;
+	while (dynamic.lengthCount > 257 && !dynamic.lengths[dynamic.lengthCount - 1])
+		dynamic.lengthCount--;
+	dynamic.distanceCount = 30;
+	while (dynamic.distanceCount > 1 && !dynamic.distanceLengths[dynamic.distanceCount - 1])
+		dynamic.distanceCount--;
+
+	// The lengths of both codes are encoded as a single sequence, itself Huffman coded
+	std::uint8_t lengths[286 + 30];
+	std::copy_n(dynamic.lengths.begin(), dynamic.lengthCount, lengths);
+	std::copy_n(dynamic.distanceLengths.begin(), dynamic.distanceCount, lengths + dynamic.lengthCount);
+	const auto	  codeLengths = encodeLengths(lengths, dynamic.lengthCount + dynamic.distanceCount);
+	std::uint32_t codeLengthFrequencies[19] = {};
+	for (const auto &codeLength : codeLengths)
+		codeLengthFrequencies[codeLength.symbol]++;
+	std::uint8_t  codeLengthLengths[19];
+	std::uint16_t codeLengthCodes[19];
+	huffmanLengths(codeLengthFrequencies, 19, 7, codeLengthLengths);
+	canonicalCodes(codeLengthLengths, 19, codeLengthCodes);
+	unsigned codeLengthCount = 19;
+	while (codeLengthCount > 4 && !codeLengthLengths[codeLengthOrder[codeLengthCount - 1]])
+		codeLengthCount--;
+
+	// Pick the smallest encoding, in bits
+	const auto	 &fixed = fixedCodes();
+	std::uint64_t extraBits = 0;
+	std::uint64_t dynamicBits = 3 + 5 + 5 + 4 + 3 * codeLengthCount;
+	std::uint64_t fixedBits = 3;
+	for (unsigned symbol = 0; symbol < m_lengthFrequencies.size(); symbol++)
+	{
+		dynamicBits += static_cast<std::uint64_t>(m_lengthFrequencies[symbol]) * dynamic.lengths[symbol];
+		fixedBits += static_cast<std::uint64_t>(m_lengthFrequencies[symbol]) * fixed.lengths[symbol];
+		if (symbol > endOfBlock)
+			extraBits += static_cast<std::uint64_t>(m_lengthFrequencies[symbol]) * lengthExtraBits[symbol - 257];
+	}
+	for (unsigned symbol = 0; symbol < m_distanceFrequencies.size(); symbol++)
+	{
+		dynamicBits += static_cast<std::uint64_t>(m_distanceFrequencies[symbol]) * dynamic.distanceLengths[symbol];
+		fixedBits += static_cast<std::uint64_t>(m_distanceFrequencies[symbol]) * fixed.distanceLengths[symbol];
+		extraBits += static_cast<std::uint64_t>(m_distanceFrequencies[symbol]) * distanceExtraBits[symbol];
+	}
+	for (const auto &codeLength : codeLengths)
+		dynamicBits += codeLengthLengths[codeLength.symbol] + (codeLength.symbol == 16 ? 2 : codeLength.symbol == 17 ? 3 : codeLength.symbol == 18 ? 7 : 0);
+	dynamicBits += extraBits;
+	fixedBits += extraBits;
+	const auto storedBlocks = std::max<std::size_t>(1, (end - start + maximumStoredSize - 1) / maximumStoredSize);
+	const auto storedBits = storedBlocks * (3 + 7 + 32) + 8 * static_cast<std::uint64_t>(end - start);
+
+	if (storedBits <= std::min(dynamicBits, fixedBits))
+		writeStored(start, end, last);
+	else
+	{
+		const auto	useFixed = fixedBits <= dynamicBits;
+		const auto &codes = useFixed ? fixed : dynamic;
+		writeBits(last ? 1 : 0, 1);
+		if (useFixed)
+			writeBits(1, 2);
+		else
+		{
+			writeBits(2, 2);
+			writeBits(dynamic.lengthCount - 257, 5);
+			writeBits(dynamic.distanceCount - 1, 5);
+			writeBits(codeLengthCount - 4, 4);
+			for (unsigned i = 0; i < codeLengthCount; i++)
+				writeBits(codeLengthLengths[codeLengthOrder[i]], 3);
+			for (const auto &codeLength : codeLengths)
+			{
+				writeBits(codeLengthCodes[codeLength.symbol], codeLengthLengths[codeLength.symbol]);
+				if (codeLength.symbol >= 16)
+					writeBits(codeLength.extra, codeLength.symbol == 16 ? 2 : codeLength.symbol == 17 ? 3 : 7);
+			}
+		}
+
+		for (const auto symbol : m_symbols)
+		{
+			if (symbol < 256)
+			{
+				writeBits(codes.codes[symbol], codes.lengths[symbol]);
+				continue;
+			}
+			const auto length = symbol >> 16;
+			const auto distance = symbol & 0xFFFF;
+			const auto code = lengthCode(length);
+			writeBits(codes.codes[257 + code], codes.lengths[257 + code]);
+			writeBits(length - lengthBases[code], lengthExtraBits[code]);
+			const auto distanceSymbol = distanceCode(distance);
+			writeBits(codes.distanceCodes[distanceSymbol], codes.distanceLengths[distanceSymbol]);
+			writeBits(distance - distanceBases[distanceSymbol], distanceExtraBits[distanceSymbol]);
+		}
+		writeBits(codes.codes[endOfBlock], codes.lengths[endOfBlock]);
+	}
+
+	m_symbols.clear();
+	m_lengthFrequencies.fill(0);
+	m_distanceFrequencies.fill(0);
+}
+
+void recpp::filesystem::detail::Deflater::writeStored(std::size_t start, std::size_t end, bool last)
+{
+	do
+	{
+		const auto size = std::min(end - start, maximumStoredSize);
+		writeBits(last && start + size == end ? 1 : 0, 1);
+		writeBits(0, 2);
+		alignToByte();
+		const std::uint8_t header[] = {static_cast<std::uint8_t>(size), static_cast<std::uint8_t>(size >> 8), static_cast<std::uint8_t>(~size),
+									   static_cast<std::uint8_t>(~size >> 8)};
+		m_output->insert(m_output->end(), std::begin(header), std::end(header));
+		m_output->insert(m_output->end(), m_base + start, m_base + start + size);
+		start += size;
+	} while (start < end);
+}
+
+void recpp::filesystem::detail::Deflater::writeBits(std::uint32_t value, unsigned count)
+{
+	m_bits |= static_cast<std::uint64_t>(value) << m_bitCount;
+	m_bitCount += count;
+	if (m_bitCount >= 32)
+	{
+		const std::uint8_t bytes[] = {static_cast<std::uint8_t>(m_bits), static_cast<std::uint8_t>(m_bits >> 8), static_cast<std::uint8_t>(m_bits >> 16),
+									  static_cast<std::uint8_t>(m_bits >> 24)};
+		m_output->insert(m_output->end(), std::begin(bytes), std::end(bytes));
+		m_bits >>= 32;
+		m_bitCount -= 32;
+	}
+}
+
+void recpp::filesystem::detail::Deflater::alignToByte()
+{
+	for (; m_bitCount > 0; m_bitCount -= std::min(m_bitCount, 8U), m_bits >>= 8)
+		m_output->push_back(static_cast<std::uint8_t>(m_bits));
+	m_bits = 0;
+}
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef RECPP_FILESYSTEM_ZLIB
+#include <memory>
+
+struct z_stream_s;
+#endif
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Compressor to the raw deflate format of RFC 1951, the counterpart of Inflater.
+	 * <p>
+	 * Each call compresses a piece of a stream on its own, the data preceding it being only used as a dictionary matches can refer back to, so that the
+	 * pieces of a stream can be compressed on several threads and their outputs concatenated in order. Matches are found with hash chains, whose length and
+	 * the use of lazy matching depend on the level like in zlib, and each block is written with the cheapest of its dynamic Huffman codes, the fixed codes
+	 * and stored blocks. When the library is built with zlib, the pieces are compressed by zlib instead, which produces the same format.
+	 */
+	class Deflater
+	{
+	public:
+		/**
+		 * @brief Construct a new Deflater object.
+		 *
+		 * @param level The compression level, from 1 (fastest) to 9
+		 */
+		explicit Deflater(int level);
+
+#ifdef RECPP_FILESYSTEM_ZLIB
+		~Deflater();
+#endif
+
+		/**
+		 * @brief Compress the @p size bytes at @p data, appending the compressed data to @p output. Unless @p last is set, the output ends on a byte
+		 * boundary with an empty stored block, like a sync flush of zlib, so that the next piece of the stream can be appended to it.
+		 *
+		 * @param dictionarySize The number of bytes right before @p data that matches may refer back to, only the last 32 KiB being used
+		 * @param last True to end the stream with this piece, which may be empty
+		 */
+		void deflate(const std::uint8_t *data, std::size_t size, std::size_t dictionarySize, bool last, std::vector<std::uint8_t> &output);
+
+	private:
+#ifdef RECPP_FILESYSTEM_ZLIB
+		std::unique_ptr<z_stream_s> m_stream;
+#else
+		static constexpr unsigned hashBits = 15;
+
+		struct Match
+		{
+			std::size_t length = 0;
+			std::size_t distance = 0;
+		};
+
+		Match find(std::size_t position);
+		void insert(std::size_t position);
+		void literal(std::uint8_t byte);
+		void match(const Match &match);
+		void flushBlock(std::size_t start, std::size_t end, bool last);
+		void writeStored(std::size_t start, std::size_t end, bool last);
+		void writeBits(std::uint32_t value, unsigned count);
+		void alignToByte();
+
+		/// The longest chain walked, shortened when a match of the good length was already found
+		unsigned					   m_chainLength;
+		unsigned					   m_goodLength;
+		/// The length from which no lazy match is looked for, or the longest match whose positions are hashed without lazy matching
+		unsigned					   m_lazyLength;
+		/// The length from which the search stops
+		unsigned					   m_niceLength;
+		bool						   m_lazy;
+		const std::uint8_t			  *m_base = nullptr;
+		std::size_t					   m_end = 0;
+		/// The last position of each hash, and the previous position with the same hash of each position of the window, -1 for none
+		std::vector<std::int32_t>	   m_heads;
+		std::vector<std::int32_t>	   m_previous;
+		/// The literals and matches of the current block, a match being its length shifted left by 16 bits or'ed with its distance
+		std::vector<std::uint32_t>	   m_symbols;
+		std::array<std::uint32_t, 286> m_lengthFrequencies;
+		std::array<std::uint32_t, 30>  m_distanceFrequencies;
+		std::vector<std::uint8_t>	  *m_output = nullptr;
+		std::uint64_t				   m_bits = 0;
+		unsigned					   m_bitCount = 0;
+#endif
+	};
+} // namespace recpp::filesystem::detail
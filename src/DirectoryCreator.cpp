@@ -0,0 +1,320 @@
+#include "DirectoryCreator.h"
+#include "Parallel.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	using Name = std::filesystem::path::string_type;
+
+#ifdef _WIN32
+	// Windows has no mkdirat, so directories are designated by their full path
+	using Handle = std::filesystem::path;
+
+	const Handle rootHandle;
+
+	std::error_code makeDirectory(const Handle &parent, const Name &name)
+	{
+		std::error_code error;
+		if (!std::filesystem::create_directory(parent / name, error) && !error)
+			error = std::make_error_code(std::errc::file_exists);
+		return error;
+	}
+
+	std::error_code openDirectory(const Handle &parent, const Name &name, Handle &handle)
+	{
+		handle = parent / name;
+		std::error_code error;
+		const auto		status = std::filesystem::status(handle, error);
+		if (status.type() == std::filesystem::file_type::not_found)
+			return std::make_error_code(std::errc::no_such_file_or_directory);
+		if (!error && status.type() != std::filesystem::file_type::directory)
+			error = std::make_error_code(std::errc::not_a_directory);
+		return error;
+	}
+
+	bool isDirectory(const Handle &parent, const Name &name)
+	{
+		std::error_code error;
+		return std::filesystem::is_directory(parent / name, error);
+	}
+
+	void closeDirectory(const Handle &)
+	{
+	}
+#else
+	using Handle = int;
+
+	// The roots are absolute paths, which openat and mkdirat resolve regardless of the directory they are given
+	const Handle rootHandle = AT_FDCWD;
+
+	std::error_code makeDirectory(Handle parent, const Name &name)
+	{
+		if (::mkdirat(parent, name.c_str(), 0777) == 0)
+			return std::error_code();
+		return std::error_code(errno, std::generic_category());
+	}
+
+	std::error_code openDirectory(Handle parent, const Name &name, Handle &handle)
+	{
+		handle = ::openat(parent, name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (handle >= 0)
+			return std::error_code();
+		return std::error_code(errno, std::generic_category());
+	}
+
+	bool isDirectory(Handle parent, const Name &name)
+	{
+		struct stat info;
+		return ::fstatat(parent, name.c_str(), &info, 0) == 0 && S_ISDIR(info.st_mode);
+	}
+
+	void closeDirectory(Handle handle)
+	{
+		if (handle != rootHandle)
+			::close(handle);
+	}
+#endif
+
+	struct Node
+	{
+		Name								  name;
+		std::unordered_map<Name, std::size_t> children;
+		bool								  created = false;
+		std::error_code						  error;
+	};
+
+	// The directories to create, node 0 being the parent of the root directories
+	class Tree
+	{
+	public:
+		Tree()
+			: m_nodes(1)
+		{
+		}
+
+		// Insert the absolute path and its parents, returning its node
+		std::size_t insert(const std::filesystem::path &path)
+		{
+			const auto normal = path.lexically_normal();
+			auto	   node = child(0, normal.root_path().native());
+			for (const auto &component : normal.relative_path())
+			{
+				if (!component.empty())
+					node = child(node, component.native());
+			}
+			return node;
+		}
+
+		// Create the directory of node, and open it into handle if it has children to create
+		bool visit(std::size_t node, const Handle &parent, bool parentCreated, Handle &handle)
+		{
+			auto &directory = m_nodes[node];
+			if (directory.children.empty())
+			{
+				const auto error = makeDirectory(parent, directory.name);
+				if (!error)
+					directory.created = true;
+				else if (error != std::errc::file_exists)
+					fail(node, error);
+				else if (!isDirectory(parent, directory.name))
+					fail(node, std::make_error_code(std::errc::not_a_directory));
+				return false;
+			}
+
+			// Parents usually exist unless they were just created, in which case their children cannot exist yet
+			auto error = parentCreated ? std::make_error_code(std::errc::no_such_file_or_directory) : openDirectory(parent, directory.name, handle);
+			if (error == std::errc::no_such_file_or_directory)
+			{
+				error = makeDirectory(parent, directory.name);
+				if (!error)
+					directory.created = true;
+				if (!error || error == std::errc::file_exists)
+					error = openDirectory(parent, directory.name, handle);
+			}
+			if (error)
+			{
+				fail(node, error);
+				return false;
+			}
+			return true;
+		}
+
+		// Create the directory of node at path on backend, which finds it if it exists
+		void visit(FileSystemBackend &backend, std::size_t node, const std::filesystem::path &path)
+		{
+			auto &directory = m_nodes[node];
+			try
+			{
+				directory.created = backend.createDirectory(path);
+				if (!directory.created && !std::filesystem::is_directory(backend.status(path)))
+					fail(node, std::make_error_code(std::errc::not_a_directory));
+			}
+			catch (const std::filesystem::filesystem_error &error)
+			{
+				fail(node, error.code());
+			}
+		}
+
+		// Create the directory of node and its subtree depth first, so that only the directories of the current branch are open
+		void create(std::size_t node, const Handle &parent, bool parentCreated)
+		{
+			Handle handle;
+			if (!visit(node, parent, parentCreated, handle))
+				return;
+			for (const auto &[name, child] : m_nodes[node].children)
+				create(child, handle, m_nodes[node].created);
+			closeDirectory(handle);
+		}
+
+		// Report error for node and every directory under it
+		void fail(std::size_t node, const std::error_code &error)
+		{
+			m_nodes[node].error = error;
+			for (const auto &[name, child] : m_nodes[node].children)
+				fail(child, error);
+		}
+
+		const Node &operator[](std::size_t node) const
+		{
+			return m_nodes[node];
+		}
+
+	private:
+		std::size_t child(std::size_t parent, const Name &name)
+		{
+			const auto [position, inserted] = m_nodes[parent].children.try_emplace(name, m_nodes.size());
+			const auto node = position->second;
+			if (inserted)
+				m_nodes.emplace_back().name = name;
+			return node;
+		}
+
+		std::vector<Node> m_nodes;
+	};
+
+	struct Task
+	{
+		std::size_t node;
+		/// The index of the handle of the parent directory in its level
+		std::size_t parent;
+		bool		parentCreated;
+	};
+} // namespace
+
+std::vector<recpp::filesystem::DirectoryCreation> recpp::filesystem::detail::createDirectories(const std::vector<std::filesystem::path> &paths,
+																							 unsigned threads)
+{
+	Tree					 tree;
+	std::vector<std::size_t> nodes;
+	nodes.reserve(paths.size());
+	for (const auto &path : paths)
+		nodes.push_back(path.empty() ? 0 : tree.insert(std::filesystem::absolute(path)));
+
+	// The first levels are created one by one until one of them has enough directories to keep every thread busy, each with its own subtree
+	const auto			workers = threadCount(threads);
+	std::vector<Handle> handles{rootHandle};
+	std::vector<Task>	level;
+	for (const auto &[name, root] : tree[0].children)
+		level.push_back(Task{root, 0, false});
+	while (!level.empty() && level.size() < 4 * static_cast<std::size_t>(workers))
+	{
+		std::vector<Handle> nextHandles;
+		std::vector<Task>	nextLevel;
+		for (const auto &task : level)
+		{
+			Handle handle;
+			if (!tree.visit(task.node, handles[task.parent], task.parentCreated, handle))
+				continue;
+			for (const auto &[name, child] : tree[task.node].children)
+				nextLevel.push_back(Task{child, nextHandles.size(), tree[task.node].created});
+			nextHandles.push_back(handle);
+		}
+		for (const auto &handle : handles)
+			closeDirectory(handle);
+		handles = std::move(nextHandles);
+		level = std::move(nextLevel);
+	}
+
+	parallelFor(
+		level.size(),
+		[&tree, &handles, &level](std::size_t i)
+		{
+			tree.create(level[i].node, handles[level[i].parent], level[i].parentCreated);
+		},
+		workers);
+	for (const auto &handle : handles)
+		closeDirectory(handle);
+
+	std::vector<DirectoryCreation> results;
+	results.reserve(paths.size());
+	for (std::size_t i = 0; i < paths.size(); i++)
+	{
+		if (!nodes[i])
+			results.push_back(DirectoryCreation{paths[i], false, std::make_error_code(std::errc::no_such_file_or_directory)});
+		else
+			results.push_back(DirectoryCreation{paths[i], tree[nodes[i]].created, tree[nodes[i]].error});
+	}
+	return results;
+}
+
+std::vector<recpp::filesystem::DirectoryCreation> recpp::filesystem::detail::createDirectories(FileSystemBackend &backend,
+																							 const std::vector<std::filesystem::path> &paths, unsigned threads)
+{
+	// The directories are created level by level, each once with FileSystemBackend::createDirectory, so that no two concurrent calls create the same
+	// directory, even a parent shared by several paths
+	Tree					 tree;
+	std::vector<std::size_t> nodes;
+	nodes.reserve(paths.size());
+	for (const auto &path : paths)
+		nodes.push_back(path.empty() ? 0 : tree.insert(backend.absolute(path)));
+
+	std::vector<std::pair<std::size_t, std::filesystem::path>> level;
+	for (const auto &[name, root] : tree[0].children)
+		level.emplace_back(root, std::filesystem::path(name));
+	while (!level.empty())
+	{
+		parallelFor(
+			level.size(),
+			[&backend, &tree, &level](std::size_t i)
+			{
+				tree.visit(backend, level[i].first, level[i].second);
+			},
+			threads);
+
+		std::vector<std::pair<std::size_t, std::filesystem::path>> nextLevel;
+		for (const auto &[node, path] : level)
+		{
+			if (tree[node].error)
+				continue;
+			for (const auto &[name, child] : tree[node].children)
+				nextLevel.emplace_back(child, path / name);
+		}
+		level = std::move(nextLevel);
+	}
+
+	std::vector<DirectoryCreation> results;
+	results.reserve(paths.size());
+	for (std::size_t i = 0; i < paths.size(); i++)
+	{
+		if (!nodes[i])
+			results.push_back(DirectoryCreation{paths[i], false, std::make_error_code(std::errc::no_such_file_or_directory)});
+		else
+			results.push_back(DirectoryCreation{paths[i], tree[nodes[i]].created, tree[nodes[i]].error});
+	}
+	return results;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <recpp/filesystem/DirectoryCreation.h>
+#include <recpp/filesystem/FileSystemBackend.h>
+
+#include <filesystem>
+#include <vector>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Create the directories at @p paths and all their missing parents, each unique directory being created at most once.
+	 * <p>
+	 * The paths are made absolute, lexically normalized, and merged into a prefix tree, which is then created top-down: each directory is created and
+	 * opened relatively to its parent, so that the kernel never walks a full path again, and independent subtrees are created on up to @p threads threads.
+	 *
+	 * @return The result of each path of @p paths, in the same order
+	 */
+	std::vector<DirectoryCreation> createDirectories(const std::vector<std::filesystem::path> &paths, unsigned threads);
+
+	/**
+	 * @brief Same as createDirectories(paths, threads) on @p backend: the paths are merged into the same prefix tree, whose directories are created level
+	 * by level with FileSystemBackend::createDirectory, each exactly once, those of a level on up to @p threads threads.
+	 *
+	 * @return The result of each path of @p paths, in the same order
+	 */
+	std::vector<DirectoryCreation> createDirectories(FileSystemBackend &backend, const std::vector<std::filesystem::path> &paths, unsigned threads);
+} // namespace recpp::filesystem::detail
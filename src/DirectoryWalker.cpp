@@ -0,0 +1,159 @@
+#include "DirectoryWalker.h"
+#include "Parallel.h"
+
+using namespace recpp::filesystem::detail;
+
+recpp::filesystem::detail::DirectoryWalker::DirectoryWalker(unsigned threads, std::filesystem::directory_options options,
+															std::optional<CancellationToken> token)
+	: m_threads(threadCount(threads))
+	, m_options(options)
+	, m_token(std::move(token))
+{
+}
+
+void recpp::filesystem::detail::DirectoryWalker::setFilter(Filter filter)
+{
+	m_filter = std::move(filter);
+}
+
+void recpp::filesystem::detail::DirectoryWalker::setErrorHandler(ErrorHandler handler)
+{
+	m_errorHandler = std::move(handler);
+}
+
+void recpp::filesystem::detail::DirectoryWalker::walk(const std::vector<std::filesystem::path> &roots, const Visitor &visitor) const
+{
+	const auto descend = [this](const std::filesystem::directory_entry &entry)
+	{
+		// An entry removed since its directory was listed has no type, and is not descended into
+		std::error_code error;
+		return entry.symlink_status(error).type() == std::filesystem::file_type::directory && (!m_filter || m_filter(entry));
+	};
+
+	std::vector<std::filesystem::directory_entry> entries;
+	for (const auto &root : roots)
+	{
+		entries.emplace_back(root);
+		if (entries.back().symlink_status().type() == std::filesystem::file_type::not_found)
+			throw std::filesystem::filesystem_error("walk", root, std::make_error_code(std::errc::no_such_file_or_directory));
+	}
+	// Unlike the entries found on the way, the roots are followed when they are symlinks to directories
+	visitor({}, entries);
+	std::vector<std::filesystem::path> pending;
+	for (const auto &entry : entries)
+	{
+		if (entry.status().type() == std::filesystem::file_type::directory && (!m_filter || m_filter(entry)))
+			pending.push_back(entry.path());
+	}
+
+	parallelQueue(
+		std::move(pending),
+		[this, &visitor, &descend](const std::filesystem::path &directory)
+		{
+			if (m_token)
+				m_token->throwIfCancelled();
+			const auto						   entries = list(directory);
+			std::vector<std::filesystem::path> directories;
+			visitor(directory, entries);
+			for (const auto &entry : entries)
+			{
+				if (descend(entry))
+					directories.push_back(entry.path());
+			}
+			return directories;
+		},
+		m_threads);
+}
+
+std::vector<std::filesystem::directory_entry> recpp::filesystem::detail::DirectoryWalker::list(const std::filesystem::path &directory) const
+{
+	std::error_code								  error;
+	std::vector<std::filesystem::directory_entry> entries;
+	for (std::filesystem::directory_iterator entry(directory, m_options, error), end; !error && entry != end; entry.increment(error))
+		entries.push_back(*entry);
+	if (!error)
+		return entries;
+
+	// The directory was removed or replaced since its parent was listed, which is no different from having been removed before the walk
+	if (error == std::errc::no_such_file_or_directory || error == std::errc::not_a_directory)
+		return {};
+	if (!m_errorHandler)
+		throw std::filesystem::filesystem_error("directory_iterator", directory, error);
+	m_errorHandler(directory, error);
+	return {};
+}
+
+recpp::filesystem::detail::BackendWalker::BackendWalker(const FileSystemBackend &backend, unsigned threads, std::optional<CancellationToken> token)
+	: m_backend(backend)
+	, m_threads(threadCount(threads))
+	, m_token(std::move(token))
+{
+}
+
+void recpp::filesystem::detail::BackendWalker::setFilter(Filter filter)
+{
+	m_filter = std::move(filter);
+}
+
+void recpp::filesystem::detail::BackendWalker::walk(const std::vector<std::filesystem::path> &roots, const Visitor &visitor) const
+{
+	// Like for DirectoryWalker, the roots are followed when they are symlinks to directories, unlike the entries found on the way
+	std::vector<BackendEntry> entries;
+	for (const auto &root : roots)
+	{
+		if (m_backend.symlinkStatus(root).type() == std::filesystem::file_type::not_found)
+			throw std::filesystem::filesystem_error("walk", root, std::make_error_code(std::errc::no_such_file_or_directory));
+		entries.push_back(BackendEntry{root, m_backend.status(root).type()});
+	}
+	visitor({}, entries);
+	std::vector<std::filesystem::path> pending;
+	for (const auto &entry : entries)
+	{
+		if (entry.type == std::filesystem::file_type::directory && (!m_filter || m_filter(entry)))
+			pending.push_back(entry.path);
+	}
+
+	parallelQueue(
+		std::move(pending),
+		[this, &visitor](const std::filesystem::path &directory)
+		{
+			if (m_token)
+				m_token->throwIfCancelled();
+			const auto						   entries = list(directory);
+			std::vector<std::filesystem::path> directories;
+			visitor(directory, entries);
+			for (const auto &entry : entries)
+			{
+				if (entry.type == std::filesystem::file_type::directory && (!m_filter || m_filter(entry)))
+					directories.push_back(entry.path);
+			}
+			return directories;
+		},
+		m_threads);
+}
+
+std::vector<BackendEntry> recpp::filesystem::detail::BackendWalker::list(const std::filesystem::path &directory) const
+{
+	std::vector<std::filesystem::path> paths;
+	try
+	{
+		paths = m_backend.directoryEntries(directory);
+	}
+	catch (const std::filesystem::filesystem_error &error)
+	{
+		// Like for DirectoryWalker, a directory removed or replaced since its parent was listed is an empty directory
+		if (error.code() == std::errc::no_such_file_or_directory || error.code() == std::errc::not_a_directory)
+			return {};
+		throw;
+	}
+
+	// An entry removed since its directory was listed is reported as not found
+	std::vector<BackendEntry> entries;
+	entries.reserve(paths.size());
+	for (auto &path : paths)
+	{
+		const auto type = m_backend.symlinkStatus(path).type();
+		entries.push_back(BackendEntry{std::move(path), type});
+	}
+	return entries;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <recpp/filesystem/CancellationToken.h>
+#include <recpp/filesystem/FileSystemBackend.h>
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <system_error>
+#include <vector>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief DirectoryWalker walks directory trees on several workers of runWorkers, each worker listing a different directory, which hides the latency
+	 * of the filesystem much better than a single recursive_directory_iterator.
+	 * <p>
+	 * Symlinks to directories are reported but not followed, unless they are roots of the walk. Directories are not listed in any particular order.
+	 */
+	class DirectoryWalker
+	{
+	public:
+		using Visitor = std::function<void(const std::filesystem::path &directory, const std::vector<std::filesystem::directory_entry> &entries)>;
+		using Filter = std::function<bool(const std::filesystem::directory_entry &directory)>;
+		using ErrorHandler = std::function<void(const std::filesystem::path &directory, const std::error_code &error)>;
+
+		/**
+		 * @brief Construct a new DirectoryWalker object.
+		 *
+		 * @param threads The number of workers listing directories, 0 for one per hardware thread
+		 * @param options The options used to list directories
+		 * @param token The CancellationToken checked before listing each directory
+		 */
+		DirectoryWalker(unsigned threads = 0, std::filesystem::directory_options options = std::filesystem::directory_options::none,
+						std::optional<CancellationToken> token = std::nullopt);
+
+		/**
+		 * @brief Only descend into the directories for which @p filter returns true. Directories are still visited when they are not descended into.
+		 */
+		void setFilter(Filter filter);
+
+		/**
+		 * @brief Call @p handler with the directories that cannot be listed, which are then visited as empty directories instead of failing the walk.
+		 * <p>
+		 * Directories removed or replaced after their parent was listed are always visited as empty directories, without calling @p handler, whether it is set
+		 * or not. @p handler is called concurrently from several threads.
+		 */
+		void setErrorHandler(ErrorHandler handler);
+
+		/**
+		 * @brief Call @p visitor with the entries of each directory under @p roots, once the whole directory is listed, and with an empty directory and the
+		 * roots themselves first. Each directory is only descended into after @p visitor returned for its parent.
+		 * <p>
+		 * @p visitor is called concurrently from several threads. The first exception thrown while listing a directory or by @p visitor stops the walk and is
+		 * rethrown once every worker stopped.
+		 */
+		void walk(const std::vector<std::filesystem::path> &roots, const Visitor &visitor) const;
+
+	private:
+		std::vector<std::filesystem::directory_entry> list(const std::filesystem::path &directory) const;
+
+		unsigned						   m_threads;
+		std::filesystem::directory_options m_options;
+		std::optional<CancellationToken>   m_token;
+		Filter							   m_filter;
+		ErrorHandler					   m_errorHandler;
+	};
+
+	/**
+	 * @brief An entry of a directory listed by a BackendWalker.
+	 */
+	struct BackendEntry
+	{
+		std::filesystem::path	   path;
+		/// The type of the entry, symlinks being followed for the roots of the walk only, or std::filesystem::file_type::not_found if it was removed since
+		/// its directory was listed
+		std::filesystem::file_type type;
+	};
+
+	/**
+	 * @brief BackendWalker walks directory trees of a FileSystemBackend like DirectoryWalker walks those of the operating system, on several workers of
+	 * runWorkers, with FileSystemBackend::directoryEntries and FileSystemBackend::symlinkStatus.
+	 * <p>
+	 * Symlinks to directories are reported but not followed, unless they are roots of the walk. Directories are not listed in any particular order.
+	 */
+	class BackendWalker
+	{
+	public:
+		using Visitor = std::function<void(const std::filesystem::path &directory, const std::vector<BackendEntry> &entries)>;
+		using Filter = std::function<bool(const BackendEntry &directory)>;
+
+		/**
+		 * @brief Construct a new BackendWalker object.
+		 *
+		 * @param backend The FileSystemBackend to walk, which must outlive this walker
+		 * @param threads The number of workers listing directories, 0 for one per hardware thread
+		 * @param token The CancellationToken checked before listing each directory
+		 */
+		BackendWalker(const FileSystemBackend &backend, unsigned threads = 0, std::optional<CancellationToken> token = std::nullopt);
+
+		/**
+		 * @brief Only descend into the directories for which @p filter returns true. Directories are still visited when they are not descended into.
+		 */
+		void setFilter(Filter filter);
+
+		/**
+		 * @brief Call @p visitor with the entries of each directory under @p roots like DirectoryWalker::walk, directories removed or replaced after their
+		 * parent was listed being visited as empty directories.
+		 */
+		void walk(const std::vector<std::filesystem::path> &roots, const Visitor &visitor) const;
+
+	private:
+		std::vector<BackendEntry> list(const std::filesystem::path &directory) const;
+
+		const FileSystemBackend			&m_backend;
+		unsigned						 m_threads;
+		std::optional<CancellationToken> m_token;
+		Filter							 m_filter;
+	};
+
+	/**
+	 * @brief Get the path of @p entry, listed by a DirectoryWalker.
+	 */
+	inline const std::filesystem::path &entryPath(const std::filesystem::directory_entry &entry)
+	{
+		return entry.path();
+	}
+
+	/**
+	 * @brief Get the path of @p entry, listed by a BackendWalker.
+	 */
+	inline const std::filesystem::path &entryPath(const BackendEntry &entry)
+	{
+		return entry.path;
+	}
+
+	/**
+	 * @brief Get the type of @p entry, listed by a DirectoryWalker, following it if it is a @p root of the walk like the walk does, or
+	 * std::filesystem::file_type::not_found if it was removed since its directory was listed.
+	 */
+	inline std::filesystem::file_type entryType(const std::filesystem::directory_entry &entry, bool root)
+	{
+		std::error_code error;
+		return root ? entry.status(error).type() : entry.symlink_status(error).type();
+	}
+
+	/**
+	 * @brief Get the type of @p entry, listed by a BackendWalker, which is followed already if it is a root of the walk.
+	 */
+	inline std::filesystem::file_type entryType(const BackendEntry &entry, bool)
+	{
+		return entry.type;
+	}
+} // namespace recpp::filesystem::detail
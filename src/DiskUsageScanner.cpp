@@ -0,0 +1,267 @@
+#include "DiskUsageScanner.h"
+#include "ConcurrentHashSet.h"
+#include "DirectoryWalker.h"
+#include "FileInfo.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	struct FileId
+	{
+		std::uintmax_t device;
+		std::uintmax_t inode;
+
+		bool operator==(const FileId &other) const
+		{
+			return device == other.device && inode == other.inode;
+		}
+	};
+
+	struct FileIdHash
+	{
+		std::size_t operator()(const FileId &id) const
+		{
+			// Inodes of the same device are often consecutive, multiplying spreads them over the whole range of the hash
+			return static_cast<std::size_t>((id.inode * 0x9E3779B97F4A7C15ull) ^ id.device);
+		}
+	};
+
+	// A directory being measured, which is complete once it was listed and all its subdirectories are complete
+	struct Node
+	{
+		std::filesystem::path		path;
+		std::shared_ptr<Node>		parent;
+		std::atomic<std::uintmax_t>	apparentSize = 0;
+		std::atomic<std::uintmax_t>	allocatedSize = 0;
+		std::atomic<std::uintmax_t>	fileCount = 0;
+		std::atomic<std::uintmax_t>	directoryCount = 1;
+		std::atomic<std::uintmax_t>	errorCount = 0;
+		// The listing of the directory itself and each of its subdirectories not complete yet
+		std::atomic<std::size_t>	pending = 1;
+
+		void add(const DiskUsage &usage)
+		{
+			apparentSize += usage.apparentSize;
+			allocatedSize += usage.allocatedSize;
+			fileCount += usage.fileCount;
+			directoryCount += usage.directoryCount;
+			errorCount += usage.errorCount;
+		}
+
+		DiskUsage usage() const
+		{
+			return DiskUsage{path, apparentSize, allocatedSize, fileCount, directoryCount, errorCount};
+		}
+	};
+
+	class Scanner
+	{
+	public:
+		// Measure the tree of backend, or the tree of the filesystem of the operating system if it is nullptr
+		Scanner(const FileSystemBackend *backend, const std::function<void(const DiskUsage &usage)> &onDirectory, const DiskUsageOptions &options)
+			: m_backend(backend)
+			, m_onDirectory(onDirectory)
+			, m_options(options)
+			, m_total(std::make_shared<Node>())
+		{
+			m_total->directoryCount = 0;
+		}
+
+		DiskUsage scan(const std::filesystem::path &root)
+		{
+			if (m_backend)
+			{
+				BackendWalker walker(*m_backend, m_options.threads, m_options.token);
+				walker.walk({root},
+							[this](const std::filesystem::path &directory, const std::vector<BackendEntry> &entries)
+							{
+								visit(directory, entries);
+							});
+			}
+			else
+			{
+				DirectoryWalker walker(m_options.threads, m_options.directoryOptions, m_options.token);
+				// A directory that cannot be listed is still visited, as an empty directory, so that its parent completes
+				walker.setErrorHandler(
+					[this](const std::filesystem::path &directory, const std::error_code &)
+					{
+						std::lock_guard lock(m_nodesMutex);
+						m_nodes.at(directory.native())->errorCount++;
+					});
+				walker.walk({root},
+							[this](const std::filesystem::path &directory, const std::vector<std::filesystem::directory_entry> &entries)
+							{
+								visit(directory, entries);
+							});
+			}
+
+			// Every directory is complete once the walk is over, only the listing of the roots is left
+			m_total->path = root;
+			return m_total->usage();
+		}
+
+	private:
+		template <typename Entry>
+		void visit(const std::filesystem::path &directory, const std::vector<Entry> &entries)
+		{
+			const auto node = directory.empty() ? m_total : takeNode(directory);
+
+			// The entries are summed locally, so that the counters shared with the other threads are only updated once per directory
+			DiskUsage						   files;
+			std::vector<std::shared_ptr<Node>> directories;
+			for (const auto &entry : entries)
+			{
+				// An entry removed since the directory was listed is left out, any other entry that cannot be measured is counted as an error
+				std::error_code error;
+				const auto		info = infoOf(entryPath(entry), directory.empty(), error);
+				if (error && error != std::errc::no_such_file_or_directory)
+					files.errorCount++;
+
+				// The type the walker descends by is used, so that each directory it lists was registered, the roots being followed
+				if (entryType(entry, directory.empty()) == std::filesystem::file_type::directory)
+				{
+					auto child = std::make_shared<Node>();
+					child->path = entryPath(entry);
+					child->parent = node;
+					if (info)
+					{
+						child->apparentSize = info->size;
+						child->allocatedSize = info->allocatedSize;
+					}
+					directories.push_back(std::move(child));
+					continue;
+				}
+				if (!info)
+					continue;
+				if (m_options.countHardLinksOnce && info->hardLinkCount > 1 && !firstLink(entryPath(entry), *info))
+					continue;
+				files.apparentSize += info->size;
+				files.allocatedSize += info->allocatedSize;
+				files.fileCount++;
+			}
+			node->add(files);
+
+			// The subdirectories must be counted as pending before this listing completes, and registered before the walker descends into them
+			node->pending += directories.size();
+			{
+				std::lock_guard lock(m_nodesMutex);
+				for (auto &child : directories)
+				{
+					auto key = child->path.native();
+					m_nodes.emplace(std::move(key), std::move(child));
+				}
+			}
+			complete(node);
+		}
+
+		// Get the attributes of path like fileInfo, from the backend if there is one, which neither tells the device and inode of its files nor the size of
+		// their blocks, so that they are counted as 0 and as their apparent size
+		std::optional<FileInfo> infoOf(const std::filesystem::path &path, bool followSymlinks, std::error_code &error) const
+		{
+			if (!m_backend)
+				return fileInfo(path, followSymlinks, error);
+			try
+			{
+				const auto status = followSymlinks ? m_backend->status(path) : m_backend->symlinkStatus(path);
+				if (status.type() == std::filesystem::file_type::not_found)
+				{
+					error = std::make_error_code(std::errc::no_such_file_or_directory);
+					return std::nullopt;
+				}
+				FileInfo info{status.type(), 0, 0, 0, 0, 1, 0, status.permissions(), 0, 0};
+				if (info.type == std::filesystem::file_type::regular)
+				{
+					info.size = m_backend->fileSize(path);
+					info.hardLinkCount = m_backend->hardLinkCount(path);
+				}
+				else if (info.type == std::filesystem::file_type::symlink)
+					info.size = m_backend->readSymlink(path).native().size();
+				info.allocatedSize = info.size;
+				return info;
+			}
+			catch (const std::filesystem::filesystem_error &failure)
+			{
+				error = failure.code();
+				return std::nullopt;
+			}
+		}
+
+		// Whether path, a file with several hard links, is the first of its links met by the scan, which are told apart by their inode, or compared with
+		// FileSystemBackend::equivalent to the first links of the other files found so far when it is unknown
+		bool firstLink(const std::filesystem::path &path, const FileInfo &info)
+		{
+			if (info.inode != 0)
+				return m_hardLinks.insert(FileId{info.device, info.inode});
+			if (!m_backend)
+				return true;
+
+			std::lock_guard lock(m_linksMutex);
+			auto		   &links = m_links[info.size];
+			for (const auto &link : links)
+			{
+				if (m_backend->equivalent(link, path))
+					return false;
+			}
+			links.push_back(path);
+			return true;
+		}
+
+		std::shared_ptr<Node> takeNode(const std::filesystem::path &directory)
+		{
+			std::lock_guard lock(m_nodesMutex);
+			const auto		node = m_nodes.find(directory.native());
+			auto			result = std::move(node->second);
+			m_nodes.erase(node);
+			return result;
+		}
+
+		// Each node completing adds its usage to its parent, which may complete in turn, up to the roots
+		void complete(std::shared_ptr<Node> node)
+		{
+			while (node != m_total && --node->pending == 0)
+			{
+				const auto usage = node->usage();
+				{
+					std::lock_guard lock(m_onDirectoryMutex);
+					m_onDirectory(usage);
+				}
+				node->parent->add(usage);
+				node = node->parent;
+			}
+		}
+
+		const FileSystemBackend														 *m_backend;
+		const std::function<void(const DiskUsage &usage)>							 &m_onDirectory;
+		const DiskUsageOptions														 &m_options;
+		std::shared_ptr<Node>														  m_total;
+		ConcurrentHashSet<FileId, FileIdHash>										  m_hardLinks;
+		std::mutex																	  m_nodesMutex;
+		std::unordered_map<std::filesystem::path::string_type, std::shared_ptr<Node>> m_nodes;
+		std::mutex																	  m_onDirectoryMutex;
+		/// The first link of each file with several hard links found so far, when their inode is unknown, by size
+		std::map<std::uintmax_t, std::vector<std::filesystem::path>>				  m_links;
+		std::mutex																	  m_linksMutex;
+	};
+} // namespace
+
+DiskUsage recpp::filesystem::detail::scanDiskUsage(const std::filesystem::path &root, const std::function<void(const DiskUsage &usage)> &onDirectory,
+												   const DiskUsageOptions &options)
+{
+	return Scanner(nullptr, onDirectory, options).scan(root);
+}
+
+DiskUsage recpp::filesystem::detail::scanDiskUsage(const FileSystemBackend &backend, const std::filesystem::path &root,
+												   const std::function<void(const DiskUsage &usage)> &onDirectory, const DiskUsageOptions &options)
+{
+	return Scanner(&backend, onDirectory, options).scan(root);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <recpp/filesystem/DiskUsage.h>
+#include <recpp/filesystem/FileSystemBackend.h>
+
+#include <filesystem>
+#include <functional>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Measure the space used by the tree rooted at @p root from a parallel walk, calling @p onDirectory with the usage of each directory of the tree
+	 * once every directory under it was measured, so that directories are reported bottom-up and @p root last.
+	 * <p>
+	 * Symlinks are counted but not followed. @p onDirectory is called from the worker threads, one directory at a time.
+	 *
+	 * @return The usage of the whole tree
+	 */
+	DiskUsage scanDiskUsage(const std::filesystem::path &root, const std::function<void(const DiskUsage &usage)> &onDirectory,
+							const DiskUsageOptions &options);
+
+	/**
+	 * @brief Same as scanDiskUsage(root, onDirectory, options) on the tree of @p backend, which does not tell the size of the blocks of its files: their
+	 * allocated size is their apparent size, and DiskUsageOptions::directoryOptions is ignored. Hard links are told apart with
+	 * FileSystemBackend::equivalent.
+	 */
+	DiskUsage scanDiskUsage(const FileSystemBackend &backend, const std::filesystem::path &root,
+							const std::function<void(const DiskUsage &usage)> &onDirectory, const DiskUsageOptions &options);
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,324 @@
+#include "DuplicateFinder.h"
+#include "ContentHash.h"
+#include "DirectoryWalker.h"
+#include "FileInfo.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	// Size of the head and of the tail hashed to tell files of the same size apart, a single page each
+	constexpr std::size_t sampleSize = 4096;
+	// Size of the blocks read when hashing whole files, small enough to hash many files at once
+	constexpr std::size_t blockSize = 1 << 20;
+	// Size of the blocks compared when verifying contents
+	constexpr std::size_t compareSize = 1 << 16;
+
+	struct Candidate
+	{
+		std::filesystem::path path;
+		std::uintmax_t		  size;
+		std::uintmax_t		  device;
+		std::uintmax_t		  inode;
+		Digest				  digest;
+		/// Set once the file could not be read, which leaves it out of every group
+		bool				  failed = false;
+	};
+
+	// Reports the files and directories that cannot be read to DuplicateOptions::onError, those removed during the search being left out silently
+	class ErrorReporter
+	{
+	public:
+		explicit ErrorReporter(const DuplicateOptions &options)
+			: m_options(options)
+		{
+		}
+
+		void report(const std::filesystem::path &path, const std::error_code &error)
+		{
+			if (error == std::errc::no_such_file_or_directory || !m_options.onError)
+				return;
+			std::lock_guard lock(m_mutex);
+			m_options.onError(path, error);
+		}
+
+	private:
+		const DuplicateOptions &m_options;
+		std::mutex				m_mutex;
+	};
+
+	struct Range
+	{
+		std::size_t begin;
+		std::size_t end;
+	};
+
+	// Files of at most two samples are entirely read by their sample, so their first digest can already be the final one
+	bool isSmall(const Candidate &candidate)
+	{
+		return candidate.size <= 2 * sampleSize;
+	}
+
+	bool sameContents(const std::filesystem::path &path1, const std::filesystem::path &path2)
+	{
+		std::ifstream file1(path1, std::ios::binary);
+		if (!file1)
+			throw std::filesystem::filesystem_error("open", path1, std::error_code(errno, std::generic_category()));
+		std::ifstream file2(path2, std::ios::binary);
+		if (!file2)
+			throw std::filesystem::filesystem_error("open", path2, std::error_code(errno, std::generic_category()));
+
+		std::unique_ptr<char[]> buffer1(new char[compareSize]);
+		std::unique_ptr<char[]> buffer2(new char[compareSize]);
+		while (file1 && file2)
+		{
+			file1.read(buffer1.get(), compareSize);
+			file2.read(buffer2.get(), compareSize);
+			if (file1.gcount() != file2.gcount() || !std::equal(buffer1.get(), buffer1.get() + file1.gcount(), buffer2.get()))
+				return false;
+		}
+		return file1.eof() && file2.eof();
+	}
+
+	// Split a range of candidates sorted by a key into the ranges of at least 2 candidates sharing the same key
+	template <typename Equal>
+	std::vector<Range> duplicateRanges(const std::vector<Candidate> &candidates, Range range, const Equal &equal)
+	{
+		std::vector<Range> ranges;
+		for (auto begin = range.begin; begin < range.end;)
+		{
+			auto end = begin + 1;
+			while (end < range.end && equal(candidates[begin], candidates[end]))
+				end++;
+			if (end - begin > 1)
+				ranges.push_back(Range{begin, end});
+			begin = end;
+		}
+		return ranges;
+	}
+
+	bool sameSize(const Candidate &candidate1, const Candidate &candidate2)
+	{
+		return candidate1.size == candidate2.size;
+	}
+
+	bool sameDigest(const Candidate &candidate1, const Candidate &candidate2)
+	{
+		return !candidate1.failed && !candidate2.failed && candidate1.digest == candidate2.digest;
+	}
+
+	bool digestLess(const Candidate &candidate1, const Candidate &candidate2)
+	{
+		return std::tie(candidate1.digest, candidate1.path) < std::tie(candidate2.digest, candidate2.path);
+	}
+
+	class Emitter
+	{
+	public:
+		Emitter(const std::function<void(const DuplicateGroup &group)> &onGroup, bool verifyContents, ErrorReporter &errors)
+			: m_onGroup(onGroup)
+			, m_verifyContents(verifyContents)
+			, m_errors(errors)
+		{
+		}
+
+		void emit(const std::vector<Candidate> &candidates, Range range)
+		{
+			std::vector<std::vector<std::filesystem::path>> groups(1);
+			for (auto i = range.begin; i < range.end; i++)
+				groups.front().push_back(candidates[i].path);
+			if (m_verifyContents)
+				groups = splitByContents(groups.front());
+
+			for (auto &paths : groups)
+			{
+				if (paths.size() < 2)
+					continue;
+				std::sort(paths.begin(), paths.end());
+				DuplicateGroup	group{candidates[range.begin].size, candidates[range.begin].digest, std::move(paths)};
+				std::lock_guard lock(m_mutex);
+				m_onGroup(group);
+			}
+		}
+
+	private:
+		std::vector<std::vector<std::filesystem::path>> splitByContents(const std::vector<std::filesystem::path> &paths)
+		{
+			std::vector<std::vector<std::filesystem::path>> groups;
+			for (const auto &path : paths)
+			{
+				auto done = false;
+				for (auto group = groups.begin(); !done && group != groups.end();)
+				{
+					try
+					{
+						done = sameContents(group->front(), path);
+						if (done)
+							group->push_back(path);
+						else
+							++group;
+					}
+					catch (const std::filesystem::filesystem_error &error)
+					{
+						// A file that cannot be read is left out, the next file of its group, known to be the same, then standing for the group
+						m_errors.report(error.path1(), error.code());
+						done = error.path1() == path;
+						if (done)
+							break;
+						group->erase(group->begin());
+						if (group->empty())
+							group = groups.erase(group);
+					}
+				}
+				if (!done)
+					groups.push_back({path});
+			}
+			return groups;
+		}
+
+		const std::function<void(const DuplicateGroup &group)> &m_onGroup;
+		const bool												m_verifyContents;
+		ErrorReporter										   &m_errors;
+		std::mutex												m_mutex;
+	};
+} // namespace
+
+void recpp::filesystem::detail::findDuplicates(const std::vector<std::filesystem::path> &roots, const std::function<void(const DuplicateGroup &group)> &onGroup,
+											   const DuplicateOptions &options)
+{
+	const auto checkToken = [&options]()
+	{
+		if (options.token)
+			options.token->throwIfCancelled();
+	};
+
+	// Stage 1: collect the regular files and their sizes from a parallel walk
+	ErrorReporter		   errors(options);
+	std::vector<Candidate> candidates;
+	std::mutex			   mutex;
+	DirectoryWalker		   walker(options.threads, options.directoryOptions, options.token);
+	walker.setErrorHandler(
+		[&errors](const std::filesystem::path &directory, const std::error_code &error)
+		{
+			errors.report(directory, error);
+		});
+	walker.walk(roots,
+				[&candidates, &mutex, &options, &errors](const std::filesystem::path &, const std::vector<std::filesystem::directory_entry> &entries)
+				{
+					std::vector<Candidate> files;
+					for (const auto &entry : entries)
+					{
+						std::error_code error;
+						if (entry.symlink_status(error).type() != std::filesystem::file_type::regular)
+							continue;
+						const auto info = fileInfo(entry.path(), false, error);
+						if (!info)
+							errors.report(entry.path(), error);
+						else if (info->size >= options.minSize)
+							files.push_back(Candidate{entry.path(), info->size, info->device, info->inode, {}});
+					}
+					std::lock_guard lock(mutex);
+					candidates.insert(candidates.end(), std::make_move_iterator(files.begin()), std::make_move_iterator(files.end()));
+				});
+
+	// Sorting by size also brings the hard links to the same file together, only the first one of them is kept
+	std::sort(candidates.begin(), candidates.end(),
+			  [](const Candidate &candidate1, const Candidate &candidate2)
+			  {
+				  return std::tie(candidate1.size, candidate1.device, candidate1.inode, candidate1.path) <
+						 std::tie(candidate2.size, candidate2.device, candidate2.inode, candidate2.path);
+			  });
+	const auto last = std::unique(candidates.begin(), candidates.end(),
+								  [](const Candidate &candidate1, const Candidate &candidate2)
+								  {
+									  return candidate1.inode != 0 && candidate1.device == candidate2.device && candidate1.inode == candidate2.inode;
+								  });
+	candidates.erase(last, candidates.end());
+
+	// Stage 2: hash the head and the tail of the files whose size is not unique
+	const auto				 sizeRanges = duplicateRanges(candidates, Range{0, candidates.size()}, sameSize);
+	std::vector<std::size_t> sampled;
+	for (const auto &range : sizeRanges)
+	{
+		for (auto i = range.begin; i < range.end; i++)
+			sampled.push_back(i);
+	}
+	parallelFor(
+		sampled.size(),
+		[&candidates, &sampled, &options, &checkToken, &errors](std::size_t i)
+		{
+			checkToken();
+			auto &candidate = candidates[sampled[i]];
+			try
+			{
+				candidate.digest = isSmall(candidate) ? hashFile(candidate.path, options.algorithm, blockSize) : hashSample(candidate.path, sampleSize);
+			}
+			catch (const std::filesystem::filesystem_error &error)
+			{
+				errors.report(candidate.path, error.code());
+				candidate.failed = true;
+			}
+		},
+		options.threads);
+
+	// Small files are already completely hashed, the others whose sample is not unique need to be hashed entirely
+	Emitter			   emitter(onGroup, options.verifyContents, errors);
+	std::vector<Range> sampleRanges;
+	for (const auto &range : sizeRanges)
+	{
+		std::sort(candidates.begin() + range.begin, candidates.begin() + range.end, digestLess);
+		for (const auto &sampleRange : duplicateRanges(candidates, range, sameDigest))
+		{
+			if (isSmall(candidates[sampleRange.begin]))
+				emitter.emit(candidates, sampleRange);
+			else
+				sampleRanges.push_back(sampleRange);
+		}
+	}
+
+	// Stage 3: hash the remaining files entirely, each group being reported by the thread hashing its last file
+	std::vector<std::pair<std::size_t, std::size_t>> hashed;
+	std::unique_ptr<std::atomic<std::size_t>[]>		 remaining(new std::atomic<std::size_t>[sampleRanges.size()]);
+	for (std::size_t range = 0; range < sampleRanges.size(); range++)
+	{
+		remaining[range] = sampleRanges[range].end - sampleRanges[range].begin;
+		for (auto i = sampleRanges[range].begin; i < sampleRanges[range].end; i++)
+			hashed.emplace_back(range, i);
+	}
+	parallelFor(
+		hashed.size(),
+		[&candidates, &hashed, &remaining, &sampleRanges, &emitter, &options, &checkToken, &errors](std::size_t i)
+		{
+			checkToken();
+			const auto [range, index] = hashed[i];
+			auto &candidate = candidates[index];
+			try
+			{
+				candidate.digest = hashFile(candidate.path, options.algorithm, blockSize);
+			}
+			catch (const std::filesystem::filesystem_error &error)
+			{
+				errors.report(candidate.path, error.code());
+				candidate.failed = true;
+			}
+			if (--remaining[range] > 0)
+				return;
+
+			const auto &sampleRange = sampleRanges[range];
+			std::sort(candidates.begin() + sampleRange.begin, candidates.begin() + sampleRange.end, digestLess);
+			for (const auto &digestRange : duplicateRanges(candidates, sampleRange, sameDigest))
+				emitter.emit(candidates, digestRange);
+		},
+		options.threads);
+}
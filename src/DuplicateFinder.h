@@ -0,0 +1,20 @@
+#pragma once
+
+#include <recpp/filesystem/Duplicates.h>
+
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Find the regular files with the same contents under @p roots, calling @p onGroup for each group as soon as it is confirmed.
+	 * <p>
+	 * Files are first grouped by size, then by a hash of their first and last bytes, and only then by a hash of their whole contents, so that files with
+	 * a unique size are never read and files with a unique head or tail are never read entirely. Hard links to the same file are reported once.
+	 * @p onGroup is called from the worker threads, one group at a time.
+	 */
+	void findDuplicates(const std::vector<std::filesystem::path> &roots, const std::function<void(const DuplicateGroup &group)> &onGroup,
+						const DuplicateOptions &options);
+} // namespace recpp::filesystem::detail
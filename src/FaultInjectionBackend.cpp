@@ -0,0 +1,346 @@
+#include "recpp/filesystem/FaultInjectionBackend.h"
+
+#include <cmath>
+#include <thread>
+
+using namespace recpp::filesystem;
+
+namespace
+{
+	// The 99th percentile of the standard normal distribution, scaling the log-normal latency from its median to its 99th percentile
+	constexpr double normalP99 = 2.3263478740408408;
+
+	// The name of the std::filesystem function of operation, used in the injected errors
+	const char *nameOf(FaultInjectionBackend::Operation operation)
+	{
+		using Operation = FaultInjectionBackend::Operation;
+
+		switch (operation)
+		{
+		case Operation::absolute:
+			return "absolute";
+		case Operation::canonical:
+			return "canonical";
+		case Operation::weaklyCanonical:
+			return "weakly_canonical";
+		case Operation::copy:
+			return "copy";
+		case Operation::copyFile:
+			return "copy_file";
+		case Operation::copySymlink:
+			return "copy_symlink";
+		case Operation::createDirectory:
+			return "create_directory";
+		case Operation::createDirectories:
+			return "create_directories";
+		case Operation::createHardLink:
+			return "create_hard_link";
+		case Operation::createSymlink:
+			return "create_symlink";
+		case Operation::createDirectorySymlink:
+			return "create_directory_symlink";
+		case Operation::currentPath:
+			return "current_path";
+		case Operation::directoryEntries:
+			return "directory_iterator";
+		case Operation::equivalent:
+			return "equivalent";
+		case Operation::fileSize:
+			return "file_size";
+		case Operation::hardLinkCount:
+			return "hard_link_count";
+		case Operation::isEmpty:
+			return "is_empty";
+		case Operation::lastWriteTime:
+			return "last_write_time";
+		case Operation::permissions:
+			return "permissions";
+		case Operation::readFile:
+			return "read";
+		case Operation::readSymlink:
+			return "read_symlink";
+		case Operation::remove:
+			return "remove";
+		case Operation::removeAll:
+			return "remove_all";
+		case Operation::rename:
+			return "rename";
+		case Operation::resizeFile:
+			return "resize_file";
+		case Operation::space:
+			return "space";
+		case Operation::status:
+			return "status";
+		case Operation::symlinkStatus:
+			return "symlink_status";
+		case Operation::tempDirectoryPath:
+			return "temp_directory_path";
+		case Operation::writeFile:
+			return "write";
+		case Operation::operation:
+			return "operation";
+		}
+		return "";
+	}
+} // namespace
+
+recpp::filesystem::FaultInjectionBackend::FaultInjectionBackend(std::shared_ptr<FileSystemBackend> backend, Settings settings)
+	: m_backend(backend ? std::move(backend) : std::make_shared<NativeBackend>())
+	, m_settings(std::move(settings))
+	, m_random(m_settings.seed)
+{
+}
+
+std::filesystem::path recpp::filesystem::FaultInjectionBackend::absolute(const std::filesystem::path &path) const
+{
+	inject(Operation::absolute, path);
+	return m_backend->absolute(path);
+}
+
+std::filesystem::path recpp::filesystem::FaultInjectionBackend::canonical(const std::filesystem::path &path) const
+{
+	inject(Operation::canonical, path);
+	return m_backend->canonical(path);
+}
+
+std::filesystem::path recpp::filesystem::FaultInjectionBackend::weaklyCanonical(const std::filesystem::path &path) const
+{
+	inject(Operation::weaklyCanonical, path);
+	return m_backend->weaklyCanonical(path);
+}
+
+void recpp::filesystem::FaultInjectionBackend::copy(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options)
+{
+	inject(Operation::copy, from, to);
+	m_backend->copy(from, to, options);
+}
+
+bool recpp::filesystem::FaultInjectionBackend::copyFile(const std::filesystem::path &from, const std::filesystem::path &to,
+														std::filesystem::copy_options options)
+{
+	inject(Operation::copyFile, from, to);
+	return m_backend->copyFile(from, to, options);
+}
+
+void recpp::filesystem::FaultInjectionBackend::copySymlink(const std::filesystem::path &from, const std::filesystem::path &to)
+{
+	inject(Operation::copySymlink, from, to);
+	m_backend->copySymlink(from, to);
+}
+
+bool recpp::filesystem::FaultInjectionBackend::createDirectory(const std::filesystem::path &path)
+{
+	inject(Operation::createDirectory, path);
+	return m_backend->createDirectory(path);
+}
+
+bool recpp::filesystem::FaultInjectionBackend::createDirectory(const std::filesystem::path &path, const std::filesystem::path &existingPath)
+{
+	inject(Operation::createDirectory, path, existingPath);
+	return m_backend->createDirectory(path, existingPath);
+}
+
+bool recpp::filesystem::FaultInjectionBackend::createDirectories(const std::filesystem::path &path)
+{
+	inject(Operation::createDirectories, path);
+	return m_backend->createDirectories(path);
+}
+
+void recpp::filesystem::FaultInjectionBackend::createHardLink(const std::filesystem::path &target, const std::filesystem::path &link)
+{
+	inject(Operation::createHardLink, target, link);
+	m_backend->createHardLink(target, link);
+}
+
+void recpp::filesystem::FaultInjectionBackend::createSymlink(const std::filesystem::path &target, const std::filesystem::path &link)
+{
+	inject(Operation::createSymlink, target, link);
+	m_backend->createSymlink(target, link);
+}
+
+void recpp::filesystem::FaultInjectionBackend::createDirectorySymlink(const std::filesystem::path &target, const std::filesystem::path &link)
+{
+	inject(Operation::createDirectorySymlink, target, link);
+	m_backend->createDirectorySymlink(target, link);
+}
+
+std::filesystem::path recpp::filesystem::FaultInjectionBackend::currentPath() const
+{
+	inject(Operation::currentPath, std::filesystem::path());
+	return m_backend->currentPath();
+}
+
+std::vector<std::filesystem::path> recpp::filesystem::FaultInjectionBackend::directoryEntries(const std::filesystem::path &path) const
+{
+	inject(Operation::directoryEntries, path);
+	return m_backend->directoryEntries(path);
+}
+
+bool recpp::filesystem::FaultInjectionBackend::equivalent(const std::filesystem::path &path1, const std::filesystem::path &path2) const
+{
+	inject(Operation::equivalent, path1, path2);
+	return m_backend->equivalent(path1, path2);
+}
+
+std::uintmax_t recpp::filesystem::FaultInjectionBackend::fileSize(const std::filesystem::path &path) const
+{
+	inject(Operation::fileSize, path);
+	return m_backend->fileSize(path);
+}
+
+std::uintmax_t recpp::filesystem::FaultInjectionBackend::hardLinkCount(const std::filesystem::path &path) const
+{
+	inject(Operation::hardLinkCount, path);
+	return m_backend->hardLinkCount(path);
+}
+
+bool recpp::filesystem::FaultInjectionBackend::isEmpty(const std::filesystem::path &path) const
+{
+	inject(Operation::isEmpty, path);
+	return m_backend->isEmpty(path);
+}
+
+std::filesystem::file_time_type recpp::filesystem::FaultInjectionBackend::lastWriteTime(const std::filesystem::path &path) const
+{
+	inject(Operation::lastWriteTime, path);
+	return m_backend->lastWriteTime(path);
+}
+
+void recpp::filesystem::FaultInjectionBackend::lastWriteTime(const std::filesystem::path &path, std::filesystem::file_time_type newTime)
+{
+	inject(Operation::lastWriteTime, path);
+	m_backend->lastWriteTime(path, newTime);
+}
+
+void recpp::filesystem::FaultInjectionBackend::permissions(const std::filesystem::path &path, std::filesystem::perms permissions,
+														   std::filesystem::perm_options options)
+{
+	inject(Operation::permissions, path);
+	m_backend->permissions(path, permissions, options);
+}
+
+std::string recpp::filesystem::FaultInjectionBackend::readFile(const std::filesystem::path &path) const
+{
+	inject(Operation::readFile, path);
+	return m_backend->readFile(path);
+}
+
+std::size_t recpp::filesystem::FaultInjectionBackend::readFile(const std::filesystem::path &path, std::uintmax_t offset, char *data, std::size_t size) const
+{
+	inject(Operation::readFile, path);
+	return m_backend->readFile(path, offset, data, size);
+}
+
+std::filesystem::path recpp::filesystem::FaultInjectionBackend::readSymlink(const std::filesystem::path &path) const
+{
+	inject(Operation::readSymlink, path);
+	return m_backend->readSymlink(path);
+}
+
+bool recpp::filesystem::FaultInjectionBackend::remove(const std::filesystem::path &path)
+{
+	inject(Operation::remove, path);
+	return m_backend->remove(path);
+}
+
+std::uintmax_t recpp::filesystem::FaultInjectionBackend::removeAll(const std::filesystem::path &path)
+{
+	inject(Operation::removeAll, path);
+	return m_backend->removeAll(path);
+}
+
+void recpp::filesystem::FaultInjectionBackend::rename(const std::filesystem::path &oldPath, const std::filesystem::path &newPath)
+{
+	inject(Operation::rename, oldPath, newPath);
+	m_backend->rename(oldPath, newPath);
+}
+
+void recpp::filesystem::FaultInjectionBackend::resizeFile(const std::filesystem::path &path, std::uintmax_t newSize)
+{
+	inject(Operation::resizeFile, path);
+	m_backend->resizeFile(path, newSize);
+}
+
+std::filesystem::space_info recpp::filesystem::FaultInjectionBackend::space(const std::filesystem::path &path) const
+{
+	inject(Operation::space, path);
+	return m_backend->space(path);
+}
+
+std::filesystem::file_status recpp::filesystem::FaultInjectionBackend::status(const std::filesystem::path &path) const
+{
+	inject(Operation::status, path);
+	return m_backend->status(path);
+}
+
+std::filesystem::file_status recpp::filesystem::FaultInjectionBackend::symlinkStatus(const std::filesystem::path &path) const
+{
+	inject(Operation::symlinkStatus, path);
+	return m_backend->symlinkStatus(path);
+}
+
+std::filesystem::path recpp::filesystem::FaultInjectionBackend::tempDirectoryPath() const
+{
+	inject(Operation::tempDirectoryPath, std::filesystem::path());
+	return m_backend->tempDirectoryPath();
+}
+
+void recpp::filesystem::FaultInjectionBackend::writeFile(const std::filesystem::path &path, std::string_view content)
+{
+	inject(Operation::writeFile, path);
+	m_backend->writeFile(path, content);
+}
+
+recpp::filesystem::FaultInjectionBackend::Statistics recpp::filesystem::FaultInjectionBackend::statistics() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_statistics;
+}
+
+const std::shared_ptr<FileSystemBackend> &recpp::filesystem::FaultInjectionBackend::backend() const
+{
+	return m_backend;
+}
+
+void recpp::filesystem::FaultInjectionBackend::injectOperation(const std::filesystem::path &path) const
+{
+	inject(Operation::operation, path);
+}
+
+void recpp::filesystem::FaultInjectionBackend::inject(Operation operation, const std::filesystem::path &path1, const std::filesystem::path &path2) const
+{
+	const auto	 found = m_settings.operations.find(operation);
+	const auto	&faults = found != m_settings.operations.end() ? found->second : m_settings.defaults;
+	auto		 latency = Clock::duration::zero();
+	const Error	*error = nullptr;
+	{
+		// The faults are drawn under the lock of the shared random number generator, but injected outside of it so that calls stall in parallel
+		std::lock_guard lock(m_mutex);
+		const auto		median = std::chrono::duration<double>(faults.medianLatency).count();
+		const auto		p99 = std::chrono::duration<double>(faults.p99Latency).count();
+		const auto		normal = std::normal_distribution<double>()(m_random);
+		if (median > 0)
+		{
+			const auto sigma = p99 > median ? std::log(p99 / median) / normalP99 : 0.0;
+			latency = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(median * std::exp(sigma * normal)));
+		}
+		const auto stalled = std::bernoulli_distribution(faults.stallProbability)(m_random);
+		if (stalled)
+			latency += faults.stallDuration;
+		for (const auto &candidate : faults.errors)
+		{
+			if (std::bernoulli_distribution(candidate.probability)(m_random) && !error)
+				error = &candidate;
+		}
+
+		m_statistics.calls++;
+		m_statistics.stalls += stalled;
+		m_statistics.errors += error != nullptr;
+		m_statistics.latency += latency;
+	}
+
+	if (latency > Clock::duration::zero())
+		std::this_thread::sleep_for(latency);
+	if (error)
+		throw std::filesystem::filesystem_error(nameOf(operation), path1, path2, std::make_error_code(error->code));
+}
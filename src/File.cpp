@@ -0,0 +1,110 @@
+#include "File.h"
+
+#include <cerrno>
+#include <system_error>
+
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#endif
+
+recpp::filesystem::detail::File::File(const std::filesystem::path &path, bool write, std::size_t bufferSize)
+	: m_path(path)
+{
+#ifdef _WIN32
+	m_file = _wfopen(path.c_str(), write ? L"wb" : L"rb");
+#else
+	m_file = std::fopen(path.c_str(), write ? "wb" : "rb");
+#endif
+	if (!m_file)
+		throw std::filesystem::filesystem_error("open", path, std::error_code(errno, std::generic_category()));
+	if (bufferSize)
+	{
+		m_buffer.reset(new char[bufferSize]);
+		std::setvbuf(m_file, m_buffer.get(), _IOFBF, bufferSize);
+	}
+	else
+		std::setvbuf(m_file, nullptr, _IONBF, 0);
+}
+
+recpp::filesystem::detail::File::~File()
+{
+	if (m_file)
+		std::fclose(m_file);
+}
+
+void recpp::filesystem::detail::File::adviseSequential()
+{
+#ifdef __linux__
+	posix_fadvise(fileno(m_file), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+recpp::filesystem::detail::FileInfo recpp::filesystem::detail::File::info() const
+{
+#ifdef _WIN32
+	struct _stat64 info;
+	if (_fstat64(_fileno(m_file), &info) != 0)
+		throw std::filesystem::filesystem_error("stat", m_path, std::error_code(errno, std::generic_category()));
+	auto type = std::filesystem::file_type::unknown;
+	if ((info.st_mode & _S_IFMT) == _S_IFREG)
+		type = std::filesystem::file_type::regular;
+	else if ((info.st_mode & _S_IFMT) == _S_IFDIR)
+		type = std::filesystem::file_type::directory;
+	return FileInfo{type,
+					static_cast<std::uintmax_t>(info.st_dev),
+					0,
+					static_cast<std::uintmax_t>(info.st_size),
+					static_cast<std::uintmax_t>(info.st_size),
+					static_cast<std::uintmax_t>(info.st_nlink),
+					static_cast<std::int64_t>(info.st_mtime) * 1000000000,
+					static_cast<std::filesystem::perms>(info.st_mode & 0777),
+					0,
+					0};
+#else
+	struct stat info;
+	if (::fstat(fileno(m_file), &info) != 0)
+		throw std::filesystem::filesystem_error("stat", m_path, std::error_code(errno, std::generic_category()));
+	return fileInfo(info);
+#endif
+}
+
+std::uintmax_t recpp::filesystem::detail::File::size() const
+{
+	return info().size;
+}
+
+void recpp::filesystem::detail::File::seek(std::uintmax_t offset)
+{
+#ifdef _WIN32
+	const auto result = _fseeki64(m_file, static_cast<__int64>(offset), SEEK_SET);
+#else
+	const auto result = fseeko(m_file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+	if (result != 0)
+		throw std::filesystem::filesystem_error("seek", m_path, std::error_code(errno, std::generic_category()));
+}
+
+std::size_t recpp::filesystem::detail::File::read(void *data, std::size_t size)
+{
+	// The end of the file is sticky in some C libraries, while more data may have been appended since it was reached
+	std::clearerr(m_file);
+	const auto result = std::fread(data, 1, size, m_file);
+	if (result < size && std::ferror(m_file))
+		throw std::filesystem::filesystem_error("read", m_path, std::error_code(errno, std::generic_category()));
+	return result;
+}
+
+void recpp::filesystem::detail::File::write(const void *data, std::size_t size)
+{
+	if (std::fwrite(data, 1, size, m_file) != size)
+		throw std::filesystem::filesystem_error("write", m_path, std::error_code(errno, std::generic_category()));
+}
+
+void recpp::filesystem::detail::File::close()
+{
+	const auto result = std::fclose(m_file);
+	m_file = nullptr;
+	if (result != 0)
+		throw std::filesystem::filesystem_error("close", m_path, std::error_code(errno, std::generic_category()));
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "FileInfo.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief File reads or writes a whole file through a stdio stream, throwing a std::filesystem::filesystem_error naming its path on failure.
+	 * <p>
+	 * Unless a buffer size is given, the stream is unbuffered: its users read and write through buffers of their own, going through the buffer of the
+	 * stream would only add a copy.
+	 */
+	class File
+	{
+	public:
+		/**
+		 * @brief Open the file at @p path for reading, or for writing if @p write is true, through a buffer of @p bufferSize bytes if it is not 0.
+		 */
+		explicit File(const std::filesystem::path &path, bool write = false, std::size_t bufferSize = 0);
+
+		File(const File &) = delete;
+		~File();
+
+		File &operator=(const File &) = delete;
+
+		/**
+		 * @brief Tell the operating system that the file is read sequentially, so that it reads ahead further. Does nothing where it is not supported.
+		 */
+		void adviseSequential();
+
+		/**
+		 * @brief Get the attributes of the open file, as if by POSIX fstat.
+		 */
+		FileInfo info() const;
+
+		/**
+		 * @brief Get the size of the open file, in bytes.
+		 */
+		std::uintmax_t size() const;
+
+		void seek(std::uintmax_t offset);
+
+		/**
+		 * @brief Read up to @p size bytes into @p data, returning the number of bytes read, which is less than @p size only at the end of the file.
+		 * <p>
+		 * Reading again after the end of the file returns the data appended since.
+		 */
+		std::size_t read(void *data, std::size_t size);
+
+		void write(const void *data, std::size_t size);
+
+		/**
+		 * @brief Close the file, flushing its buffer, before it is destroyed, so that the errors of the last writes are thrown rather than lost.
+		 */
+		void close();
+
+	private:
+		std::filesystem::path	m_path;
+		std::FILE			   *m_file = nullptr;
+		std::unique_ptr<char[]> m_buffer;
+	};
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,174 @@
+#include "FileHandles.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	[[noreturn]] void fail(const char *operation, const std::filesystem::path &path, int error)
+	{
+		throw std::filesystem::filesystem_error(operation, path, std::error_code(error, std::generic_category()));
+	}
+
+#ifdef __linux__
+	// The handle a filesystem gives to a file, which FileHandle stores as its type and the size of its bytes, in little endian, followed by its bytes
+	struct Handle
+	{
+		int			type = 0;
+		std::string bytes;
+	};
+
+	class Descriptor
+	{
+	public:
+		explicit Descriptor(int descriptor)
+			: m_descriptor(descriptor)
+		{
+		}
+
+		Descriptor(const Descriptor &) = delete;
+		Descriptor &operator=(const Descriptor &) = delete;
+
+		~Descriptor()
+		{
+			if (m_descriptor >= 0)
+				::close(m_descriptor);
+		}
+
+		int get() const
+		{
+			return m_descriptor;
+		}
+
+	private:
+		int m_descriptor;
+	};
+
+	void appendHandle(std::string &bytes, const Handle &handle)
+	{
+		const std::uint32_t header[2] = {static_cast<std::uint32_t>(handle.type), static_cast<std::uint32_t>(handle.bytes.size())};
+		for (const auto value : header)
+			for (auto i = 0; i < 4; i++)
+				bytes += static_cast<char>(value >> (8 * i));
+		bytes += handle.bytes;
+	}
+
+	// Read the handle at position in bytes, moving position past it, returning false if bytes are not a FileHandle
+	bool readHandle(const std::string &bytes, std::size_t &position, Handle &handle)
+	{
+		std::uint32_t header[2] = {};
+		if (bytes.size() - position < sizeof(header))
+			return false;
+		for (auto &value : header)
+			for (auto i = 0; i < 4; i++)
+				value |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(bytes[position++])) << (8 * i);
+		if (header[1] > MAX_HANDLE_SZ || bytes.size() - position < header[1])
+			return false;
+		handle.type = static_cast<int>(header[0]);
+		handle.bytes = bytes.substr(position, header[1]);
+		position += header[1];
+		return true;
+	}
+
+	Handle handleOf(const std::filesystem::path &path, int flags)
+	{
+		// The handle is preceded by its header, the room for the largest handle of any filesystem following it
+		std::vector<std::uint64_t> storage((sizeof(file_handle) + MAX_HANDLE_SZ + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+		const auto				   handle = reinterpret_cast<file_handle *>(storage.data());
+		handle->handle_bytes = MAX_HANDLE_SZ;
+		int mountId;
+		if (::name_to_handle_at(AT_FDCWD, path.c_str(), handle, &mountId, flags) != 0)
+			fail("name_to_handle_at", path, errno);
+		return Handle{handle->handle_type, std::string(reinterpret_cast<const char *>(handle->f_handle), handle->handle_bytes)};
+	}
+
+	int openHandle(int mount, const Handle &handle, int flags)
+	{
+		std::vector<std::uint64_t> storage((sizeof(file_handle) + MAX_HANDLE_SZ + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+		const auto				   fileHandle = reinterpret_cast<file_handle *>(storage.data());
+		fileHandle->handle_type = handle.type;
+		fileHandle->handle_bytes = static_cast<unsigned>(handle.bytes.size());
+		handle.bytes.copy(reinterpret_cast<char *>(fileHandle->f_handle), handle.bytes.size());
+		return ::open_by_handle_at(mount, fileHandle, flags | O_CLOEXEC);
+	}
+
+	// The path the kernel knows for descriptor, empty if it has none
+	std::filesystem::path pathOf(int descriptor)
+	{
+		std::error_code error;
+		auto			path = std::filesystem::read_symlink("/proc/self/fd/" + std::to_string(descriptor), error);
+		return error ? std::filesystem::path() : path;
+	}
+
+	bool isFile(const std::filesystem::path &path, const struct stat &file)
+	{
+		struct stat info;
+		return !path.empty() && ::lstat(path.c_str(), &info) == 0 && info.st_dev == file.st_dev && info.st_ino == file.st_ino;
+	}
+#endif
+} // namespace
+
+FileHandle recpp::filesystem::detail::fileHandle(const std::filesystem::path &path)
+{
+#ifdef __linux__
+	// The directory of a symlink is the one containing the symlink itself, which is not followed
+	const auto directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+	FileHandle handle;
+	appendHandle(handle.bytes, handleOf(path, 0));
+	appendHandle(handle.bytes, handleOf(directory, AT_SYMLINK_FOLLOW));
+	return handle;
+#else
+	fail("name_to_handle_at", path, static_cast<int>(std::errc::operation_not_supported));
+#endif
+}
+
+std::filesystem::path recpp::filesystem::detail::resolveFileHandle([[maybe_unused]] const FileHandle &handle, const std::filesystem::path &mountPoint)
+{
+#ifdef __linux__
+	Handle		file;
+	Handle		directory;
+	std::size_t position = 0;
+	if (!readHandle(handle.bytes, position, file) || !readHandle(handle.bytes, position, directory) || position != handle.bytes.size())
+		fail("open_by_handle_at", mountPoint, EINVAL);
+
+	const Descriptor mount(::open(mountPoint.c_str(), O_RDONLY | O_CLOEXEC));
+	if (mount.get() < 0)
+		fail("open", mountPoint, errno);
+	const Descriptor descriptor(openHandle(mount.get(), file, O_PATH));
+	struct stat		 info;
+	if (descriptor.get() < 0 || ::fstat(descriptor.get(), &info) != 0)
+		fail("open_by_handle_at", mountPoint, errno);
+	const auto path = pathOf(descriptor.get());
+	if (isFile(path, info))
+		return path;
+
+	// The path of a directory is always known, the kernel connecting the directories it opens by handle to their parents
+	const Descriptor directoryDescriptor(openHandle(mount.get(), directory, O_RDONLY | O_DIRECTORY));
+	const auto		 directoryPath = directoryDescriptor.get() < 0 ? std::filesystem::path() : pathOf(directoryDescriptor.get());
+	const std::unique_ptr<DIR, int (*)(DIR *)> entries(directoryPath.empty() ? nullptr : ::opendir(directoryPath.c_str()), &::closedir);
+	if (entries)
+		while (const auto entry = ::readdir(entries.get()))
+		{
+			const auto candidate = directoryPath / entry->d_name;
+			if (entry->d_ino == info.st_ino && isFile(candidate, info))
+				return candidate;
+		}
+	fail("open_by_handle_at", mountPoint, ENOENT);
+#else
+	fail("open_by_handle_at", mountPoint, static_cast<int>(std::errc::operation_not_supported));
+#endif
+}
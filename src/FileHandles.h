@@ -0,0 +1,23 @@
+#pragma once
+
+#include <recpp/filesystem/FileHandle.h>
+
+#include <filesystem>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Get the FileHandle of the file at @p path, without following it if it is a symlink, made of the handles name_to_handle_at gives to the file
+	 * and to its directory.
+	 */
+	FileHandle fileHandle(const std::filesystem::path &path);
+
+	/**
+	 * @brief Get the current path of the file identified by @p handle, on the filesystem containing @p mountPoint, as if by open_by_handle_at.
+	 * <p>
+	 * The path of the file is read from the descriptor open_by_handle_at returns, which is only known while the kernel caches the link between the file
+	 * and its directory. Otherwise, the file is looked for by its inode in its directory, whose path is always known: only a file both moved to another
+	 * directory and evicted from the cache cannot be found.
+	 */
+	std::filesystem::path resolveFileHandle(const FileHandle &handle, const std::filesystem::path &mountPoint);
+} // namespace recpp::filesystem::detail
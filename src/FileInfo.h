@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <system_error>
+
+#include <sys/stat.h>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief The attributes of a file read with a single stat call, which std::filesystem would need several calls to retrieve.
+	 */
+	struct FileInfo
+	{
+		std::filesystem::file_type type;
+		/// The device containing the file
+		std::uintmax_t device;
+		/// The inode of the file on its device, always 0 on Windows
+		std::uintmax_t inode;
+		/// The apparent size of the file, in bytes
+		std::uintmax_t size;
+		/// The size of the blocks allocated to the file, in bytes, which is the apparent size on Windows
+		std::uintmax_t allocatedSize;
+		std::uintmax_t hardLinkCount;
+		/// The time of the last modification of the file, in nanoseconds since the Unix epoch
+		std::int64_t   modificationTime;
+		/// The permissions of the file, without its type
+		std::filesystem::perms permissions;
+		/// The user and the group owning the file, always 0 on Windows
+		std::uintmax_t owner;
+		std::uintmax_t group;
+	};
+
+#ifndef _WIN32
+	/**
+	 * @brief Get the attributes of a file from the result of a POSIX stat call.
+	 */
+	inline FileInfo fileInfo(const struct stat &info)
+	{
+		auto type = std::filesystem::file_type::unknown;
+		if (S_ISREG(info.st_mode))
+			type = std::filesystem::file_type::regular;
+		else if (S_ISDIR(info.st_mode))
+			type = std::filesystem::file_type::directory;
+		else if (S_ISLNK(info.st_mode))
+			type = std::filesystem::file_type::symlink;
+		else if (S_ISBLK(info.st_mode))
+			type = std::filesystem::file_type::block;
+		else if (S_ISCHR(info.st_mode))
+			type = std::filesystem::file_type::character;
+		else if (S_ISFIFO(info.st_mode))
+			type = std::filesystem::file_type::fifo;
+		else if (S_ISSOCK(info.st_mode))
+			type = std::filesystem::file_type::socket;
+#ifdef __APPLE__
+		const auto &modification = info.st_mtimespec;
+#else
+		const auto &modification = info.st_mtim;
+#endif
+		// st_blocks is always counted in 512 bytes units, whatever the block size of the filesystem
+		return FileInfo{type,
+						static_cast<std::uintmax_t>(info.st_dev),
+						static_cast<std::uintmax_t>(info.st_ino),
+						static_cast<std::uintmax_t>(info.st_size),
+						static_cast<std::uintmax_t>(info.st_blocks) * 512,
+						static_cast<std::uintmax_t>(info.st_nlink),
+						static_cast<std::int64_t>(modification.tv_sec) * 1000000000 + modification.tv_nsec,
+						static_cast<std::filesystem::perms>(info.st_mode & 07777),
+						static_cast<std::uintmax_t>(info.st_uid),
+						static_cast<std::uintmax_t>(info.st_gid)};
+	}
+#endif
+
+	/**
+	 * @brief Get the attributes of the file at @p path as if by POSIX lstat, or stat if @p followSymlinks is true, setting @p error and returning
+	 * std::nullopt on failure.
+	 */
+	inline std::optional<FileInfo> fileInfo(const std::filesystem::path &path, bool followSymlinks, std::error_code &error)
+	{
+#ifdef _WIN32
+		// Windows has no symlink aware stat, symlinks are reported by std::filesystem::symlink_status instead
+		struct _stat64 info;
+		if (_wstat64(path.c_str(), &info) != 0)
+		{
+			error = std::error_code(errno, std::generic_category());
+			return std::nullopt;
+		}
+		const auto status = followSymlinks ? std::filesystem::status(path, error) : std::filesystem::symlink_status(path, error);
+		if (error)
+			return std::nullopt;
+		return FileInfo{status.type(),
+						static_cast<std::uintmax_t>(info.st_dev),
+						0,
+						static_cast<std::uintmax_t>(info.st_size),
+						static_cast<std::uintmax_t>(info.st_size),
+						static_cast<std::uintmax_t>(info.st_nlink),
+						static_cast<std::int64_t>(info.st_mtime) * 1000000000,
+						status.permissions(),
+						0,
+						0};
+#else
+		struct stat info;
+		if ((followSymlinks ? ::stat(path.c_str(), &info) : ::lstat(path.c_str(), &info)) != 0)
+		{
+			error = std::error_code(errno, std::generic_category());
+			return std::nullopt;
+		}
+		return fileInfo(info);
+#endif
+	}
+
+	/**
+	 * @brief Get the attributes of the file at @p path as if by POSIX lstat, or stat if @p followSymlinks is true.
+	 */
+	inline FileInfo fileInfo(const std::filesystem::path &path, bool followSymlinks = false)
+	{
+		std::error_code error;
+		const auto		info = fileInfo(path, followSymlinks, error);
+		if (!info)
+			throw std::filesystem::filesystem_error(followSymlinks ? "stat" : "lstat", path, error);
+		return *info;
+	}
+} // namespace recpp::filesystem::detail
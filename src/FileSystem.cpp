@@ -1,7 +1,205 @@
 #include "recpp/filesystem/FileSystem.h"
+#include "ArchiveEngine.h"
+#include "CompressionEngine.h"
+#include "ContentHash.h"
+#include "DirectoryCreator.h"
+#include "DiskUsageScanner.h"
+#include "DuplicateFinder.h"
+#include "FileHandles.h"
+#include "FileTailer.h"
+#include "FileInfo.h"
+#include "GlobMatcher.h"
+#include "InternedWalk.h"
+#include "Parallel.h"
+#include "PathKey.h"
+#include "RecordSplitter.h"
+#include "SparseFile.h"
+#include "SyncEngine.h"
+#include "TextSearcher.h"
+#include "TransactionEngine.h"
+#include "Xattrs.h"
+
+#include <algorithm>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
 
 using namespace recpp::async;
 using namespace recpp::rx;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	void copyTree(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options,
+				  const recpp::filesystem::CancellationToken &token, bool nested)
+	{
+		using std::filesystem::copy_options;
+
+		token.throwIfCancelled();
+		const auto symlinkOptions = copy_options::copy_symlinks | copy_options::skip_symlinks | copy_options::create_symlinks;
+		const auto fromStatus = (options & symlinkOptions) == copy_options::none ? std::filesystem::status(from) : std::filesystem::symlink_status(from);
+
+		// Only directories need to be walked here, std::filesystem::copy handles every other file type and reports the errors of invalid options
+		if (!std::filesystem::is_directory(fromStatus) || (options & copy_options::create_symlinks) != copy_options::none)
+		{
+			std::filesystem::copy(from, to, options);
+			return;
+		}
+
+		// Like std::filesystem::copy, copy_options::none only copies the first level of a directory
+		if ((options & copy_options::recursive) == copy_options::none && (nested || options != copy_options::none))
+			return;
+		if (!std::filesystem::exists(to))
+			std::filesystem::create_directory(to, from);
+		for (const auto &entry : std::filesystem::directory_iterator(from))
+			copyTree(entry.path(), to / entry.path().filename(), options, token, true);
+	}
+
+	std::uintmax_t removeTree(const std::filesystem::path &path, const recpp::filesystem::CancellationToken &token)
+	{
+		token.throwIfCancelled();
+		const auto status = std::filesystem::symlink_status(path);
+		if (!std::filesystem::exists(status))
+			return 0;
+
+		std::uintmax_t count = 0;
+		if (std::filesystem::is_directory(status))
+		{
+			for (const auto &entry : std::filesystem::directory_iterator(path))
+				count += removeTree(entry.path(), token);
+		}
+		token.throwIfCancelled();
+		if (std::filesystem::remove(path))
+			count++;
+		return count;
+	}
+
+	// The device and inode of each directory being walked, from the root down
+	using Ancestors = std::vector<std::pair<std::uintmax_t, std::uintmax_t>>;
+
+	void walkOverlay(const recpp::filesystem::OverlayFileSystem &overlay, const std::filesystem::path &directory,
+					 const std::function<void(const recpp::filesystem::OverlayEntry &entry)> &onEntry,
+					 const std::optional<recpp::filesystem::CancellationToken> &token, Ancestors &ancestors)
+	{
+		if (token)
+			token->throwIfCancelled();
+		for (const auto &entry : overlay.list(directory))
+		{
+			onEntry(entry);
+			if (entry.type != std::filesystem::file_type::directory)
+				continue;
+			// A symlink leading back to a directory being walked is not walked again. Windows has no inodes to tell directories apart
+			const auto info = fileInfo(entry.source, true);
+			const auto identity = std::make_pair(info.device, info.inode);
+			if (info.inode != 0 && std::find(ancestors.begin(), ancestors.end(), identity) != ancestors.end())
+				continue;
+			ancestors.push_back(identity);
+			walkOverlay(overlay, entry.path, onEntry, token, ancestors);
+			ancestors.pop_back();
+		}
+	}
+
+	// Replace each of paths by transform applied to it, by chunks so that the threads do not contend on each path
+	template <typename Transform>
+	std::vector<std::string> transformPaths(std::vector<std::string> paths, unsigned threads, const Transform &transform)
+	{
+		constexpr std::size_t chunkSize = 1024;
+		parallelFor(
+			(paths.size() + chunkSize - 1) / chunkSize,
+			[&paths, &transform](std::size_t chunk)
+			{
+				const auto end = std::min(paths.size(), (chunk + 1) * chunkSize);
+				for (auto i = chunk * chunkSize; i < end; i++)
+					paths[i] = transform(paths[i]);
+			},
+			threads);
+		return paths;
+	}
+
+	// Split the file path read like rxReadFileDecompressed, from backend if there is one, with the RecordSplitter made by makeSplitter when subscribed,
+	// reporting its exceptions as errors
+	template <typename MakeSplitter>
+	Completable readRecords(const std::shared_ptr<recpp::filesystem::FileSystemBackend> &backend, const std::filesystem::path &path,
+							const MakeSplitter &makeSplitter, const recpp::filesystem::RecordOptions &options)
+	{
+		return Completable::defer(
+			[backend, path, makeSplitter, options]()
+			{
+				try
+				{
+					recpp::filesystem::CompressionOptions compressionOptions;
+					compressionOptions.format = options.format;
+					compressionOptions.chunkSize = options.chunkSize;
+					compressionOptions.queueDepth = options.queueDepth;
+					compressionOptions.token = options.token;
+					RecordSplitter splitter = makeSplitter();
+					const auto	   onChunk = [&splitter](std::string_view chunk)
+					{
+						splitter.split(chunk);
+					};
+					if (backend)
+						readDecompressed(*backend, path, onChunk, compressionOptions);
+					else
+						readDecompressed(path, onChunk, compressionOptions);
+					splitter.finish();
+				}
+				catch (const std::exception &)
+				{
+					return Completable::error(std::current_exception());
+				}
+				return Completable::complete();
+			});
+	}
+
+	// Run operation on backend when subscribed, reporting its exceptions as errors
+	template <typename Operation>
+	auto backendSingle(const std::shared_ptr<recpp::filesystem::FileSystemBackend> &backend, const Operation &operation)
+	{
+		using T = std::invoke_result_t<Operation, recpp::filesystem::FileSystemBackend &>;
+		return Single<T>::defer(
+			[backend, operation]()
+			{
+				try
+				{
+					return Single<T>::just(operation(*backend));
+				}
+				catch (const std::exception &)
+				{
+					return Single<T>::error(std::current_exception());
+				}
+			});
+	}
+
+	template <typename Operation>
+	Completable backendCompletable(const std::shared_ptr<recpp::filesystem::FileSystemBackend> &backend, const Operation &operation)
+	{
+		return Completable::defer(
+			[backend, operation]()
+			{
+				try
+				{
+					operation(*backend);
+					return Completable::complete();
+				}
+				catch (const std::exception &)
+				{
+					return Completable::error(std::current_exception());
+				}
+			});
+	}
+
+	// The error of the operations that are not made of the primitives of a FileSystemBackend, when a FileSystem uses one
+	std::exception_ptr unsupported(const char *operation, const std::filesystem::path &path)
+	{
+		return std::make_exception_ptr(std::filesystem::filesystem_error(operation, path, std::make_error_code(std::errc::operation_not_supported)));
+	}
+
+	// The error of the operations that only end when their token is cancelled, when neither their options nor the FileSystem provide one
+	std::exception_ptr untokenized(const char *operation, const std::filesystem::path &path)
+	{
+		return std::make_exception_ptr(std::filesystem::filesystem_error(operation, path, std::make_error_code(std::errc::invalid_argument)));
+	}
+} // namespace
 
 Single<std::filesystem::path> recpp::filesystem::rxAbsolute(const std::filesystem::path &path)
 {
@@ -35,6 +233,22 @@ Single<std::filesystem::path> recpp::filesystem::rxCanonical(const std::filesyst
 		});
 }
 
+Single<std::filesystem::path> recpp::filesystem::rxCanonical(const std::filesystem::path &path, const CanonicalCache &cache)
+{
+	return Single<std::filesystem::path>::defer(
+		[path, cache]()
+		{
+			try
+			{
+				return Single<std::filesystem::path>::just(cache.canonical(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<std::filesystem::path>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
 Single<std::filesystem::path> recpp::filesystem::rxWeaklyCanonical(const std::filesystem::path &path)
 {
 	return Single<std::filesystem::path>::defer(
@@ -51,6 +265,22 @@ Single<std::filesystem::path> recpp::filesystem::rxWeaklyCanonical(const std::fi
 		});
 }
 
+Single<std::filesystem::path> recpp::filesystem::rxWeaklyCanonical(const std::filesystem::path &path, const CanonicalCache &cache)
+{
+	return Single<std::filesystem::path>::defer(
+		[path, cache]()
+		{
+			try
+			{
+				return Single<std::filesystem::path>::just(cache.weaklyCanonical(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<std::filesystem::path>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
 Single<std::filesystem::path> recpp::filesystem::rxRelative(const std::filesystem::path &path, const std::filesystem::path &base)
 {
 	return Single<std::filesystem::path>::defer(
@@ -117,6 +347,24 @@ Completable recpp::filesystem::rxCopy(const std::filesystem::path &from, const s
 		});
 }
 
+Completable recpp::filesystem::rxCopy(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options,
+									  const CancellationToken &token)
+{
+	return Completable::defer(
+		[from, to, options, token]()
+		{
+			try
+			{
+				copyTree(from, to, options, token, false);
+			}
+			catch (const std::exception &)
+			{
+				return Completable::error(std::current_exception());
+			}
+			return Completable::complete();
+		});
+}
+
 Completable recpp::filesystem::rxCopyFile(const std::filesystem::path &from, const std::filesystem::path &to)
 {
 	return Completable::defer(
@@ -216,6 +464,22 @@ Single<bool> recpp::filesystem::rxCreateDirectories(const std::filesystem::path
 		});
 }
 
+Single<std::vector<recpp::filesystem::DirectoryCreation>> recpp::filesystem::rxCreateDirectories(std::vector<std::filesystem::path> paths, unsigned threads)
+{
+	return Single<std::vector<DirectoryCreation>>::defer(
+		[paths = std::move(paths), threads]()
+		{
+			try
+			{
+				return Single<std::vector<DirectoryCreation>>::just(createDirectories(paths, threads));
+			}
+			catch (const std::exception &)
+			{
+				return Single<std::vector<DirectoryCreation>>::error(std::current_exception());
+			}
+		});
+}
+
 Completable recpp::filesystem::rxCreateHardLink(const std::filesystem::path &target, const std::filesystem::path &link)
 {
 	return Completable::defer(
@@ -300,30 +564,42 @@ Completable recpp::filesystem::rxCurrentPath(const std::filesystem::path &path)
 		});
 }
 
-Single<bool> recpp::filesystem::rxExists(const std::filesystem::path &path)
+Single<recpp::filesystem::DiskUsage> recpp::filesystem::rxDiskUsage(const std::filesystem::path &root, const DiskUsageOptions &options)
 {
-	return Single<bool>::defer(
-		[path]()
+	return rxDiskUsage(
+		root,
+		[](const DiskUsage &)
+		{
+		},
+		options);
+}
+
+Single<recpp::filesystem::DiskUsage> recpp::filesystem::rxDiskUsage(const std::filesystem::path &root,
+																	const std::function<void(const DiskUsage &usage)> &onDirectory,
+																	const DiskUsageOptions &options)
+{
+	return Single<DiskUsage>::defer(
+		[root, onDirectory, options]()
 		{
 			try
 			{
-				return Single<bool>::just(std::filesystem::exists(path));
+				return Single<DiskUsage>::just(scanDiskUsage(root, onDirectory, options));
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<bool>::error(std::make_exception_ptr(exception));
+				return Single<DiskUsage>::error(std::current_exception());
 			}
 		});
 }
 
-Single<bool> recpp::filesystem::rxEquivalent(const std::filesystem::path &path1, const std::filesystem::path &path2)
+Single<bool> recpp::filesystem::rxExists(const std::filesystem::path &path)
 {
 	return Single<bool>::defer(
-		[path1, path2]()
+		[path]()
 		{
 			try
 			{
-				return Single<bool>::just(std::filesystem::equivalent(path1, path2));
+				return Single<bool>::just(std::filesystem::exists(path));
 			}
 			catch (const std::exception &exception)
 			{
@@ -332,46 +608,49 @@ Single<bool> recpp::filesystem::rxEquivalent(const std::filesystem::path &path1,
 		});
 }
 
-Single<uintmax_t> recpp::filesystem::rxFileSize(const std::filesystem::path &path)
+Single<bool> recpp::filesystem::rxExists(const std::filesystem::path &path, const OverlayFileSystem &overlay)
 {
-	return Single<uintmax_t>::defer(
-		[path]()
+	return Single<bool>::defer(
+		[path, overlay]()
 		{
 			try
 			{
-				return Single<uintmax_t>::just(std::filesystem::file_size(path));
+				return Single<bool>::just(overlay.resolve(path).has_value());
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<uintmax_t>::error(std::make_exception_ptr(exception));
+				return Single<bool>::error(std::current_exception());
 			}
 		});
 }
 
-Single<uintmax_t> recpp::filesystem::rxHardLinkCount(const std::filesystem::path &path)
+Single<recpp::filesystem::OverlayEntry> recpp::filesystem::rxResolve(const std::filesystem::path &path, const OverlayFileSystem &overlay)
 {
-	return Single<uintmax_t>::defer(
-		[path]()
+	return Single<OverlayEntry>::defer(
+		[path, overlay]()
 		{
 			try
 			{
-				return Single<uintmax_t>::just(std::filesystem::hard_link_count(path));
+				auto entry = overlay.resolve(path);
+				if (!entry)
+					throw std::filesystem::filesystem_error("overlay resolve", path, std::make_error_code(std::errc::no_such_file_or_directory));
+				return Single<OverlayEntry>::just(std::move(*entry));
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<uintmax_t>::error(std::make_exception_ptr(exception));
+				return Single<OverlayEntry>::error(std::current_exception());
 			}
 		});
 }
 
-Single<bool> recpp::filesystem::rxIsBlockFile(const std::filesystem::path &path)
+Single<bool> recpp::filesystem::rxEquivalent(const std::filesystem::path &path1, const std::filesystem::path &path2)
 {
 	return Single<bool>::defer(
-		[path]()
+		[path1, path2]()
 		{
 			try
 			{
-				return Single<bool>::just(std::filesystem::is_block_file(path));
+				return Single<bool>::just(std::filesystem::equivalent(path1, path2));
 			}
 			catch (const std::exception &exception)
 			{
@@ -380,549 +659,2539 @@ Single<bool> recpp::filesystem::rxIsBlockFile(const std::filesystem::path &path)
 		});
 }
 
-Single<bool> recpp::filesystem::rxIsCharacterFile(const std::filesystem::path &path)
+Single<uintmax_t> recpp::filesystem::rxFileSize(const std::filesystem::path &path)
 {
-	return Single<bool>::defer(
+	return Single<uintmax_t>::defer(
 		[path]()
 		{
 			try
 			{
-				return Single<bool>::just(std::filesystem::is_character_file(path));
+				return Single<uintmax_t>::just(std::filesystem::file_size(path));
 			}
 			catch (const std::exception &exception)
 			{
-				return Single<bool>::error(std::make_exception_ptr(exception));
+				return Single<uintmax_t>::error(std::make_exception_ptr(exception));
 			}
 		});
 }
 
-Single<bool> recpp::filesystem::rxIsDirectory(const std::filesystem::path &path)
+Completable recpp::filesystem::rxFindDuplicates(const std::vector<std::filesystem::path> &roots,
+												const std::function<void(const DuplicateGroup &group)> &onGroup, const DuplicateOptions &options)
 {
-	return Single<bool>::defer(
-		[path]()
+	return Completable::defer(
+		[roots, onGroup, options]()
 		{
 			try
 			{
-				return Single<bool>::just(std::filesystem::is_directory(path));
+				findDuplicates(roots, onGroup, options);
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<bool>::error(std::make_exception_ptr(exception));
+				return Completable::error(std::current_exception());
 			}
+			return Completable::complete();
 		});
 }
 
-Single<bool> recpp::filesystem::rxIsEmpty(const std::filesystem::path &path)
+Single<std::vector<std::filesystem::path>> recpp::filesystem::rxGlob(const std::string &pattern, const GlobOptions &options)
 {
-	return Single<bool>::defer(
-		[path]()
+	return Single<std::vector<std::filesystem::path>>::defer(
+		[pattern, options]()
 		{
 			try
 			{
-				return Single<bool>::just(std::filesystem::is_empty(path));
+				std::vector<std::filesystem::path> paths;
+				glob(
+					pattern,
+					[&paths](const std::filesystem::path &path)
+					{
+						paths.push_back(path);
+					},
+					options);
+				std::sort(paths.begin(), paths.end());
+				return Single<std::vector<std::filesystem::path>>::just(std::move(paths));
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<bool>::error(std::make_exception_ptr(exception));
+				return Single<std::vector<std::filesystem::path>>::error(std::current_exception());
 			}
 		});
 }
 
-Single<bool> recpp::filesystem::rxIsFifo(const std::filesystem::path &path)
+Completable recpp::filesystem::rxGlob(const std::string &pattern, const std::function<void(const std::filesystem::path &path)> &onMatch,
+									  const GlobOptions &options)
 {
-	return Single<bool>::defer(
-		[path]()
+	return Completable::defer(
+		[pattern, onMatch, options]()
 		{
 			try
 			{
-				return Single<bool>::just(std::filesystem::is_fifo(path));
+				glob(pattern, onMatch, options);
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<bool>::error(std::make_exception_ptr(exception));
+				return Completable::error(std::current_exception());
 			}
+			return Completable::complete();
 		});
 }
 
-Single<bool> recpp::filesystem::rxIsOther(const std::filesystem::path &path)
+Single<std::vector<recpp::filesystem::GrepMatch>> recpp::filesystem::rxGrep(const std::filesystem::path &root, const std::string &pattern,
+																			const GrepOptions &options)
 {
-	return Single<bool>::defer(
-		[path]()
+	return Single<std::vector<GrepMatch>>::defer(
+		[root, pattern, options]()
 		{
 			try
 			{
-				return Single<bool>::just(std::filesystem::is_other(path));
-			}
-			catch (const std::exception &exception)
-			{
-				return Single<bool>::error(std::make_exception_ptr(exception));
+				std::vector<GrepMatch> matches;
+				grep(
+					root, pattern,
+					[&matches](const GrepMatch &match)
+					{
+						matches.push_back(match);
+					},
+					options);
+				std::sort(matches.begin(), matches.end(),
+						  [](const GrepMatch &match1, const GrepMatch &match2)
+						  {
+							  return std::tie(match1.path, match1.lineNumber) < std::tie(match2.path, match2.lineNumber);
+						  });
+				return Single<std::vector<GrepMatch>>::just(std::move(matches));
+			}
+			catch (const std::exception &)
+			{
+				return Single<std::vector<GrepMatch>>::error(std::current_exception());
 			}
 		});
 }
 
-Single<bool> recpp::filesystem::rxIsRegularFile(const std::filesystem::path &path)
+Completable recpp::filesystem::rxGrep(const std::filesystem::path &root, const std::string &pattern,
+									  const std::function<void(const GrepMatch &match)> &onMatch, const GrepOptions &options)
 {
-	return Single<bool>::defer(
-		[path]()
+	return Completable::defer(
+		[root, pattern, onMatch, options]()
 		{
 			try
 			{
-				return Single<bool>::just(std::filesystem::is_regular_file(path));
+				grep(root, pattern, onMatch, options);
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<bool>::error(std::make_exception_ptr(exception));
+				return Completable::error(std::current_exception());
 			}
+			return Completable::complete();
 		});
 }
 
-Single<bool> recpp::filesystem::rxIsSocket(const std::filesystem::path &path)
+Single<std::vector<std::string>> recpp::filesystem::rxLexicallyNormal(std::vector<std::string> paths, unsigned threads)
 {
-	return Single<bool>::defer(
-		[path]()
+	return Single<std::vector<std::string>>::defer(
+		[paths = std::move(paths), threads]()
 		{
 			try
 			{
-				return Single<bool>::just(std::filesystem::is_socket(path));
+				return Single<std::vector<std::string>>::just(transformPaths(paths, threads, lexical::normalize));
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<bool>::error(std::make_exception_ptr(exception));
+				return Single<std::vector<std::string>>::error(std::current_exception());
 			}
 		});
 }
 
-Single<bool> recpp::filesystem::rxIsSymlink(const std::filesystem::path &path)
+Single<std::vector<std::string>> recpp::filesystem::rxLexicallyRelative(std::vector<std::string> paths, const std::string &base, unsigned threads)
 {
-	return Single<bool>::defer(
-		[path]()
+	return Single<std::vector<std::string>>::defer(
+		[paths = std::move(paths), base, threads]()
 		{
 			try
 			{
-				return Single<bool>::just(std::filesystem::is_symlink(path));
+				return Single<std::vector<std::string>>::just(transformPaths(paths, threads,
+																			 [&base](const std::string &path)
+																			 {
+																				 return lexical::relative(path, base);
+																			 }));
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<bool>::error(std::make_exception_ptr(exception));
+				return Single<std::vector<std::string>>::error(std::current_exception());
 			}
 		});
 }
 
-Single<std::filesystem::file_time_type> recpp::filesystem::rxLastWriteTime(const std::filesystem::path &path)
+Completable recpp::filesystem::rxWalk(const std::filesystem::path &root, PathTable &table,
+									  const std::function<void(PathTable::Id id, std::filesystem::file_type type)> &onEntry, const WalkOptions &options)
 {
-	return Single<std::filesystem::file_time_type>::defer(
-		[path]()
+	return Completable::defer(
+		[root, table, onEntry, options]() mutable
 		{
 			try
 			{
-				return Single<std::filesystem::file_time_type>::just(std::filesystem::last_write_time(path));
+				walkInterned(root, table, onEntry, options);
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<std::filesystem::file_time_type>::error(std::make_exception_ptr(exception));
+				return Completable::error(std::current_exception());
 			}
+			return Completable::complete();
 		});
 }
 
-Completable recpp::filesystem::rxLastWriteTime(const std::filesystem::path &path, std::filesystem::file_time_type newTime)
+Completable recpp::filesystem::rxWalk(const std::filesystem::path &root, const OverlayFileSystem &overlay,
+									  const std::function<void(const OverlayEntry &entry)> &onEntry, const std::optional<CancellationToken> &token)
 {
 	return Completable::defer(
-		[path, newTime]()
+		[root, overlay, onEntry, token]()
 		{
 			try
 			{
-				std::filesystem::last_write_time(path, newTime);
+				Ancestors  ancestors;
+				const auto entry = overlay.resolve(root);
+				if (entry && entry->type == std::filesystem::file_type::directory)
+				{
+					const auto info = fileInfo(entry->source, true);
+					ancestors.emplace_back(info.device, info.inode);
+				}
+				walkOverlay(overlay, root, onEntry, token, ancestors);
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Completable::error(std::make_exception_ptr(exception));
+				return Completable::error(std::current_exception());
 			}
 			return Completable::complete();
 		});
 }
 
-Completable recpp::filesystem::rxPermissions(const std::filesystem::path &path, std::filesystem::perms permissions, std::filesystem::perm_options options)
+Completable recpp::filesystem::rxCommit(const FileSystemTransaction &transaction, const TransactionOptions &options)
 {
 	return Completable::defer(
-		[path, permissions, options]()
+		[operations = transaction.operations(), options]()
 		{
 			try
 			{
-				std::filesystem::permissions(path, permissions, options);
+				commitTransaction(operations, options);
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Completable::error(std::make_exception_ptr(exception));
+				return Completable::error(std::current_exception());
 			}
 			return Completable::complete();
 		});
 }
 
-Single<std::filesystem::path> recpp::filesystem::rxReadSymlink(const std::filesystem::path &path)
+Completable recpp::filesystem::rxRecoverTransaction(const std::filesystem::path &journal)
 {
-	return Single<std::filesystem::path>::defer(
-		[path]()
+	return Completable::defer(
+		[journal]()
 		{
 			try
 			{
-				return Single<std::filesystem::path>::just(std::filesystem::read_symlink(path));
+				recoverTransaction(journal);
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<std::filesystem::path>::error(std::make_exception_ptr(exception));
+				return Completable::error(std::current_exception());
 			}
+			return Completable::complete();
 		});
 }
 
-Single<bool> recpp::filesystem::rxRemove(const std::filesystem::path &path)
+Completable recpp::filesystem::rxPackTar(const std::filesystem::path &root, const std::filesystem::path &archive, const ArchiveOptions &options)
 {
-	return Single<bool>::defer(
-		[path]()
+	return rxPackTar(
+		root, archive,
+		[](const ArchiveEntry &)
 		{
-			try
-			{
-				return Single<bool>::just(std::filesystem::remove(path));
-			}
-			catch (const std::exception &exception)
-			{
-				return Single<bool>::error(std::make_exception_ptr(exception));
-			}
-		});
+		},
+		options);
 }
 
-Single<uintmax_t> recpp::filesystem::rxRemoveAll(const std::filesystem::path &path)
+Completable recpp::filesystem::rxPackTar(const std::filesystem::path &root, const std::filesystem::path &archive,
+										 const std::function<void(const ArchiveEntry &entry)> &onEntry, const ArchiveOptions &options)
 {
-	return Single<uintmax_t>::defer(
-		[path]()
+	return Completable::defer(
+		[root, archive, onEntry, options]()
 		{
 			try
 			{
-				return Single<uintmax_t>::just(std::filesystem::remove_all(path));
+				packTar(root, archive, onEntry, options);
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<uintmax_t>::error(std::make_exception_ptr(exception));
+				return Completable::error(std::current_exception());
 			}
+			return Completable::complete();
 		});
 }
 
-Completable recpp::filesystem::rxRename(const std::filesystem::path &oldPath, const std::filesystem::path &newPath)
+Completable recpp::filesystem::rxUnpackTar(const std::filesystem::path &archive, const std::filesystem::path &destination, const ArchiveOptions &options)
+{
+	return rxUnpackTar(
+		archive, destination,
+		[](const ArchiveEntry &)
+		{
+		},
+		options);
+}
+
+Completable recpp::filesystem::rxUnpackTar(const std::filesystem::path &archive, const std::filesystem::path &destination,
+										   const std::function<void(const ArchiveEntry &entry)> &onEntry, const ArchiveOptions &options)
 {
 	return Completable::defer(
-		[oldPath, newPath]()
+		[archive, destination, onEntry, options]()
 		{
 			try
 			{
-				std::filesystem::rename(oldPath, newPath);
-				return Completable::complete();
+				unpackTar(archive, destination, onEntry, options);
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Completable::error(std::make_exception_ptr(exception));
+				return Completable::error(std::current_exception());
 			}
+			return Completable::complete();
 		});
 }
 
-Completable recpp::filesystem::rxResizeFile(const std::filesystem::path &path, std::uintmax_t newSize)
+Completable recpp::filesystem::rxUnpackZip(const std::filesystem::path &archive, const std::filesystem::path &destination, const ArchiveOptions &options)
+{
+	return rxUnpackZip(
+		archive, destination,
+		[](const ArchiveEntry &)
+		{
+		},
+		options);
+}
+
+Completable recpp::filesystem::rxUnpackZip(const std::filesystem::path &archive, const std::filesystem::path &destination,
+										   const std::function<void(const ArchiveEntry &entry)> &onEntry, const ArchiveOptions &options)
 {
 	return Completable::defer(
-		[path, newSize]()
+		[archive, destination, onEntry, options]()
 		{
 			try
 			{
-				std::filesystem::resize_file(path, newSize);
+				unpackZip(archive, destination, onEntry, options);
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Completable::error(std::make_exception_ptr(exception));
+				return Completable::error(std::current_exception());
 			}
 			return Completable::complete();
 		});
 }
 
-Single<std::filesystem::space_info> recpp::filesystem::rxSpace(const std::filesystem::path &path)
+Single<std::string> recpp::filesystem::rxReadFileDecompressed(const std::filesystem::path &path, const CompressionOptions &options)
 {
-	return Single<std::filesystem::space_info>::defer(
-		[path]()
+	return Single<std::string>::defer(
+		[path, options]()
 		{
 			try
 			{
-				return Single<std::filesystem::space_info>::just(std::filesystem::space(path));
+				std::string contents;
+				readDecompressed(
+					path,
+					[&contents](std::string_view chunk)
+					{
+						contents.append(chunk);
+					},
+					options);
+				return Single<std::string>::just(std::move(contents));
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<std::filesystem::space_info>::error(std::make_exception_ptr(exception));
+				return Single<std::string>::error(std::current_exception());
 			}
 		});
 }
 
-Single<std::filesystem::file_status> recpp::filesystem::rxStatus(const std::filesystem::path &path)
+Completable recpp::filesystem::rxReadFileDecompressed(const std::filesystem::path &path, const std::function<void(std::string_view chunk)> &onChunk,
+													  const CompressionOptions &options)
 {
-	return Single<std::filesystem::file_status>::defer(
-		[path]()
+	return Completable::defer(
+		[path, onChunk, options]()
 		{
 			try
 			{
-				return Single<std::filesystem::file_status>::just(std::filesystem::status(path));
+				readDecompressed(path, onChunk, options);
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<std::filesystem::file_status>::error(std::make_exception_ptr(exception));
+				return Completable::error(std::current_exception());
 			}
+			return Completable::complete();
 		});
 }
 
-Single<std::filesystem::file_status> recpp::filesystem::rxSymlinkStatus(const std::filesystem::path &path)
+Completable recpp::filesystem::rxWriteFileCompressed(const std::filesystem::path &path, std::string contents, const CompressionOptions &options)
 {
-	return Single<std::filesystem::file_status>::defer(
-		[path]()
+	return Completable::defer(
+		[path, contents = std::move(contents), options]()
 		{
 			try
 			{
-				return Single<std::filesystem::file_status>::just(symlink_status(path));
+				std::size_t position = 0;
+				writeCompressed(
+					path,
+					[&contents, &position](char *data, std::size_t size)
+					{
+						const auto count = contents.copy(data, size, position);
+						position += count;
+						return count;
+					},
+					options);
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<std::filesystem::file_status>::error(std::make_exception_ptr(exception));
+				return Completable::error(std::current_exception());
 			}
+			return Completable::complete();
 		});
 }
 
-Single<std::filesystem::path> recpp::filesystem::rxTempDirectoryPath()
+Completable recpp::filesystem::rxWriteFileCompressed(const std::filesystem::path &path, const std::function<std::size_t(char *data, std::size_t size)> &source,
+													 const CompressionOptions &options)
 {
-	return Single<std::filesystem::path>::defer(
-		[]()
+	return Completable::defer(
+		[path, source, options]()
 		{
 			try
 			{
-				return Single<std::filesystem::path>::just(std::filesystem::temp_directory_path());
+				writeCompressed(path, source, options);
 			}
-			catch (const std::exception &exception)
+			catch (const std::exception &)
 			{
-				return Single<std::filesystem::path>::error(std::make_exception_ptr(exception));
+				return Completable::error(std::current_exception());
 			}
+			return Completable::complete();
 		});
 }
 
-recpp::filesystem::FileSystem::FileSystem(Scheduler &scheduler)
-	: m_scheduler(scheduler)
+Completable recpp::filesystem::rxReadLines(const std::filesystem::path &path, const std::function<void(std::string_view line)> &onLine,
+										   const RecordOptions &options)
 {
+	return readRecords(
+		nullptr, path,
+		[onLine]()
+		{
+			return RecordSplitter('\n', true, onLine);
+		},
+		options);
 }
 
-Single<std::filesystem::path> recpp::filesystem::FileSystem::rxAbsolute(const std::filesystem::path &path) const
+Completable recpp::filesystem::rxReadRecords(const std::filesystem::path &path, char delimiter, const std::function<void(std::string_view record)> &onRecord,
+											 const RecordOptions &options)
 {
-	return recpp::filesystem::rxAbsolute(path).subscribeOn(m_scheduler);
+	return readRecords(
+		nullptr, path,
+		[delimiter, onRecord]()
+		{
+			return RecordSplitter(delimiter, false, onRecord);
+		},
+		options);
 }
 
-Single<std::filesystem::path> recpp::filesystem::FileSystem::rxCanonical(const std::filesystem::path &path) const
+Completable recpp::filesystem::rxReadFixedSizeRecords(const std::filesystem::path &path, std::size_t recordSize,
+													  const std::function<void(std::string_view record)> &onRecord, const RecordOptions &options)
 {
-	return recpp::filesystem::rxCanonical(path).subscribeOn(m_scheduler);
+	return readRecords(
+		nullptr, path,
+		[recordSize, onRecord]()
+		{
+			return RecordSplitter(recordSize, onRecord);
+		},
+		options);
 }
 
-Single<std::filesystem::path> recpp::filesystem::FileSystem::rxWeaklyCanonical(const std::filesystem::path &path) const
+Completable recpp::filesystem::rxTail(const std::filesystem::path &path, std::uintmax_t startPosition,
+									  const std::function<void(const TailData &data)> &onData, const TailOptions &options)
 {
-	return recpp::filesystem::rxWeaklyCanonical(path).subscribeOn(m_scheduler);
-}
-
-Single<std::filesystem::path> recpp::filesystem::FileSystem::rxRelative(const std::filesystem::path &path, const std::filesystem::path &base) const
+	return Completable::defer(
+		[path, startPosition, onData, options]()
+		{
+			try
+			{
+				tailFile(path, startPosition, onData, options);
+			}
+			catch (const std::exception &)
+			{
+				return Completable::error(std::current_exception());
+			}
+			return Completable::complete();
+		});
+}
+
+Completable recpp::filesystem::rxTailLines(const std::filesystem::path &path, std::uintmax_t startPosition,
+										   const std::function<void(const TailData &line)> &onLine, const TailOptions &options)
+{
+	return Completable::defer(
+		[path, startPosition, onLine, options]()
+		{
+			try
+			{
+				tailLines(path, startPosition, onLine, options);
+			}
+			catch (const std::exception &)
+			{
+				return Completable::error(std::current_exception());
+			}
+			return Completable::complete();
+		});
+}
+
+Single<std::string> recpp::filesystem::rxGetXattr(const std::filesystem::path &path, const std::string &name)
+{
+	return Single<std::string>::defer(
+		[path, name]()
+		{
+			try
+			{
+				return Single<std::string>::just(getXattr(path, name));
+			}
+			catch (const std::exception &)
+			{
+				return Single<std::string>::error(std::current_exception());
+			}
+		});
+}
+
+Completable recpp::filesystem::rxSetXattr(const std::filesystem::path &path, const std::string &name, std::string value, XattrMode mode)
+{
+	return Completable::defer(
+		[path, name, value = std::move(value), mode]()
+		{
+			try
+			{
+				setXattr(path, name, value, mode);
+			}
+			catch (const std::exception &)
+			{
+				return Completable::error(std::current_exception());
+			}
+			return Completable::complete();
+		});
+}
+
+Completable recpp::filesystem::rxRemoveXattr(const std::filesystem::path &path, const std::string &name)
+{
+	return Completable::defer(
+		[path, name]()
+		{
+			try
+			{
+				removeXattr(path, name);
+			}
+			catch (const std::exception &)
+			{
+				return Completable::error(std::current_exception());
+			}
+			return Completable::complete();
+		});
+}
+
+Single<std::vector<std::string>> recpp::filesystem::rxListXattrs(const std::filesystem::path &path)
+{
+	return Single<std::vector<std::string>>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<std::vector<std::string>>::just(listXattrs(path));
+			}
+			catch (const std::exception &)
+			{
+				return Single<std::vector<std::string>>::error(std::current_exception());
+			}
+		});
+}
+
+Single<std::vector<recpp::filesystem::FileXattrs>> recpp::filesystem::rxGetXattrs(std::vector<std::filesystem::path> paths, std::vector<std::string> names,
+																				  unsigned threads)
+{
+	return Single<std::vector<FileXattrs>>::defer(
+		[paths = std::move(paths), names = std::move(names), threads]()
+		{
+			try
+			{
+				return Single<std::vector<FileXattrs>>::just(getXattrs(paths, names, threads));
+			}
+			catch (const std::exception &)
+			{
+				return Single<std::vector<FileXattrs>>::error(std::current_exception());
+			}
+		});
+}
+
+Single<recpp::filesystem::FileHandle> recpp::filesystem::rxFileHandle(const std::filesystem::path &path)
+{
+	return Single<FileHandle>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<FileHandle>::just(fileHandle(path));
+			}
+			catch (const std::exception &)
+			{
+				return Single<FileHandle>::error(std::current_exception());
+			}
+		});
+}
+
+Single<std::filesystem::path> recpp::filesystem::rxResolveFileHandle(const FileHandle &handle, const std::filesystem::path &mountPoint)
+{
+	return Single<std::filesystem::path>::defer(
+		[handle, mountPoint]()
+		{
+			try
+			{
+				return Single<std::filesystem::path>::just(resolveFileHandle(handle, mountPoint));
+			}
+			catch (const std::exception &)
+			{
+				return Single<std::filesystem::path>::error(std::current_exception());
+			}
+		});
+}
+
+Single<uintmax_t> recpp::filesystem::rxHardLinkCount(const std::filesystem::path &path)
+{
+	return Single<uintmax_t>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<uintmax_t>::just(std::filesystem::hard_link_count(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<uintmax_t>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<recpp::filesystem::Digest> recpp::filesystem::rxHashFile(const std::filesystem::path &path, HashAlgorithm algorithm)
+{
+	return Single<Digest>::defer(
+		[path, algorithm]()
+		{
+			try
+			{
+				return Single<Digest>::just(hashFile(path, algorithm));
+			}
+			catch (const std::exception &)
+			{
+				return Single<Digest>::error(std::current_exception());
+			}
+		});
+}
+
+Single<recpp::filesystem::Digest> recpp::filesystem::rxHashTree(const std::filesystem::path &root, HashAlgorithm algorithm)
+{
+	return Single<Digest>::defer(
+		[root, algorithm]()
+		{
+			try
+			{
+				return Single<Digest>::just(hashTree(root, algorithm));
+			}
+			catch (const std::exception &)
+			{
+				return Single<Digest>::error(std::current_exception());
+			}
+		});
+}
+
+Single<recpp::filesystem::MetadataIndex> recpp::filesystem::rxBuildIndex(const std::filesystem::path &root, const MetadataIndexOptions &options)
+{
+	return Single<MetadataIndex>::defer(
+		[root, options]()
+		{
+			try
+			{
+				return Single<MetadataIndex>::just(MetadataIndex::build(root, options));
+			}
+			catch (const std::exception &)
+			{
+				return Single<MetadataIndex>::error(std::current_exception());
+			}
+		});
+}
+
+Single<recpp::filesystem::MetadataIndex> recpp::filesystem::rxOpenIndex(const std::filesystem::path &file)
+{
+	return Single<MetadataIndex>::defer(
+		[file]()
+		{
+			try
+			{
+				return Single<MetadataIndex>::just(MetadataIndex::open(file));
+			}
+			catch (const std::exception &)
+			{
+				return Single<MetadataIndex>::error(std::current_exception());
+			}
+		});
+}
+
+Single<recpp::filesystem::MetadataIndex> recpp::filesystem::rxRefreshIndex(const MetadataIndex &index, const MetadataIndexOptions &options)
+{
+	return Single<MetadataIndex>::defer(
+		[index, options]()
+		{
+			try
+			{
+				return Single<MetadataIndex>::just(index.refresh(options));
+			}
+			catch (const std::exception &)
+			{
+				return Single<MetadataIndex>::error(std::current_exception());
+			}
+		});
+}
+
+Completable recpp::filesystem::rxWriteIndex(const MetadataIndex &index, const std::filesystem::path &file)
+{
+	return Completable::defer(
+		[index, file]()
+		{
+			try
+			{
+				index.write(file);
+			}
+			catch (const std::exception &)
+			{
+				return Completable::error(std::current_exception());
+			}
+			return Completable::complete();
+		});
+}
+
+Single<bool> recpp::filesystem::rxIsBlockFile(const std::filesystem::path &path)
+{
+	return Single<bool>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<bool>::just(std::filesystem::is_block_file(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<bool>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<bool> recpp::filesystem::rxIsCharacterFile(const std::filesystem::path &path)
+{
+	return Single<bool>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<bool>::just(std::filesystem::is_character_file(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<bool>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<bool> recpp::filesystem::rxIsDirectory(const std::filesystem::path &path)
+{
+	return Single<bool>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<bool>::just(std::filesystem::is_directory(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<bool>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<bool> recpp::filesystem::rxIsEmpty(const std::filesystem::path &path)
+{
+	return Single<bool>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<bool>::just(std::filesystem::is_empty(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<bool>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<bool> recpp::filesystem::rxIsFifo(const std::filesystem::path &path)
+{
+	return Single<bool>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<bool>::just(std::filesystem::is_fifo(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<bool>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<bool> recpp::filesystem::rxIsOther(const std::filesystem::path &path)
+{
+	return Single<bool>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<bool>::just(std::filesystem::is_other(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<bool>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<bool> recpp::filesystem::rxIsRegularFile(const std::filesystem::path &path)
+{
+	return Single<bool>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<bool>::just(std::filesystem::is_regular_file(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<bool>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<bool> recpp::filesystem::rxIsSocket(const std::filesystem::path &path)
+{
+	return Single<bool>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<bool>::just(std::filesystem::is_socket(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<bool>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<bool> recpp::filesystem::rxIsSymlink(const std::filesystem::path &path)
+{
+	return Single<bool>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<bool>::just(std::filesystem::is_symlink(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<bool>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<std::filesystem::file_time_type> recpp::filesystem::rxLastWriteTime(const std::filesystem::path &path)
+{
+	return Single<std::filesystem::file_time_type>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<std::filesystem::file_time_type>::just(std::filesystem::last_write_time(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<std::filesystem::file_time_type>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Completable recpp::filesystem::rxLastWriteTime(const std::filesystem::path &path, std::filesystem::file_time_type newTime)
+{
+	return Completable::defer(
+		[path, newTime]()
+		{
+			try
+			{
+				std::filesystem::last_write_time(path, newTime);
+			}
+			catch (const std::exception &exception)
+			{
+				return Completable::error(std::make_exception_ptr(exception));
+			}
+			return Completable::complete();
+		});
+}
+
+Completable recpp::filesystem::rxPermissions(const std::filesystem::path &path, std::filesystem::perms permissions, std::filesystem::perm_options options)
+{
+	return Completable::defer(
+		[path, permissions, options]()
+		{
+			try
+			{
+				std::filesystem::permissions(path, permissions, options);
+			}
+			catch (const std::exception &exception)
+			{
+				return Completable::error(std::make_exception_ptr(exception));
+			}
+			return Completable::complete();
+		});
+}
+
+Single<std::filesystem::path> recpp::filesystem::rxReadSymlink(const std::filesystem::path &path)
+{
+	return Single<std::filesystem::path>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<std::filesystem::path>::just(std::filesystem::read_symlink(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<std::filesystem::path>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<bool> recpp::filesystem::rxRemove(const std::filesystem::path &path)
+{
+	return Single<bool>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<bool>::just(std::filesystem::remove(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<bool>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<uintmax_t> recpp::filesystem::rxRemoveAll(const std::filesystem::path &path)
+{
+	return Single<uintmax_t>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<uintmax_t>::just(std::filesystem::remove_all(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<uintmax_t>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<uintmax_t> recpp::filesystem::rxRemoveAll(const std::filesystem::path &path, const CancellationToken &token)
+{
+	return Single<uintmax_t>::defer(
+		[path, token]()
+		{
+			try
+			{
+				return Single<uintmax_t>::just(removeTree(path, token));
+			}
+			catch (const std::exception &)
+			{
+				return Single<uintmax_t>::error(std::current_exception());
+			}
+		});
+}
+
+Completable recpp::filesystem::rxRename(const std::filesystem::path &oldPath, const std::filesystem::path &newPath)
+{
+	return Completable::defer(
+		[oldPath, newPath]()
+		{
+			try
+			{
+				std::filesystem::rename(oldPath, newPath);
+				return Completable::complete();
+			}
+			catch (const std::exception &exception)
+			{
+				return Completable::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Completable recpp::filesystem::rxResizeFile(const std::filesystem::path &path, std::uintmax_t newSize)
+{
+	return Completable::defer(
+		[path, newSize]()
+		{
+			try
+			{
+				std::filesystem::resize_file(path, newSize);
+			}
+			catch (const std::exception &exception)
+			{
+				return Completable::error(std::make_exception_ptr(exception));
+			}
+			return Completable::complete();
+		});
+}
+
+Completable recpp::filesystem::rxAllocate(const std::filesystem::path &path, std::uintmax_t offset, std::uintmax_t length, AllocationMode mode)
+{
+	return Completable::defer(
+		[path, offset, length, mode]()
+		{
+			try
+			{
+				allocate(path, offset, length, mode);
+			}
+			catch (const std::exception &)
+			{
+				return Completable::error(std::current_exception());
+			}
+			return Completable::complete();
+		});
+}
+
+Single<std::vector<recpp::filesystem::DataSegment>> recpp::filesystem::rxDataSegments(const std::filesystem::path &path)
+{
+	return Single<std::vector<DataSegment>>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<std::vector<DataSegment>>::just(dataSegments(path));
+			}
+			catch (const std::exception &)
+			{
+				return Single<std::vector<DataSegment>>::error(std::current_exception());
+			}
+		});
+}
+
+Single<std::filesystem::space_info> recpp::filesystem::rxSpace(const std::filesystem::path &path)
+{
+	return Single<std::filesystem::space_info>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<std::filesystem::space_info>::just(std::filesystem::space(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<std::filesystem::space_info>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<std::filesystem::file_status> recpp::filesystem::rxStatus(const std::filesystem::path &path)
+{
+	return Single<std::filesystem::file_status>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<std::filesystem::file_status>::just(std::filesystem::status(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<std::filesystem::file_status>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Single<std::filesystem::file_status> recpp::filesystem::rxSymlinkStatus(const std::filesystem::path &path)
+{
+	return Single<std::filesystem::file_status>::defer(
+		[path]()
+		{
+			try
+			{
+				return Single<std::filesystem::file_status>::just(symlink_status(path));
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<std::filesystem::file_status>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+Completable recpp::filesystem::rxSync(const std::filesystem::path &source, const std::filesystem::path &destination, const SyncOptions &options)
+{
+	return rxSync(
+		source, destination,
+		[](const SyncAction &)
+		{
+		},
+		options);
+}
+
+Completable recpp::filesystem::rxSync(const std::filesystem::path &source, const std::filesystem::path &destination,
+									  const std::function<void(const SyncAction &action)> &onAction, const SyncOptions &options)
+{
+	return Completable::defer(
+		[source, destination, onAction, options]()
+		{
+			try
+			{
+				syncTrees(source, destination, onAction, options);
+			}
+			catch (const std::exception &)
+			{
+				return Completable::error(std::current_exception());
+			}
+			return Completable::complete();
+		});
+}
+
+Single<std::filesystem::path> recpp::filesystem::rxTempDirectoryPath()
 {
-	return recpp::filesystem::rxRelative(path, base).subscribeOn(m_scheduler);
+	return Single<std::filesystem::path>::defer(
+		[]()
+		{
+			try
+			{
+				return Single<std::filesystem::path>::just(std::filesystem::temp_directory_path());
+			}
+			catch (const std::exception &exception)
+			{
+				return Single<std::filesystem::path>::error(std::make_exception_ptr(exception));
+			}
+		});
+}
+
+recpp::filesystem::FileSystem::FileSystem(Scheduler &scheduler)
+	: m_scheduler(scheduler)
+{
+}
+
+recpp::filesystem::FileSystem::FileSystem(IoScheduler &ioScheduler)
+	: m_scheduler(ioScheduler.scheduler(IoPriority::interactive))
+	, m_ioScheduler(&ioScheduler)
+{
+}
+
+recpp::filesystem::FileSystem recpp::filesystem::FileSystem::withPriority(IoPriority priority) const
+{
+	auto fileSystem = *this;
+	fileSystem.m_priority = priority;
+	return fileSystem;
+}
+
+recpp::filesystem::FileSystem recpp::filesystem::FileSystem::withConcurrencyLimiter(const std::filesystem::path &mountPoint,
+																					 const std::shared_ptr<ConcurrencyLimiter> &limiter) const
+{
+	auto  fileSystem = *this;
+	auto  key = lexicalKey(mountPoint);
+	auto &limiters = fileSystem.m_limiters;
+
+	// Keep the longest mount points first so that nested mounts win over their parents
+	auto position = limiters.begin();
+	while (position != limiters.end() && position->mountPoint.size() >= key.size())
+	{
+		if (position->mountPoint == key)
+			position = limiters.erase(position);
+		else
+			++position;
+	}
+	if (limiter)
+		limiters.insert(position, MountLimiter{std::move(key), limiter});
+	return fileSystem;
+}
+
+recpp::filesystem::FileSystem recpp::filesystem::FileSystem::withCancellation(const CancellationToken &token) const
+{
+	auto fileSystem = *this;
+	fileSystem.m_cancellationToken = token;
+	return fileSystem;
+}
+
+recpp::filesystem::FileSystem recpp::filesystem::FileSystem::withCanonicalCache(const CanonicalCache &cache) const
+{
+	auto fileSystem = *this;
+	fileSystem.m_canonicalCache = cache;
+	return fileSystem;
+}
+
+recpp::filesystem::FileSystem recpp::filesystem::FileSystem::withCompletionScheduler(recpp::async::Scheduler &scheduler) const
+{
+	auto fileSystem = *this;
+	fileSystem.m_completionScheduler = &scheduler;
+	return fileSystem;
+}
+
+recpp::filesystem::FileSystem recpp::filesystem::FileSystem::withBackend(std::shared_ptr<FileSystemBackend> backend) const
+{
+	// The native backend is the default behavior, whose own operations support more than the primitives of the backend, so faults injected in it are
+	// injected in front of these operations by dispatch
+	auto	   fileSystem = *this;
+	const auto faultInjection = std::dynamic_pointer_cast<const FaultInjectionBackend>(backend);
+	fileSystem.m_faultInjection = nullptr;
+	if (faultInjection && dynamic_cast<NativeBackend *>(faultInjection->backend().get()))
+	{
+		fileSystem.m_backend = nullptr;
+		fileSystem.m_faultInjection = faultInjection;
+		return fileSystem;
+	}
+	fileSystem.m_backend = dynamic_cast<NativeBackend *>(backend.get()) ? nullptr : std::move(backend);
+	return fileSystem;
+}
+
+template <typename T>
+Single<T> recpp::filesystem::FileSystem::deliver(const Single<T> &single) const
+{
+	if (!m_completionScheduler)
+		return single;
+	return single.observeOn(*m_completionScheduler);
+}
+
+Completable recpp::filesystem::FileSystem::deliver(const Completable &completable) const
+{
+	if (!m_completionScheduler)
+		return completable;
+	return completable.observeOn(*m_completionScheduler);
+}
+
+template <typename T>
+Single<T> recpp::filesystem::FileSystem::dispatch(const std::filesystem::path &path, IoPriority priority, const Single<T> &single, bool limited) const
+{
+	const auto mountLimiter = limited ? limiter(path) : std::nullopt;
+	auto	  &target = scheduler(path, priority);
+
+	auto guarded = Single<T>::defer(
+		[single, path, mountLimiter, token = m_cancellationToken, faultInjection = m_faultInjection, &target]()
+		{
+			if (token && token->isCancelled())
+				return Single<T>::error(token->exception());
+
+			std::optional<ConcurrencyLimiter::Permit> permit;
+			if (mountLimiter && !(permit = mountLimiter->limiter->tryAcquire()))
+				return Single<T>::error(std::make_exception_ptr(ConcurrencyLimitError(mountLimiter->mountPoint, mountLimiter->limiter->limit())));
+
+			// The wrapped operations are deferred and complete synchronously on the subscribing thread, so the permit covers the whole operation, and
+			// the parallel parts of the operation run their tasks on the same scheduler and limiter
+			const TaskContext			context(target, mountLimiter ? mountLimiter->limiter : nullptr);
+			const TaskContext::Scope	scope(context);
+			std::optional<T>			value;
+			std::exception_ptr			error;
+			if (faultInjection)
+			{
+				try
+				{
+					faultInjection->injectOperation(path);
+				}
+				catch (const std::exception &)
+				{
+					if (permit)
+						permit->release();
+					return Single<T>::error(std::current_exception());
+				}
+			}
+			single.subscribe(
+				[&value](const T &result)
+				{
+					value = result;
+				},
+				[&error](const std::exception_ptr &exception)
+				{
+					error = exception;
+				});
+			if (permit)
+				permit->release();
+			return value ? Single<T>::just(*value) : Single<T>::error(error);
+		});
+	return deliver(guarded.subscribeOn(target));
+}
+
+Completable recpp::filesystem::FileSystem::dispatch(const std::filesystem::path &path, IoPriority priority, const Completable &completable,
+													 bool limited) const
+{
+	const auto mountLimiter = limited ? limiter(path) : std::nullopt;
+	auto	  &target = scheduler(path, priority);
+
+	auto guarded = Completable::defer(
+		[completable, path, mountLimiter, token = m_cancellationToken, faultInjection = m_faultInjection, &target]()
+		{
+			if (token && token->isCancelled())
+				return Completable::error(token->exception());
+
+			std::optional<ConcurrencyLimiter::Permit> permit;
+			if (mountLimiter && !(permit = mountLimiter->limiter->tryAcquire()))
+				return Completable::error(std::make_exception_ptr(ConcurrencyLimitError(mountLimiter->mountPoint, mountLimiter->limiter->limit())));
+
+			// The wrapped operations are deferred and complete synchronously on the subscribing thread, so the permit covers the whole operation, and
+			// the parallel parts of the operation run their tasks on the same scheduler and limiter
+			const TaskContext			context(target, mountLimiter ? mountLimiter->limiter : nullptr);
+			const TaskContext::Scope	scope(context);
+			std::exception_ptr			error;
+			if (faultInjection)
+			{
+				try
+				{
+					faultInjection->injectOperation(path);
+				}
+				catch (const std::exception &)
+				{
+					if (permit)
+						permit->release();
+					return Completable::error(std::current_exception());
+				}
+			}
+			completable.subscribe(
+				[]()
+				{
+				},
+				[&error](const std::exception_ptr &exception)
+				{
+					error = exception;
+				});
+			if (permit)
+				permit->release();
+			return error ? Completable::error(error) : Completable::complete();
+		});
+	return deliver(guarded.subscribeOn(target));
+}
+
+std::optional<recpp::filesystem::FileSystem::MountLimiter> recpp::filesystem::FileSystem::limiter(const std::filesystem::path &path) const
+{
+	if (m_limiters.empty() || path.empty())
+		return std::nullopt;
+
+	std::string key;
+	try
+	{
+		key = lexicalKey(path);
+	}
+	catch (const std::exception &)
+	{
+		return std::nullopt;
+	}
+	for (const auto &mount : m_limiters)
+	{
+		if (isUnder(key, mount.mountPoint))
+			return mount;
+	}
+	return std::nullopt;
+}
+
+Scheduler &recpp::filesystem::FileSystem::scheduler(const std::filesystem::path &path, IoPriority priority) const
+{
+	if (!m_ioScheduler)
+		return m_scheduler;
+	if (path.empty())
+		return m_ioScheduler->scheduler(m_priority.value_or(priority));
+	return m_ioScheduler->scheduler(path, m_priority.value_or(priority));
+}
+
+Single<std::filesystem::path> recpp::filesystem::FileSystem::rxAbsolute(const std::filesystem::path &path) const
+{
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.absolute(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxAbsolute(path));
+}
+
+Single<std::filesystem::path> recpp::filesystem::FileSystem::rxCanonical(const std::filesystem::path &path) const
+{
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.canonical(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	if (m_canonicalCache)
+		return dispatch(path, IoPriority::interactive, recpp::filesystem::rxCanonical(path, *m_canonicalCache));
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxCanonical(path));
+}
+
+Single<std::filesystem::path> recpp::filesystem::FileSystem::rxWeaklyCanonical(const std::filesystem::path &path) const
+{
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.weaklyCanonical(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	if (m_canonicalCache)
+		return dispatch(path, IoPriority::interactive, recpp::filesystem::rxWeaklyCanonical(path, *m_canonicalCache));
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxWeaklyCanonical(path));
+}
+
+Single<std::filesystem::path> recpp::filesystem::FileSystem::rxRelative(const std::filesystem::path &path, const std::filesystem::path &base) const
+{
+	if (m_backend)
+	{
+		const auto operation = [path, base](FileSystemBackend &backend)
+		{
+			return backend.weaklyCanonical(path).lexically_relative(backend.weaklyCanonical(base));
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxRelative(path, base));
 }
 
 Single<std::filesystem::path> recpp::filesystem::FileSystem::rxProximate(const std::filesystem::path &path, const std::filesystem::path &base) const
 {
-	return recpp::filesystem::rxProximate(path, base).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path, base](FileSystemBackend &backend)
+		{
+			return backend.weaklyCanonical(path).lexically_proximate(backend.weaklyCanonical(base));
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxProximate(path, base));
 }
 
 Completable recpp::filesystem::FileSystem::rxCopy(const std::filesystem::path &from, const std::filesystem::path &to) const
 {
-	return recpp::filesystem::rxCopy(from, to).subscribeOn(m_scheduler);
+	return rxCopy(from, to, std::filesystem::copy_options::none);
 }
 
 Completable recpp::filesystem::FileSystem::rxCopy(const std::filesystem::path &from, const std::filesystem::path &to,
 												  std::filesystem::copy_options options) const
 {
-	return recpp::filesystem::rxCopy(from, to, options).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [from, to, options](FileSystemBackend &backend)
+		{
+			backend.copy(from, to, options);
+		};
+		return dispatch(from, IoPriority::bulk, backendCompletable(m_backend, operation));
+	}
+	if (m_cancellationToken)
+		return rxCopy(from, to, options, *m_cancellationToken);
+	return dispatch(from, IoPriority::bulk, recpp::filesystem::rxCopy(from, to, options));
+}
+
+Completable recpp::filesystem::FileSystem::rxCopy(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options,
+												  const CancellationToken &token) const
+{
+	if (m_backend)
+	{
+		const auto operation = [from, to, options](FileSystemBackend &backend)
+		{
+			backend.copy(from, to, options);
+		};
+		return dispatch(from, IoPriority::bulk, backendCompletable(m_backend, operation));
+	}
+	return dispatch(from, IoPriority::bulk, recpp::filesystem::rxCopy(from, to, options, token));
 }
 
 Completable recpp::filesystem::FileSystem::rxCopyFile(const std::filesystem::path &from, const std::filesystem::path &to) const
 {
-	return recpp::filesystem::rxCopyFile(from, to).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [from, to](FileSystemBackend &backend)
+		{
+			backend.copyFile(from, to, std::filesystem::copy_options::none);
+		};
+		return dispatch(from, IoPriority::bulk, backendCompletable(m_backend, operation));
+	}
+	return dispatch(from, IoPriority::bulk, recpp::filesystem::rxCopyFile(from, to));
 }
 
 Completable recpp::filesystem::FileSystem::rxCopyFile(const std::filesystem::path &from, const std::filesystem::path &to,
 													  std::filesystem::copy_options options) const
 {
-	return recpp::filesystem::rxCopyFile(from, to, options).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [from, to, options](FileSystemBackend &backend)
+		{
+			backend.copyFile(from, to, options);
+		};
+		return dispatch(from, IoPriority::bulk, backendCompletable(m_backend, operation));
+	}
+	return dispatch(from, IoPriority::bulk, recpp::filesystem::rxCopyFile(from, to, options));
 }
 
 Completable recpp::filesystem::FileSystem::rxCopySymlink(const std::filesystem::path &from, const std::filesystem::path &to) const
 {
-	return recpp::filesystem::rxCopySymlink(from, to).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [from, to](FileSystemBackend &backend)
+		{
+			backend.copySymlink(from, to);
+		};
+		return dispatch(from, IoPriority::interactive, backendCompletable(m_backend, operation));
+	}
+	return dispatch(from, IoPriority::interactive, recpp::filesystem::rxCopySymlink(from, to));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxCreateDirectory(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxCreateDirectory(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.createDirectory(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxCreateDirectory(path));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxCreateDirectory(const std::filesystem::path &path, const std::filesystem::path &existingPath) const
 {
-	return recpp::filesystem::rxCreateDirectory(path, existingPath).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path, existingPath](FileSystemBackend &backend)
+		{
+			return backend.createDirectory(path, existingPath);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxCreateDirectory(path, existingPath));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxCreateDirectories(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxCreateDirectories(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.createDirectories(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxCreateDirectories(path));
+}
+
+Single<std::vector<recpp::filesystem::DirectoryCreation>> recpp::filesystem::FileSystem::rxCreateDirectories(std::vector<std::filesystem::path> paths,
+																											unsigned threads) const
+{
+	const auto path = paths.empty() ? std::filesystem::path() : paths.front();
+	if (m_backend)
+	{
+		const auto operation = [paths = std::move(paths), threads](FileSystemBackend &backend)
+		{
+			return createDirectories(backend, paths, threads);
+		};
+		return dispatch(path, IoPriority::bulk, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxCreateDirectories(std::move(paths), threads));
 }
 
 Completable recpp::filesystem::FileSystem::rxCreateHardLink(const std::filesystem::path &target, const std::filesystem::path &link) const
 {
-	return recpp::filesystem::rxCreateHardLink(target, link).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [target, link](FileSystemBackend &backend)
+		{
+			backend.createHardLink(target, link);
+		};
+		return dispatch(link, IoPriority::interactive, backendCompletable(m_backend, operation));
+	}
+	return dispatch(link, IoPriority::interactive, recpp::filesystem::rxCreateHardLink(target, link));
 }
 
 Completable recpp::filesystem::FileSystem::rxCreateSymlink(const std::filesystem::path &target, const std::filesystem::path &link) const
 {
-	return recpp::filesystem::rxCreateSymlink(target, link).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [target, link](FileSystemBackend &backend)
+		{
+			backend.createSymlink(target, link);
+		};
+		return dispatch(link, IoPriority::interactive, backendCompletable(m_backend, operation));
+	}
+	return dispatch(link, IoPriority::interactive, recpp::filesystem::rxCreateSymlink(target, link));
 }
 
 Completable recpp::filesystem::FileSystem::rxCreateDirectorySymlink(const std::filesystem::path &target, const std::filesystem::path &link) const
 {
-	return recpp::filesystem::rxCreateDirectorySymlink(target, link).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [target, link](FileSystemBackend &backend)
+		{
+			backend.createDirectorySymlink(target, link);
+		};
+		return dispatch(link, IoPriority::interactive, backendCompletable(m_backend, operation));
+	}
+	return dispatch(link, IoPriority::interactive, recpp::filesystem::rxCreateDirectorySymlink(target, link));
 }
 
 Single<std::filesystem::path> recpp::filesystem::FileSystem::rxCurrentPath() const
 {
-	return recpp::filesystem::rxCurrentPath().subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [](FileSystemBackend &backend)
+		{
+			return backend.currentPath();
+		};
+		return dispatch({}, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch({}, IoPriority::interactive, recpp::filesystem::rxCurrentPath());
 }
 
 Completable recpp::filesystem::FileSystem::rxCurrentPath(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxCurrentPath(path).subscribeOn(m_scheduler);
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxCurrentPath", path)));
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxCurrentPath(path));
+}
+
+Single<recpp::filesystem::DiskUsage> recpp::filesystem::FileSystem::rxDiskUsage(const std::filesystem::path &root, const DiskUsageOptions &options) const
+{
+	return rxDiskUsage(
+		root,
+		[](const DiskUsage &)
+		{
+		},
+		options);
+}
+
+Single<recpp::filesystem::DiskUsage> recpp::filesystem::FileSystem::rxDiskUsage(const std::filesystem::path &root,
+																				const std::function<void(const DiskUsage &usage)> &onDirectory,
+																				const DiskUsageOptions &options) const
+{
+	auto usageOptions = options;
+	if (!usageOptions.token)
+		usageOptions.token = m_cancellationToken;
+	if (m_backend)
+	{
+		const auto operation = [root, onDirectory, usageOptions](FileSystemBackend &backend)
+		{
+			return scanDiskUsage(backend, root, onDirectory, usageOptions);
+		};
+		return dispatch(root, IoPriority::bulk, backendSingle(m_backend, operation));
+	}
+	return dispatch(root, IoPriority::bulk, recpp::filesystem::rxDiskUsage(root, onDirectory, usageOptions));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxExists(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxExists(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return std::filesystem::exists(backend.status(path));
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxExists(path));
+}
+
+Single<bool> recpp::filesystem::FileSystem::rxExists(const std::filesystem::path &path, const OverlayFileSystem &overlay) const
+{
+	if (m_backend)
+		return deliver(Single<bool>::error(unsupported("rxExists", path)));
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxExists(path, overlay));
+}
+
+Single<recpp::filesystem::OverlayEntry> recpp::filesystem::FileSystem::rxResolve(const std::filesystem::path &path, const OverlayFileSystem &overlay) const
+{
+	if (m_backend)
+		return deliver(Single<OverlayEntry>::error(unsupported("rxResolve", path)));
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxResolve(path, overlay));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxEquivalent(const std::filesystem::path &path1, const std::filesystem::path &path2) const
 {
-	return recpp::filesystem::rxEquivalent(path1, path2).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path1, path2](FileSystemBackend &backend)
+		{
+			return backend.equivalent(path1, path2);
+		};
+		return dispatch(path1, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path1, IoPriority::interactive, recpp::filesystem::rxEquivalent(path1, path2));
 }
 
 Single<uintmax_t> recpp::filesystem::FileSystem::rxFileSize(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxFileSize(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.fileSize(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxFileSize(path));
+}
+
+Completable recpp::filesystem::FileSystem::rxFindDuplicates(const std::vector<std::filesystem::path> &roots,
+															const std::function<void(const DuplicateGroup &group)> &onGroup,
+															const DuplicateOptions &options) const
+{
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxFindDuplicates", std::filesystem::path())));
+	auto findOptions = options;
+	if (!findOptions.token)
+		findOptions.token = m_cancellationToken;
+	const auto path = roots.empty() ? std::filesystem::path() : roots.front();
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxFindDuplicates(roots, onGroup, findOptions));
+}
+
+Single<std::vector<std::filesystem::path>> recpp::filesystem::FileSystem::rxGlob(const std::string &pattern, const GlobOptions &options) const
+{
+	auto globOptions = options;
+	if (!globOptions.token)
+		globOptions.token = m_cancellationToken;
+	if (m_backend)
+	{
+		const auto operation = [pattern, globOptions](FileSystemBackend &backend)
+		{
+			std::vector<std::filesystem::path> paths;
+			glob(
+				backend, pattern,
+				[&paths](const std::filesystem::path &path)
+				{
+					paths.push_back(path);
+				},
+				globOptions);
+			std::sort(paths.begin(), paths.end());
+			return paths;
+		};
+		return dispatch(std::filesystem::path(), IoPriority::bulk, backendSingle(m_backend, operation));
+	}
+	return dispatch(std::filesystem::path(), IoPriority::bulk, recpp::filesystem::rxGlob(pattern, globOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxGlob(const std::string &pattern, const std::function<void(const std::filesystem::path &path)> &onMatch,
+												  const GlobOptions &options) const
+{
+	auto globOptions = options;
+	if (!globOptions.token)
+		globOptions.token = m_cancellationToken;
+	if (m_backend)
+	{
+		const auto operation = [pattern, onMatch, globOptions](FileSystemBackend &backend)
+		{
+			glob(backend, pattern, onMatch, globOptions);
+		};
+		return dispatch(std::filesystem::path(), IoPriority::bulk, backendCompletable(m_backend, operation));
+	}
+	return dispatch(std::filesystem::path(), IoPriority::bulk, recpp::filesystem::rxGlob(pattern, onMatch, globOptions));
+}
+
+Single<std::vector<recpp::filesystem::GrepMatch>> recpp::filesystem::FileSystem::rxGrep(const std::filesystem::path &root, const std::string &pattern,
+																						const GrepOptions &options) const
+{
+	auto grepOptions = options;
+	if (!grepOptions.token)
+		grepOptions.token = m_cancellationToken;
+	if (m_backend)
+	{
+		const auto operation = [root, pattern, grepOptions](FileSystemBackend &backend)
+		{
+			std::vector<GrepMatch> matches;
+			grep(
+				backend, root, pattern,
+				[&matches](const GrepMatch &match)
+				{
+					matches.push_back(match);
+				},
+				grepOptions);
+			std::sort(matches.begin(), matches.end(),
+					  [](const GrepMatch &match1, const GrepMatch &match2)
+					  {
+						  return std::tie(match1.path, match1.lineNumber) < std::tie(match2.path, match2.lineNumber);
+					  });
+			return matches;
+		};
+		return dispatch(root, IoPriority::bulk, backendSingle(m_backend, operation));
+	}
+	return dispatch(root, IoPriority::bulk, recpp::filesystem::rxGrep(root, pattern, grepOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxGrep(const std::filesystem::path &root, const std::string &pattern,
+												  const std::function<void(const GrepMatch &match)> &onMatch, const GrepOptions &options) const
+{
+	auto grepOptions = options;
+	if (!grepOptions.token)
+		grepOptions.token = m_cancellationToken;
+	if (m_backend)
+	{
+		const auto operation = [root, pattern, onMatch, grepOptions](FileSystemBackend &backend)
+		{
+			grep(backend, root, pattern, onMatch, grepOptions);
+		};
+		return dispatch(root, IoPriority::bulk, backendCompletable(m_backend, operation));
+	}
+	return dispatch(root, IoPriority::bulk, recpp::filesystem::rxGrep(root, pattern, onMatch, grepOptions));
+}
+
+Single<std::vector<std::string>> recpp::filesystem::FileSystem::rxLexicallyNormal(std::vector<std::string> paths, unsigned threads) const
+{
+	return dispatch(std::filesystem::path(), IoPriority::bulk, recpp::filesystem::rxLexicallyNormal(std::move(paths), threads));
+}
+
+Single<std::vector<std::string>> recpp::filesystem::FileSystem::rxLexicallyRelative(std::vector<std::string> paths, const std::string &base,
+																					unsigned threads) const
+{
+	return dispatch(std::filesystem::path(), IoPriority::bulk, recpp::filesystem::rxLexicallyRelative(std::move(paths), base, threads));
+}
+
+Completable recpp::filesystem::FileSystem::rxWalk(const std::filesystem::path &root, PathTable &table,
+												  const std::function<void(PathTable::Id id, std::filesystem::file_type type)> &onEntry,
+												  const WalkOptions &options) const
+{
+	auto walkOptions = options;
+	if (!walkOptions.token)
+		walkOptions.token = m_cancellationToken;
+	if (m_backend)
+	{
+		const auto operation = [root, table, onEntry, walkOptions](FileSystemBackend &backend)
+		{
+			// The copies of a PathTable share its paths
+			auto shared = table;
+			walkInterned(backend, root, shared, onEntry, walkOptions);
+		};
+		return dispatch(root, IoPriority::bulk, backendCompletable(m_backend, operation));
+	}
+	return dispatch(root, IoPriority::bulk, recpp::filesystem::rxWalk(root, table, onEntry, walkOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxWalk(const std::filesystem::path &root, const OverlayFileSystem &overlay,
+												  const std::function<void(const OverlayEntry &entry)> &onEntry) const
+{
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxWalk", root)));
+	return dispatch(root, IoPriority::bulk, recpp::filesystem::rxWalk(root, overlay, onEntry, m_cancellationToken));
+}
+
+Completable recpp::filesystem::FileSystem::rxCommit(const FileSystemTransaction &transaction, const TransactionOptions &options) const
+{
+	// The journal is a native file, which a backend cannot hold
+	if (m_backend && !options.journal.empty())
+		return deliver(Completable::error(unsupported("rxCommit", options.journal)));
+	auto transactionOptions = options;
+	if (!transactionOptions.token)
+		transactionOptions.token = m_cancellationToken;
+	const auto &operations = transaction.operations();
+	const auto	path = operations.empty() ? std::filesystem::path() : operations.front().path;
+	if (m_backend)
+	{
+		const auto operation = [operations, transactionOptions](FileSystemBackend &backend)
+		{
+			commitTransaction(backend, operations, transactionOptions);
+		};
+		return dispatch(path, IoPriority::interactive, backendCompletable(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxCommit(transaction, transactionOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxRecoverTransaction(const std::filesystem::path &journal) const
+{
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxRecoverTransaction", journal)));
+	return dispatch(journal, IoPriority::interactive, recpp::filesystem::rxRecoverTransaction(journal));
+}
+
+Completable recpp::filesystem::FileSystem::rxPackTar(const std::filesystem::path &root, const std::filesystem::path &archive,
+													 const ArchiveOptions &options) const
+{
+	return rxPackTar(
+		root, archive,
+		[](const ArchiveEntry &)
+		{
+		},
+		options);
+}
+
+Completable recpp::filesystem::FileSystem::rxPackTar(const std::filesystem::path &root, const std::filesystem::path &archive,
+													 const std::function<void(const ArchiveEntry &entry)> &onEntry, const ArchiveOptions &options) const
+{
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxPackTar", archive)));
+	auto archiveOptions = options;
+	if (!archiveOptions.token)
+		archiveOptions.token = m_cancellationToken;
+	return dispatch(archive, IoPriority::bulk, recpp::filesystem::rxPackTar(root, archive, onEntry, archiveOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxUnpackTar(const std::filesystem::path &archive, const std::filesystem::path &destination,
+													   const ArchiveOptions &options) const
+{
+	return rxUnpackTar(
+		archive, destination,
+		[](const ArchiveEntry &)
+		{
+		},
+		options);
+}
+
+Completable recpp::filesystem::FileSystem::rxUnpackTar(const std::filesystem::path &archive, const std::filesystem::path &destination,
+													   const std::function<void(const ArchiveEntry &entry)> &onEntry, const ArchiveOptions &options) const
+{
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxUnpackTar", destination)));
+	auto archiveOptions = options;
+	if (!archiveOptions.token)
+		archiveOptions.token = m_cancellationToken;
+	return dispatch(destination, IoPriority::bulk, recpp::filesystem::rxUnpackTar(archive, destination, onEntry, archiveOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxUnpackZip(const std::filesystem::path &archive, const std::filesystem::path &destination,
+													   const ArchiveOptions &options) const
+{
+	return rxUnpackZip(
+		archive, destination,
+		[](const ArchiveEntry &)
+		{
+		},
+		options);
+}
+
+Completable recpp::filesystem::FileSystem::rxUnpackZip(const std::filesystem::path &archive, const std::filesystem::path &destination,
+													   const std::function<void(const ArchiveEntry &entry)> &onEntry, const ArchiveOptions &options) const
+{
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxUnpackZip", destination)));
+	auto archiveOptions = options;
+	if (!archiveOptions.token)
+		archiveOptions.token = m_cancellationToken;
+	return dispatch(destination, IoPriority::bulk, recpp::filesystem::rxUnpackZip(archive, destination, onEntry, archiveOptions));
+}
+
+Single<std::string> recpp::filesystem::FileSystem::rxReadFileDecompressed(const std::filesystem::path &path, const CompressionOptions &options) const
+{
+	auto compressionOptions = options;
+	if (!compressionOptions.token)
+		compressionOptions.token = m_cancellationToken;
+	if (m_backend)
+	{
+		const auto operation = [path, compressionOptions](FileSystemBackend &backend)
+		{
+			std::string contents;
+			readDecompressed(
+				backend, path,
+				[&contents](std::string_view chunk)
+				{
+					contents.append(chunk);
+				},
+				compressionOptions);
+			return contents;
+		};
+		return dispatch(path, IoPriority::bulk, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxReadFileDecompressed(path, compressionOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxReadFileDecompressed(const std::filesystem::path &path, const std::function<void(std::string_view chunk)> &onChunk,
+																  const CompressionOptions &options) const
+{
+	auto compressionOptions = options;
+	if (!compressionOptions.token)
+		compressionOptions.token = m_cancellationToken;
+	if (m_backend)
+	{
+		const auto operation = [path, onChunk, compressionOptions](FileSystemBackend &backend)
+		{
+			readDecompressed(backend, path, onChunk, compressionOptions);
+		};
+		return dispatch(path, IoPriority::bulk, backendCompletable(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxReadFileDecompressed(path, onChunk, compressionOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxWriteFileCompressed(const std::filesystem::path &path, std::string contents,
+																 const CompressionOptions &options) const
+{
+	auto compressionOptions = options;
+	if (!compressionOptions.token)
+		compressionOptions.token = m_cancellationToken;
+	if (m_backend)
+	{
+		const auto operation = [path, contents = std::move(contents), compressionOptions](FileSystemBackend &backend)
+		{
+			std::size_t position = 0;
+			writeCompressed(
+				backend, path,
+				[&contents, &position](char *data, std::size_t size)
+				{
+					const auto count = contents.copy(data, size, position);
+					position += count;
+					return count;
+				},
+				compressionOptions);
+		};
+		return dispatch(path, IoPriority::bulk, backendCompletable(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxWriteFileCompressed(path, std::move(contents), compressionOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxWriteFileCompressed(const std::filesystem::path &path,
+																 const std::function<std::size_t(char *data, std::size_t size)> &source,
+																 const CompressionOptions &options) const
+{
+	auto compressionOptions = options;
+	if (!compressionOptions.token)
+		compressionOptions.token = m_cancellationToken;
+	if (m_backend)
+	{
+		const auto operation = [path, source, compressionOptions](FileSystemBackend &backend)
+		{
+			writeCompressed(backend, path, source, compressionOptions);
+		};
+		return dispatch(path, IoPriority::bulk, backendCompletable(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxWriteFileCompressed(path, source, compressionOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxReadLines(const std::filesystem::path &path, const std::function<void(std::string_view line)> &onLine,
+													   const RecordOptions &options) const
+{
+	auto recordOptions = options;
+	if (!recordOptions.token)
+		recordOptions.token = m_cancellationToken;
+	if (m_backend)
+	{
+		const auto makeSplitter = [onLine]()
+		{
+			return RecordSplitter('\n', true, onLine);
+		};
+		return dispatch(path, IoPriority::bulk, readRecords(m_backend, path, makeSplitter, recordOptions));
+	}
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxReadLines(path, onLine, recordOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxReadRecords(const std::filesystem::path &path, char delimiter,
+														 const std::function<void(std::string_view record)> &onRecord, const RecordOptions &options) const
+{
+	auto recordOptions = options;
+	if (!recordOptions.token)
+		recordOptions.token = m_cancellationToken;
+	if (m_backend)
+	{
+		const auto makeSplitter = [delimiter, onRecord]()
+		{
+			return RecordSplitter(delimiter, false, onRecord);
+		};
+		return dispatch(path, IoPriority::bulk, readRecords(m_backend, path, makeSplitter, recordOptions));
+	}
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxReadRecords(path, delimiter, onRecord, recordOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxReadFixedSizeRecords(const std::filesystem::path &path, std::size_t recordSize,
+																  const std::function<void(std::string_view record)> &onRecord,
+																  const RecordOptions &options) const
+{
+	auto recordOptions = options;
+	if (!recordOptions.token)
+		recordOptions.token = m_cancellationToken;
+	if (m_backend)
+	{
+		const auto makeSplitter = [recordSize, onRecord]()
+		{
+			return RecordSplitter(recordSize, onRecord);
+		};
+		return dispatch(path, IoPriority::bulk, readRecords(m_backend, path, makeSplitter, recordOptions));
+	}
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxReadFixedSizeRecords(path, recordSize, onRecord, recordOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxTail(const std::filesystem::path &path, std::uintmax_t startPosition,
+												  const std::function<void(const TailData &data)> &onData, const TailOptions &options) const
+{
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxTail", path)));
+	auto tailOptions = options;
+	if (!tailOptions.token)
+		tailOptions.token = m_cancellationToken;
+	if (!tailOptions.token)
+		return deliver(Completable::error(untokenized("rxTail", path)));
+	// Following a file mostly waits for it to change, so it does not hold a permit of the concurrency limit of its mount
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxTail(path, startPosition, onData, tailOptions), false);
+}
+
+Completable recpp::filesystem::FileSystem::rxTailLines(const std::filesystem::path &path, std::uintmax_t startPosition,
+													   const std::function<void(const TailData &line)> &onLine, const TailOptions &options) const
+{
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxTailLines", path)));
+	auto tailOptions = options;
+	if (!tailOptions.token)
+		tailOptions.token = m_cancellationToken;
+	if (!tailOptions.token)
+		return deliver(Completable::error(untokenized("rxTailLines", path)));
+	// Following a file mostly waits for it to change, so it does not hold a permit of the concurrency limit of its mount
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxTailLines(path, startPosition, onLine, tailOptions), false);
+}
+
+Single<std::string> recpp::filesystem::FileSystem::rxGetXattr(const std::filesystem::path &path, const std::string &name) const
+{
+	if (m_backend)
+		return deliver(Single<std::string>::error(unsupported("rxGetXattr", path)));
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxGetXattr(path, name));
+}
+
+Completable recpp::filesystem::FileSystem::rxSetXattr(const std::filesystem::path &path, const std::string &name, std::string value, XattrMode mode) const
+{
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxSetXattr", path)));
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxSetXattr(path, name, std::move(value), mode));
+}
+
+Completable recpp::filesystem::FileSystem::rxRemoveXattr(const std::filesystem::path &path, const std::string &name) const
+{
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxRemoveXattr", path)));
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxRemoveXattr(path, name));
+}
+
+Single<std::vector<std::string>> recpp::filesystem::FileSystem::rxListXattrs(const std::filesystem::path &path) const
+{
+	if (m_backend)
+		return deliver(Single<std::vector<std::string>>::error(unsupported("rxListXattrs", path)));
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxListXattrs(path));
+}
+
+Single<std::vector<recpp::filesystem::FileXattrs>> recpp::filesystem::FileSystem::rxGetXattrs(std::vector<std::filesystem::path> paths,
+																							  std::vector<std::string> names, unsigned threads) const
+{
+	if (m_backend)
+		return deliver(Single<std::vector<FileXattrs>>::error(unsupported("rxGetXattrs", std::filesystem::path())));
+	const auto path = paths.empty() ? std::filesystem::path() : paths.front();
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxGetXattrs(std::move(paths), std::move(names), threads));
+}
+
+Single<recpp::filesystem::FileHandle> recpp::filesystem::FileSystem::rxFileHandle(const std::filesystem::path &path) const
+{
+	if (m_backend)
+		return deliver(Single<FileHandle>::error(unsupported("rxFileHandle", path)));
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxFileHandle(path));
+}
+
+Single<std::filesystem::path> recpp::filesystem::FileSystem::rxResolveFileHandle(const FileHandle &handle, const std::filesystem::path &mountPoint) const
+{
+	if (m_backend)
+		return deliver(Single<std::filesystem::path>::error(unsupported("rxResolveFileHandle", mountPoint)));
+	return dispatch(mountPoint, IoPriority::interactive, recpp::filesystem::rxResolveFileHandle(handle, mountPoint));
 }
 
 Single<uintmax_t> recpp::filesystem::FileSystem::rxHardLinkCount(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxHardLinkCount(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.hardLinkCount(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxHardLinkCount(path));
+}
+
+Single<recpp::filesystem::Digest> recpp::filesystem::FileSystem::rxHashFile(const std::filesystem::path &path, HashAlgorithm algorithm) const
+{
+	if (m_backend)
+	{
+		const auto operation = [path, algorithm](FileSystemBackend &backend)
+		{
+			return hashFile(backend, path, algorithm);
+		};
+		return dispatch(path, IoPriority::bulk, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxHashFile(path, algorithm));
+}
+
+Single<recpp::filesystem::Digest> recpp::filesystem::FileSystem::rxHashTree(const std::filesystem::path &root, HashAlgorithm algorithm) const
+{
+	if (m_backend)
+	{
+		const auto operation = [root, algorithm](FileSystemBackend &backend)
+		{
+			return hashTree(backend, root, algorithm);
+		};
+		return dispatch(root, IoPriority::bulk, backendSingle(m_backend, operation));
+	}
+	return dispatch(root, IoPriority::bulk, recpp::filesystem::rxHashTree(root, algorithm));
+}
+
+Single<recpp::filesystem::MetadataIndex> recpp::filesystem::FileSystem::rxBuildIndex(const std::filesystem::path &root,
+																					 const MetadataIndexOptions &options) const
+{
+	if (m_backend)
+		return deliver(Single<MetadataIndex>::error(unsupported("rxBuildIndex", root)));
+	auto indexOptions = options;
+	if (!indexOptions.token)
+		indexOptions.token = m_cancellationToken;
+	return dispatch(root, IoPriority::bulk, recpp::filesystem::rxBuildIndex(root, indexOptions));
+}
+
+Single<recpp::filesystem::MetadataIndex> recpp::filesystem::FileSystem::rxOpenIndex(const std::filesystem::path &file) const
+{
+	if (m_backend)
+		return deliver(Single<MetadataIndex>::error(unsupported("rxOpenIndex", file)));
+	return dispatch(file, IoPriority::interactive, recpp::filesystem::rxOpenIndex(file));
+}
+
+Single<recpp::filesystem::MetadataIndex> recpp::filesystem::FileSystem::rxRefreshIndex(const MetadataIndex &index, const MetadataIndexOptions &options) const
+{
+	if (m_backend)
+		return deliver(Single<MetadataIndex>::error(unsupported("rxRefreshIndex", index.root())));
+	auto indexOptions = options;
+	if (!indexOptions.token)
+		indexOptions.token = m_cancellationToken;
+	return dispatch(index.root(), IoPriority::bulk, recpp::filesystem::rxRefreshIndex(index, indexOptions));
+}
+
+Completable recpp::filesystem::FileSystem::rxWriteIndex(const MetadataIndex &index, const std::filesystem::path &file) const
+{
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxWriteIndex", file)));
+	return dispatch(file, IoPriority::bulk, recpp::filesystem::rxWriteIndex(index, file));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxIsBlockFile(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxIsBlockFile(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return std::filesystem::is_block_file(backend.status(path));
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxIsBlockFile(path));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxIsCharacterFile(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxIsCharacterFile(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return std::filesystem::is_character_file(backend.status(path));
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxIsCharacterFile(path));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxIsDirectory(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxIsDirectory(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return std::filesystem::is_directory(backend.status(path));
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxIsDirectory(path));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxIsEmpty(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxIsEmpty(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.isEmpty(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxIsEmpty(path));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxIsFifo(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxIsFifo(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return std::filesystem::is_fifo(backend.status(path));
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxIsFifo(path));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxIsOther(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxIsOther(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return std::filesystem::is_other(backend.status(path));
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxIsOther(path));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxIsRegularFile(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxIsRegularFile(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return std::filesystem::is_regular_file(backend.status(path));
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxIsRegularFile(path));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxIsSocket(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxIsSocket(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return std::filesystem::is_socket(backend.status(path));
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxIsSocket(path));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxIsSymlink(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxIsSymlink(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return std::filesystem::is_symlink(backend.symlinkStatus(path));
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxIsSymlink(path));
 }
 
 Single<std::filesystem::file_time_type> recpp::filesystem::FileSystem::rxLastWriteTime(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxLastWriteTime(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.lastWriteTime(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxLastWriteTime(path));
 }
 
 Completable recpp::filesystem::FileSystem::rxLastWriteTime(const std::filesystem::path &path, std::filesystem::file_time_type newTime) const
 {
-	return recpp::filesystem::rxLastWriteTime(path, newTime).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path, newTime](FileSystemBackend &backend)
+		{
+			backend.lastWriteTime(path, newTime);
+		};
+		return dispatch(path, IoPriority::interactive, backendCompletable(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxLastWriteTime(path, newTime));
 }
 
 Completable recpp::filesystem::FileSystem::rxPermissions(const std::filesystem::path &path, std::filesystem::perms permissions,
 														 std::filesystem::perm_options options) const
 {
-	return recpp::filesystem::rxPermissions(path, permissions, options).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path, permissions, options](FileSystemBackend &backend)
+		{
+			backend.permissions(path, permissions, options);
+		};
+		return dispatch(path, IoPriority::interactive, backendCompletable(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxPermissions(path, permissions, options));
 }
 
 Single<std::filesystem::path> recpp::filesystem::FileSystem::rxReadSymlink(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxReadSymlink(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.readSymlink(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxReadSymlink(path));
 }
 
 Single<bool> recpp::filesystem::FileSystem::rxRemove(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxRemove(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.remove(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxRemove(path));
 }
 
 Single<uintmax_t> recpp::filesystem::FileSystem::rxRemoveAll(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxRemoveAll(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.removeAll(path);
+		};
+		return dispatch(path, IoPriority::bulk, backendSingle(m_backend, operation));
+	}
+	if (m_cancellationToken)
+		return rxRemoveAll(path, *m_cancellationToken);
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxRemoveAll(path));
+}
+
+Single<uintmax_t> recpp::filesystem::FileSystem::rxRemoveAll(const std::filesystem::path &path, const CancellationToken &token) const
+{
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.removeAll(path);
+		};
+		return dispatch(path, IoPriority::bulk, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::bulk, recpp::filesystem::rxRemoveAll(path, token));
 }
 
 Completable recpp::filesystem::FileSystem::rxRename(const std::filesystem::path &oldPath, const std::filesystem::path &newPath) const
 {
-	return recpp::filesystem::rxRename(oldPath, newPath).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [oldPath, newPath](FileSystemBackend &backend)
+		{
+			backend.rename(oldPath, newPath);
+		};
+		return dispatch(oldPath, IoPriority::interactive, backendCompletable(m_backend, operation));
+	}
+	return dispatch(oldPath, IoPriority::interactive, recpp::filesystem::rxRename(oldPath, newPath));
 }
 
 Completable recpp::filesystem::FileSystem::rxResizeFile(const std::filesystem::path &path, std::uintmax_t newSize) const
 {
-	return recpp::filesystem::rxResizeFile(path, newSize).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path, newSize](FileSystemBackend &backend)
+		{
+			backend.resizeFile(path, newSize);
+		};
+		return dispatch(path, IoPriority::interactive, backendCompletable(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxResizeFile(path, newSize));
+}
+
+Completable recpp::filesystem::FileSystem::rxAllocate(const std::filesystem::path &path, std::uintmax_t offset, std::uintmax_t length,
+													  AllocationMode mode) const
+{
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxAllocate", path)));
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxAllocate(path, offset, length, mode));
+}
+
+Single<std::vector<recpp::filesystem::DataSegment>> recpp::filesystem::FileSystem::rxDataSegments(const std::filesystem::path &path) const
+{
+	if (m_backend)
+		return deliver(Single<std::vector<DataSegment>>::error(unsupported("rxDataSegments", path)));
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxDataSegments(path));
 }
 
 Single<std::filesystem::space_info> recpp::filesystem::FileSystem::rxSpace(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxSpace(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.space(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxSpace(path));
 }
 
 Single<std::filesystem::file_status> recpp::filesystem::FileSystem::rxStatus(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxStatus(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.status(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxStatus(path));
 }
 
 Single<std::filesystem::file_status> recpp::filesystem::FileSystem::rxSymlinkStatus(const std::filesystem::path &path) const
 {
-	return recpp::filesystem::rxSymlinkStatus(path).subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [path](FileSystemBackend &backend)
+		{
+			return backend.symlinkStatus(path);
+		};
+		return dispatch(path, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch(path, IoPriority::interactive, recpp::filesystem::rxSymlinkStatus(path));
+}
+
+Completable recpp::filesystem::FileSystem::rxSync(const std::filesystem::path &source, const std::filesystem::path &destination,
+												  const SyncOptions &options) const
+{
+	return rxSync(
+		source, destination,
+		[](const SyncAction &)
+		{
+		},
+		options);
+}
+
+Completable recpp::filesystem::FileSystem::rxSync(const std::filesystem::path &source, const std::filesystem::path &destination,
+												  const std::function<void(const SyncAction &action)> &onAction, const SyncOptions &options) const
+{
+	if (m_backend)
+		return deliver(Completable::error(unsupported("rxSync", destination)));
+	auto syncOptions = options;
+	if (!syncOptions.token)
+		syncOptions.token = m_cancellationToken;
+	return dispatch(destination, IoPriority::bulk, recpp::filesystem::rxSync(source, destination, onAction, syncOptions));
 }
 
 Single<std::filesystem::path> recpp::filesystem::FileSystem::rxTempDirectoryPath() const
 {
-	return recpp::filesystem::rxTempDirectoryPath().subscribeOn(m_scheduler);
+	if (m_backend)
+	{
+		const auto operation = [](FileSystemBackend &backend)
+		{
+			return backend.tempDirectoryPath();
+		};
+		return dispatch({}, IoPriority::interactive, backendSingle(m_backend, operation));
+	}
+	return dispatch({}, IoPriority::interactive, recpp::filesystem::rxTempDirectoryPath());
 }
@@ -0,0 +1,197 @@
+#include "recpp/filesystem/FileSystemBackend.h"
+#include "File.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+std::filesystem::path recpp::filesystem::NativeBackend::absolute(const std::filesystem::path &path) const
+{
+	return std::filesystem::absolute(path);
+}
+
+std::filesystem::path recpp::filesystem::NativeBackend::canonical(const std::filesystem::path &path) const
+{
+	return std::filesystem::canonical(path);
+}
+
+std::filesystem::path recpp::filesystem::NativeBackend::weaklyCanonical(const std::filesystem::path &path) const
+{
+	return std::filesystem::weakly_canonical(path);
+}
+
+void recpp::filesystem::NativeBackend::copy(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options)
+{
+	std::filesystem::copy(from, to, options);
+}
+
+bool recpp::filesystem::NativeBackend::copyFile(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options)
+{
+	return std::filesystem::copy_file(from, to, options);
+}
+
+void recpp::filesystem::NativeBackend::copySymlink(const std::filesystem::path &from, const std::filesystem::path &to)
+{
+	std::filesystem::copy_symlink(from, to);
+}
+
+bool recpp::filesystem::NativeBackend::createDirectory(const std::filesystem::path &path)
+{
+	return std::filesystem::create_directory(path);
+}
+
+bool recpp::filesystem::NativeBackend::createDirectory(const std::filesystem::path &path, const std::filesystem::path &existingPath)
+{
+	return std::filesystem::create_directory(path, existingPath);
+}
+
+bool recpp::filesystem::NativeBackend::createDirectories(const std::filesystem::path &path)
+{
+	return std::filesystem::create_directories(path);
+}
+
+void recpp::filesystem::NativeBackend::createHardLink(const std::filesystem::path &target, const std::filesystem::path &link)
+{
+	std::filesystem::create_hard_link(target, link);
+}
+
+void recpp::filesystem::NativeBackend::createSymlink(const std::filesystem::path &target, const std::filesystem::path &link)
+{
+	std::filesystem::create_symlink(target, link);
+}
+
+void recpp::filesystem::NativeBackend::createDirectorySymlink(const std::filesystem::path &target, const std::filesystem::path &link)
+{
+	std::filesystem::create_directory_symlink(target, link);
+}
+
+std::filesystem::path recpp::filesystem::NativeBackend::currentPath() const
+{
+	return std::filesystem::current_path();
+}
+
+std::vector<std::filesystem::path> recpp::filesystem::NativeBackend::directoryEntries(const std::filesystem::path &path) const
+{
+	std::vector<std::filesystem::path> entries;
+	for (const auto &entry : std::filesystem::directory_iterator(path))
+		entries.push_back(entry.path());
+	std::sort(entries.begin(), entries.end());
+	return entries;
+}
+
+bool recpp::filesystem::NativeBackend::equivalent(const std::filesystem::path &path1, const std::filesystem::path &path2) const
+{
+	return std::filesystem::equivalent(path1, path2);
+}
+
+std::uintmax_t recpp::filesystem::NativeBackend::fileSize(const std::filesystem::path &path) const
+{
+	return std::filesystem::file_size(path);
+}
+
+std::uintmax_t recpp::filesystem::NativeBackend::hardLinkCount(const std::filesystem::path &path) const
+{
+	return std::filesystem::hard_link_count(path);
+}
+
+bool recpp::filesystem::NativeBackend::isEmpty(const std::filesystem::path &path) const
+{
+	return std::filesystem::is_empty(path);
+}
+
+std::filesystem::file_time_type recpp::filesystem::NativeBackend::lastWriteTime(const std::filesystem::path &path) const
+{
+	return std::filesystem::last_write_time(path);
+}
+
+void recpp::filesystem::NativeBackend::lastWriteTime(const std::filesystem::path &path, std::filesystem::file_time_type newTime)
+{
+	std::filesystem::last_write_time(path, newTime);
+}
+
+void recpp::filesystem::NativeBackend::permissions(const std::filesystem::path &path, std::filesystem::perms permissions,
+												   std::filesystem::perm_options options)
+{
+	std::filesystem::permissions(path, permissions, options);
+}
+
+std::string recpp::filesystem::NativeBackend::readFile(const std::filesystem::path &path) const
+{
+	// A directory can be opened as a stream, whose first read then throws
+	if (std::filesystem::is_directory(path))
+		throw std::filesystem::filesystem_error("read", path, std::make_error_code(std::errc::is_a_directory));
+	std::ifstream stream(path, std::ios::binary);
+	if (!stream)
+		throw std::filesystem::filesystem_error("read", path, std::error_code(errno, std::generic_category()));
+	std::string content{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+	if (stream.bad())
+		throw std::filesystem::filesystem_error("read", path, std::make_error_code(std::errc::io_error));
+	return content;
+}
+
+std::size_t recpp::filesystem::NativeBackend::readFile(const std::filesystem::path &path, std::uintmax_t offset, char *data, std::size_t size) const
+{
+	if (std::filesystem::is_directory(path))
+		throw std::filesystem::filesystem_error("read", path, std::make_error_code(std::errc::is_a_directory));
+	detail::File file(path);
+	file.seek(offset);
+	return file.read(data, size);
+}
+
+std::filesystem::path recpp::filesystem::NativeBackend::readSymlink(const std::filesystem::path &path) const
+{
+	return std::filesystem::read_symlink(path);
+}
+
+bool recpp::filesystem::NativeBackend::remove(const std::filesystem::path &path)
+{
+	return std::filesystem::remove(path);
+}
+
+std::uintmax_t recpp::filesystem::NativeBackend::removeAll(const std::filesystem::path &path)
+{
+	return std::filesystem::remove_all(path);
+}
+
+void recpp::filesystem::NativeBackend::rename(const std::filesystem::path &oldPath, const std::filesystem::path &newPath)
+{
+	std::filesystem::rename(oldPath, newPath);
+}
+
+void recpp::filesystem::NativeBackend::resizeFile(const std::filesystem::path &path, std::uintmax_t newSize)
+{
+	std::filesystem::resize_file(path, newSize);
+}
+
+std::filesystem::space_info recpp::filesystem::NativeBackend::space(const std::filesystem::path &path) const
+{
+	return std::filesystem::space(path);
+}
+
+std::filesystem::file_status recpp::filesystem::NativeBackend::status(const std::filesystem::path &path) const
+{
+	return std::filesystem::status(path);
+}
+
+std::filesystem::file_status recpp::filesystem::NativeBackend::symlinkStatus(const std::filesystem::path &path) const
+{
+	return std::filesystem::symlink_status(path);
+}
+
+std::filesystem::path recpp::filesystem::NativeBackend::tempDirectoryPath() const
+{
+	return std::filesystem::temp_directory_path();
+}
+
+void recpp::filesystem::NativeBackend::writeFile(const std::filesystem::path &path, std::string_view content)
+{
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	if (!stream)
+		throw std::filesystem::filesystem_error("write", path, std::error_code(errno, std::generic_category()));
+	stream.write(content.data(), static_cast<std::streamsize>(content.size()));
+	stream.close();
+	if (!stream)
+		throw std::filesystem::filesystem_error("write", path, std::make_error_code(std::errc::io_error));
+}
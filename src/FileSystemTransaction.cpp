@@ -0,0 +1,66 @@
+#include "recpp/filesystem/FileSystemTransaction.h"
+
+#include <utility>
+
+recpp::filesystem::TransactionRollbackError::TransactionRollbackError(std::exception_ptr failure, std::exception_ptr rollbackFailure)
+	: std::runtime_error("the transaction failed and could not be rolled back")
+	, m_failure(std::move(failure))
+	, m_rollbackFailure(std::move(rollbackFailure))
+{
+}
+
+const std::exception_ptr &recpp::filesystem::TransactionRollbackError::failure() const
+{
+	return m_failure;
+}
+
+const std::exception_ptr &recpp::filesystem::TransactionRollbackError::rollbackFailure() const
+{
+	return m_rollbackFailure;
+}
+
+recpp::filesystem::FileSystemTransaction &recpp::filesystem::FileSystemTransaction::createDirectory(const std::filesystem::path &path)
+{
+	TransactionOperation operation;
+	operation.type = TransactionOperationType::createDirectory;
+	operation.path = path;
+	m_operations.push_back(std::move(operation));
+	return *this;
+}
+
+recpp::filesystem::FileSystemTransaction &recpp::filesystem::FileSystemTransaction::rename(const std::filesystem::path &from, const std::filesystem::path &to)
+{
+	TransactionOperation operation;
+	operation.type = TransactionOperationType::rename;
+	operation.path = from;
+	operation.target = to;
+	m_operations.push_back(std::move(operation));
+	return *this;
+}
+
+recpp::filesystem::FileSystemTransaction &recpp::filesystem::FileSystemTransaction::remove(const std::filesystem::path &path)
+{
+	TransactionOperation operation;
+	operation.type = TransactionOperationType::remove;
+	operation.path = path;
+	m_operations.push_back(std::move(operation));
+	return *this;
+}
+
+recpp::filesystem::FileSystemTransaction &recpp::filesystem::FileSystemTransaction::permissions(const std::filesystem::path &path,
+																							  std::filesystem::perms permissions,
+																							  std::filesystem::perm_options options)
+{
+	TransactionOperation operation;
+	operation.type = TransactionOperationType::permissions;
+	operation.path = path;
+	operation.permissions = permissions;
+	operation.options = options;
+	m_operations.push_back(std::move(operation));
+	return *this;
+}
+
+const std::vector<recpp::filesystem::TransactionOperation> &recpp::filesystem::FileSystemTransaction::operations() const
+{
+	return m_operations;
+}
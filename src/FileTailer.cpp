@@ -0,0 +1,261 @@
+#include "FileTailer.h"
+#include "File.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+#include <sys/stat.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	// The identity of a file and its size, the inode being always 0 on Windows
+	struct Status
+	{
+		std::uintmax_t device = 0;
+		std::uintmax_t inode = 0;
+		std::uintmax_t size = 0;
+	};
+
+	// Get the status of the file at path into status, returning false if it does not exist, which it may not while it is being rotated
+	bool statusOf(const std::filesystem::path &path, Status &status)
+	{
+#ifdef _WIN32
+		struct _stat64 info;
+		if (_wstat64(path.c_str(), &info) != 0)
+#else
+		struct stat info;
+		if (::stat(path.c_str(), &info) != 0)
+#endif
+		{
+			if (errno == ENOENT)
+				return false;
+			throw std::filesystem::filesystem_error("stat", path, std::error_code(errno, std::generic_category()));
+		}
+		status = Status{static_cast<std::uintmax_t>(info.st_dev), static_cast<std::uintmax_t>(info.st_ino), static_cast<std::uintmax_t>(info.st_size)};
+		return true;
+	}
+
+	// Waits for the changes of a file, watching its directory with inotify where available, which also reports the files renamed to its name, and sleeping
+	// otherwise
+	class Watcher
+	{
+	public:
+		explicit Watcher([[maybe_unused]] const std::filesystem::path &path)
+		{
+#ifdef __linux__
+			m_name = path.filename().string();
+			const auto directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+			const auto events = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+			// Past the limit of inotify instances, the file is polled instead
+			m_descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (m_descriptor >= 0 && inotify_add_watch(m_descriptor, directory.c_str(), events) < 0)
+			{
+				::close(m_descriptor);
+				m_descriptor = -1;
+			}
+#endif
+		}
+
+		Watcher(const Watcher &) = delete;
+		Watcher &operator=(const Watcher &) = delete;
+
+		~Watcher()
+		{
+#ifdef __linux__
+			if (m_descriptor >= 0)
+				::close(m_descriptor);
+#endif
+		}
+
+		// Wait until the file may have changed, for timeout at most
+		void wait(std::chrono::milliseconds timeout)
+		{
+#ifdef __linux__
+			if (m_descriptor >= 0)
+			{
+				const auto deadline = std::chrono::steady_clock::now() + timeout;
+				for (;;)
+				{
+					const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+					pollfd	   descriptor = {m_descriptor, POLLIN, 0};
+					if (remaining.count() <= 0 || ::poll(&descriptor, 1, static_cast<int>(remaining.count())) <= 0 || readEvents())
+						return;
+				}
+			}
+#endif
+			std::this_thread::sleep_for(timeout);
+		}
+
+	private:
+#ifdef __linux__
+		// Read the pending events, returning true if one of them is about the file, or if some were lost
+		bool readEvents()
+		{
+			alignas(inotify_event) char buffer[4096];
+			auto						changed = false;
+			for (;;)
+			{
+				const auto size = ::read(m_descriptor, buffer, sizeof(buffer));
+				if (size <= 0)
+					return changed;
+				for (std::ptrdiff_t offset = 0; offset < size;)
+				{
+					const auto event = reinterpret_cast<const inotify_event *>(buffer + offset);
+					if ((event->mask & IN_Q_OVERFLOW) || (event->len && m_name == event->name))
+						changed = true;
+					offset += static_cast<std::ptrdiff_t>(sizeof(inotify_event) + event->len);
+				}
+			}
+		}
+
+		int			m_descriptor = -1;
+		std::string m_name;
+#endif
+	};
+} // namespace
+
+void recpp::filesystem::detail::tailFile(const std::filesystem::path &path, std::uintmax_t startPosition,
+										 const std::function<void(const TailData &data)> &onData, const TailOptions &options)
+{
+	// Without a token the following would never end, holding its thread forever
+	if (!options.token)
+		throw std::filesystem::filesystem_error("tail", path, std::make_error_code(std::errc::invalid_argument));
+	const auto chunkSize = std::max<std::size_t>(options.chunkSize, 1);
+
+	// The directory is watched before the file is opened, so that no change is missed
+	Watcher watcher(path);
+	auto	file = std::make_unique<File>(path);
+	auto	position = startPosition;
+	auto	rotated = false;
+	if (file->size() < position)
+	{
+		position = 0;
+		rotated = true;
+	}
+	file->seek(position);
+
+	// The held bytes at the start of the buffer were read but not delivered yet, the first of them being at position - held in the file
+	std::unique_ptr<char[]> buffer(new char[chunkSize]);
+	std::size_t				held = 0;
+	const auto				deliver = [&buffer, &held, &position, &rotated, &onData](std::size_t size)
+	{
+		const auto offset = position - held;
+		onData(TailData{std::string_view(buffer.get(), size), offset, offset + size, rotated});
+		rotated = false;
+		std::memmove(buffer.get(), buffer.get() + size, held - size);
+		held -= size;
+	};
+	const auto drain = [&]()
+	{
+		for (;;)
+		{
+			if (options.token)
+				options.token->throwIfCancelled();
+			const auto count = file->read(buffer.get() + held, chunkSize - held);
+			if (count == 0)
+				return;
+			held += count;
+			position += count;
+
+			// Only the end of a line longer than the buffer is delivered before the line is complete
+			auto size = held;
+			if (options.wholeLines)
+			{
+				while (size > 0 && buffer[size - 1] != '\n')
+					size--;
+				if (size == 0 && held == chunkSize)
+					size = held;
+			}
+			if (size)
+				deliver(size);
+		}
+	};
+
+	for (;;)
+	{
+		drain();
+
+		Status current;
+		if (statusOf(path, current))
+		{
+			const auto opened = file->info();
+			if (current.device != opened.device || current.inode != opened.inode)
+			{
+				// The rest of the previous file was just read, the line it does not end is delivered as is since the file no longer grows
+				std::unique_ptr<File> next;
+				try
+				{
+					next = std::make_unique<File>(path);
+				}
+				catch (const std::filesystem::filesystem_error &error)
+				{
+					if (error.code() != std::errc::no_such_file_or_directory)
+						throw;
+				}
+				if (next)
+				{
+					if (held)
+						deliver(held);
+					file = std::move(next);
+					position = 0;
+					rotated = true;
+					continue;
+				}
+			}
+			else if (opened.size < position)
+			{
+				// The file was truncated, and its contents before are lost but for the line being written that was already read
+				if (held)
+					deliver(held);
+				file->seek(0);
+				position = 0;
+				rotated = true;
+				continue;
+			}
+		}
+		watcher.wait(options.pollInterval);
+	}
+}
+
+void recpp::filesystem::detail::tailLines(const std::filesystem::path &path, std::uintmax_t startPosition,
+										  const std::function<void(const TailData &line)> &onLine, TailOptions options)
+{
+	options.wholeLines = true;
+	tailFile(
+		path, startPosition,
+		[&onLine](const TailData &data)
+		{
+			// Only the last line may not be ended, when the file was rotated or the line is longer than the buffer
+			auto	   rotated = data.rotated;
+			auto	   begin = data.data.data();
+			const auto end = begin + data.data.size();
+			while (begin != end)
+			{
+				const auto found = static_cast<const char *>(std::memchr(begin, '\n', end - begin));
+				const auto next = found ? found + 1 : end;
+				auto	   line = std::string_view(begin, (found ? found : end) - begin);
+				if (found && !line.empty() && line.back() == '\r')
+					line.remove_suffix(1);
+				onLine(TailData{line, data.offset + (begin - data.data.data()), data.offset + (next - data.data.data()), rotated});
+				rotated = false;
+				begin = next;
+			}
+		},
+		options);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <recpp/filesystem/Tail.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Follow the file @p path from @p startPosition, calling @p onData with the data appended to it, until the token of @p options is cancelled. Throws
+	 * a filesystem_error with std::errc::invalid_argument if @p options has no token.
+	 * <p>
+	 * The file is drained whenever inotify reports a change in its directory, or every TailOptions::pollInterval where inotify is not available. After
+	 * each drain, the file at @p path is compared with the file open: a different inode means the file was rotated, and the rest of the file open having
+	 * been read, the new file is followed from its start, while a size lower than the position read means the file was truncated and is followed again
+	 * from its start. A @p startPosition beyond the end of the file is handled like a truncation.
+	 */
+	void tailFile(const std::filesystem::path &path, std::uintmax_t startPosition, const std::function<void(const TailData &data)> &onData,
+				  const TailOptions &options);
+
+	/**
+	 * @brief Follow the file @p path like tailFile with TailOptions::wholeLines, calling @p onLine with each line appended to it, without its line
+	 * terminator.
+	 */
+	void tailLines(const std::filesystem::path &path, std::uintmax_t startPosition, const std::function<void(const TailData &line)> &onLine,
+				   TailOptions options);
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,425 @@
+#include "GlobMatcher.h"
+#include "DirectoryWalker.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	constexpr auto none = std::string::npos;
+
+	// Parse the set whose '[' is at begin into set, returning the index of its closing ']', or none if it is not closed and the '[' is a literal one
+	std::size_t parseSet(const std::string &text, std::size_t begin, std::bitset<256> &set)
+	{
+		auto	   i = begin + 1;
+		const bool negated = i < text.size() && (text[i] == '!' || text[i] == '^');
+		if (negated)
+			i++;
+
+		// A ']' right after the '[' is a member of the set rather than its end
+		std::bitset<256> characters;
+		for (const auto first = i; i < text.size(); i++)
+		{
+			if (text[i] == ']' && i > first)
+			{
+				set = negated ? ~characters : characters;
+				return i;
+			}
+			if (text[i] == '\\' && i + 1 < text.size())
+				i++;
+			unsigned low = static_cast<unsigned char>(text[i]);
+			unsigned high = low;
+			if (i + 2 < text.size() && text[i + 1] == '-' && text[i + 2] != ']')
+			{
+				i += 2;
+				if (text[i] == '\\' && i + 1 < text.size())
+					i++;
+				high = static_cast<unsigned char>(text[i]);
+			}
+			for (auto character = low; character <= high; character++)
+				characters.set(character);
+		}
+		return none;
+	}
+
+	// Names are UTF-8, a character is a whole sequence of bytes
+	std::size_t nextCharacter(const std::string &name, std::size_t position)
+	{
+		for (position++; position < name.size() && (static_cast<unsigned char>(name[position]) & 0xC0) == 0x80;)
+			position++;
+		return position;
+	}
+
+	std::vector<std::string> split(const std::string &pattern)
+	{
+		std::vector<std::string> segments;
+		for (std::size_t begin = 0; begin < pattern.size();)
+		{
+			auto end = pattern.find('/', begin);
+			if (end == none)
+				end = pattern.size();
+			if (end > begin)
+				segments.push_back(pattern.substr(begin, end - begin));
+			begin = end + 1;
+		}
+		return segments;
+	}
+
+	// Walk with walker only the directories that may contain matches of pattern, isDirectory telling whether the roots of the walk exist
+	template <typename Walker, typename IsDirectory>
+	void globWith(Walker walker, const IsDirectory &isDirectory, const std::string &pattern,
+				  const std::function<void(const std::filesystem::path &path)> &onMatch, const GlobOptions &options)
+	{
+		struct Pending
+		{
+			GlobMatcher::States states;
+			bool				implicit;
+		};
+
+		// Only the directories registered here, that may contain matches, are descended into
+		const GlobMatcher												matcher(pattern, options.matchHidden);
+		std::unordered_map<std::filesystem::path::string_type, Pending>	pending;
+		std::vector<std::filesystem::path>								roots;
+		std::mutex														mutex;
+		std::mutex														onMatchMutex;
+		for (const auto &root : matcher.roots())
+		{
+			// A missing literal prefix only means that nothing matches
+			if (!isDirectory(root.path))
+				continue;
+			roots.push_back(root.path);
+			pending.emplace(root.path.native(), Pending{root.states, root.implicit});
+		}
+		if (roots.empty())
+			return;
+
+		walker.setFilter(
+			[&pending, &mutex](const auto &directory)
+			{
+				std::lock_guard lock(mutex);
+				return pending.count(entryPath(directory).native()) > 0;
+			});
+		walker.walk(roots,
+					[&matcher, &pending, &mutex, &onMatch, &onMatchMutex](const std::filesystem::path &directory, const auto &entries)
+					{
+						if (directory.empty())
+							return;
+						Pending current;
+						{
+							std::lock_guard lock(mutex);
+							const auto		node = pending.find(directory.native());
+							current = std::move(node->second);
+							pending.erase(node);
+						}
+
+						std::vector<std::pair<std::filesystem::path::string_type, Pending>>	directories;
+						GlobMatcher::States													next;
+						for (const auto &entry : entries)
+						{
+							const auto &path = entryPath(entry);
+							const auto	isDirectory = entryType(entry, false) == std::filesystem::file_type::directory;
+							if (matcher.match(current.states, path.filename().u8string(), isDirectory, next))
+							{
+								// The "./" of the current directory is only there when the pattern has it
+								const auto		match = current.implicit ? std::filesystem::path(path.native().substr(2)) : path;
+								std::lock_guard lock(onMatchMutex);
+								onMatch(match);
+							}
+							if (!next.empty())
+								directories.emplace_back(path.native(), Pending{next, current.implicit});
+						}
+						std::lock_guard lock(mutex);
+						for (auto &subdirectory : directories)
+							pending.insert(std::move(subdirectory));
+					});
+	}
+} // namespace
+
+bool recpp::filesystem::detail::GlobMatcher::State::operator==(const State &other) const
+{
+	return pattern == other.pattern && segment == other.segment;
+}
+
+recpp::filesystem::detail::GlobMatcher::GlobMatcher(const std::string &pattern, bool matchHidden)
+	: m_matchHidden(matchHidden)
+{
+	if (pattern.empty())
+		throw std::invalid_argument("empty glob pattern");
+
+	// The leading literal segments of each pattern name the directory its walk can start from, the last segment being matched against a listing
+	std::vector<bool>		 absolute;
+	std::vector<std::size_t> prefixes;
+	for (const auto &expanded : expandBraces(pattern))
+	{
+		std::vector<Segment> segments;
+		for (const auto &segment : split(expanded))
+			segments.push_back(compile(segment));
+		if (segments.empty())
+			continue;
+
+		std::size_t prefix = 0;
+		while (prefix + 1 < segments.size() && segments[prefix].literal)
+			prefix++;
+		absolute.push_back(expanded.front() == '/');
+		prefixes.push_back(prefix);
+		m_patterns.push_back(std::move(segments));
+		m_directoryOnly.push_back(expanded.back() == '/');
+	}
+
+	// A pattern whose prefix is under the prefix of another one starts from the same directory, so that no directory is walked twice
+	const auto samePrefix = [this](std::size_t pattern1, std::size_t pattern2, std::size_t length)
+	{
+		for (std::size_t i = 0; i < length; i++)
+		{
+			if (m_patterns[pattern1][i].text != m_patterns[pattern2][i].text)
+				return false;
+		}
+		return true;
+	};
+	std::map<std::pair<bool, std::vector<std::string>>, std::size_t> roots;
+	for (std::size_t pattern = 0; pattern < m_patterns.size(); pattern++)
+	{
+		auto start = prefixes[pattern];
+		for (std::size_t other = 0; other < m_patterns.size(); other++)
+		{
+			if (absolute[other] == absolute[pattern] && prefixes[other] < start && samePrefix(other, pattern, prefixes[other]))
+				start = prefixes[other];
+		}
+
+		std::vector<std::string> key;
+		std::string				 path = absolute[pattern] ? "/" : "";
+		for (std::size_t i = 0; i < start; i++)
+		{
+			key.push_back(m_patterns[pattern][i].text);
+			path += (i > 0 ? "/" : "") + key.back();
+		}
+		const auto root = roots.emplace(std::make_pair(absolute[pattern], key), m_roots.size());
+		if (root.second)
+			m_roots.push_back(Root{std::filesystem::u8path(path.empty() ? "." : path), path.empty(), {}});
+		m_roots[root.first->second].states.push_back(State{pattern, start});
+	}
+	for (auto &root : m_roots)
+		close(root.states);
+}
+
+const std::vector<GlobMatcher::Root> &recpp::filesystem::detail::GlobMatcher::roots() const
+{
+	return m_roots;
+}
+
+bool recpp::filesystem::detail::GlobMatcher::match(const States &states, const std::string &name, bool isDirectory, States &next) const
+{
+	next.clear();
+	const auto add = [&next](State state)
+	{
+		if (std::find(next.begin(), next.end(), state) == next.end())
+			next.push_back(state);
+	};
+	for (const auto &state : states)
+	{
+		const auto &pattern = m_patterns[state.pattern];
+		if (state.segment == pattern.size())
+			continue;
+		const auto &segment = pattern[state.segment];
+		// "**" consumes the name and stays, to match the entries under it as well, hidden names excepted like for "*"
+		if (segment.recursive && (m_matchHidden || name.front() != '.'))
+			add(state);
+		else if (!segment.recursive && matchSegment(segment, name))
+			add(State{state.pattern, state.segment + 1});
+	}
+	close(next);
+
+	// The states that reached the end of their pattern are the matches, unless the pattern ends with a '/' and the entry is not a directory, the other
+	// ones are left to the entries of a directory
+	bool matched = false;
+	next.erase(std::remove_if(next.begin(), next.end(),
+							  [this, &matched, isDirectory](const State &state)
+							  {
+								  const auto end = state.segment == m_patterns[state.pattern].size();
+								  matched = matched || (end && (isDirectory || !m_directoryOnly[state.pattern]));
+								  return end;
+							  }),
+			   next.end());
+	if (!isDirectory)
+		next.clear();
+	return matched;
+}
+
+std::vector<std::string> recpp::filesystem::detail::GlobMatcher::expandBraces(const std::string &pattern)
+{
+	// The first group with a comma at its level is expanded, braces that are escaped, unmatched or without a comma being literal ones
+	for (std::size_t open = 0; open < pattern.size(); open++)
+	{
+		if (pattern[open] == '\\')
+		{
+			open++;
+			continue;
+		}
+		if (pattern[open] != '{')
+			continue;
+
+		std::vector<std::size_t> commas;
+		std::size_t				 close = none;
+		std::size_t				 depth = 0;
+		for (auto i = open + 1; i < pattern.size() && close == none; i++)
+		{
+			if (pattern[i] == '\\')
+				i++;
+			else if (pattern[i] == '{')
+				depth++;
+			else if (pattern[i] == '}' && depth > 0)
+				depth--;
+			else if (pattern[i] == '}')
+				close = i;
+			else if (pattern[i] == ',' && depth == 0)
+				commas.push_back(i);
+		}
+		if (close == none || commas.empty())
+			continue;
+
+		commas.push_back(close);
+		std::vector<std::string> patterns;
+		auto					 begin = open + 1;
+		for (const auto comma : commas)
+		{
+			for (auto &expanded : expandBraces(pattern.substr(0, open) + pattern.substr(begin, comma - begin) + pattern.substr(close + 1)))
+				patterns.push_back(std::move(expanded));
+			begin = comma + 1;
+		}
+		return patterns;
+	}
+	return {pattern};
+}
+
+GlobMatcher::Segment recpp::filesystem::detail::GlobMatcher::compile(const std::string &text)
+{
+	Segment segment;
+	if (text == "**")
+	{
+		segment.recursive = true;
+		segment.literal = false;
+		return segment;
+	}
+
+	for (std::size_t i = 0; i < text.size(); i++)
+	{
+		Token token{Token::Kind::character, text[i], {}};
+		if (text[i] == '\\' && i + 1 < text.size())
+			token.character = text[++i];
+		else if (text[i] == '*')
+		{
+			// Consecutive stars match the same names as a single one
+			if (!segment.tokens.empty() && segment.tokens.back().kind == Token::Kind::anyString)
+				continue;
+			token.kind = Token::Kind::anyString;
+		}
+		else if (text[i] == '?')
+			token.kind = Token::Kind::anyCharacter;
+		else if (text[i] == '[')
+		{
+			const auto end = parseSet(text, i, token.set);
+			if (end != none)
+			{
+				token.kind = Token::Kind::characterSet;
+				i = end;
+			}
+		}
+
+		if (token.kind == Token::Kind::character)
+			segment.text += token.character;
+		else
+			segment.literal = false;
+		segment.tokens.push_back(token);
+	}
+	return segment;
+}
+
+bool recpp::filesystem::detail::GlobMatcher::matchSegment(const Segment &segment, const std::string &name) const
+{
+	if (segment.literal)
+		return name == segment.text;
+	// Wildcards do not match a leading dot, which has to be matched by a literal one
+	if (!m_matchHidden && name.front() == '.' && segment.tokens.front().kind != Token::Kind::character)
+		return false;
+
+	// Each star first matches as few characters as possible, and then one more each time the tokens after it fail to match
+	const auto &tokens = segment.tokens;
+	std::size_t token = 0;
+	std::size_t position = 0;
+	std::size_t starToken = none;
+	std::size_t starPosition = 0;
+	while (position < name.size())
+	{
+		if (token < tokens.size())
+		{
+			const auto &current = tokens[token];
+			if (current.kind == Token::Kind::anyString)
+			{
+				starToken = token++;
+				starPosition = position;
+				continue;
+			}
+			if ((current.kind == Token::Kind::character && name[position] == current.character) || current.kind == Token::Kind::anyCharacter ||
+				(current.kind == Token::Kind::characterSet && current.set[static_cast<unsigned char>(name[position])]))
+			{
+				token++;
+				position = current.kind == Token::Kind::character ? position + 1 : nextCharacter(name, position);
+				continue;
+			}
+		}
+		if (starToken == none)
+			return false;
+		token = starToken + 1;
+		position = starPosition = nextCharacter(name, starPosition);
+	}
+	while (token < tokens.size() && tokens[token].kind == Token::Kind::anyString)
+		token++;
+	return token == tokens.size();
+}
+
+void recpp::filesystem::detail::GlobMatcher::close(States &states) const
+{
+	// A "**" may also match no directory at all, so the segment after it can be matched right away
+	for (std::size_t i = 0; i < states.size(); i++)
+	{
+		const auto	state = states[i];
+		const auto &pattern = m_patterns[state.pattern];
+		if (state.segment == pattern.size() || !pattern[state.segment].recursive)
+			continue;
+		const State skipped{state.pattern, state.segment + 1};
+		if (std::find(states.begin(), states.end(), skipped) == states.end())
+			states.push_back(skipped);
+	}
+}
+
+void recpp::filesystem::detail::glob(const std::string &pattern, const std::function<void(const std::filesystem::path &path)> &onMatch,
+									 const GlobOptions &options)
+{
+	globWith(
+		DirectoryWalker(options.threads, options.directoryOptions, options.token),
+		[](const std::filesystem::path &path)
+		{
+			std::error_code error;
+			return std::filesystem::is_directory(path, error);
+		},
+		pattern, onMatch, options);
+}
+
+void recpp::filesystem::detail::glob(const FileSystemBackend &backend, const std::string &pattern,
+									 const std::function<void(const std::filesystem::path &path)> &onMatch, const GlobOptions &options)
+{
+	globWith(
+		BackendWalker(backend, options.threads, options.token),
+		[&backend](const std::filesystem::path &path)
+		{
+			return std::filesystem::is_directory(backend.status(path));
+		},
+		pattern, onMatch, options);
+}
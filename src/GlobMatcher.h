@@ -0,0 +1,115 @@
+#pragma once
+
+#include <recpp/filesystem/FileSystemBackend.h>
+#include <recpp/filesystem/Glob.h>
+
+#include <bitset>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief GlobMatcher compiles a glob pattern once, to match the entries of each directory of a walk against it.
+	 * <p>
+	 * Braces are expanded first, each alternative becoming a pattern of its own. Each pattern is then split into segments at '/': the leading literal
+	 * segments give the directory where the walk of the pattern starts, and the other ones are compiled into tokens. A directory of the walk is described
+	 * by the set of the positions in the patterns its entries may match next, so that a directory whose set is empty is not descended into. A "**"
+	 * segment matches any number of directories, and a pattern ending with a '/' only matches directories.
+	 */
+	class GlobMatcher
+	{
+	public:
+		/**
+		 * @brief A position in a pattern, the index of the next segment to match in the pattern at index pattern.
+		 */
+		struct State
+		{
+			std::size_t pattern;
+			std::size_t segment;
+
+			bool operator==(const State &other) const;
+		};
+
+		using States = std::vector<State>;
+
+		/**
+		 * @brief A directory where the walk starts, given by the literal segments leading the patterns.
+		 */
+		struct Root
+		{
+			std::filesystem::path path;
+			/// Whether the root is the current directory without the pattern naming it, so that "./" is stripped from the matches
+			bool				  implicit;
+			States				  states;
+		};
+
+		/**
+		 * @brief Compile @p pattern, throwing std::invalid_argument if it is empty.
+		 */
+		GlobMatcher(const std::string &pattern, bool matchHidden);
+
+		/**
+		 * @brief Get the directories where the walk starts, none of them being under another one.
+		 */
+		const std::vector<Root> &roots() const;
+
+		/**
+		 * @brief Match the entry @p name of a directory described by @p states.
+		 *
+		 * @param next Receives the states of the entries of @p name, when it is a directory that may contain matches
+		 * @return Whether @p name matches one of the patterns
+		 */
+		bool match(const States &states, const std::string &name, bool isDirectory, States &next) const;
+
+	private:
+		struct Token
+		{
+			enum class Kind
+			{
+				character,
+				anyCharacter,
+				anyString,
+				characterSet,
+			};
+
+			Kind			 kind;
+			char			 character;
+			std::bitset<256> set;
+		};
+
+		struct Segment
+		{
+			bool			   recursive = false;
+			bool			   literal = true;
+			std::string		   text;
+			std::vector<Token> tokens;
+		};
+
+		static std::vector<std::string> expandBraces(const std::string &pattern);
+		static Segment					compile(const std::string &segment);
+		bool							matchSegment(const Segment &segment, const std::string &name) const;
+		void							close(States &states) const;
+
+		bool							  m_matchHidden;
+		std::vector<std::vector<Segment>> m_patterns;
+		/// Whether each pattern ends with a '/', to match directories only
+		std::vector<bool>				  m_directoryOnly;
+		std::vector<Root>				  m_roots;
+	};
+
+	/**
+	 * @brief Call @p onMatch with each path matching @p pattern, walking only the directories that may contain matches, on several threads.
+	 * @p onMatch is called from the worker threads, one path at a time.
+	 */
+	void glob(const std::string &pattern, const std::function<void(const std::filesystem::path &path)> &onMatch, const GlobOptions &options);
+
+	/**
+	 * @brief Same as glob(pattern, onMatch, options) on the tree of @p backend, GlobOptions::directoryOptions being ignored.
+	 */
+	void glob(const FileSystemBackend &backend, const std::string &pattern, const std::function<void(const std::filesystem::path &path)> &onMatch,
+			  const GlobOptions &options);
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,128 @@
+#include "recpp/filesystem/Hash.h"
+#include "Blake3.h"
+#include "XxHash3.h"
+
+#include <stdexcept>
+#include <tuple>
+#include <variant>
+
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	std::uint8_t bigEndianByte(std::uint64_t value, std::size_t index)
+	{
+		return static_cast<std::uint8_t>(value >> (56 - 8 * index));
+	}
+} // namespace
+
+struct recpp::filesystem::Hasher::State
+{
+	std::variant<XxHash3, Blake3> hash;
+};
+
+recpp::filesystem::Digest::Digest(HashAlgorithm algorithm, const std::uint8_t *data, std::size_t size)
+	: m_algorithm(algorithm)
+	, m_size(size)
+{
+	if (size > maxSize)
+		throw std::invalid_argument("digest of " + std::to_string(size) + " bytes exceeds the maximum of " + std::to_string(maxSize) + " bytes");
+	std::memcpy(m_bytes.data(), data, size);
+}
+
+recpp::filesystem::HashAlgorithm recpp::filesystem::Digest::algorithm() const
+{
+	return m_algorithm;
+}
+
+const std::uint8_t *recpp::filesystem::Digest::data() const
+{
+	return m_bytes.data();
+}
+
+std::size_t recpp::filesystem::Digest::size() const
+{
+	return m_size;
+}
+
+std::string recpp::filesystem::Digest::toString() const
+{
+	static constexpr char digits[] = "0123456789abcdef";
+
+	std::string result;
+	result.reserve(2 * m_size);
+	for (std::size_t i = 0; i < m_size; i++)
+	{
+		result.push_back(digits[m_bytes[i] >> 4]);
+		result.push_back(digits[m_bytes[i] & 0xF]);
+	}
+	return result;
+}
+
+bool recpp::filesystem::Digest::operator==(const Digest &other) const
+{
+	return m_algorithm == other.m_algorithm && m_size == other.m_size && m_bytes == other.m_bytes;
+}
+
+bool recpp::filesystem::Digest::operator!=(const Digest &other) const
+{
+	return !(*this == other);
+}
+
+bool recpp::filesystem::Digest::operator<(const Digest &other) const
+{
+	return std::tie(m_algorithm, m_size, m_bytes) < std::tie(other.m_algorithm, other.m_size, other.m_bytes);
+}
+
+recpp::filesystem::Hasher::Hasher(HashAlgorithm algorithm)
+	: m_algorithm(algorithm)
+{
+	m_state = std::make_unique<State>();
+	if (algorithm == HashAlgorithm::blake3)
+		m_state->hash.emplace<Blake3>();
+}
+
+recpp::filesystem::Hasher::Hasher(Hasher &&other) noexcept = default;
+
+recpp::filesystem::Hasher::~Hasher() = default;
+
+recpp::filesystem::Hasher &recpp::filesystem::Hasher::operator=(Hasher &&other) noexcept = default;
+
+recpp::filesystem::HashAlgorithm recpp::filesystem::Hasher::algorithm() const
+{
+	return m_algorithm;
+}
+
+void recpp::filesystem::Hasher::update(const void *data, std::size_t size)
+{
+	const auto *bytes = static_cast<const std::uint8_t *>(data);
+	if (auto *blake3 = std::get_if<Blake3>(&m_state->hash))
+		blake3->update(bytes, size);
+	else
+		std::get<XxHash3>(m_state->hash).update(bytes, size);
+}
+
+recpp::filesystem::Digest recpp::filesystem::Hasher::digest() const
+{
+	if (const auto *blake3 = std::get_if<Blake3>(&m_state->hash))
+	{
+		std::uint8_t bytes[Blake3::digestSize];
+		blake3->digest(bytes);
+		return Digest(HashAlgorithm::blake3, bytes, sizeof(bytes));
+	}
+
+	// XXH3 digests are stored in big endian order like the canonical representation of the reference implementation
+	const auto	 value = std::get<XxHash3>(m_state->hash).digest();
+	std::uint8_t bytes[sizeof(value)];
+	for (std::size_t i = 0; i < sizeof(bytes); i++)
+		bytes[i] = bigEndianByte(value, i);
+	return Digest(HashAlgorithm::xxh3, bytes, sizeof(bytes));
+}
+
+void recpp::filesystem::Hasher::reset()
+{
+	if (auto *blake3 = std::get_if<Blake3>(&m_state->hash))
+		blake3->reset();
+	else
+		std::get<XxHash3>(m_state->hash).reset();
+}
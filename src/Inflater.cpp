@@ -0,0 +1,453 @@
+#include "Inflater.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+#ifdef RECPP_FILESYSTEM_ZLIB
+#include <new>
+
+#include <zlib.h>
+
+namespace
+{
+	constexpr std::size_t inputSize = 1 << 16;
+	constexpr std::size_t outputSize = 1 << 18;
+
+	[[noreturn]] void invalid(const char *reason)
+	{
+		throw std::system_error(std::make_error_code(std::errc::bad_message), reason);
+	}
+} // namespace
+
+recpp::filesystem::detail::Inflater::Inflater(Source source)
+	: m_source(std::move(source))
+	, m_input(inputSize)
+	, m_output(outputSize)
+	, m_stream(std::make_unique<z_stream>())
+{
+	// Negative window bits select raw deflate streams, without the header and the trailer of the zlib format
+	if (inflateInit2(m_stream.get(), -MAX_WBITS) != Z_OK)
+		throw std::bad_alloc();
+}
+
+recpp::filesystem::detail::Inflater::~Inflater()
+{
+	inflateEnd(m_stream.get());
+}
+
+std::uintmax_t recpp::filesystem::detail::Inflater::inflate(const Sink &sink)
+{
+	inflateReset(m_stream.get());
+	std::uintmax_t total = 0;
+	auto		   full = false;
+	for (auto result = Z_OK; result != Z_STREAM_END;)
+	{
+		// More input is only needed once zlib flushed the output it has pending, which it may have when the last call filled the output buffer
+		if (m_position == m_end && !full)
+		{
+			m_position = 0;
+			m_end = m_sourceEnded ? 0 : m_source(m_input.data(), m_input.size());
+			m_sourceEnded = m_end == 0;
+			if (m_sourceEnded)
+				invalid("truncated deflate stream");
+		}
+		m_stream->next_in = m_input.data() + m_position;
+		m_stream->avail_in = static_cast<uInt>(m_end - m_position);
+		m_stream->next_out = m_output.data();
+		m_stream->avail_out = static_cast<uInt>(m_output.size());
+		result = ::inflate(m_stream.get(), Z_NO_FLUSH);
+		m_position = m_end - m_stream->avail_in;
+		if (result == Z_MEM_ERROR)
+			throw std::bad_alloc();
+		// Z_BUF_ERROR only means that no progress was possible without more input
+		if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR)
+			invalid(m_stream->msg ? m_stream->msg : "invalid deflate stream");
+		const auto count = m_output.size() - m_stream->avail_out;
+		full = m_stream->avail_out == 0;
+		if (count)
+			sink(m_output.data(), count);
+		total += count;
+	}
+	return total;
+}
+
+std::size_t recpp::filesystem::detail::Inflater::read(std::uint8_t *data, std::size_t size)
+{
+	// zlib consumes the stream up to the byte holding its last bit, so the bytes following it are the rest of the input buffer
+	std::size_t done = 0;
+	while (done < size)
+	{
+		if (m_position == m_end)
+		{
+			if (m_sourceEnded)
+				break;
+			// Large reads bypass the input buffer
+			if (size - done >= m_input.size())
+			{
+				const auto count = m_source(data + done, size - done);
+				m_sourceEnded = count == 0;
+				done += count;
+				continue;
+			}
+			m_position = 0;
+			m_end = m_source(m_input.data(), m_input.size());
+			m_sourceEnded = m_end == 0;
+			continue;
+		}
+		const auto count = std::min(size - done, m_end - m_position);
+		std::memcpy(data + done, m_input.data() + m_position, count);
+		m_position += count;
+		done += count;
+	}
+	return done;
+}
+#else
+
+namespace
+{
+	// The largest distance a match can refer back to
+	constexpr std::size_t historySize = 32768;
+	// The longest match
+	constexpr std::size_t maximumLength = 258;
+	constexpr std::size_t inputSize = 1 << 16;
+	constexpr std::size_t windowSize = 1 << 18;
+
+	constexpr std::uint16_t lengthBases[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+	constexpr std::uint8_t	lengthExtraBits[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+	constexpr std::uint16_t distanceBases[] = {1,	2,	 3,	  4,   5,	7,	  9,	13,	  17,	25,	  33,	49,	  65,	 97,	129,
+											   193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+	constexpr std::uint8_t	distanceExtraBits[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+	// The order in which the lengths of the code length codes are stored
+	constexpr std::uint8_t	codeLengthOrder[] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+	[[noreturn]] void invalid(const char *reason)
+	{
+		throw std::system_error(std::make_error_code(std::errc::bad_message), reason);
+	}
+
+	unsigned reverse(unsigned code, unsigned length)
+	{
+		unsigned reversed = 0;
+		for (unsigned i = 0; i < length; i++, code >>= 1)
+			reversed = (reversed << 1) | (code & 1);
+		return reversed;
+	}
+} // namespace
+
+recpp::filesystem::detail::Inflater::Inflater(Source source)
+	: m_source(std::move(source))
+	, m_input(inputSize)
+	, m_window(windowSize)
+{
+	std::uint8_t lengths[288];
+	std::fill(lengths, lengths + 144, 8);
+	std::fill(lengths + 144, lengths + 256, 9);
+	std::fill(lengths + 256, lengths + 280, 7);
+	std::fill(lengths + 280, lengths + 288, 8);
+	build(m_fixedLengths, lengths, 288);
+	std::fill(lengths, lengths + 30, 5);
+	build(m_fixedDistances, lengths, 30);
+}
+
+std::uintmax_t recpp::filesystem::detail::Inflater::inflate(const Sink &sink)
+{
+	m_output = 0;
+	m_flushed = 0;
+	m_total = 0;
+	auto last = false;
+	while (!last)
+	{
+		last = bits(1) != 0;
+		switch (bits(2))
+		{
+		case 0:
+			copyStoredBlock(sink);
+			break;
+		case 1:
+			inflateBlock(m_fixedLengths, m_fixedDistances, sink);
+			break;
+		case 2:
+			readDynamicCodes();
+			inflateBlock(m_lengths, m_distances, sink);
+			break;
+		default:
+			invalid("invalid deflate block type");
+		}
+	}
+	if (m_output > m_flushed)
+	{
+		sink(m_window.data() + m_flushed, m_output - m_flushed);
+		m_total += m_output - m_flushed;
+		m_flushed = m_output;
+	}
+	return m_total;
+}
+
+std::size_t recpp::filesystem::detail::Inflater::read(std::uint8_t *data, std::size_t size)
+{
+	// The bytes already moved to the bit buffer come first, from the next byte boundary
+	m_bits >>= m_bitCount % 8;
+	m_bitCount -= m_bitCount % 8;
+	std::size_t done = 0;
+	for (; done < size && m_bitCount >= 8; m_bitCount -= 8, m_bits >>= 8)
+		data[done++] = static_cast<std::uint8_t>(m_bits);
+
+	while (done < size)
+	{
+		if (m_position == m_end)
+		{
+			if (m_sourceEnded)
+				break;
+			// Large reads bypass the input buffer
+			if (size - done >= m_input.size())
+			{
+				const auto count = m_source(data + done, size - done);
+				m_sourceEnded = count == 0;
+				done += count;
+				continue;
+			}
+			m_position = 0;
+			m_end = m_source(m_input.data(), m_input.size());
+			m_sourceEnded = m_end == 0;
+			continue;
+		}
+		const auto count = std::min(size - done, m_end - m_position);
+		std::memcpy(data + done, m_input.data() + m_position, count);
+		m_position += count;
+		done += count;
+	}
+	return done;
+}
+
+void recpp::filesystem::detail::Inflater::fill()
+{
+	while (m_bitCount <= 56)
+	{
+		if (m_position == m_end)
+		{
+			if (m_sourceEnded)
+				return;
+			m_position = 0;
+			m_end = m_source(m_input.data(), m_input.size());
+			if (m_end == 0)
+			{
+				m_sourceEnded = true;
+				return;
+			}
+		}
+		m_bits |= static_cast<std::uint64_t>(m_input[m_position++]) << m_bitCount;
+		m_bitCount += 8;
+	}
+}
+
+std::uint32_t recpp::filesystem::detail::Inflater::bits(unsigned count)
+{
+	if (m_bitCount < count)
+	{
+		fill();
+		if (m_bitCount < count)
+			invalid("truncated deflate stream");
+	}
+	const auto value = static_cast<std::uint32_t>(m_bits & ((std::uint64_t(1) << count) - 1));
+	m_bits >>= count;
+	m_bitCount -= count;
+	return value;
+}
+
+void recpp::filesystem::detail::Inflater::build(Huffman &huffman, const std::uint8_t *lengths, std::size_t count)
+{
+	huffman.counts.fill(0);
+	for (std::size_t symbol = 0; symbol < count; symbol++)
+		huffman.counts[lengths[symbol]]++;
+	huffman.counts[0] = 0;
+
+	// Codes may be incomplete, in which case the missing codes are rejected when decoded, but not over-subscribed
+	int left = 1;
+	for (unsigned length = 1; length < huffman.counts.size(); length++)
+	{
+		left = (left << 1) - huffman.counts[length];
+		if (left < 0)
+			invalid("over-subscribed Huffman code");
+	}
+
+	std::array<std::uint16_t, 16> offsets = {};
+	for (unsigned length = 1; length + 1 < offsets.size(); length++)
+		offsets[length + 1] = offsets[length] + huffman.counts[length];
+	for (std::size_t symbol = 0; symbol < count; symbol++)
+	{
+		if (lengths[symbol])
+			huffman.symbols[offsets[lengths[symbol]]++] = static_cast<std::uint16_t>(symbol);
+	}
+
+	// Each short code fills every entry of the table whose first bits are the code, in the order they are read from the stream
+	huffman.fast.fill(0);
+	unsigned code = 0;
+	unsigned index = 0;
+	for (unsigned length = 1; length <= fastBits; length++, code <<= 1)
+	{
+		for (unsigned i = 0; i < huffman.counts[length]; i++, code++)
+		{
+			const auto entry = static_cast<std::uint16_t>(huffman.symbols[index++] << 4 | length);
+			for (auto bits = reverse(code, length); bits < huffman.fast.size(); bits += 1U << length)
+				huffman.fast[bits] = entry;
+		}
+	}
+}
+
+unsigned recpp::filesystem::detail::Inflater::decode(const Huffman &huffman)
+{
+	if (m_bitCount < 15)
+		fill();
+	const auto entry = huffman.fast[m_bits & (huffman.fast.size() - 1)];
+	if (entry)
+	{
+		const unsigned length = entry & 15;
+		if (length > m_bitCount)
+			invalid("truncated deflate stream");
+		m_bits >>= length;
+		m_bitCount -= length;
+		return entry >> 4;
+	}
+
+	// Longer codes are decoded one bit at a time, comparing them with the first code of each length
+	int code = 0;
+	int first = 0;
+	int index = 0;
+	for (unsigned length = 1; length < huffman.counts.size(); length++)
+	{
+		code |= static_cast<int>((m_bits >> (length - 1)) & 1);
+		const int count = huffman.counts[length];
+		if (code - count < first)
+		{
+			if (length > m_bitCount)
+				invalid("truncated deflate stream");
+			m_bits >>= length;
+			m_bitCount -= length;
+			return huffman.symbols[index + (code - first)];
+		}
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+	invalid("invalid Huffman code");
+}
+
+void recpp::filesystem::detail::Inflater::readDynamicCodes()
+{
+	const auto lengthCount = bits(5) + 257;
+	const auto distanceCount = bits(5) + 1;
+	const auto codeLengthCount = bits(4) + 4;
+	if (lengthCount > 286 || distanceCount > 30)
+		invalid("too many deflate codes");
+
+	std::uint8_t lengths[286 + 30] = {};
+	for (unsigned i = 0; i < codeLengthCount; i++)
+		lengths[codeLengthOrder[i]] = static_cast<std::uint8_t>(bits(3));
+	Huffman codeLengths;
+	build(codeLengths, lengths, 19);
+
+	std::fill(std::begin(lengths), std::end(lengths), 0);
+	for (unsigned i = 0; i < lengthCount + distanceCount;)
+	{
+		const auto symbol = decode(codeLengths);
+		if (symbol < 16)
+		{
+			lengths[i++] = static_cast<std::uint8_t>(symbol);
+			continue;
+		}
+		std::uint8_t length = 0;
+		unsigned	 repeat = 0;
+		if (symbol == 16)
+		{
+			if (i == 0)
+				invalid("repeated deflate code length without a previous one");
+			length = lengths[i - 1];
+			repeat = 3 + bits(2);
+		}
+		else if (symbol == 17)
+			repeat = 3 + bits(3);
+		else
+			repeat = 11 + bits(7);
+		if (i + repeat > lengthCount + distanceCount)
+			invalid("too many deflate code lengths");
+		std::fill(lengths + i, lengths + i + repeat, length);
+		i += repeat;
+	}
+	if (lengths[256] == 0)
+		invalid("deflate block without an end code");
+
+	build(m_lengths, lengths, lengthCount);
+	build(m_distances, lengths + lengthCount, distanceCount);
+}
+
+void recpp::filesystem::detail::Inflater::inflateBlock(const Huffman &lengths, const Huffman &distances, const Sink &sink)
+{
+	for (;;)
+	{
+		auto symbol = decode(lengths);
+		if (symbol < 256)
+		{
+			reserve(sink);
+			m_window[m_output++] = static_cast<std::uint8_t>(symbol);
+			continue;
+		}
+		if (symbol == 256)
+			return;
+
+		symbol -= 257;
+		if (symbol >= std::size(lengthBases))
+			invalid("invalid deflate length code");
+		const auto length = lengthBases[symbol] + bits(lengthExtraBits[symbol]);
+		symbol = decode(distances);
+		if (symbol >= std::size(distanceBases))
+			invalid("invalid deflate distance code");
+		const auto distance = distanceBases[symbol] + bits(distanceExtraBits[symbol]);
+
+		reserve(sink);
+		if (distance > m_output)
+			invalid("deflate distance too far back");
+		// The source and the destination overlap when the distance is shorter than the length, repeating the last bytes
+		auto	   source = m_window.data() + m_output - distance;
+		auto	   destination = m_window.data() + m_output;
+		const auto end = destination + length;
+		while (destination != end)
+			*destination++ = *source++;
+		m_output += length;
+	}
+}
+
+void recpp::filesystem::detail::Inflater::copyStoredBlock(const Sink &sink)
+{
+	m_bits >>= m_bitCount % 8;
+	m_bitCount -= m_bitCount % 8;
+	auto		length = bits(16);
+	const auto	complement = bits(16);
+	if (length != (~complement & 0xFFFF))
+		invalid("invalid stored deflate block length");
+	while (length > 0)
+	{
+		reserve(sink);
+		const auto count = std::min<std::size_t>(length, m_window.size() - m_output);
+		if (read(m_window.data() + m_output, count) != count)
+			invalid("truncated deflate stream");
+		m_output += count;
+		length -= static_cast<std::uint32_t>(count);
+	}
+}
+
+void recpp::filesystem::detail::Inflater::reserve(const Sink &sink)
+{
+	if (m_output + maximumLength <= m_window.size())
+		return;
+	sink(m_window.data() + m_flushed, m_output - m_flushed);
+	m_total += m_output - m_flushed;
+	// Only the history matches can refer back to is kept
+	const auto kept = std::min(m_output, historySize);
+	std::memmove(m_window.data(), m_window.data() + m_output - kept, kept);
+	m_output = kept;
+	m_flushed = kept;
+}
+#endif
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#ifdef RECPP_FILESYSTEM_ZLIB
+#include <memory>
+
+struct z_stream_s;
+#endif
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Streaming decompressor of the raw deflate format of RFC 1951, used by zip and gzip.
+	 * <p>
+	 * The compressed stream is pulled from a source in blocks, and the decompressed data is pushed to a sink in blocks as well, so that the memory used does
+	 * not depend on the size of the stream: only the 32 KiB window the stream refers back to is kept between two blocks. Huffman codes are decoded with a
+	 * lookup table indexed by their first bits, the rare longer codes being decoded bit by bit. When the library is built with zlib, the blocks are
+	 * decompressed by zlib instead.
+	 */
+	class Inflater
+	{
+	public:
+		/// Read up to size bytes of the compressed stream into data, returning how many were read, 0 once the stream ended
+		using Source = std::function<std::size_t(std::uint8_t *data, std::size_t size)>;
+		/// Receive the next size decompressed bytes
+		using Sink = std::function<void(const std::uint8_t *data, std::size_t size)>;
+
+		/**
+		 * @brief Construct a new Inflater object, reading the compressed data from @p source.
+		 */
+		explicit Inflater(Source source);
+
+#ifdef RECPP_FILESYSTEM_ZLIB
+		~Inflater();
+#endif
+
+		/**
+		 * @brief Decompress the next deflate stream of the source, up to its final block, calling @p sink with the decompressed data. A std::system_error
+		 * with std::errc::bad_message is thrown if the stream is invalid or truncated.
+		 *
+		 * @return The size of the decompressed data
+		 */
+		std::uintmax_t inflate(const Sink &sink);
+
+		/**
+		 * @brief Read the bytes following the last stream decompressed, such as the trailer of a gzip member, starting at the next byte boundary.
+		 *
+		 * @return The number of bytes read, less than @p size only at the end of the source
+		 */
+		std::size_t read(std::uint8_t *data, std::size_t size);
+
+	private:
+#ifdef RECPP_FILESYSTEM_ZLIB
+		Source						m_source;
+		std::vector<std::uint8_t>	m_input;
+		std::size_t					m_position = 0;
+		std::size_t					m_end = 0;
+		bool						m_sourceEnded = false;
+		std::vector<std::uint8_t>	m_output;
+		std::unique_ptr<z_stream_s>	m_stream;
+#else
+		static constexpr unsigned fastBits = 10;
+
+		struct Huffman
+		{
+			/// The symbol and the length of the codes of at most fastBits bits, indexed by their bits in stream order, 0 for the longer codes
+			std::array<std::uint16_t, 1 << fastBits> fast;
+			/// The number of codes of each length
+			std::array<std::uint16_t, 16>			 counts;
+			/// The symbols sorted by code
+			std::array<std::uint16_t, 288>			 symbols;
+		};
+
+		void fill();
+		std::uint32_t bits(unsigned count);
+		void build(Huffman &huffman, const std::uint8_t *lengths, std::size_t count);
+		unsigned decode(const Huffman &huffman);
+		void readDynamicCodes();
+		void inflateBlock(const Huffman &lengths, const Huffman &distances, const Sink &sink);
+		void copyStoredBlock(const Sink &sink);
+		void reserve(const Sink &sink);
+
+		Source					  m_source;
+		std::vector<std::uint8_t> m_input;
+		std::size_t				  m_position = 0;
+		std::size_t				  m_end = 0;
+		bool					  m_sourceEnded = false;
+		std::uint64_t			  m_bits = 0;
+		unsigned				  m_bitCount = 0;
+		std::vector<std::uint8_t> m_window;
+		std::size_t				  m_output = 0;
+		std::size_t				  m_flushed = 0;
+		std::uintmax_t			  m_total = 0;
+		Huffman					  m_fixedLengths;
+		Huffman					  m_fixedDistances;
+		Huffman					  m_lengths;
+		Huffman					  m_distances;
+#endif
+	};
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,51 @@
+#include "InternedWalk.h"
+#include "DirectoryWalker.h"
+
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	template <typename Walker>
+	void walkWith(const Walker &walker, const std::filesystem::path &root, PathTable &table,
+				  const std::function<void(PathTable::Id id, std::filesystem::file_type type)> &onEntry)
+	{
+		std::mutex mutex;
+		walker.walk({root},
+					[&table, &onEntry, &mutex](const std::filesystem::path &directory, const auto &entries)
+					{
+						if (directory.empty())
+							return;
+
+						// The directory was interned with its parent, so finding it again only takes the shared lock of the table
+						const auto parent = table.intern(directory);
+
+						std::vector<std::pair<PathTable::Id, std::filesystem::file_type>> children;
+						children.reserve(entries.size());
+						for (const auto &entry : entries)
+							children.emplace_back(table.child(parent, entryPath(entry).filename().native()), entryType(entry, false));
+
+						std::lock_guard lock(mutex);
+						for (const auto &[id, type] : children)
+							onEntry(id, type);
+					});
+	}
+} // namespace
+
+void recpp::filesystem::detail::walkInterned(const std::filesystem::path &root, PathTable &table,
+											 const std::function<void(PathTable::Id id, std::filesystem::file_type type)> &onEntry,
+											 const WalkOptions &options)
+{
+	walkWith(DirectoryWalker(options.threads, options.directoryOptions, options.token), root, table, onEntry);
+}
+
+void recpp::filesystem::detail::walkInterned(const FileSystemBackend &backend, const std::filesystem::path &root, PathTable &table,
+											 const std::function<void(PathTable::Id id, std::filesystem::file_type type)> &onEntry,
+											 const WalkOptions &options)
+{
+	walkWith(BackendWalker(backend, options.threads, options.token), root, table, onEntry);
+}
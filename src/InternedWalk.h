@@ -0,0 +1,26 @@
+#pragma once
+
+#include <recpp/filesystem/FileSystemBackend.h>
+#include <recpp/filesystem/Walk.h>
+
+#include <filesystem>
+#include <functional>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Walk the tree rooted at @p root in parallel, interning the path of each entry under it into @p table and calling @p onEntry with its handle and
+	 * type.
+	 * <p>
+	 * The entries of a directory are interned by their name, as children of the handle of the directory, so that no full path is stored. The full paths
+	 * the listing of a directory gives are only kept until the directory is handled. @p onEntry is called from the worker threads, one directory at a time.
+	 */
+	void walkInterned(const std::filesystem::path &root, PathTable &table,
+					  const std::function<void(PathTable::Id id, std::filesystem::file_type type)> &onEntry, const WalkOptions &options);
+
+	/**
+	 * @brief Same as walkInterned(root, table, onEntry, options) on the tree of @p backend, WalkOptions::directoryOptions being ignored.
+	 */
+	void walkInterned(const FileSystemBackend &backend, const std::filesystem::path &root, PathTable &table,
+					  const std::function<void(PathTable::Id id, std::filesystem::file_type type)> &onEntry, const WalkOptions &options);
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,98 @@
+#include "recpp/filesystem/IoScheduler.h"
+#include "PathKey.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <mutex>
+
+using namespace recpp::async;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	std::uintmax_t deviceId(const std::filesystem::path &path)
+	{
+#ifdef _WIN32
+		struct _stat64 info;
+		if (_wstat64(path.c_str(), &info) != 0)
+#else
+		struct stat info;
+		if (::stat(path.c_str(), &info) != 0)
+#endif
+			throw std::filesystem::filesystem_error("stat", path, std::error_code(errno, std::generic_category()));
+		return static_cast<std::uintmax_t>(info.st_dev);
+	}
+} // namespace
+
+recpp::filesystem::IoScheduler::IoScheduler(Scheduler &defaultScheduler)
+	: m_defaults{&defaultScheduler, &defaultScheduler, &defaultScheduler}
+{
+}
+
+void recpp::filesystem::IoScheduler::setScheduler(IoPriority priority, Scheduler &scheduler)
+{
+	std::unique_lock lock(m_mutex);
+	m_defaults[static_cast<std::size_t>(priority)] = &scheduler;
+}
+
+void recpp::filesystem::IoScheduler::addDevice(const std::filesystem::path &mountPoint, IoPriority priority, Scheduler &scheduler)
+{
+	const auto id = deviceId(mountPoint);
+	auto	   key = lexicalKey(mountPoint);
+
+	std::unique_lock lock(m_mutex);
+	auto			 device = std::find_if(m_devices.begin(), m_devices.end(), [id](const Device &device) { return device.id == id; });
+	if (device == m_devices.end())
+		device = m_devices.insert(m_devices.end(), Device{id, {}});
+	device->schedulers[static_cast<std::size_t>(priority)] = &scheduler;
+
+	const auto index = static_cast<std::size_t>(device - m_devices.begin());
+	auto mount = std::find_if(m_mountPoints.begin(), m_mountPoints.end(), [&key](const MountPoint &mount) { return mount.mountPoint == key; });
+	if (mount != m_mountPoints.end())
+		mount->device = index;
+	else
+	{
+		// Keep the longest mount points first so that nested mounts win over their parents
+		auto position = std::find_if(m_mountPoints.begin(), m_mountPoints.end(),
+									 [&key](const MountPoint &mount) { return mount.mountPoint.size() < key.size(); });
+		m_mountPoints.insert(position, MountPoint{std::move(key), index});
+	}
+}
+
+Scheduler &recpp::filesystem::IoScheduler::scheduler(const std::filesystem::path &path, IoPriority priority) const
+{
+	std::string key;
+	try
+	{
+		key = lexicalKey(path);
+	}
+	catch (const std::exception &)
+	{
+		return scheduler(priority);
+	}
+
+	std::shared_lock lock(m_mutex);
+	for (const auto &mount : m_mountPoints)
+	{
+		if (isUnder(key, mount.mountPoint))
+			return resolve(m_devices[mount.device].schedulers, priority);
+	}
+	return *m_defaults[static_cast<std::size_t>(priority)];
+}
+
+Scheduler &recpp::filesystem::IoScheduler::scheduler(IoPriority priority) const
+{
+	std::shared_lock lock(m_mutex);
+	return *m_defaults[static_cast<std::size_t>(priority)];
+}
+
+Scheduler &recpp::filesystem::IoScheduler::resolve(const Schedulers &schedulers, IoPriority priority) const
+{
+	if (auto *scheduler = schedulers[static_cast<std::size_t>(priority)])
+		return *scheduler;
+	if (auto *scheduler = schedulers[static_cast<std::size_t>(IoPriority::interactive)])
+		return *scheduler;
+	return *m_defaults[static_cast<std::size_t>(priority)];
+}
@@ -0,0 +1,266 @@
+#include "recpp/filesystem/LexicalPath.h"
+
+#include <cstring>
+
+namespace
+{
+	constexpr char separator = '/';
+
+	// Find the first separator of path from position, or its size if there is none
+	std::size_t findSeparator(std::string_view path, std::size_t position)
+	{
+		if (position >= path.size())
+			return path.size();
+		const auto found = static_cast<const char *>(std::memchr(path.data() + position, separator, path.size() - position));
+		return found ? static_cast<std::size_t>(found - path.data()) : path.size();
+	}
+
+	std::size_t skipSeparators(std::string_view path, std::size_t position)
+	{
+		while (position < path.size() && path[position] == separator)
+			position++;
+		return position;
+	}
+
+	bool isAbsolute(std::string_view path)
+	{
+		return !path.empty() && path.front() == separator;
+	}
+
+	// Iterate the elements of a path like std::filesystem::path::iterator, as views of the path
+	class Elements
+	{
+	public:
+		explicit Elements(std::string_view path)
+			: m_path(path)
+		{
+		}
+
+		bool next(std::string_view &element)
+		{
+			if (m_position == 0 && isAbsolute(m_path))
+			{
+				element = m_path.substr(0, 1);
+				m_position = skipSeparators(m_path, 0);
+				return true;
+			}
+			if (m_trailing)
+			{
+				element = std::string_view();
+				m_trailing = false;
+				return true;
+			}
+			if (m_position >= m_path.size())
+				return false;
+
+			const auto end = findSeparator(m_path, m_position);
+			element = m_path.substr(m_position, end - m_position);
+			m_position = skipSeparators(m_path, end);
+			m_trailing = end < m_path.size() && m_position == m_path.size();
+			return true;
+		}
+
+	private:
+		std::string_view m_path;
+		std::size_t		 m_position = 0;
+		bool			 m_trailing = false;
+	};
+
+	// Append element to path like std::filesystem::path::operator/= does with a relative path
+	void append(std::string &path, std::string_view element)
+	{
+		if (!path.empty() && path.back() != separator)
+			path += separator;
+		path += element;
+	}
+
+	// Check whether the last of the components of result kept after base, each followed by a separator, is ".."
+	bool endsWithDotDot(const std::string &result, std::size_t base)
+	{
+		const auto size = result.size();
+		return size >= base + 3 && result.compare(size - 3, 3, "../") == 0 && (size == base + 3 || result[size - 4] == separator);
+	}
+} // namespace
+
+std::string recpp::filesystem::lexical::normalize(std::string_view path)
+{
+	if (path.empty())
+		return std::string();
+
+	std::string result;
+	result.reserve(path.size() + 1);
+	const auto absolute = isAbsolute(path);
+	if (absolute)
+		result += separator;
+
+	// The kept components are each followed by a separator, the last one being removed at the end unless the path names a directory
+	const auto base = result.size();
+	auto	   trailing = false;
+	for (auto position = skipSeparators(path, 0); position < path.size();)
+	{
+		const auto end = findSeparator(path, position);
+		const auto component = path.substr(position, end - position);
+		const auto followed = end < path.size();
+		position = skipSeparators(path, end);
+
+		if (component == ".")
+			trailing = true;
+		else if (component != "..")
+		{
+			result += component;
+			result += separator;
+			trailing = followed;
+		}
+		else if (result.size() > base && !endsWithDotDot(result, base))
+		{
+			const auto previous = result.rfind(separator, result.size() - 2);
+			result.resize(previous == std::string::npos ? 0 : previous + 1);
+			trailing = true;
+		}
+		else if (!absolute)
+			result += "../";
+	}
+
+	if (result.size() == base)
+		return absolute ? result : std::string(".");
+	if (!trailing || endsWithDotDot(result, base))
+		result.pop_back();
+	return result;
+}
+
+std::string recpp::filesystem::lexical::relative(std::string_view path, std::string_view base)
+{
+	if (isAbsolute(path) != isAbsolute(base))
+		return std::string();
+
+	Elements		 pathElements(path);
+	Elements		 baseElements(base);
+	std::string_view pathElement;
+	std::string_view baseElement;
+	auto			 hasPath = pathElements.next(pathElement);
+	auto			 hasBase = baseElements.next(baseElement);
+	while (hasPath && hasBase && pathElement == baseElement)
+	{
+		hasPath = pathElements.next(pathElement);
+		hasBase = baseElements.next(baseElement);
+	}
+	if (!hasPath && !hasBase)
+		return std::string(".");
+
+	// Each remaining filename of base needs a "..", and each of its ".." cancels one
+	std::ptrdiff_t count = 0;
+	for (; hasBase; hasBase = baseElements.next(baseElement))
+	{
+		if (baseElement == "..")
+			count--;
+		else if (!baseElement.empty() && baseElement != ".")
+			count++;
+	}
+	if (count < 0)
+		return std::string();
+	if (count == 0 && (!hasPath || pathElement.empty()))
+		return std::string(".");
+
+	std::string result;
+	result.reserve(3 * static_cast<std::size_t>(count) + path.size());
+	for (std::ptrdiff_t i = 0; i < count; i++)
+		append(result, "..");
+	for (; hasPath; hasPath = pathElements.next(pathElement))
+		append(result, pathElement);
+	return result;
+}
+
+std::string recpp::filesystem::lexical::proximate(std::string_view path, std::string_view base)
+{
+	auto result = relative(path, base);
+	if (result.empty())
+		return std::string(path);
+	return result;
+}
+
+std::string recpp::filesystem::lexical::join(std::string_view base, std::string_view path)
+{
+	if (isAbsolute(path))
+		return std::string(path);
+
+	std::string result;
+	result.reserve(base.size() + 1 + path.size());
+	result += base;
+	if (!base.empty() && base.back() != separator)
+		result += separator;
+	result += path;
+	return result;
+}
+
+std::vector<std::string_view> recpp::filesystem::lexical::split(std::string_view path)
+{
+	std::vector<std::string_view> components;
+	Elements					  elements(path);
+	for (std::string_view element; elements.next(element);)
+		components.push_back(element);
+	return components;
+}
+
+std::string_view recpp::filesystem::lexical::parent(std::string_view path)
+{
+	// Paths without relative part, such as the root directory, are their own parent
+	const auto relativeBegin = skipSeparators(path, 0);
+	if (relativeBegin == path.size())
+		return path;
+
+	auto end = path.rfind(separator);
+	if (end == std::string_view::npos)
+		return std::string_view();
+	if (end < relativeBegin)
+		return path.substr(0, 1);
+	while (end > relativeBegin && path[end - 1] == separator)
+		end--;
+	return path.substr(0, end);
+}
+
+std::string_view recpp::filesystem::lexical::filename(std::string_view path)
+{
+	if (skipSeparators(path, 0) == path.size())
+		return std::string_view();
+	const auto last = path.rfind(separator);
+	return last == std::string_view::npos ? path : path.substr(last + 1);
+}
+
+std::string_view recpp::filesystem::lexical::stem(std::string_view path)
+{
+	const auto name = filename(path);
+	const auto dot = name.rfind('.');
+	if (dot == std::string_view::npos || dot == 0 || name == "..")
+		return name;
+	return name.substr(0, dot);
+}
+
+std::string_view recpp::filesystem::lexical::extension(std::string_view path)
+{
+	const auto name = filename(path);
+	const auto dot = name.rfind('.');
+	if (dot == std::string_view::npos || dot == 0 || name == "..")
+		return std::string_view();
+	return name.substr(dot);
+}
+
+int recpp::filesystem::lexical::compare(std::string_view path1, std::string_view path2)
+{
+	// Like std::filesystem::path, relative paths sort before absolute ones whatever their first characters
+	if (isAbsolute(path1) != isAbsolute(path2))
+		return isAbsolute(path1) ? 1 : -1;
+
+	Elements		 elements1(path1);
+	Elements		 elements2(path2);
+	std::string_view element1;
+	std::string_view element2;
+	while (true)
+	{
+		const auto hasElement1 = elements1.next(element1);
+		const auto hasElement2 = elements2.next(element2);
+		if (!hasElement1 || !hasElement2)
+			return static_cast<int>(hasElement1) - static_cast<int>(hasElement2);
+		if (const auto result = element1.compare(element2))
+			return result;
+	}
+}
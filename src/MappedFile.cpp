@@ -0,0 +1,94 @@
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+recpp::filesystem::detail::MappedFile::MappedFile(const std::filesystem::path &path)
+{
+#ifdef _WIN32
+	const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::filesystem::filesystem_error("open", path, std::error_code(GetLastError(), std::system_category()));
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		const auto error = GetLastError();
+		CloseHandle(file);
+		throw std::filesystem::filesystem_error("stat", path, std::error_code(error, std::system_category()));
+	}
+	m_size = static_cast<std::size_t>(size.QuadPart);
+	// Empty files cannot be mapped, and need not be
+	if (m_size > 0)
+	{
+		m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping)
+			m_data = static_cast<const std::uint8_t *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	const auto error = GetLastError();
+	CloseHandle(file);
+	if (m_size > 0 && !m_data)
+	{
+		if (m_mapping)
+			CloseHandle(m_mapping);
+		throw std::filesystem::filesystem_error("mmap", path, std::error_code(error, std::system_category()));
+	}
+#else
+	const auto file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+		throw std::filesystem::filesystem_error("open", path, std::error_code(errno, std::generic_category()));
+	struct stat info;
+	if (::fstat(file, &info) != 0)
+	{
+		const auto error = errno;
+		::close(file);
+		throw std::filesystem::filesystem_error("fstat", path, std::error_code(error, std::generic_category()));
+	}
+	m_size = static_cast<std::size_t>(info.st_size);
+	// Empty files cannot be mapped, and need not be
+	if (m_size > 0)
+	{
+		const auto data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, file, 0);
+		if (data == MAP_FAILED)
+		{
+			const auto error = errno;
+			::close(file);
+			throw std::filesystem::filesystem_error("mmap", path, std::error_code(error, std::generic_category()));
+		}
+		m_data = static_cast<const std::uint8_t *>(data);
+	}
+	// The mapping keeps the file alive on its own
+	::close(file);
+#endif
+}
+
+recpp::filesystem::detail::MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+#else
+	if (m_data)
+		::munmap(const_cast<std::uint8_t *>(m_data), m_size);
+#endif
+}
+
+const std::uint8_t *recpp::filesystem::detail::MappedFile::data() const
+{
+	return m_data;
+}
+
+std::size_t recpp::filesystem::detail::MappedFile::size() const
+{
+	return m_size;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief MappedFile maps a whole file into memory, read-only. The pages are only read from the file when they are first accessed.
+	 */
+	class MappedFile
+	{
+	public:
+		/**
+		 * @brief Map the file at @p path, throwing a std::filesystem::filesystem_error if it cannot be opened or mapped.
+		 */
+		explicit MappedFile(const std::filesystem::path &path);
+
+		MappedFile(const MappedFile &) = delete;
+		~MappedFile();
+
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		const std::uint8_t *data() const;
+		std::size_t			size() const;
+
+	private:
+		const std::uint8_t *m_data = nullptr;
+		std::size_t			m_size = 0;
+#ifdef _WIN32
+		void *m_mapping = nullptr;
+#endif
+	};
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,973 @@
+#include "recpp/filesystem/MemoryBackend.h"
+#include "DirectoryCreator.h"
+#include "Parallel.h"
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	using Name = std::string;
+
+	constexpr std::size_t shardCount = 64;
+	// The number of symlinks followed while resolving a path before giving up, like the SYMLOOP_MAX of Linux
+	constexpr int		  maxSymlinks = 40;
+
+	// The permissions of new directories and files, like those created by a process with the usual umask of 022
+	constexpr auto directoryPermissions = std::filesystem::perms::owner_all | std::filesystem::perms::group_read | std::filesystem::perms::group_exec |
+										  std::filesystem::perms::others_read | std::filesystem::perms::others_exec;
+	constexpr auto filePermissions = std::filesystem::perms::owner_read | std::filesystem::perms::owner_write | std::filesystem::perms::group_read |
+									 std::filesystem::perms::others_read;
+
+	struct Node
+	{
+		Node(std::filesystem::file_type type, std::filesystem::perms permissions)
+			: type(type)
+			, permissions(permissions)
+			, modificationTime(std::filesystem::file_time_type::clock::now())
+		{
+		}
+
+		const std::filesystem::file_type			type;
+		std::filesystem::perms						permissions;
+		std::filesystem::file_time_type				modificationTime;
+		/// The number of directory entries of the node
+		std::uintmax_t								links = 0;
+		/// The content of a regular file
+		std::string									content;
+		/// The target of a symlink
+		std::filesystem::path						target;
+		/// The entries of a directory, sorted by name
+		std::map<Name, std::shared_ptr<Node>>		children;
+	};
+
+	using NodePtr = std::shared_ptr<Node>;
+
+	// The components a path resolved to, from the root directory, whose name is empty, to the last component, whose node is null if it does not exist
+	using Chain = std::vector<std::pair<Name, NodePtr>>;
+
+	std::filesystem::path pathOf(const Chain &chain)
+	{
+		std::string path;
+		for (std::size_t i = 1; i < chain.size(); i++)
+			path += '/' + chain[i].first;
+		return std::filesystem::u8path(path.empty() ? "/" : path);
+	}
+
+	// The directory holding the last component of chain, which must not be the root directory
+	const NodePtr &parentOf(const Chain &chain)
+	{
+		return chain[chain.size() - 2].second;
+	}
+
+	std::deque<Name> components(const std::filesystem::path &path)
+	{
+		const auto		 text = path.generic_u8string();
+		std::deque<Name> names;
+		for (std::size_t position = 0; position < text.size();)
+		{
+			auto end = text.find('/', position);
+			if (end == std::string::npos)
+				end = text.size();
+			if (end > position)
+				names.push_back(text.substr(position, end - position));
+			position = end + 1;
+		}
+		return names;
+	}
+
+	// Whether the last component of path is "." or "..", which name a directory but not an entry of its parent
+	bool isDots(const std::filesystem::path &path)
+	{
+		const auto name = path.filename();
+		return name == "." || name == "..";
+	}
+
+	[[noreturn]] void fail(const char *operation, const std::filesystem::path &path, std::errc error)
+	{
+		throw std::filesystem::filesystem_error(operation, path, std::make_error_code(error));
+	}
+
+	[[noreturn]] void fail(const char *operation, const std::filesystem::path &path1, const std::filesystem::path &path2, std::errc error)
+	{
+		throw std::filesystem::filesystem_error(operation, path1, path2, std::make_error_code(error));
+	}
+
+	// Like rmdir, refuse to remove the "." and ".." entries
+	void checkRemovable(const char *operation, const std::filesystem::path &path)
+	{
+		const auto name = path.filename();
+		if (name == ".")
+			fail(operation, path, std::errc::invalid_argument);
+		if (name == "..")
+			fail(operation, path, std::errc::directory_not_empty);
+	}
+
+	void copyEntry(recpp::filesystem::MemoryBackend &backend, const std::filesystem::path &from, const std::filesystem::path &to,
+				   std::filesystem::copy_options options, bool nested)
+	{
+		using std::filesystem::copy_options;
+
+		const auto symlinkOptions = copy_options::copy_symlinks | copy_options::skip_symlinks | copy_options::create_symlinks;
+		const auto followed = (options & symlinkOptions) == copy_options::none;
+		const auto fromStatus = followed ? backend.status(from) : backend.symlinkStatus(from);
+		const auto toStatus = followed ? backend.status(to) : backend.symlinkStatus(to);
+		if (!std::filesystem::exists(fromStatus))
+			fail("copy", from, to, std::errc::no_such_file_or_directory);
+		// Without following symlinks, a symlink is only equivalent to itself
+		const auto entry = [&backend](const std::filesystem::path &path)
+		{
+			return backend.weaklyCanonical(backend.absolute(path).parent_path()) / path.filename();
+		};
+		const auto symlinks = std::filesystem::is_symlink(fromStatus) || std::filesystem::is_symlink(toStatus);
+		const auto same = symlinks ? std::filesystem::is_symlink(fromStatus) && std::filesystem::is_symlink(toStatus) && entry(from) == entry(to)
+								   : std::filesystem::exists(toStatus) && backend.equivalent(from, to);
+		if (same)
+			fail("copy", from, to, std::errc::file_exists);
+		if (std::filesystem::is_directory(fromStatus) && std::filesystem::is_regular_file(toStatus))
+			fail("copy", from, to, std::errc::is_a_directory);
+
+		if (std::filesystem::is_symlink(fromStatus))
+		{
+			if ((options & copy_options::skip_symlinks) != copy_options::none)
+				return;
+			if ((options & copy_options::copy_symlinks) == copy_options::none)
+				fail("copy", from, to, std::errc::invalid_argument);
+			backend.copySymlink(from, to);
+		}
+		else if (std::filesystem::is_regular_file(fromStatus))
+		{
+			if ((options & copy_options::directories_only) != copy_options::none)
+				return;
+			if ((options & copy_options::create_symlinks) != copy_options::none)
+				backend.createSymlink(from, to);
+			else if ((options & copy_options::create_hard_links) != copy_options::none)
+				backend.createHardLink(from, to);
+			else if (std::filesystem::is_directory(toStatus))
+				backend.copyFile(from, to / from.filename(), options);
+			else
+				backend.copyFile(from, to, options);
+		}
+		else if (std::filesystem::is_directory(fromStatus))
+		{
+			if ((options & copy_options::create_symlinks) != copy_options::none)
+				fail("copy", from, to, std::errc::is_a_directory);
+			// Like std::filesystem::copy, copy_options::none only copies the first level of a directory
+			if ((options & copy_options::recursive) == copy_options::none && (nested || options != copy_options::none))
+				return;
+			if (!std::filesystem::exists(toStatus))
+				backend.createDirectory(to, from);
+			for (const auto &entry : backend.directoryEntries(from))
+				copyEntry(backend, entry, to / entry.filename(), options, true);
+		}
+		else
+			fail("copy", from, to, std::errc::not_supported);
+	}
+} // namespace
+
+struct recpp::filesystem::MemoryBackend::Data
+{
+	explicit Data(std::uintmax_t capacity)
+		: root(std::make_shared<Node>(std::filesystem::file_type::directory, directoryPermissions))
+		, capacity(capacity)
+	{
+		root->links = 1;
+	}
+
+	std::shared_mutex &shard(const NodePtr &node) const
+	{
+		return shards[std::hash<const Node *>()(node.get()) % shardCount];
+	}
+
+	// Resolve the components of path one by one from the root directory, following symlinks except the last component unless follow is set, or set error
+	// and stop at the first component that cannot be resolved. The structure of the tree must be locked
+	Chain resolve(const std::filesystem::path &path, bool follow, std::error_code &error) const
+	{
+		const auto text = path.generic_u8string();
+		// Like on POSIX systems, a trailing separator requires a directory, following the last component if it is a symlink
+		const auto directoryRequired = !text.empty() && text.back() == '/';
+		follow = follow || directoryRequired;
+
+		Chain chain{{Name(), root}};
+		auto  pending = components(path);
+		auto  symlinks = 0;
+		while (!pending.empty())
+		{
+			auto name = std::move(pending.front());
+			pending.pop_front();
+			if (name == ".")
+				continue;
+			if (name == "..")
+			{
+				if (chain.size() > 1)
+					chain.pop_back();
+				continue;
+			}
+
+			const auto &directory = chain.back().second;
+			const auto	child = directory->children.find(name);
+			const auto	last = pending.empty();
+			if (child == directory->children.end())
+			{
+				if (!last)
+					error = std::make_error_code(std::errc::no_such_file_or_directory);
+				else
+					chain.emplace_back(std::move(name), nullptr);
+				return chain;
+			}
+
+			const auto &node = child->second;
+			if (node->type == std::filesystem::file_type::symlink && (follow || !last))
+			{
+				// The target replaces the symlink in the pending components, an absolute target restarting from the root directory
+				if (++symlinks > maxSymlinks)
+				{
+					error = std::make_error_code(std::errc::too_many_symbolic_link_levels);
+					return chain;
+				}
+				if (node->target.has_root_directory())
+					chain.resize(1);
+				const auto target = components(node->target);
+				pending.insert(pending.begin(), target.begin(), target.end());
+				continue;
+			}
+			if (!last && node->type != std::filesystem::file_type::directory)
+			{
+				error = std::make_error_code(std::errc::not_a_directory);
+				return chain;
+			}
+			chain.emplace_back(std::move(name), node);
+		}
+
+		if (directoryRequired && chain.back().second && chain.back().second->type != std::filesystem::file_type::directory)
+			error = std::make_error_code(std::errc::not_a_directory);
+		return chain;
+	}
+
+	// Resolve path, throwing the errors of operation
+	Chain find(const char *operation, const std::filesystem::path &path, bool follow) const
+	{
+		std::error_code error;
+		auto			chain = resolve(path, follow, error);
+		if (error)
+			throw std::filesystem::filesystem_error(operation, path, error);
+		return chain;
+	}
+
+	// Resolve path to an existing node, throwing the errors of operation
+	NodePtr existing(const char *operation, const std::filesystem::path &path, bool follow) const
+	{
+		auto node = find(operation, path, follow).back().second;
+		if (!node)
+			fail(operation, path, std::errc::no_such_file_or_directory);
+		return node;
+	}
+
+	// Resolve path to a regular file, throwing the errors of operation
+	NodePtr regularFile(const char *operation, const std::filesystem::path &path) const
+	{
+		auto node = existing(operation, path, true);
+		requireRegularFile(operation, path, *node);
+		return node;
+	}
+
+	static void requireRegularFile(const char *operation, const std::filesystem::path &path, const Node &node)
+	{
+		if (node.type == std::filesystem::file_type::directory)
+			fail(operation, path, std::errc::is_a_directory);
+		if (node.type != std::filesystem::file_type::regular)
+			fail(operation, path, std::errc::not_supported);
+	}
+
+	// Resolve path to a new entry whose parent exists, throwing the errors of operation
+	Chain creatable(const char *operation, const std::filesystem::path &path) const
+	{
+		auto chain = find(operation, path, false);
+		if (chain.back().second)
+			fail(operation, path, std::errc::file_exists);
+		return chain;
+	}
+
+	// Add the entry name to directory. The structure of the tree must be locked exclusively
+	void attach(const NodePtr &directory, const Name &name, const NodePtr &node)
+	{
+		directory->children[name] = node;
+		directory->modificationTime = std::filesystem::file_time_type::clock::now();
+		node->links++;
+	}
+
+	// Remove the entry name from directory, releasing its node if it was its last entry. The structure of the tree must be locked exclusively
+	void detach(const NodePtr &directory, const Name &name)
+	{
+		const auto entry = directory->children.find(name);
+		const auto node = entry->second;
+		directory->children.erase(entry);
+		directory->modificationTime = std::filesystem::file_time_type::clock::now();
+		if (--node->links == 0)
+			release(*node);
+	}
+
+	void release(Node &node)
+	{
+		used -= node.content.size();
+		for (const auto &[name, child] : node.children)
+		{
+			if (--child->links == 0)
+				release(*child);
+		}
+	}
+
+	void setContent(Node &node, std::string content)
+	{
+		used += content.size();
+		used -= node.content.size();
+		node.content = std::move(content);
+		node.modificationTime = std::filesystem::file_time_type::clock::now();
+	}
+
+	// Create a directory at the end of chain with permissions, or return false if there is a directory there already
+	bool createDirectory(const char *operation, const std::filesystem::path &path, const Chain &chain, std::filesystem::perms permissions)
+	{
+		if (const auto &node = chain.back().second)
+		{
+			std::error_code error;
+			auto			followed = node;
+			if (node->type == std::filesystem::file_type::symlink)
+			{
+				const auto chain = resolve(path, true, error);
+				if (error && error != std::errc::no_such_file_or_directory && error != std::errc::not_a_directory)
+					throw std::filesystem::filesystem_error(operation, path, error);
+				followed = error ? nullptr : chain.back().second;
+			}
+			if (!followed || followed->type != std::filesystem::file_type::directory)
+				fail(operation, path, std::errc::file_exists);
+			return false;
+		}
+		attach(parentOf(chain), chain.back().first, std::make_shared<Node>(std::filesystem::file_type::directory, permissions));
+		return true;
+	}
+
+	void createSymlink(const std::filesystem::path &target, const std::filesystem::path &link)
+	{
+		const auto chain = creatable("create_symlink", link);
+		const auto node = std::make_shared<Node>(std::filesystem::file_type::symlink, std::filesystem::perms::all);
+		node->target = target;
+		attach(parentOf(chain), chain.back().first, node);
+	}
+
+	mutable std::shared_mutex						tree;
+	mutable std::array<std::shared_mutex, shardCount> shards;
+	const NodePtr									root;
+	const std::uintmax_t							capacity;
+	std::atomic<std::uintmax_t>						used = 0;
+};
+
+recpp::filesystem::MemoryBackend::MemoryBackend(std::uintmax_t capacity)
+	: m_data(std::make_shared<Data>(capacity))
+{
+}
+
+std::filesystem::path recpp::filesystem::MemoryBackend::absolute(const std::filesystem::path &path) const
+{
+	if (path.has_root_directory())
+		return path;
+	return std::filesystem::path("/") / path;
+}
+
+std::filesystem::path recpp::filesystem::MemoryBackend::canonical(const std::filesystem::path &path) const
+{
+	std::shared_lock lock(m_data->tree);
+	const auto		 chain = m_data->find("canonical", path, true);
+	if (!chain.back().second)
+		fail("canonical", path, std::errc::no_such_file_or_directory);
+	return pathOf(chain);
+}
+
+std::filesystem::path recpp::filesystem::MemoryBackend::weaklyCanonical(const std::filesystem::path &path) const
+{
+	// Like std::filesystem::weakly_canonical, the longest existing prefix of path is canonicalized, and the rest is appended as is
+	const auto								 absolutePath = absolute(path);
+	const std::vector<std::filesystem::path> elements(absolutePath.begin(), absolutePath.end());
+	std::shared_lock						 lock(m_data->tree);
+	for (auto count = elements.size(); count > 0; count--)
+	{
+		std::filesystem::path prefix;
+		for (std::size_t i = 0; i < count; i++)
+			prefix /= elements[i];
+
+		std::error_code error;
+		const auto		chain = m_data->resolve(prefix, true, error);
+		if (error && error != std::errc::no_such_file_or_directory && error != std::errc::not_a_directory)
+			throw std::filesystem::filesystem_error("weakly_canonical", path, error);
+		if (!error && chain.back().second)
+		{
+			auto existing = pathOf(chain);
+			for (auto i = count; i < elements.size(); i++)
+				existing /= elements[i];
+			return existing.lexically_normal();
+		}
+	}
+	return absolutePath.lexically_normal();
+}
+
+void recpp::filesystem::MemoryBackend::copy(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options)
+{
+	{
+		// Like std::filesystem::copy, report why from cannot be resolved rather than only that it does not exist
+		using std::filesystem::copy_options;
+
+		const auto		 symlinkOptions = copy_options::copy_symlinks | copy_options::skip_symlinks | copy_options::create_symlinks;
+		std::shared_lock lock(m_data->tree);
+		m_data->find("copy", from, (options & symlinkOptions) == copy_options::none);
+	}
+	copyEntry(*this, from, to, options, false);
+}
+
+bool recpp::filesystem::MemoryBackend::copyFile(const std::filesystem::path &from, const std::filesystem::path &to, std::filesystem::copy_options options)
+{
+	using std::filesystem::copy_options;
+
+	std::unique_lock lock(m_data->tree);
+	const auto		 source = m_data->existing("copy_file", from, true);
+	if (source->type != std::filesystem::file_type::regular)
+		fail("copy_file", from, to, std::errc::invalid_argument);
+	const auto		link = m_data->find("copy_file", to, false).back().second;
+	std::error_code error;
+	const auto		chain = m_data->resolve(to, true, error);
+	// Like std::filesystem::copy_file, a dangling symlink is only followed when existing files may be overwritten
+	const auto overwrite = (options & (copy_options::overwrite_existing | copy_options::update_existing)) != copy_options::none;
+	if (link && (error || !chain.back().second) && !overwrite)
+		fail("copy_file", from, to, std::errc::file_exists);
+	if (error)
+		throw std::filesystem::filesystem_error("copy_file", from, to, error);
+	if (const auto &destination = chain.back().second)
+	{
+		if (destination == source)
+			fail("copy_file", from, to, std::errc::file_exists);
+		if (destination->type != std::filesystem::file_type::regular)
+			fail("copy_file", from, to, std::errc::invalid_argument);
+		if ((options & copy_options::skip_existing) != copy_options::none)
+			return false;
+		if ((options & copy_options::update_existing) != copy_options::none && source->modificationTime <= destination->modificationTime)
+			return false;
+		if (!overwrite)
+			fail("copy_file", from, to, std::errc::file_exists);
+		m_data->setContent(*destination, source->content);
+		destination->permissions = source->permissions;
+		return true;
+	}
+
+	const auto node = std::make_shared<Node>(std::filesystem::file_type::regular, source->permissions);
+	m_data->setContent(*node, source->content);
+	m_data->attach(parentOf(chain), chain.back().first, node);
+	return true;
+}
+
+void recpp::filesystem::MemoryBackend::copySymlink(const std::filesystem::path &from, const std::filesystem::path &to)
+{
+	std::unique_lock lock(m_data->tree);
+	const auto		 node = m_data->existing("copy_symlink", from, false);
+	if (node->type != std::filesystem::file_type::symlink)
+		fail("copy_symlink", from, std::errc::invalid_argument);
+	m_data->createSymlink(node->target, to);
+}
+
+bool recpp::filesystem::MemoryBackend::createDirectory(const std::filesystem::path &path)
+{
+	std::unique_lock lock(m_data->tree);
+	return m_data->createDirectory("create_directory", path, m_data->find("create_directory", path, false), directoryPermissions);
+}
+
+bool recpp::filesystem::MemoryBackend::createDirectory(const std::filesystem::path &path, const std::filesystem::path &existingPath)
+{
+	std::unique_lock lock(m_data->tree);
+	const auto		 existing = m_data->existing("create_directory", existingPath, true);
+	if (existing->type != std::filesystem::file_type::directory)
+		fail("create_directory", path, existingPath, std::errc::not_a_directory);
+	return m_data->createDirectory("create_directory", path, m_data->find("create_directory", path, false), existing->permissions);
+}
+
+bool recpp::filesystem::MemoryBackend::createDirectories(const std::filesystem::path &path)
+{
+	// Like std::filesystem::create_directories, the missing directories are found walking up from path, skipping its "." and ".." components, then
+	// created from the topmost down, so that "a/../b" creates both "a" and "b"
+	std::unique_lock lock(m_data->tree);
+	{
+		std::error_code error;
+		const auto		chain = m_data->resolve(path, true, error);
+		if (error && error != std::errc::no_such_file_or_directory && error != std::errc::not_a_directory)
+			throw std::filesystem::filesystem_error("create_directories", path, error);
+		if (!error && chain.back().second)
+		{
+			if (chain.back().second->type != std::filesystem::file_type::directory)
+				fail("create_directories", path, std::errc::not_a_directory);
+			return false;
+		}
+	}
+	std::vector<std::filesystem::path> missing;
+	auto							   current = absolute(path);
+	if (!current.has_filename())
+		current = current.parent_path();
+	while (current.has_relative_path())
+	{
+		if (!isDots(current))
+			missing.push_back(current);
+		current = current.parent_path();
+
+		std::error_code error;
+		const auto		chain = m_data->resolve(current, true, error);
+		if (error == std::errc::no_such_file_or_directory || error == std::errc::not_a_directory || (!error && !chain.back().second))
+			continue;
+		if (error)
+			throw std::filesystem::filesystem_error("create_directories", path, error);
+		if (chain.back().second->type != std::filesystem::file_type::directory)
+			fail("create_directories", path, std::errc::not_a_directory);
+		break;
+	}
+
+	auto created = false;
+	for (auto it = missing.rbegin(); it != missing.rend(); ++it)
+		created = m_data->createDirectory("create_directories", *it, m_data->find("create_directories", *it, false), directoryPermissions);
+	return created;
+}
+
+void recpp::filesystem::MemoryBackend::createHardLink(const std::filesystem::path &target, const std::filesystem::path &link)
+{
+	std::unique_lock lock(m_data->tree);
+	const auto		 node = m_data->existing("create_hard_link", target, false);
+	const auto		 chain = m_data->creatable("create_hard_link", link);
+	if (node->type == std::filesystem::file_type::directory)
+		fail("create_hard_link", target, link, std::errc::operation_not_permitted);
+	m_data->attach(parentOf(chain), chain.back().first, node);
+}
+
+void recpp::filesystem::MemoryBackend::createSymlink(const std::filesystem::path &target, const std::filesystem::path &link)
+{
+	std::unique_lock lock(m_data->tree);
+	m_data->createSymlink(target, link);
+}
+
+void recpp::filesystem::MemoryBackend::createDirectorySymlink(const std::filesystem::path &target, const std::filesystem::path &link)
+{
+	createSymlink(target, link);
+}
+
+std::filesystem::path recpp::filesystem::MemoryBackend::currentPath() const
+{
+	// Relative paths are resolved against the root directory, which is never changed
+	return "/";
+}
+
+std::vector<std::filesystem::path> recpp::filesystem::MemoryBackend::directoryEntries(const std::filesystem::path &path) const
+{
+	std::shared_lock lock(m_data->tree);
+	const auto		 node = m_data->existing("directory_iterator", path, true);
+	if (node->type != std::filesystem::file_type::directory)
+		fail("directory_iterator", path, std::errc::not_a_directory);
+
+	std::vector<std::filesystem::path> entries;
+	entries.reserve(node->children.size());
+	for (const auto &[name, child] : node->children)
+		entries.push_back(path / std::filesystem::u8path(name));
+	return entries;
+}
+
+bool recpp::filesystem::MemoryBackend::equivalent(const std::filesystem::path &path1, const std::filesystem::path &path2) const
+{
+	std::shared_lock lock(m_data->tree);
+	const auto		 find = [this](const std::filesystem::path &path)
+	{
+		// Like std::filesystem::equivalent, a path that cannot be resolved is a file that does not exist
+		std::error_code error;
+		const auto		chain = m_data->resolve(path, true, error);
+		return error ? nullptr : chain.back().second;
+	};
+	const auto node1 = find(path1);
+	const auto node2 = find(path2);
+	if (!node1 && !node2)
+		fail("equivalent", path1, path2, std::errc::no_such_file_or_directory);
+	return node1 == node2;
+}
+
+std::uintmax_t recpp::filesystem::MemoryBackend::fileSize(const std::filesystem::path &path) const
+{
+	std::shared_lock lock(m_data->tree);
+	const auto		 node = m_data->regularFile("file_size", path);
+	std::shared_lock nodeLock(m_data->shard(node));
+	return node->content.size();
+}
+
+std::uintmax_t recpp::filesystem::MemoryBackend::hardLinkCount(const std::filesystem::path &path) const
+{
+	std::shared_lock lock(m_data->tree);
+	const auto		 node = m_data->existing("hard_link_count", path, true);
+	if (node->type != std::filesystem::file_type::directory)
+		return node->links;
+
+	// Like on POSIX systems, a directory is linked from its parent, from its own "." entry, and from the ".." entry of each of its subdirectories
+	std::uintmax_t links = 2;
+	for (const auto &[name, child] : node->children)
+	{
+		if (child->type == std::filesystem::file_type::directory)
+			links++;
+	}
+	return links;
+}
+
+bool recpp::filesystem::MemoryBackend::isEmpty(const std::filesystem::path &path) const
+{
+	std::shared_lock lock(m_data->tree);
+	const auto		 node = m_data->existing("is_empty", path, true);
+	if (node->type == std::filesystem::file_type::directory)
+		return node->children.empty();
+	if (node->type != std::filesystem::file_type::regular)
+		fail("is_empty", path, std::errc::not_supported);
+	std::shared_lock nodeLock(m_data->shard(node));
+	return node->content.empty();
+}
+
+std::filesystem::file_time_type recpp::filesystem::MemoryBackend::lastWriteTime(const std::filesystem::path &path) const
+{
+	std::shared_lock lock(m_data->tree);
+	const auto		 node = m_data->existing("last_write_time", path, true);
+	std::shared_lock nodeLock(m_data->shard(node));
+	return node->modificationTime;
+}
+
+void recpp::filesystem::MemoryBackend::lastWriteTime(const std::filesystem::path &path, std::filesystem::file_time_type newTime)
+{
+	std::shared_lock lock(m_data->tree);
+	const auto		 node = m_data->existing("last_write_time", path, true);
+	std::unique_lock nodeLock(m_data->shard(node));
+	node->modificationTime = newTime;
+}
+
+void recpp::filesystem::MemoryBackend::permissions(const std::filesystem::path &path, std::filesystem::perms permissions,
+												   std::filesystem::perm_options options)
+{
+	using std::filesystem::perm_options;
+
+	std::shared_lock lock(m_data->tree);
+	const auto		 node = m_data->existing("permissions", path, (options & perm_options::nofollow) != perm_options::nofollow);
+	// Like on Linux, the permissions of a symlink cannot change
+	if (node->type == std::filesystem::file_type::symlink)
+		fail("permissions", path, std::errc::not_supported);
+
+	permissions &= std::filesystem::perms::mask;
+	std::unique_lock nodeLock(m_data->shard(node));
+	if ((options & perm_options::add) == perm_options::add)
+		node->permissions |= permissions;
+	else if ((options & perm_options::remove) == perm_options::remove)
+		node->permissions &= ~permissions;
+	else
+		node->permissions = permissions;
+}
+
+std::string recpp::filesystem::MemoryBackend::readFile(const std::filesystem::path &path) const
+{
+	std::shared_lock lock(m_data->tree);
+	const auto		 node = m_data->regularFile("read", path);
+	std::shared_lock nodeLock(m_data->shard(node));
+	return node->content;
+}
+
+std::size_t recpp::filesystem::MemoryBackend::readFile(const std::filesystem::path &path, std::uintmax_t offset, char *data, std::size_t size) const
+{
+	std::shared_lock lock(m_data->tree);
+	const auto		 node = m_data->regularFile("read", path);
+	std::shared_lock nodeLock(m_data->shard(node));
+	if (offset >= node->content.size())
+		return 0;
+	return node->content.copy(data, size, static_cast<std::size_t>(offset));
+}
+
+std::filesystem::path recpp::filesystem::MemoryBackend::readSymlink(const std::filesystem::path &path) const
+{
+	std::shared_lock lock(m_data->tree);
+	const auto		 node = m_data->existing("read_symlink", path, false);
+	if (node->type != std::filesystem::file_type::symlink)
+		fail("read_symlink", path, std::errc::invalid_argument);
+	return node->target;
+}
+
+bool recpp::filesystem::MemoryBackend::remove(const std::filesystem::path &path)
+{
+	std::unique_lock lock(m_data->tree);
+	std::error_code	 error;
+	const auto		 chain = m_data->resolve(path, false, error);
+	if (error == std::errc::no_such_file_or_directory)
+		return false;
+	if (error)
+		throw std::filesystem::filesystem_error("remove", path, error);
+	checkRemovable("remove", path);
+	const auto &node = chain.back().second;
+	if (!node)
+		return false;
+	if (chain.size() == 1)
+		fail("remove", path, std::errc::device_or_resource_busy);
+	if (!node->children.empty())
+		fail("remove", path, std::errc::directory_not_empty);
+	m_data->detach(parentOf(chain), chain.back().first);
+	return true;
+}
+
+std::uintmax_t recpp::filesystem::MemoryBackend::removeAll(const std::filesystem::path &path)
+{
+	std::unique_lock lock(m_data->tree);
+	std::error_code	 error;
+	const auto		 chain = m_data->resolve(path, false, error);
+	if (error == std::errc::no_such_file_or_directory)
+		return 0;
+	if (error)
+		throw std::filesystem::filesystem_error("remove_all", path, error);
+	checkRemovable("remove_all", path);
+	const auto &node = chain.back().second;
+	if (!node)
+		return 0;
+	if (chain.size() == 1)
+		fail("remove_all", path, std::errc::device_or_resource_busy);
+
+	const std::function<std::uintmax_t(const Node &)> count = [&count](const Node &node)
+	{
+		std::uintmax_t total = 1;
+		for (const auto &[name, child] : node.children)
+			total += count(*child);
+		return total;
+	};
+	const auto removed = count(*node);
+	m_data->detach(parentOf(chain), chain.back().first);
+	return removed;
+}
+
+void recpp::filesystem::MemoryBackend::rename(const std::filesystem::path &oldPath, const std::filesystem::path &newPath)
+{
+	std::unique_lock lock(m_data->tree);
+	std::error_code	 error;
+	const auto		 source = m_data->resolve(oldPath, false, error);
+	const auto		 destination = error ? Chain() : m_data->resolve(newPath, false, error);
+	if (error)
+		throw std::filesystem::filesystem_error("rename", oldPath, newPath, error);
+	// Like on Linux, the "." and ".." entries cannot be moved or replaced
+	if (isDots(oldPath) || isDots(newPath))
+		fail("rename", oldPath, newPath, std::errc::device_or_resource_busy);
+	const auto &node = source.back().second;
+	if (!node)
+		fail("rename", oldPath, newPath, std::errc::no_such_file_or_directory);
+	if (source.size() == 1 || destination.size() == 1)
+		fail("rename", oldPath, newPath, std::errc::device_or_resource_busy);
+
+	if (node->type == std::filesystem::file_type::directory)
+	{
+		// A directory cannot be moved under itself
+		for (std::size_t i = 0; i + 1 < destination.size(); i++)
+		{
+			if (destination[i].second == node)
+				fail("rename", oldPath, newPath, std::errc::invalid_argument);
+		}
+	}
+	if (const auto &replaced = destination.back().second)
+	{
+		if (replaced == node)
+			return;
+		// A directory cannot be replaced by one of its descendants, which it contains
+		for (std::size_t i = 0; i + 1 < source.size(); i++)
+		{
+			if (source[i].second == replaced)
+				fail("rename", oldPath, newPath, std::errc::directory_not_empty);
+		}
+		if (node->type == std::filesystem::file_type::directory && replaced->type != std::filesystem::file_type::directory)
+			fail("rename", oldPath, newPath, std::errc::not_a_directory);
+		if (node->type != std::filesystem::file_type::directory && replaced->type == std::filesystem::file_type::directory)
+			fail("rename", oldPath, newPath, std::errc::is_a_directory);
+		if (!replaced->children.empty())
+			fail("rename", oldPath, newPath, std::errc::directory_not_empty);
+		m_data->detach(parentOf(destination), destination.back().first);
+	}
+	// The node is attached to its new parent first, so that it is not released in between
+	m_data->attach(parentOf(destination), destination.back().first, node);
+	m_data->detach(parentOf(source), source.back().first);
+}
+
+void recpp::filesystem::MemoryBackend::resizeFile(const std::filesystem::path &path, std::uintmax_t newSize)
+{
+	std::shared_lock lock(m_data->tree);
+	const auto		 node = m_data->regularFile("resize_file", path);
+	std::unique_lock nodeLock(m_data->shard(node));
+	auto			 content = node->content;
+	content.resize(newSize);
+	m_data->setContent(*node, std::move(content));
+}
+
+std::filesystem::space_info recpp::filesystem::MemoryBackend::space(const std::filesystem::path &path) const
+{
+	std::shared_lock lock(m_data->tree);
+	m_data->existing("space", path, true);
+	const std::uintmax_t used = m_data->used;
+	const auto			 free = m_data->capacity > used ? m_data->capacity - used : 0;
+	return std::filesystem::space_info{m_data->capacity, free, free};
+}
+
+std::filesystem::file_status recpp::filesystem::MemoryBackend::status(const std::filesystem::path &path) const
+{
+	std::shared_lock lock(m_data->tree);
+	std::error_code	 error;
+	const auto		 chain = m_data->resolve(path, true, error);
+	if (error == std::errc::no_such_file_or_directory || error == std::errc::not_a_directory || (!error && !chain.back().second))
+		return std::filesystem::file_status(std::filesystem::file_type::not_found);
+	if (error)
+		throw std::filesystem::filesystem_error("status", path, error);
+	const auto		&node = chain.back().second;
+	std::shared_lock nodeLock(m_data->shard(node));
+	return std::filesystem::file_status(node->type, node->permissions);
+}
+
+std::filesystem::file_status recpp::filesystem::MemoryBackend::symlinkStatus(const std::filesystem::path &path) const
+{
+	std::shared_lock lock(m_data->tree);
+	std::error_code	 error;
+	const auto		 chain = m_data->resolve(path, false, error);
+	if (error == std::errc::no_such_file_or_directory || error == std::errc::not_a_directory || (!error && !chain.back().second))
+		return std::filesystem::file_status(std::filesystem::file_type::not_found);
+	if (error)
+		throw std::filesystem::filesystem_error("symlink_status", path, error);
+	const auto		&node = chain.back().second;
+	std::shared_lock nodeLock(m_data->shard(node));
+	return std::filesystem::file_status(node->type, node->permissions);
+}
+
+std::filesystem::path recpp::filesystem::MemoryBackend::tempDirectoryPath() const
+{
+	// Like on POSIX systems without TMPDIR, the directory is "/tmp", which must exist
+	const std::filesystem::path path("/tmp");
+	if (!std::filesystem::is_directory(status(path)))
+		fail("temp_directory_path", path, std::errc::not_a_directory);
+	return path;
+}
+
+void recpp::filesystem::MemoryBackend::writeFile(const std::filesystem::path &path, std::string_view content)
+{
+	// Replacing the content of an existing file only locks the structure of the tree for reading
+	{
+		std::shared_lock lock(m_data->tree);
+		std::error_code	 error;
+		const auto		 chain = m_data->resolve(path, true, error);
+		if (const auto &node = chain.back().second; !error && node)
+		{
+			Data::requireRegularFile("write", path, *node);
+			std::unique_lock nodeLock(m_data->shard(node));
+			m_data->setContent(*node, std::string(content));
+			return;
+		}
+	}
+
+	std::unique_lock lock(m_data->tree);
+	const auto		 chain = m_data->find("write", path, true);
+	if (const auto &node = chain.back().second)
+	{
+		Data::requireRegularFile("write", path, *node);
+		m_data->setContent(*node, std::string(content));
+		return;
+	}
+	const auto node = std::make_shared<Node>(std::filesystem::file_type::regular, filePermissions);
+	m_data->setContent(*node, std::string(content));
+	m_data->attach(parentOf(chain), chain.back().first, node);
+}
+
+void recpp::filesystem::MemoryBackend::materialize(const std::filesystem::path &root, const std::filesystem::path &destination, unsigned threads) const
+{
+	struct Entry
+	{
+		std::filesystem::path path;
+		NodePtr				  node;
+	};
+
+	std::shared_lock lock(m_data->tree);
+	const auto		 rootNode = m_data->existing("materialize", root, true);
+
+	// The entries are collected depth first, so that each directory comes before its entries, and the later entries of a hard linked file link to the first
+	std::vector<Entry>												   directories;
+	std::vector<Entry>												   files;
+	std::vector<std::pair<std::filesystem::path, std::filesystem::path>> hardLinks;
+	std::unordered_map<const Node *, std::filesystem::path>			   firstLinks;
+	const std::function<void(const NodePtr &, const std::filesystem::path &)> collect = [&](const NodePtr &node, const std::filesystem::path &path)
+	{
+		if (node->type == std::filesystem::file_type::directory)
+		{
+			directories.push_back(Entry{path, node});
+			for (const auto &[name, child] : node->children)
+				collect(child, path / std::filesystem::u8path(name));
+			return;
+		}
+		if (node->links > 1)
+		{
+			const auto [first, inserted] = firstLinks.try_emplace(node.get(), path);
+			if (!inserted)
+			{
+				hardLinks.emplace_back(first->second, path);
+				return;
+			}
+		}
+		files.push_back(Entry{path, node});
+	};
+	collect(rootNode, destination);
+
+	std::vector<std::filesystem::path> paths;
+	paths.reserve(directories.size());
+	for (const auto &directory : directories)
+		paths.push_back(directory.path);
+	for (const auto &creation : detail::createDirectories(paths, threads))
+	{
+		if (creation.error)
+			throw std::filesystem::filesystem_error("materialize", creation.path, creation.error);
+	}
+
+	parallelFor(
+		files.size(),
+		[this, &files](std::size_t i)
+		{
+			const auto &[path, node] = files[i];
+			if (node->type == std::filesystem::file_type::symlink)
+			{
+				std::error_code error;
+				std::filesystem::remove(path, error);
+				std::filesystem::create_symlink(node->target, path);
+				return;
+			}
+
+			std::shared_lock nodeLock(m_data->shard(node));
+			std::ofstream	 stream(path, std::ios::binary | std::ios::trunc);
+			stream.write(node->content.data(), static_cast<std::streamsize>(node->content.size()));
+			stream.close();
+			if (!stream)
+				throw std::filesystem::filesystem_error("materialize", path, std::make_error_code(std::errc::io_error));
+			std::filesystem::permissions(path, node->permissions);
+			std::filesystem::last_write_time(path, node->modificationTime);
+		},
+		threads);
+
+	for (const auto &[target, link] : hardLinks)
+	{
+		std::error_code error;
+		std::filesystem::remove(link, error);
+		std::filesystem::create_hard_link(target, link);
+	}
+
+	// Writing entries changes the modification time of their directory, and their permissions may forbid it, so directories are finished last, deepest first
+	for (auto directory = directories.rbegin(); directory != directories.rend(); ++directory)
+	{
+		std::shared_lock nodeLock(m_data->shard(directory->node));
+		std::filesystem::permissions(directory->path, directory->node->permissions);
+		std::filesystem::last_write_time(directory->path, directory->node->modificationTime);
+	}
+}
@@ -0,0 +1,614 @@
+#include "recpp/filesystem/MetadataIndex.h"
+#include "DirectoryWalker.h"
+#include "FileInfo.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	constexpr char			magic[8] = {'R', 'C', 'P', 'P', 'I', 'D', 'X', '1'};
+	constexpr std::uint32_t formatVersion = 1;
+	// The number of paths of each front-coded block, the first one being stored entirely
+	constexpr std::size_t	blockEntries = 16;
+
+	// Offsets of the fields of the header, all little-endian
+	enum HeaderField : std::size_t
+	{
+		versionField = 8,
+		blockEntriesField = 12,
+		countField = 16,
+		rootTimeField = 24,
+		rootOffsetField = 32,
+		rootLengthField = 40,
+		blockOffsetsField = 48,
+		pathsOffsetField = 56,
+		pathsLengthField = 64,
+		sizesOffsetField = 72,
+		timesOffsetField = 80,
+		typesOffsetField = 88,
+		fileLengthField = 96,
+		headerSize = 104,
+	};
+
+	// The file types are stored as their index in this table, since the values of std::filesystem::file_type are implementation-defined
+	constexpr std::filesystem::file_type fileTypes[] = {
+		std::filesystem::file_type::none,	   std::filesystem::file_type::not_found, std::filesystem::file_type::regular,
+		std::filesystem::file_type::directory, std::filesystem::file_type::symlink,	  std::filesystem::file_type::block,
+		std::filesystem::file_type::character, std::filesystem::file_type::fifo,	  std::filesystem::file_type::socket,
+		std::filesystem::file_type::unknown,
+	};
+
+	// An entry before it is written, its path being relative to the root, in UTF-8 and with '/' separators
+	struct Record
+	{
+		std::string				   path;
+		std::filesystem::file_type type;
+		std::uintmax_t			   size;
+		std::int64_t			   modificationTime;
+	};
+
+	enum class DirectoryState : char
+	{
+		unchanged,
+		changed,
+		removed,
+	};
+
+	std::uint8_t typeCode(std::filesystem::file_type type)
+	{
+		const auto code = std::find(std::begin(fileTypes), std::end(fileTypes), type) - std::begin(fileTypes);
+		return static_cast<std::uint8_t>(code < static_cast<std::ptrdiff_t>(std::size(fileTypes)) ? code : std::size(fileTypes) - 1);
+	}
+
+	std::filesystem::file_type fileType(std::uint8_t code)
+	{
+		return code < std::size(fileTypes) ? fileTypes[code] : std::filesystem::file_type::unknown;
+	}
+
+	void store64(std::vector<std::uint8_t> &bytes, std::size_t offset, std::uint64_t value)
+	{
+		for (std::size_t i = 0; i < 8; i++)
+			bytes[offset + i] = static_cast<std::uint8_t>(value >> (8 * i));
+	}
+
+	void append64(std::vector<std::uint8_t> &bytes, std::uint64_t value)
+	{
+		bytes.resize(bytes.size() + 8);
+		store64(bytes, bytes.size() - 8, value);
+	}
+
+	std::uint64_t load64(const std::uint8_t *bytes)
+	{
+		std::uint64_t value = 0;
+		for (std::size_t i = 0; i < 8; i++)
+			value |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+		return value;
+	}
+
+	void appendVarint(std::vector<std::uint8_t> &bytes, std::uint64_t value)
+	{
+		for (; value >= 0x80; value >>= 7)
+			bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+		bytes.push_back(static_cast<std::uint8_t>(value));
+	}
+
+	std::uint64_t loadVarint(const std::uint8_t *&bytes, const std::uint8_t *end)
+	{
+		std::uint64_t value = 0;
+		for (unsigned shift = 0; bytes < end && shift < 64; shift += 7)
+		{
+			const auto byte = *bytes++;
+			value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+				return value;
+		}
+		throw std::runtime_error("corrupted metadata index");
+	}
+
+	void align(std::vector<std::uint8_t> &bytes)
+	{
+		bytes.resize((bytes.size() + 7) / 8 * 8);
+	}
+
+	// Separators sort before any other character, so that the entries under a directory directly follow it, before any of its siblings
+	bool pathLess(const std::string &path1, const std::string &path2)
+	{
+		return std::lexicographical_compare(path1.begin(), path1.end(), path2.begin(), path2.end(),
+											[](char character1, char character2)
+											{
+												const auto rank1 = character1 == '/' ? 0 : static_cast<unsigned char>(character1) + 1;
+												const auto rank2 = character2 == '/' ? 0 : static_cast<unsigned char>(character2) + 1;
+												return rank1 < rank2;
+											});
+	}
+
+	bool isUnder(const std::string &path, const std::string &directory)
+	{
+		if (directory.empty())
+			return !path.empty();
+		return path.size() > directory.size() && path.compare(0, directory.size(), directory) == 0 && path[directory.size()] == '/';
+	}
+
+	std::string pathKey(const std::filesystem::path &path)
+	{
+		auto key = path.lexically_normal().generic_u8string();
+		while (!key.empty() && key.back() == '/')
+			key.pop_back();
+		return key == "." ? std::string() : key;
+	}
+
+	std::filesystem::path indexRoot(const std::filesystem::path &root)
+	{
+		auto normal = std::filesystem::absolute(root).lexically_normal();
+		if (!normal.has_filename() && normal.has_relative_path())
+			normal = normal.parent_path();
+		return normal;
+	}
+
+	// Lists files into records whose paths are relative to the root of the index
+	class RecordReader
+	{
+	public:
+		RecordReader(const std::filesystem::path &root, const MetadataIndexOptions &options)
+			: m_root(root)
+			, m_prefix(root.native().size() + (root.native().back() == std::filesystem::path::preferred_separator ? 0 : 1))
+			, m_options(options)
+		{
+		}
+
+		Record record(const std::filesystem::path &path) const
+		{
+			const auto info = fileInfo(path);
+			return Record{std::filesystem::path(path.native().substr(m_prefix)).generic_u8string(), info.type, info.size, info.modificationTime};
+		}
+
+		std::filesystem::path path(const std::string &key) const
+		{
+			return key.empty() ? m_root : m_root / std::filesystem::u8path(key);
+		}
+
+		// Every file under roots, the roots themselves excluded
+		std::vector<Record> walk(const std::vector<std::filesystem::path> &roots) const
+		{
+			std::vector<Record> records;
+			std::mutex			mutex;
+			DirectoryWalker		walker(m_options.threads, m_options.directoryOptions, m_options.token);
+			walker.walk(roots,
+						[this, &records, &mutex](const std::filesystem::path &directory, const std::vector<std::filesystem::directory_entry> &entries)
+						{
+							if (directory.empty())
+								return;
+							std::vector<Record> local;
+							for (const auto &entry : entries)
+								local.push_back(record(entry.path()));
+							std::lock_guard lock(mutex);
+							records.insert(records.end(), std::make_move_iterator(local.begin()), std::make_move_iterator(local.end()));
+						});
+			return records;
+		}
+
+		std::vector<Record> list(const std::filesystem::path &directory) const
+		{
+			if (m_options.token)
+				m_options.token->throwIfCancelled();
+			std::vector<Record> records;
+			for (const auto &entry : std::filesystem::directory_iterator(directory, m_options.directoryOptions))
+				records.push_back(record(entry.path()));
+			return records;
+		}
+
+	private:
+		const std::filesystem::path &m_root;
+		const std::size_t			 m_prefix;
+		const MetadataIndexOptions	&m_options;
+	};
+
+	std::vector<std::uint8_t> serialize(const std::filesystem::path &root, std::int64_t rootTime, std::vector<Record> &records)
+	{
+		std::sort(records.begin(), records.end(),
+				  [](const Record &record1, const Record &record2)
+				  {
+					  return pathLess(record1.path, record2.path);
+				  });
+
+		// Each path of a block only stores the suffix it does not share with the previous one
+		std::vector<std::uint8_t>  paths;
+		std::vector<std::uint64_t> blockOffsets;
+		for (std::size_t i = 0; i < records.size(); i++)
+		{
+			const auto &path = records[i].path;
+			std::size_t shared = 0;
+			if (i % blockEntries == 0)
+				blockOffsets.push_back(paths.size());
+			else
+			{
+				const auto &previous = records[i - 1].path;
+				shared = std::mismatch(path.begin(), path.begin() + std::min(path.size(), previous.size()), previous.begin()).first - path.begin();
+				appendVarint(paths, shared);
+			}
+			appendVarint(paths, path.size() - shared);
+			paths.insert(paths.end(), path.begin() + shared, path.end());
+		}
+
+		std::vector<std::uint8_t> bytes(headerSize);
+		const auto				  rootPath = root.u8string();
+		std::memcpy(bytes.data(), magic, sizeof(magic));
+		bytes[versionField] = static_cast<std::uint8_t>(formatVersion);
+		bytes[blockEntriesField] = static_cast<std::uint8_t>(blockEntries);
+		store64(bytes, countField, records.size());
+		store64(bytes, rootTimeField, static_cast<std::uint64_t>(rootTime));
+		store64(bytes, rootOffsetField, bytes.size());
+		store64(bytes, rootLengthField, rootPath.size());
+		bytes.insert(bytes.end(), rootPath.begin(), rootPath.end());
+		align(bytes);
+
+		store64(bytes, blockOffsetsField, bytes.size());
+		for (const auto offset : blockOffsets)
+			append64(bytes, offset);
+		store64(bytes, sizesOffsetField, bytes.size());
+		for (const auto &record : records)
+			append64(bytes, record.size);
+		store64(bytes, timesOffsetField, bytes.size());
+		for (const auto &record : records)
+			append64(bytes, static_cast<std::uint64_t>(record.modificationTime));
+		store64(bytes, typesOffsetField, bytes.size());
+		for (const auto &record : records)
+			bytes.push_back(typeCode(record.type));
+		align(bytes);
+
+		store64(bytes, pathsOffsetField, bytes.size());
+		store64(bytes, pathsLengthField, paths.size());
+		bytes.insert(bytes.end(), paths.begin(), paths.end());
+		store64(bytes, fileLengthField, bytes.size());
+		return bytes;
+	}
+} // namespace
+
+struct recpp::filesystem::MetadataIndex::Data
+{
+	explicit Data(std::vector<std::uint8_t> bytes)
+		: memory(std::move(bytes))
+		, base(memory.data())
+		, length(memory.size())
+	{
+		parse();
+	}
+
+	explicit Data(std::unique_ptr<MappedFile> mappedFile)
+		: file(std::move(mappedFile))
+		, base(file->data())
+		, length(file->size())
+	{
+		parse();
+	}
+
+	Data(const Data &) = delete;
+	Data &operator=(const Data &) = delete;
+
+	// Only the header is read, the other pages of a mapped file are read as they are accessed
+	void parse()
+	{
+		if (length < headerSize || std::memcmp(base, magic, sizeof(magic)) != 0)
+			throw std::runtime_error("not a metadata index");
+		if (base[versionField] != formatVersion || base[blockEntriesField] != blockEntries || load64(base + fileLengthField) != length)
+			throw std::runtime_error("unsupported or truncated metadata index");
+
+		count = load64(base + countField);
+		rootTime = static_cast<std::int64_t>(load64(base + rootTimeField));
+		const auto blocks = (count + blockEntries - 1) / blockEntries;
+		const auto section = [this](HeaderField field, std::uint64_t size)
+		{
+			const auto offset = load64(base + field);
+			if (offset > length || size > length - offset)
+				throw std::runtime_error("corrupted metadata index");
+			return base + offset;
+		};
+		if (count > length)
+			throw std::runtime_error("corrupted metadata index");
+		const auto rootBytes = section(rootOffsetField, load64(base + rootLengthField));
+		root = std::filesystem::u8path(std::string(reinterpret_cast<const char *>(rootBytes), load64(base + rootLengthField)));
+		blockOffsets = section(blockOffsetsField, blocks * 8);
+		sizes = section(sizesOffsetField, count * 8);
+		times = section(timesOffsetField, count * 8);
+		types = section(typesOffsetField, count);
+		pathsLength = load64(base + pathsLengthField);
+		paths = section(pathsOffsetField, pathsLength);
+	}
+
+	std::size_t blockCount() const
+	{
+		return (count + blockEntries - 1) / blockEntries;
+	}
+
+	// Call visitor with the index and the path of each entry from the first one of block, until it returns false
+	template <typename Visitor>
+	void decode(std::size_t block, const Visitor &visitor) const
+	{
+		const auto	end = paths + pathsLength;
+		const auto *bytes = paths;
+		std::string path;
+		for (auto index = block * blockEntries; index < count; index++)
+		{
+			std::uint64_t shared = 0;
+			if (index % blockEntries == 0)
+			{
+				const auto offset = load64(blockOffsets + index / blockEntries * 8);
+				if (offset > pathsLength)
+					throw std::runtime_error("corrupted metadata index");
+				bytes = paths + offset;
+			}
+			else
+				shared = loadVarint(bytes, end);
+			const auto suffix = loadVarint(bytes, end);
+			if (shared > path.size() || suffix > static_cast<std::uint64_t>(end - bytes))
+				throw std::runtime_error("corrupted metadata index");
+			path.resize(shared);
+			path.append(reinterpret_cast<const char *>(bytes), suffix);
+			bytes += suffix;
+			if (!visitor(index, path))
+				return;
+		}
+	}
+
+	std::string blockPath(std::size_t block) const
+	{
+		std::string first;
+		decode(block,
+			   [&first](std::size_t, const std::string &path)
+			   {
+				   first = path;
+				   return false;
+			   });
+		return first;
+	}
+
+	// The last block whose first path is not after key, where the entry of key or its first entry after it is
+	std::size_t findBlock(const std::string &key) const
+	{
+		std::size_t begin = 0;
+		std::size_t end = blockCount();
+		while (end - begin > 1)
+		{
+			const auto middle = begin + (end - begin) / 2;
+			if (pathLess(key, blockPath(middle)))
+				end = middle;
+			else
+				begin = middle;
+		}
+		return begin;
+	}
+
+	IndexEntry entry(std::size_t index, const std::string &path) const
+	{
+		return IndexEntry{std::filesystem::u8path(path), fileType(types[index]), load64(sizes + index * 8),
+						  static_cast<std::int64_t>(load64(times + index * 8))};
+	}
+
+	std::vector<Record> records() const
+	{
+		std::vector<Record> result;
+		result.reserve(count);
+		decode(0,
+			   [this, &result](std::size_t index, const std::string &path)
+			   {
+				   result.push_back(Record{path, fileType(types[index]), load64(sizes + index * 8), static_cast<std::int64_t>(load64(times + index * 8))});
+				   return true;
+			   });
+		return result;
+	}
+
+	std::unique_ptr<MappedFile> file;
+	std::vector<std::uint8_t>	memory;
+	const std::uint8_t		   *base = nullptr;
+	std::size_t					length = 0;
+	std::filesystem::path		root;
+	std::int64_t				rootTime = 0;
+	std::uint64_t				count = 0;
+	const std::uint8_t		   *blockOffsets = nullptr;
+	const std::uint8_t		   *sizes = nullptr;
+	const std::uint8_t		   *times = nullptr;
+	const std::uint8_t		   *types = nullptr;
+	const std::uint8_t		   *paths = nullptr;
+	std::uint64_t				pathsLength = 0;
+};
+
+recpp::filesystem::MetadataIndex::MetadataIndex()
+{
+}
+
+recpp::filesystem::MetadataIndex::MetadataIndex(std::shared_ptr<const Data> data)
+	: m_data(std::move(data))
+{
+}
+
+recpp::filesystem::MetadataIndex recpp::filesystem::MetadataIndex::build(const std::filesystem::path &root, const MetadataIndexOptions &options)
+{
+	const auto indexedRoot = indexRoot(root);
+	const auto rootInfo = fileInfo(indexedRoot, true);
+	if (rootInfo.type != std::filesystem::file_type::directory)
+		throw std::filesystem::filesystem_error("index", root, std::make_error_code(std::errc::not_a_directory));
+
+	const RecordReader reader(indexedRoot, options);
+	auto			   records = reader.walk({indexedRoot});
+	return MetadataIndex(std::make_shared<const Data>(serialize(indexedRoot, rootInfo.modificationTime, records)));
+}
+
+recpp::filesystem::MetadataIndex recpp::filesystem::MetadataIndex::open(const std::filesystem::path &file)
+{
+	return MetadataIndex(std::make_shared<const Data>(std::make_unique<MappedFile>(file)));
+}
+
+recpp::filesystem::MetadataIndex recpp::filesystem::MetadataIndex::refresh(const MetadataIndexOptions &options) const
+{
+	if (!m_data)
+		throw std::logic_error("refresh of an empty metadata index");
+
+	const auto rootInfo = fileInfo(m_data->root, true);
+	if (rootInfo.type != std::filesystem::file_type::directory)
+		throw std::filesystem::filesystem_error("index", m_data->root, std::make_error_code(std::errc::not_a_directory));
+	const RecordReader reader(m_data->root, options);
+	auto			   records = m_data->records();
+
+	// Every indexed directory is checked on several threads, its new modification time being kept if it is still there
+	std::vector<std::size_t> directories;
+	for (std::size_t i = 0; i < records.size(); i++)
+	{
+		if (records[i].type == std::filesystem::file_type::directory)
+			directories.push_back(i);
+	}
+	std::vector<DirectoryState> states(directories.size());
+	parallelFor(
+		directories.size(),
+		[&records, &directories, &states, &reader, &options](std::size_t i)
+		{
+			if (options.token)
+				options.token->throwIfCancelled();
+			auto &record = records[directories[i]];
+			try
+			{
+				const auto info = fileInfo(reader.path(record.path));
+				if (info.type != std::filesystem::file_type::directory)
+					states[i] = DirectoryState::removed;
+				else if (info.modificationTime != record.modificationTime)
+					states[i] = DirectoryState::changed;
+				record.modificationTime = info.modificationTime;
+			}
+			catch (const std::filesystem::filesystem_error &)
+			{
+				states[i] = DirectoryState::removed;
+			}
+		},
+		options.threads);
+
+	// The entries of the unchanged directories are kept as is, the parent of each entry being the innermost directory enclosing it on the stack
+	const auto rootState = rootInfo.modificationTime == m_data->rootTime ? DirectoryState::unchanged : DirectoryState::changed;
+
+	std::unordered_map<std::string, DirectoryState>		known;
+	std::vector<Record>									kept;
+	std::vector<std::string>							relisted;
+	std::vector<std::pair<std::string, DirectoryState>> parents;
+	if (rootState == DirectoryState::changed)
+		relisted.emplace_back();
+	for (std::size_t i = 0, directory = 0; i < records.size(); i++)
+	{
+		auto &record = records[i];
+		while (!parents.empty() && !isUnder(record.path, parents.back().first))
+			parents.pop_back();
+		const auto parentState = parents.empty() ? rootState : parents.back().second;
+		const auto state = record.type == std::filesystem::file_type::directory ? states[directory++] : DirectoryState::unchanged;
+		if (parentState == DirectoryState::unchanged && state != DirectoryState::removed)
+			kept.push_back(record);
+		if (record.type != std::filesystem::file_type::directory)
+			continue;
+
+		known.emplace(record.path, state);
+		if (state == DirectoryState::changed)
+			relisted.push_back(record.path);
+		parents.emplace_back(std::move(record.path), state);
+	}
+
+	// The changed directories are listed again, and the directories that were not indexed yet are walked entirely
+	std::vector<std::vector<Record>> listings(relisted.size());
+	parallelFor(
+		relisted.size(),
+		[&relisted, &listings, &reader](std::size_t i)
+		{
+			listings[i] = reader.list(reader.path(relisted[i]));
+		},
+		options.threads);
+	std::vector<std::filesystem::path> added;
+	for (auto &listing : listings)
+	{
+		for (auto &record : listing)
+		{
+			const auto state = known.find(record.path);
+			if (record.type == std::filesystem::file_type::directory && (state == known.end() || state->second == DirectoryState::removed))
+				added.push_back(reader.path(record.path));
+			kept.push_back(std::move(record));
+		}
+	}
+	if (!added.empty())
+	{
+		auto walked = reader.walk(added);
+		kept.insert(kept.end(), std::make_move_iterator(walked.begin()), std::make_move_iterator(walked.end()));
+	}
+	return MetadataIndex(std::make_shared<const Data>(serialize(m_data->root, rootInfo.modificationTime, kept)));
+}
+
+void recpp::filesystem::MetadataIndex::write(const std::filesystem::path &file) const
+{
+	if (!m_data)
+		throw std::logic_error("write of an empty metadata index");
+
+	auto temporary = file;
+	temporary += ".tmp";
+	{
+		std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+		stream.write(reinterpret_cast<const char *>(m_data->base), static_cast<std::streamsize>(m_data->length));
+		stream.close();
+		if (!stream)
+		{
+			std::error_code error;
+			std::filesystem::remove(temporary, error);
+			throw std::filesystem::filesystem_error("write", temporary, std::make_error_code(std::errc::io_error));
+		}
+	}
+	std::filesystem::rename(temporary, file);
+}
+
+std::filesystem::path recpp::filesystem::MetadataIndex::root() const
+{
+	return m_data ? m_data->root : std::filesystem::path();
+}
+
+std::size_t recpp::filesystem::MetadataIndex::size() const
+{
+	return m_data ? static_cast<std::size_t>(m_data->count) : 0;
+}
+
+std::optional<IndexEntry> recpp::filesystem::MetadataIndex::find(const std::filesystem::path &path) const
+{
+	const auto key = pathKey(path);
+	if (!m_data || key.empty() || m_data->count == 0)
+		return std::nullopt;
+
+	std::optional<IndexEntry> result;
+	m_data->decode(m_data->findBlock(key),
+				   [this, &key, &result](std::size_t index, const std::string &entryPath)
+				   {
+					   if (entryPath == key)
+						   result = m_data->entry(index, entryPath);
+					   return pathLess(entryPath, key);
+				   });
+	return result;
+}
+
+void recpp::filesystem::MetadataIndex::forEach(const std::filesystem::path &prefix, const std::function<void(const IndexEntry &entry)> &visitor) const
+{
+	const auto key = pathKey(prefix);
+	if (!m_data || m_data->count == 0)
+		return;
+
+	m_data->decode(key.empty() ? 0 : m_data->findBlock(key),
+				   [this, &key, &visitor](std::size_t index, const std::string &entryPath)
+				   {
+					   if (!isUnder(entryPath, key))
+						   return !pathLess(key, entryPath);
+					   visitor(m_data->entry(index, entryPath));
+					   return true;
+				   });
+}
@@ -0,0 +1,353 @@
+#include "recpp/filesystem/OverlayFileSystem.h"
+#include "FileInfo.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	using Clock = recpp::filesystem::OverlayFileSystem::Clock;
+	// The relative path of a directory in the overlay, with '/' separators, empty for its root
+	using Key = std::string;
+
+	struct Entry
+	{
+		/// The layer providing the entry
+		std::size_t				   layer;
+		std::filesystem::file_type type;
+	};
+
+	// What a path of the overlay is in one layer
+	struct LayerState
+	{
+		std::size_t				   layer;
+		/// std::filesystem::file_type::not_found if the layer does not have the path
+		std::filesystem::file_type type;
+		/// The modification time of the file, in nanoseconds since the Unix epoch
+		std::int64_t			   modificationTime;
+
+		bool operator==(const LayerState &other) const
+		{
+			return type == other.type && modificationTime == other.modificationTime;
+		}
+	};
+
+	struct Directory
+	{
+		/// The states of the directory in the layers it was looked up in, which are checked to know whether it changed
+		std::vector<LayerState>		   checked;
+		/// The layers merged into the directory, from the highest precedence
+		std::vector<std::size_t>	   layers;
+		/// The entries of the directory by name
+		std::unordered_map<Key, Entry> entries;
+		/// A number identifying this listing, recorded by the listings of the subdirectories to know whether they were made from an older one
+		std::uint64_t				   generation = 0;
+		std::uint64_t				   parentGeneration = 0;
+		Clock::time_point			   checkedAt;
+	};
+
+	// Split path into its components in the overlay, or return false if it goes above its root
+	bool split(const std::filesystem::path &path, std::vector<Key> &components)
+	{
+		for (const auto &component : path.relative_path())
+		{
+			auto name = component.string();
+			if (name.empty() || name == ".")
+				continue;
+			if (name == "..")
+			{
+				if (components.empty())
+					return false;
+				components.pop_back();
+				continue;
+			}
+			components.push_back(std::move(name));
+		}
+		return true;
+	}
+
+	Key join(const std::vector<Key> &components, std::size_t count)
+	{
+		Key key;
+		for (std::size_t i = 0; i < count; i++)
+		{
+			if (i > 0)
+				key += '/';
+			key += components[i];
+		}
+		return key;
+	}
+} // namespace
+
+struct recpp::filesystem::OverlayFileSystem::Data
+{
+	Data(std::vector<std::filesystem::path> layers, const Settings &settings)
+		: layers(std::move(layers))
+		, settings(settings)
+	{
+	}
+
+	// Look up the state of key in a layer, following symlinks
+	LayerState state(std::size_t layer, const Key &key) const
+	{
+		try
+		{
+			const auto info = fileInfo(layers[layer] / key, true);
+			return LayerState{layer, info.type, info.modificationTime};
+		}
+		catch (const std::filesystem::filesystem_error &exception)
+		{
+			if (exception.code() != std::errc::no_such_file_or_directory && exception.code() != std::errc::not_a_directory)
+				throw;
+			return LayerState{layer, std::filesystem::file_type::not_found, 0};
+		}
+	}
+
+	// List the directory key from the layers, entry being its entry in its parent listing. The unique lock must be held
+	Directory list(const Key &key, const Directory *parent, const Entry *entry, Clock::time_point now)
+	{
+		Directory directory;
+		directory.generation = ++generations;
+		directory.parentGeneration = parent ? parent->generation : 0;
+		directory.checkedAt = now;
+
+		// The root is looked up in every layer, and the other directories in the layers merged into their parent, from the one providing them
+		std::vector<std::size_t> candidates;
+		if (parent)
+		{
+			std::copy_if(parent->layers.begin(), parent->layers.end(), std::back_inserter(candidates),
+						 [entry](std::size_t layer)
+						 {
+							 return layer >= entry->layer;
+						 });
+		}
+		else
+		{
+			for (std::size_t layer = 0; layer < layers.size(); layer++)
+				candidates.push_back(layer);
+		}
+
+		for (const auto layer : candidates)
+		{
+			const auto current = state(layer, key);
+			directory.checked.push_back(current);
+			if (current.type == std::filesystem::file_type::not_found)
+				continue;
+			// A file hides the directories below it
+			if (current.type != std::filesystem::file_type::directory)
+				break;
+			directory.layers.push_back(layer);
+			for (const auto &child : std::filesystem::directory_iterator(layers[layer] / key))
+			{
+				auto name = child.path().filename().string();
+				if (directory.entries.count(name))
+					continue;
+				// Only symlinks need another stat to get the type of their target
+				auto type = child.symlink_status().type();
+				if (type == std::filesystem::file_type::symlink)
+				{
+					std::error_code error;
+					const auto		target = std::filesystem::status(child.path(), error);
+					if (!error)
+						type = target.type();
+				}
+				directory.entries.emplace(std::move(name), Entry{layer, type});
+			}
+		}
+		return directory;
+	}
+
+	// Get the listing of key from the cache, or nullptr if it is missing or must be checked, with a shared lock held
+	const Directory *cached(const Key &key, const Directory *parent, Clock::time_point now) const
+	{
+		const auto found = directories.find(key);
+		if (found == directories.end())
+			return nullptr;
+		const auto &directory = found->second;
+		if ((parent && directory.parentGeneration != parent->generation) || now - directory.checkedAt >= settings.revalidationInterval)
+			return nullptr;
+		hits++;
+		return &directory;
+	}
+
+	// Get the listing of key, checking whether it changed or listing it if needed, with the unique lock held
+	const Directory *fresh(const Key &key, const Directory *parent, const Entry *entry, Clock::time_point now)
+	{
+		if (const auto directory = cached(key, parent, now))
+			return directory;
+		const auto found = directories.find(key);
+		if (found != directories.end() && (!parent || found->second.parentGeneration == parent->generation))
+		{
+			revalidations++;
+			auto	  &directory = found->second;
+			const auto unchanged = std::all_of(directory.checked.begin(), directory.checked.end(),
+											   [this, &key](const LayerState &checked)
+											   {
+												   return state(checked.layer, key) == checked;
+											   });
+			if (unchanged)
+			{
+				directory.checkedAt = now;
+				return &directory;
+			}
+		}
+		// The listing is only stored once it succeeded, so that a directory that could not be listed is not left cached as empty
+		misses++;
+		auto directory = list(key, parent, entry, now);
+		return &directories.insert_or_assign(key, std::move(directory)).first->second;
+	}
+
+	// Get the listing of the directory made of the first count components, or nullptr if one of them is not a directory of the overlay. Without load, the
+	// directories are only taken from the cache, missed being set if one of them was not
+	const Directory *directory(const std::vector<Key> &components, std::size_t count, bool load, bool &missed)
+	{
+		const auto now = Clock::now();
+		Key		   key;
+		auto	   current = load ? fresh(key, nullptr, nullptr, now) : cached(key, nullptr, now);
+		for (std::size_t i = 0; current && i < count; i++)
+		{
+			const auto found = current->entries.find(components[i]);
+			if (found == current->entries.end() || found->second.type != std::filesystem::file_type::directory)
+				return nullptr;
+			if (i > 0)
+				key += '/';
+			key += components[i];
+			current = load ? fresh(key, current, &found->second, now) : cached(key, current, now);
+		}
+		missed = !current;
+		return current;
+	}
+
+	// Run lookUp with a shared lock on the cache, and again with a unique lock loading the directories if some of them needed it
+	template <typename LookUp>
+	auto locked(const LookUp &lookUp)
+	{
+		{
+			std::shared_lock lock(mutex);
+			auto			 missed = false;
+			auto			 result = lookUp(false, missed);
+			if (!missed)
+				return result;
+		}
+		std::unique_lock lock(mutex);
+		auto			 missed = false;
+		return lookUp(true, missed);
+	}
+
+	OverlayEntry entry(const Key &key, std::size_t layer, std::filesystem::file_type type) const
+	{
+		return OverlayEntry{key, key.empty() ? layers[layer] : layers[layer] / key, layer, type};
+	}
+
+	const std::vector<std::filesystem::path> layers;
+	const Settings							 settings;
+	mutable std::shared_mutex				 mutex;
+	std::unordered_map<Key, Directory>		 directories;
+	std::uint64_t							 generations = 0;
+	mutable std::atomic<std::uintmax_t>		 hits = 0;
+	std::atomic<std::uintmax_t>				 revalidations = 0;
+	std::atomic<std::uintmax_t>				 misses = 0;
+};
+
+recpp::filesystem::OverlayFileSystem::OverlayFileSystem(std::vector<std::filesystem::path> layers)
+	: OverlayFileSystem(std::move(layers), Settings())
+{
+}
+
+recpp::filesystem::OverlayFileSystem::OverlayFileSystem(std::vector<std::filesystem::path> layers, const Settings &settings)
+	: m_data(std::make_shared<Data>(std::move(layers), settings))
+{
+}
+
+const std::vector<std::filesystem::path> &recpp::filesystem::OverlayFileSystem::layers() const
+{
+	return m_data->layers;
+}
+
+std::optional<recpp::filesystem::OverlayEntry> recpp::filesystem::OverlayFileSystem::resolve(const std::filesystem::path &path) const
+{
+	std::vector<Key> components;
+	if (!split(path, components))
+		return std::nullopt;
+
+	return m_data->locked(
+		[this, &components](bool load, bool &missed) -> std::optional<OverlayEntry>
+		{
+			const auto count = components.empty() ? 0 : components.size() - 1;
+			const auto parent = m_data->directory(components, count, load, missed);
+			if (!parent)
+				return std::nullopt;
+			if (components.empty())
+			{
+				if (parent->layers.empty())
+					return std::nullopt;
+				return m_data->entry(Key(), parent->layers.front(), std::filesystem::file_type::directory);
+			}
+			const auto found = parent->entries.find(components.back());
+			if (found == parent->entries.end())
+				return std::nullopt;
+			return m_data->entry(join(components, components.size()), found->second.layer, found->second.type);
+		});
+}
+
+std::vector<recpp::filesystem::OverlayEntry> recpp::filesystem::OverlayFileSystem::list(const std::filesystem::path &path) const
+{
+	const auto entry = resolve(path);
+	if (!entry)
+		throw std::filesystem::filesystem_error("overlay list", path, std::make_error_code(std::errc::no_such_file_or_directory));
+	if (entry->type != std::filesystem::file_type::directory)
+		throw std::filesystem::filesystem_error("overlay list", path, std::make_error_code(std::errc::not_a_directory));
+
+	std::vector<Key> components;
+	split(path, components);
+	auto entries = m_data->locked(
+		[this, &components](bool load, bool &missed)
+		{
+			std::vector<OverlayEntry> result;
+			const auto				  directory = m_data->directory(components, components.size(), load, missed);
+			if (!directory)
+				return result;
+			const auto prefix = join(components, components.size());
+			for (const auto &[name, child] : directory->entries)
+				result.push_back(m_data->entry(prefix.empty() ? name : prefix + '/' + name, child.layer, child.type));
+			return result;
+		});
+	std::sort(entries.begin(), entries.end(),
+			  [](const OverlayEntry &a, const OverlayEntry &b)
+			  {
+				  return a.path < b.path;
+			  });
+	return entries;
+}
+
+void recpp::filesystem::OverlayFileSystem::invalidate(const std::filesystem::path &path)
+{
+	std::vector<Key> components;
+	if (!split(path, components))
+		return;
+
+	// The listings of the directories under the forgotten one no longer match its generation, and are listed again when looked up
+	std::unique_lock lock(m_data->mutex);
+	if (m_data->directories.erase(join(components, components.size())) == 0 && !components.empty())
+		m_data->directories.erase(join(components, components.size() - 1));
+}
+
+void recpp::filesystem::OverlayFileSystem::clear()
+{
+	std::unique_lock lock(m_data->mutex);
+	m_data->directories.clear();
+}
+
+recpp::filesystem::OverlayFileSystem::Statistics recpp::filesystem::OverlayFileSystem::statistics() const
+{
+	return Statistics{m_data->hits, m_data->revalidations, m_data->misses};
+}
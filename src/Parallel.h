@@ -0,0 +1,397 @@
+#pragma once
+
+#include <recpp/filesystem/ConcurrencyLimiter.h>
+#include <recpp/rx/Single.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Get the number of threads to use for @p requested threads, 0 meaning one per hardware thread.
+	 */
+	inline unsigned threadCount(unsigned requested = 0)
+	{
+		if (requested)
+			return requested;
+		return std::max(1U, std::thread::hardware_concurrency());
+	}
+
+	/**
+	 * @brief The scheduler and the concurrency limiter of the FileSystem operation running on the current thread, which the parallel parts of the
+	 * operation run their tasks on rather than on threads of their own.
+	 */
+	class TaskContext
+	{
+	public:
+		/**
+		 * @brief Installs a TaskContext on the current thread for as long as it lives.
+		 */
+		class Scope
+		{
+		public:
+			explicit Scope(const TaskContext &context)
+				: m_previous(current())
+			{
+				currentContext() = &context;
+			}
+
+			Scope(const Scope &) = delete;
+			Scope &operator=(const Scope &) = delete;
+
+			~Scope()
+			{
+				currentContext() = m_previous;
+			}
+
+		private:
+			const TaskContext *m_previous;
+		};
+
+		TaskContext(recpp::async::Scheduler &scheduler, std::shared_ptr<ConcurrencyLimiter> limiter)
+			: m_scheduler(&scheduler)
+			, m_limiter(std::move(limiter))
+		{
+		}
+
+		/**
+		 * @brief Get the TaskContext installed on the current thread, nullptr outside of the operations of a FileSystem.
+		 */
+		static const TaskContext *current()
+		{
+			return currentContext();
+		}
+
+		/**
+		 * @brief Run @p task on the scheduler, with this context installed.
+		 */
+		void post(std::function<void()> task) const
+		{
+			recpp::rx::Completable::defer(
+				[context = *this, task = std::move(task)]()
+				{
+					const Scope scope(context);
+					task();
+					return recpp::rx::Completable::complete();
+				})
+				.subscribeOn(*m_scheduler)
+				.subscribe(
+					[]()
+					{
+					},
+					[](const std::exception_ptr &)
+					{
+					});
+		}
+
+		/**
+		 * @brief Try to start one more worker on the mount of the operation, returning false if its limiter rejects it. The permit acquired is stored in
+		 * @p permit, to release once the worker is done.
+		 */
+		bool admit(std::optional<ConcurrencyLimiter::Permit> &permit) const
+		{
+			if (!m_limiter)
+				return true;
+			permit = m_limiter->tryAcquire();
+			return permit.has_value();
+		}
+
+	private:
+		static const TaskContext *&currentContext()
+		{
+			static thread_local const TaskContext *context = nullptr;
+			return context;
+		}
+
+		recpp::async::Scheduler			   *m_scheduler;
+		std::shared_ptr<ConcurrencyLimiter> m_limiter;
+	};
+
+	/**
+	 * @brief Call @p work on the calling thread and on up to @p workers - 1 other workers, returning once every call returned. @p work must not throw.
+	 * <p>
+	 * Within the operations of a FileSystem, the other workers are tasks of the scheduler of the operation, each holding a permit of the concurrency limiter
+	 * of its mount: the calling thread never waits for them to start, so that the workers the scheduler does not start before it is done, and those the
+	 * limiter rejects, do not call @p work at all. Elsewhere, they are threads.
+	 */
+	template <typename Work>
+	void runWorkers(unsigned workers, const Work &work)
+	{
+		const auto context = TaskContext::current();
+		if (!context)
+		{
+			std::vector<std::thread> threads;
+			for (unsigned i = 1; i < workers; i++)
+				threads.emplace_back(work);
+			work();
+			for (auto &thread : threads)
+				thread.join();
+			return;
+		}
+
+		// The tasks may outlive this call when the scheduler starts them late, in which case they find the workers closed and return right away
+		struct Workers
+		{
+			std::mutex				mutex;
+			std::condition_variable condition;
+			const Work			   *work;
+			std::size_t				running = 0;
+			bool					closed = false;
+		};
+		const auto state = std::make_shared<Workers>();
+		state->work = &work;
+		for (unsigned i = 1; i < workers; i++)
+			context->post(
+				[state]()
+				{
+					std::optional<ConcurrencyLimiter::Permit> permit;
+					{
+						std::lock_guard lock(state->mutex);
+						if (state->closed || !TaskContext::current()->admit(permit))
+							return;
+						state->running++;
+					}
+					(*state->work)();
+					if (permit)
+						permit->release();
+
+					std::lock_guard lock(state->mutex);
+					if (--state->running == 0)
+						state->condition.notify_all();
+				});
+
+		work();
+		std::unique_lock lock(state->mutex);
+		state->closed = true;
+		state->condition.wait(lock,
+							  [&state]()
+							  {
+								  return state->running == 0;
+							  });
+	}
+
+	/**
+	 * @brief Call @p function with every index in [0, @p count) on up to @p threads workers of runWorkers, the calling thread being one of them. The first
+	 * exception thrown by @p function stops the remaining calls and is rethrown once every worker stopped.
+	 */
+	template <typename Function>
+	void parallelFor(std::size_t count, const Function &function, unsigned threads = 0)
+	{
+		std::atomic<std::size_t> next = 0;
+		std::atomic<bool>		 failed = false;
+		std::mutex				 mutex;
+		std::exception_ptr		 error;
+
+		const auto work = [&]()
+		{
+			for (auto i = next++; i < count && !failed; i = next++)
+			{
+				try
+				{
+					function(i);
+				}
+				catch (...)
+				{
+					std::lock_guard lock(mutex);
+					if (!error)
+						error = std::current_exception();
+					failed = true;
+				}
+			}
+		};
+
+		runWorkers(static_cast<unsigned>(std::min<std::size_t>(threadCount(threads), count)), work);
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+	/**
+	 * @brief Call @p process with each item of @p items, and with each item the calls return, on up to @p threads workers of runWorkers, the calling
+	 * thread being one of them, until none is left. The first exception thrown by @p process stops the remaining calls and is rethrown once every worker
+	 * stopped.
+	 */
+	template <typename Item, typename Process>
+	void parallelQueue(std::vector<Item> items, const Process &process, unsigned threads = 0)
+	{
+		std::mutex				mutex;
+		std::condition_variable condition;
+		std::size_t				busy = 0;
+		std::exception_ptr		error;
+
+		const auto work = [&]()
+		{
+			std::unique_lock lock(mutex);
+			while (true)
+			{
+				// The queue is drained once no item is left and no worker is processing one, since only those could add new items
+				condition.wait(lock,
+							   [&]()
+							   {
+								   return !items.empty() || busy == 0 || error;
+							   });
+				if (items.empty() || error)
+					break;
+
+				const auto item = std::move(items.back());
+				items.pop_back();
+				busy++;
+				lock.unlock();
+
+				std::vector<Item>  next;
+				std::exception_ptr failure;
+				try
+				{
+					next = process(item);
+				}
+				catch (...)
+				{
+					failure = std::current_exception();
+				}
+
+				lock.lock();
+				busy--;
+				if (failure && !error)
+					error = failure;
+				items.insert(items.end(), std::make_move_iterator(next.begin()), std::make_move_iterator(next.end()));
+				condition.notify_all();
+			}
+			condition.notify_all();
+		};
+
+		runWorkers(threadCount(threads), work);
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+	/**
+	 * @brief A call of a function started in the background, on the scheduler of the current FileSystem operation like the workers of runWorkers, or on
+	 * a thread elsewhere, which get makes on the calling thread if it did not start yet.
+	 */
+	template <typename T>
+	class BackgroundCall
+	{
+	public:
+		explicit BackgroundCall(std::function<T()> function)
+			: m_call(std::make_shared<Call>())
+		{
+			m_call->function = std::move(function);
+			if (const auto context = TaskContext::current())
+				context->post(
+					[call = m_call]()
+					{
+						std::optional<ConcurrencyLimiter::Permit> permit;
+						if (call->start(permit))
+							call->run();
+					});
+			else
+				m_thread = std::thread(
+					[call = m_call]()
+					{
+						if (call->start())
+							call->run();
+					});
+		}
+
+		BackgroundCall(const BackgroundCall &) = delete;
+		BackgroundCall &operator=(const BackgroundCall &) = delete;
+
+		~BackgroundCall()
+		{
+			// A call that did not start is dropped, and one that started is waited for since it uses the state of its caller
+			if (m_call->start())
+				m_call->finish();
+			else
+				m_call->wait();
+			if (m_thread.joinable())
+				m_thread.join();
+		}
+
+		/**
+		 * @brief Get the result of the call, rethrowing its exception if it threw one.
+		 */
+		T get()
+		{
+			if (m_call->start())
+				m_call->run();
+			else
+				m_call->wait();
+			if (m_thread.joinable())
+				m_thread.join();
+			if (m_call->error)
+				std::rethrow_exception(m_call->error);
+			return std::move(*m_call->result);
+		}
+
+	private:
+		struct Call
+		{
+			std::mutex				mutex;
+			std::condition_variable condition;
+			std::function<T()>		function;
+			std::optional<T>		result;
+			std::exception_ptr		error;
+			bool					started = false;
+			bool					done = false;
+
+			bool start()
+			{
+				std::lock_guard lock(mutex);
+				return !std::exchange(started, true);
+			}
+
+			// Start the call from the scheduler, unless the limiter of the mount rejects it, in which case get makes it
+			bool start(std::optional<ConcurrencyLimiter::Permit> &permit)
+			{
+				std::lock_guard lock(mutex);
+				if (started || !TaskContext::current()->admit(permit))
+					return false;
+				return started = true;
+			}
+
+			void run()
+			{
+				try
+				{
+					result = function();
+				}
+				catch (...)
+				{
+					error = std::current_exception();
+				}
+				finish();
+			}
+
+			void finish()
+			{
+				std::lock_guard lock(mutex);
+				done = true;
+				condition.notify_all();
+			}
+
+			void wait()
+			{
+				std::unique_lock lock(mutex);
+				condition.wait(lock,
+							   [this]()
+							   {
+								   return done;
+							   });
+			}
+		};
+
+		std::shared_ptr<Call> m_call;
+		std::thread			  m_thread;
+	};
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Get the absolute, lexically normal, generic form of @p path without any trailing separator, used to match paths against mount points without
+	 * performing any blocking call.
+	 */
+	inline std::string lexicalKey(const std::filesystem::path &path)
+	{
+		auto key = std::filesystem::absolute(path).lexically_normal().generic_string();
+		while (key.size() > 1 && key.back() == '/')
+			key.pop_back();
+		return key;
+	}
+
+	/**
+	 * @brief Check whether the lexical key @p key designates @p mountPoint or a path under it.
+	 */
+	inline bool isUnder(const std::string &key, const std::string &mountPoint)
+	{
+		if (key.compare(0, mountPoint.size(), mountPoint) != 0)
+			return false;
+		return key.size() == mountPoint.size() || mountPoint.back() == '/' || key[mountPoint.size()] == '/';
+	}
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,232 @@
+#include "recpp/filesystem/PathTable.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <vector>
+
+using namespace recpp::filesystem;
+
+namespace
+{
+	using Character = std::filesystem::path::value_type;
+
+	// Size of the blocks of the arena holding the names, in characters, which is also the length of the longest name
+	constexpr std::size_t blockSize = 1 << 16;
+	// The nodes are allocated by pages rather than in a vector, which would need twice their size while growing
+	constexpr std::size_t pageShift = 12;
+	constexpr std::size_t pageSize = std::size_t(1) << pageShift;
+	constexpr std::size_t initialSlots = 64;
+} // namespace
+
+struct recpp::filesystem::PathTable::Data
+{
+	// The name is addressed by its offset in the arena rather than by a pointer, to fit the node in 12 bytes
+	struct Node
+	{
+		Id			  parent;
+		std::uint32_t name;
+		std::uint32_t size;
+	};
+
+	Data()
+		: slots(initialSlots, 0)
+	{
+		append(Node{empty, 0, 0});
+	}
+
+	static std::size_t hash(Id parent, NameView name)
+	{
+		return std::hash<NameView>()(name) ^ static_cast<std::size_t>(parent * 0x9E3779B97F4A7C15ULL);
+	}
+
+	void check(Id id) const
+	{
+		if (id >= count)
+			throw std::out_of_range("invalid PathTable handle");
+	}
+
+	const Node &node(Id id) const
+	{
+		return pages[id >> pageShift][id & (pageSize - 1)];
+	}
+
+	NameView nodeName(Id id) const
+	{
+		const auto &current = node(id);
+		return NameView(blocks[current.name / blockSize].get() + current.name % blockSize, current.size);
+	}
+
+	void append(const Node &node)
+	{
+		if (count % pageSize == 0)
+			pages.emplace_back(new Node[pageSize]);
+		pages.back()[count % pageSize] = node;
+		count++;
+	}
+
+	// Find the slot of the child name of parent, or the empty slot where it belongs, the slots holding the handles plus one so that 0 marks empty slots
+	std::size_t slot(Id parent, NameView name) const
+	{
+		const auto mask = slots.size() - 1;
+		for (auto i = hash(parent, name) & mask;; i = (i + 1) & mask)
+		{
+			const auto id = slots[i];
+			if (id == 0 || (node(id - 1).parent == parent && nodeName(id - 1) == name))
+				return i;
+		}
+	}
+
+	std::optional<Id> lookup(Id parent, NameView name) const
+	{
+		if (parent == empty && name.empty())
+			return empty;
+		const auto id = slots[slot(parent, name)];
+		if (id == 0)
+			return std::nullopt;
+		return id - 1;
+	}
+
+	Id insert(Id parent, NameView name)
+	{
+		if (parent == empty && name.empty())
+			return empty;
+		auto i = slot(parent, name);
+		if (slots[i] != 0)
+			return slots[i] - 1;
+		if (count >= std::numeric_limits<Id>::max() || blocks.size() * blockSize > std::numeric_limits<std::uint32_t>::max() - blockSize)
+			throw std::length_error("too many paths in PathTable");
+		if (name.size() > blockSize)
+			throw std::length_error("name too long for PathTable");
+
+		// The table is kept at most 3/4 full so that the probes stay short
+		if ((count + 1) * 4 > slots.size() * 3)
+		{
+			grow();
+			i = slot(parent, name);
+		}
+		const auto id = static_cast<Id>(count);
+		append(Node{parent, store(name), static_cast<std::uint32_t>(name.size())});
+		slots[i] = id + 1;
+		return id;
+	}
+
+	void grow()
+	{
+		slots.assign(slots.size() * 2, 0);
+		const auto mask = slots.size() - 1;
+		for (Id id = 1; id < count; id++)
+		{
+			auto i = hash(node(id).parent, nodeName(id)) & mask;
+			while (slots[i] != 0)
+				i = (i + 1) & mask;
+			slots[i] = id + 1;
+		}
+	}
+
+	// Copy name at the end of the arena, starting a new block when it does not fit in the current one
+	std::uint32_t store(NameView name)
+	{
+		if (blocks.empty() || name.size() > blockSize - blockUsed)
+		{
+			blocks.emplace_back(new Character[blockSize]);
+			blockUsed = 0;
+		}
+		std::copy(name.begin(), name.end(), blocks.back().get() + blockUsed);
+		const auto offset = (blocks.size() - 1) * blockSize + blockUsed;
+		blockUsed += name.size();
+		return static_cast<std::uint32_t>(offset);
+	}
+
+	std::shared_mutex						  mutex;
+	std::vector<std::unique_ptr<Node[]>>	  pages;
+	std::size_t								  count = 0;
+	std::vector<Id>							  slots;
+	std::vector<std::unique_ptr<Character[]>> blocks;
+	std::size_t								  blockUsed = 0;
+};
+
+recpp::filesystem::PathTable::PathTable()
+	: m_data(std::make_shared<Data>())
+{
+}
+
+recpp::filesystem::PathTable::Id recpp::filesystem::PathTable::intern(const std::filesystem::path &path)
+{
+	// Most paths interned by a walk already have their parents interned, which only needs the shared lock
+	if (const auto id = find(path))
+		return *id;
+
+	std::unique_lock lock(m_data->mutex);
+	auto			 id = empty;
+	for (const auto &component : path)
+		id = m_data->insert(id, component.native());
+	return id;
+}
+
+recpp::filesystem::PathTable::Id recpp::filesystem::PathTable::child(Id parent, NameView name)
+{
+	{
+		std::shared_lock lock(m_data->mutex);
+		m_data->check(parent);
+		if (const auto id = m_data->lookup(parent, name))
+			return *id;
+	}
+	std::unique_lock lock(m_data->mutex);
+	return m_data->insert(parent, name);
+}
+
+std::optional<recpp::filesystem::PathTable::Id> recpp::filesystem::PathTable::find(const std::filesystem::path &path) const
+{
+	std::shared_lock  lock(m_data->mutex);
+	std::optional<Id> id = empty;
+	for (auto component = path.begin(); component != path.end() && id; ++component)
+		id = m_data->lookup(*id, component->native());
+	return id;
+}
+
+recpp::filesystem::PathTable::Id recpp::filesystem::PathTable::parent(Id id) const
+{
+	std::shared_lock lock(m_data->mutex);
+	m_data->check(id);
+	return m_data->node(id).parent;
+}
+
+recpp::filesystem::PathTable::NameView recpp::filesystem::PathTable::name(Id id) const
+{
+	std::shared_lock lock(m_data->mutex);
+	m_data->check(id);
+	return m_data->nodeName(id);
+}
+
+std::filesystem::path recpp::filesystem::PathTable::path(Id id) const
+{
+	std::vector<NameView> components;
+	{
+		std::shared_lock lock(m_data->mutex);
+		m_data->check(id);
+		for (auto current = id; current != empty; current = m_data->node(current).parent)
+			components.push_back(m_data->nodeName(current));
+	}
+
+	std::filesystem::path result;
+	for (auto component = components.rbegin(); component != components.rend(); ++component)
+		result /= std::filesystem::path(*component);
+	return result;
+}
+
+std::size_t recpp::filesystem::PathTable::size() const
+{
+	std::shared_lock lock(m_data->mutex);
+	return m_data->count;
+}
+
+std::size_t recpp::filesystem::PathTable::memoryUsage() const
+{
+	std::shared_lock lock(m_data->mutex);
+	const auto		&data = *m_data;
+	return data.pages.size() * pageSize * sizeof(Data::Node) + data.slots.capacity() * sizeof(Id) + data.blocks.size() * blockSize * sizeof(Character);
+}
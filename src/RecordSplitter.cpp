@@ -0,0 +1,89 @@
+#include "RecordSplitter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+using namespace recpp::filesystem::detail;
+
+recpp::filesystem::detail::RecordSplitter::RecordSplitter(char delimiter, bool stripCarriageReturn, Callback onRecord)
+	: m_onRecord(std::move(onRecord))
+	, m_delimiter(delimiter)
+	, m_stripCarriageReturn(stripCarriageReturn)
+{
+}
+
+recpp::filesystem::detail::RecordSplitter::RecordSplitter(std::size_t recordSize, Callback onRecord)
+	: m_onRecord(std::move(onRecord))
+	, m_recordSize(recordSize)
+{
+	if (recordSize == 0)
+		throw std::invalid_argument("record size of 0 bytes");
+}
+
+void recpp::filesystem::detail::RecordSplitter::split(std::string_view chunk)
+{
+	if (m_recordSize)
+		splitFixedSize(chunk);
+	else
+		splitDelimited(chunk);
+}
+
+void recpp::filesystem::detail::RecordSplitter::finish()
+{
+	if (m_pending.empty())
+		return;
+	deliver(m_pending);
+	m_pending.clear();
+}
+
+void recpp::filesystem::detail::RecordSplitter::splitDelimited(std::string_view chunk)
+{
+	auto	   begin = chunk.data();
+	const auto end = begin + chunk.size();
+	while (begin != end)
+	{
+		const auto found = static_cast<const char *>(std::memchr(begin, m_delimiter, end - begin));
+		if (!found)
+		{
+			m_pending.append(begin, end);
+			return;
+		}
+
+		// The pending record is never empty, the previous chunk having left at least a byte of it
+		if (m_pending.empty())
+			deliver(std::string_view(begin, found - begin));
+		else
+		{
+			m_pending.append(begin, found);
+			deliver(m_pending);
+			m_pending.clear();
+		}
+		begin = found + 1;
+	}
+}
+
+void recpp::filesystem::detail::RecordSplitter::splitFixedSize(std::string_view chunk)
+{
+	if (!m_pending.empty())
+	{
+		const auto count = std::min(m_recordSize - m_pending.size(), chunk.size());
+		m_pending.append(chunk.data(), count);
+		chunk.remove_prefix(count);
+		if (m_pending.size() < m_recordSize)
+			return;
+		deliver(m_pending);
+		m_pending.clear();
+	}
+	for (; chunk.size() >= m_recordSize; chunk.remove_prefix(m_recordSize))
+		m_onRecord(chunk.substr(0, m_recordSize));
+	m_pending.assign(chunk);
+}
+
+void recpp::filesystem::detail::RecordSplitter::deliver(std::string_view record)
+{
+	if (m_stripCarriageReturn && !record.empty() && record.back() == '\r')
+		record.remove_suffix(1);
+	m_onRecord(record);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Splitter of a stream fed by chunks into records, either ended by a delimiter or of a fixed size.
+	 * <p>
+	 * The records lying within a chunk are delivered as views into it, without being copied. Only a record spanning several chunks is assembled in a buffer
+	 * reused from one record to the next, so that splitting allocates nothing once that buffer has grown to the longest such record. Delimiters are found
+	 * with memchr, which the C libraries vectorize.
+	 */
+	class RecordSplitter
+	{
+	public:
+		using Callback = std::function<void(std::string_view record)>;
+
+		/**
+		 * @brief Construct a RecordSplitter splitting records ended by @p delimiter, which is not part of the records.
+		 *
+		 * @param stripCarriageReturn True to also remove a '\r' ending a record, to split the lines of both Unix and Windows text files
+		 * @param onRecord The function called with each record, only valid until it returns
+		 */
+		RecordSplitter(char delimiter, bool stripCarriageReturn, Callback onRecord);
+
+		/**
+		 * @brief Construct a RecordSplitter splitting records of @p recordSize bytes, throwing a std::invalid_argument if it is 0.
+		 *
+		 * @param onRecord The function called with each record, only valid until it returns
+		 */
+		RecordSplitter(std::size_t recordSize, Callback onRecord);
+
+		/**
+		 * @brief Deliver the records ended in @p chunk, keeping the beginning of the record it does not end for the next chunks.
+		 */
+		void split(std::string_view chunk);
+
+		/**
+		 * @brief Deliver the last record of the stream, if it is not empty: the record not ended by a delimiter, or the last record shorter than the record
+		 * size.
+		 */
+		void finish();
+
+	private:
+		void splitDelimited(std::string_view chunk);
+		void splitFixedSize(std::string_view chunk);
+		void deliver(std::string_view record);
+
+		Callback	m_onRecord;
+		std::size_t m_recordSize = 0;
+		char		m_delimiter = '\0';
+		bool		m_stripCarriageReturn = false;
+		/// The beginning of the record spanning several chunks
+		std::string m_pending;
+	};
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,135 @@
+#include "SparseFile.h"
+
+#include <cerrno>
+#include <system_error>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	[[noreturn]] void fail(const char *operation, const std::filesystem::path &path, int error)
+	{
+		throw std::filesystem::filesystem_error(operation, path, std::error_code(error, std::generic_category()));
+	}
+
+#ifndef _WIN32
+	class Descriptor
+	{
+	public:
+		Descriptor(const std::filesystem::path &path, int flags)
+			: m_descriptor(::open(path.c_str(), flags | O_CLOEXEC))
+		{
+			if (m_descriptor < 0)
+				fail("open", path, errno);
+		}
+
+		Descriptor(const Descriptor &) = delete;
+		Descriptor &operator=(const Descriptor &) = delete;
+
+		~Descriptor()
+		{
+			::close(m_descriptor);
+		}
+
+		int get() const
+		{
+			return m_descriptor;
+		}
+
+	private:
+		int m_descriptor;
+	};
+#endif
+} // namespace
+
+void recpp::filesystem::detail::allocate(const std::filesystem::path &path, [[maybe_unused]] std::uintmax_t offset, std::uintmax_t length,
+										 [[maybe_unused]] AllocationMode mode)
+{
+	// fallocate rejects empty ranges, which have nothing to do anyway
+	if (length == 0)
+		return;
+
+#ifdef __linux__
+	const Descriptor file(path, O_WRONLY);
+	const auto		 fallocateRange = [&file, offset, length](int flags)
+	{
+		return ::fallocate(file.get(), flags, static_cast<off_t>(offset), static_cast<off_t>(length)) == 0;
+	};
+
+	auto flags = 0;
+	switch (mode)
+	{
+	case AllocationMode::allocate:
+		break;
+	case AllocationMode::keepSize:
+		flags = FALLOC_FL_KEEP_SIZE;
+		break;
+	case AllocationMode::punchHole:
+		flags = FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE;
+		break;
+	case AllocationMode::zeroRange:
+		flags = FALLOC_FL_ZERO_RANGE;
+		break;
+	}
+	if (fallocateRange(flags))
+		return;
+
+	// A hole allocated again reads as zeros too, and both are supported by more filesystems
+	if (errno == EOPNOTSUPP && mode == AllocationMode::zeroRange && fallocateRange(FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE) && fallocateRange(0))
+		return;
+	fail("fallocate", path, errno);
+#elif defined(_WIN32) || defined(__APPLE__)
+	fail("fallocate", path, static_cast<int>(std::errc::operation_not_supported));
+#else
+	if (mode != AllocationMode::allocate)
+		fail("fallocate", path, static_cast<int>(std::errc::operation_not_supported));
+	const Descriptor file(path, O_WRONLY);
+	const auto		 result = ::posix_fallocate(file.get(), static_cast<off_t>(offset), static_cast<off_t>(length));
+	if (result != 0)
+		fail("posix_fallocate", path, result);
+#endif
+}
+
+std::vector<DataSegment> recpp::filesystem::detail::dataSegments(const std::filesystem::path &path)
+{
+	std::vector<DataSegment> segments;
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+	const Descriptor file(path, O_RDONLY);
+	struct stat		 info;
+	if (::fstat(file.get(), &info) != 0)
+		fail("stat", path, errno);
+	const auto size = static_cast<std::uintmax_t>(info.st_size);
+
+	for (std::uintmax_t offset = 0; offset < size;)
+	{
+		const auto data = ::lseek(file.get(), static_cast<off_t>(offset), SEEK_DATA);
+		if (data < 0)
+		{
+			// ENXIO means that only a hole is left, and old kernels reject SEEK_DATA with EINVAL, the whole file being data for them
+			if (errno == ENXIO)
+				break;
+			if (errno != EINVAL)
+				fail("lseek", path, errno);
+			segments.assign(1, DataSegment{0, size});
+			break;
+		}
+		const auto hole = ::lseek(file.get(), data, SEEK_HOLE);
+		if (hole < 0)
+			fail("lseek", path, errno);
+		segments.push_back(DataSegment{static_cast<std::uintmax_t>(data), static_cast<std::uintmax_t>(hole - data)});
+		offset = static_cast<std::uintmax_t>(hole);
+	}
+#else
+	const auto size = std::filesystem::file_size(path);
+	if (size)
+		segments.push_back(DataSegment{0, size});
+#endif
+	return segments;
+}
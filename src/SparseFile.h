@@ -0,0 +1,25 @@
+#pragma once
+
+#include <recpp/filesystem/Allocation.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Apply @p mode to the @p length bytes of the file at @p path from @p offset, as if by Linux fallocate.
+	 * <p>
+	 * AllocationMode::zeroRange falls back to punching a hole and allocating it again on the filesystems that cannot zero a range, such as tmpfs. Other
+	 * systems only support AllocationMode::allocate, through posix_fallocate where it exists, and the other modes fail with
+	 * std::errc::operation_not_supported.
+	 */
+	void allocate(const std::filesystem::path &path, std::uintmax_t offset, std::uintmax_t length, AllocationMode mode);
+
+	/**
+	 * @brief List the segments of the file at @p path holding data, in order, as if by lseek with SEEK_DATA and SEEK_HOLE. The whole file is a single
+	 * segment where holes cannot be found, and an empty file has no segment.
+	 */
+	std::vector<DataSegment> dataSegments(const std::filesystem::path &path);
+} // namespace recpp::filesystem::detail
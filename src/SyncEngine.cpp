@@ -0,0 +1,547 @@
+#include "SyncEngine.h"
+#include "ContentHash.h"
+#include "DirectoryWalker.h"
+#include "FileInfo.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	using PathString = std::filesystem::path::string_type;
+
+	constexpr auto none = static_cast<std::size_t>(-1);
+
+	// The marker of the temporary files copies are written to, named ".<name>.recpp-sync-<random>-<index>"
+	constexpr char temporaryMarker[] = ".recpp-sync-";
+
+	// A file of a tree, identified by its path relative to the root of the tree
+	struct SnapshotEntry
+	{
+		PathString				   path;
+		std::filesystem::file_type type;
+		std::uintmax_t			   size;
+		std::int64_t			   modificationTime;
+		std::filesystem::path	   target;
+	};
+
+	// A change to a single file of the destination, from the file of the source at index source and to the file of the destination at index destination
+	struct Change
+	{
+		SyncActionType type;
+		std::size_t	   source;
+		std::size_t	   destination;
+	};
+
+	bool isSeparator(PathString::value_type character)
+	{
+		return character == std::filesystem::path::preferred_separator;
+	}
+
+	bool isSynced(std::filesystem::file_type type)
+	{
+		return type == std::filesystem::file_type::directory || type == std::filesystem::file_type::regular || type == std::filesystem::file_type::symlink;
+	}
+
+	// Separators sort before any other character, so that the entries under a directory directly follow it, before any of its siblings
+	bool pathLess(const SnapshotEntry &entry1, const SnapshotEntry &entry2)
+	{
+		return std::lexicographical_compare(entry1.path.begin(), entry1.path.end(), entry2.path.begin(), entry2.path.end(),
+											[](PathString::value_type character1, PathString::value_type character2)
+											{
+												using Unsigned = std::make_unsigned_t<PathString::value_type>;
+												return std::make_tuple(!isSeparator(character1), static_cast<Unsigned>(character1)) <
+													   std::make_tuple(!isSeparator(character2), static_cast<Unsigned>(character2));
+											});
+	}
+
+	bool isUnder(const PathString &path, const std::optional<PathString> &directory)
+	{
+		return directory && path.size() > directory->size() && path.compare(0, directory->size(), *directory) == 0 && isSeparator(path[directory->size()]);
+	}
+
+	// Whether name is the name of a temporary file of a synchronization, which snapshots skip so that a synchronization never copies nor removes those of
+	// another one running at the same time
+	bool isTemporary(const PathString &name)
+	{
+		const auto marker = std::filesystem::path(temporaryMarker).native();
+		const auto position = name.rfind(marker);
+		if (name.empty() || name[0] != '.' || position == PathString::npos || position == 0)
+			return false;
+		const auto suffix = name.substr(position + marker.size());
+		const auto dash = suffix.find('-');
+		const auto isDigit = [](PathString::value_type character)
+		{
+			return character >= '0' && character <= '9';
+		};
+		const auto isHexDigit = [&isDigit](PathString::value_type character)
+		{
+			return isDigit(character) || (character >= 'a' && character <= 'f');
+		};
+		return dash != PathString::npos && dash > 0 && dash + 1 < suffix.size() && std::all_of(suffix.begin(), suffix.begin() + dash, isHexDigit) &&
+			   std::all_of(suffix.begin() + dash + 1, suffix.end(), isDigit);
+	}
+
+	// The root without any trailing separator, as a prefix of the paths of the entries listed under it
+	std::filesystem::path normalRoot(const std::filesystem::path &root)
+	{
+		auto normal = root.lexically_normal();
+		if (!normal.has_filename() && normal.has_relative_path())
+			normal = normal.parent_path();
+		return normal;
+	}
+
+	std::vector<SnapshotEntry> snapshot(const std::filesystem::path &root, const SyncOptions &options)
+	{
+		const auto prefix = root.native().size() + (isSeparator(root.native().back()) ? 0 : 1);
+
+		std::vector<SnapshotEntry> entries;
+		std::mutex				   mutex;
+		DirectoryWalker			   walker(options.threads, options.directoryOptions, options.token);
+		walker.walk({root},
+					[&entries, &mutex, prefix](const std::filesystem::path &directory, const std::vector<std::filesystem::directory_entry> &listing)
+					{
+						if (directory.empty())
+							return;
+						std::vector<SnapshotEntry> local;
+						for (const auto &entry : listing)
+						{
+							if (isTemporary(entry.path().filename().native()))
+								continue;
+							const auto info = fileInfo(entry.path());
+							local.push_back(SnapshotEntry{entry.path().native().substr(prefix), info.type, info.size, info.modificationTime, {}});
+							if (info.type == std::filesystem::file_type::symlink)
+								local.back().target = std::filesystem::read_symlink(entry.path());
+						}
+						std::lock_guard lock(mutex);
+						entries.insert(entries.end(), std::make_move_iterator(local.begin()), std::make_move_iterator(local.end()));
+					});
+		std::sort(entries.begin(), entries.end(), pathLess);
+		return entries;
+	}
+
+	class Synchronizer
+	{
+	public:
+		Synchronizer(const std::filesystem::path &source, const std::filesystem::path &destination,
+					 const std::function<void(const SyncAction &action)> &onAction, const SyncOptions &options)
+			: m_source(normalRoot(source))
+			, m_destination(normalRoot(destination))
+			, m_onAction(onAction)
+			, m_options(options)
+		{
+			// The temporary files of the synchronization are told apart from those of others by a random part
+			std::random_device random;
+			std::ostringstream suffix;
+			suffix << temporaryMarker << std::hex << random() << random() << '-';
+			m_temporarySuffix = suffix.str();
+		}
+
+		void run()
+		{
+			checkToken();
+			const auto sourceType = std::filesystem::status(m_source).type();
+			if (sourceType == std::filesystem::file_type::not_found)
+				throw std::filesystem::filesystem_error("sync", m_source, std::make_error_code(std::errc::no_such_file_or_directory));
+			if (sourceType != std::filesystem::file_type::directory)
+				throw std::filesystem::filesystem_error("sync", m_source, std::make_error_code(std::errc::not_a_directory));
+
+			// Both trees are listed at once, each walk already spreading over several workers
+			const auto destinationType = std::filesystem::status(m_destination).type();
+			if (destinationType == std::filesystem::file_type::directory)
+			{
+				BackgroundCall<std::vector<SnapshotEntry>> destinationEntries(
+					[this]()
+					{
+						return snapshot(m_destination, m_options);
+					});
+				m_sourceEntries = snapshot(m_source, m_options);
+				m_destinationEntries = destinationEntries.get();
+			}
+			else if (destinationType == std::filesystem::file_type::not_found)
+			{
+				m_sourceEntries = snapshot(m_source, m_options);
+				apply(SyncAction{SyncActionType::createDirectory, m_source, m_destination, 0},
+					  [this]()
+					  {
+						  std::filesystem::create_directories(m_destination);
+					  });
+			}
+			else
+				throw std::filesystem::filesystem_error("sync", m_destination, std::make_error_code(std::errc::not_a_directory));
+
+			compare();
+			compareContents();
+			detectRenames();
+			applyChanges();
+		}
+
+	private:
+		void checkToken() const
+		{
+			if (m_options.token)
+				m_options.token->throwIfCancelled();
+		}
+
+		// Merge the sorted snapshots, sorting out which files are missing from each side and which ones differ
+		void compare()
+		{
+			for (std::size_t source = 0, destination = 0; source < m_sourceEntries.size() || destination < m_destinationEntries.size();)
+			{
+				if (destination == m_destinationEntries.size() ||
+					(source < m_sourceEntries.size() && pathLess(m_sourceEntries[source], m_destinationEntries[destination])))
+					onlyInSource(source++);
+				else if (source == m_sourceEntries.size() || pathLess(m_destinationEntries[destination], m_sourceEntries[source]))
+					onlyInDestination(destination++);
+				else
+					inBoth(source++, destination++);
+			}
+		}
+
+		void onlyInSource(std::size_t source)
+		{
+			switch (m_sourceEntries[source].type)
+			{
+			case std::filesystem::file_type::directory:
+				m_directories.push_back(source);
+				break;
+			case std::filesystem::file_type::regular:
+				m_changes.push_back(Change{SyncActionType::copyFile, source, none});
+				break;
+			case std::filesystem::file_type::symlink:
+				m_changes.push_back(Change{SyncActionType::createSymlink, source, none});
+				break;
+			default:
+				break;
+			}
+		}
+
+		void onlyInDestination(std::size_t destination)
+		{
+			// The entries under a removed directory go away with it, but the regular files may still be moved out of it beforehand
+			const auto &entry = m_destinationEntries[destination];
+			if (!m_options.deleteExtraneous || isUnder(entry.path, m_replacedDirectory))
+				return;
+			if (!isUnder(entry.path, m_extraneousDirectory))
+			{
+				m_removals.push_back(destination);
+				if (entry.type == std::filesystem::file_type::directory)
+					m_extraneousDirectory = entry.path;
+			}
+			if (entry.type == std::filesystem::file_type::regular)
+				m_renameCandidates.push_back(destination);
+		}
+
+		void inBoth(std::size_t source, std::size_t destination)
+		{
+			const auto &sourceEntry = m_sourceEntries[source];
+			const auto &destinationEntry = m_destinationEntries[destination];
+			if (!isSynced(sourceEntry.type))
+			{
+				onlyInDestination(destination);
+				return;
+			}
+			if (sourceEntry.type != destinationEntry.type)
+			{
+				m_replacements.push_back(destination);
+				if (destinationEntry.type == std::filesystem::file_type::directory)
+					m_replacedDirectory = destinationEntry.path;
+				onlyInSource(source);
+				return;
+			}
+
+			if (sourceEntry.type == std::filesystem::file_type::symlink && sourceEntry.target != destinationEntry.target)
+				m_changes.push_back(Change{SyncActionType::createSymlink, source, destination});
+			if (sourceEntry.type != std::filesystem::file_type::regular)
+				return;
+			if (sourceEntry.size != destinationEntry.size)
+				m_changes.push_back(Change{SyncActionType::updateFile, source, destination});
+			else if (m_options.compareContents)
+				m_comparisons.push_back(Change{SyncActionType::updateFile, source, destination});
+			else if (!sameTime(sourceEntry, destinationEntry))
+				m_changes.push_back(Change{SyncActionType::updateFile, source, destination});
+		}
+
+		bool sameTime(const SnapshotEntry &entry1, const SnapshotEntry &entry2) const
+		{
+			return std::llabs(entry1.modificationTime - entry2.modificationTime) <= m_options.modifyWindow.count();
+		}
+
+		bool sameContents(std::size_t source, std::size_t destination) const
+		{
+			checkToken();
+			return hashFile(sourcePath(source), HashAlgorithm::xxh3) == hashFile(destinationPath(destination), HashAlgorithm::xxh3);
+		}
+
+		// Files of the same size are hashed on several threads, the ones with the same contents only need their modification time to be copied
+		void compareContents()
+		{
+			std::vector<char> same(m_comparisons.size());
+			parallelFor(
+				m_comparisons.size(),
+				[this, &same](std::size_t i)
+				{
+					same[i] = sameContents(m_comparisons[i].source, m_comparisons[i].destination);
+				},
+				m_options.threads);
+			for (std::size_t i = 0; i < m_comparisons.size(); i++)
+			{
+				auto change = m_comparisons[i];
+				if (same[i])
+				{
+					if (sameTime(m_sourceEntries[change.source], m_destinationEntries[change.destination]))
+						continue;
+					change.type = SyncActionType::updateTime;
+				}
+				m_changes.push_back(change);
+			}
+		}
+
+		// A file missing from the destination is moved there from the extraneous files when exactly one of them has the same size and modification time
+		void detectRenames()
+		{
+			if (!m_options.detectRenames || !m_options.deleteExtraneous)
+				return;
+
+			using Key = std::pair<std::uintmax_t, std::int64_t>;
+			std::map<Key, std::pair<std::vector<std::size_t>, std::vector<std::size_t>>> matches;
+			for (const auto destination : m_renameCandidates)
+			{
+				const auto &entry = m_destinationEntries[destination];
+				matches[Key(entry.size, entry.modificationTime)].second.push_back(destination);
+			}
+			for (std::size_t i = 0; i < m_changes.size(); i++)
+			{
+				const auto &entry = m_sourceEntries[m_changes[i].source];
+				const auto	match = matches.find(Key(entry.size, entry.modificationTime));
+				if (m_changes[i].type == SyncActionType::copyFile && entry.size > 0 && match != matches.end())
+					match->second.first.push_back(i);
+			}
+
+			std::vector<Change> renames;
+			for (const auto &[key, match] : matches)
+			{
+				if (match.first.size() == 1 && match.second.size() == 1)
+					renames.push_back(Change{SyncActionType::rename, match.first.front(), match.second.front()});
+			}
+			std::vector<char> confirmed(renames.size(), 1);
+			if (m_options.compareContents)
+			{
+				parallelFor(
+					renames.size(),
+					[this, &renames, &confirmed](std::size_t i)
+					{
+						confirmed[i] = sameContents(m_changes[renames[i].source].source, renames[i].destination);
+					},
+					m_options.threads);
+			}
+
+			// The renamed changes are taken out of the copies, and the renamed files out of the removals
+			std::vector<char> renamed(m_destinationEntries.size());
+			for (std::size_t i = 0; i < renames.size(); i++)
+			{
+				if (!confirmed[i])
+					continue;
+				auto &change = m_changes[renames[i].source];
+				change.type = SyncActionType::rename;
+				change.destination = renames[i].destination;
+				m_renames.push_back(change);
+				renamed[change.destination] = 1;
+			}
+			m_changes.erase(std::remove_if(m_changes.begin(), m_changes.end(),
+										   [](const Change &change)
+										   {
+											   return change.type == SyncActionType::rename;
+										   }),
+							m_changes.end());
+			m_removals.erase(std::remove_if(m_removals.begin(), m_removals.end(),
+											[&renamed](std::size_t destination)
+											{
+												return renamed[destination];
+											}),
+							 m_removals.end());
+		}
+
+		// Replaced files are removed before anything is created in their place, and the extraneous files are removed once the renamed files were moved
+		void applyChanges()
+		{
+			for (const auto destination : m_replacements)
+				remove(destinationPath(destination));
+			for (const auto source : m_directories)
+			{
+				const auto from = sourcePath(source);
+				const auto to = targetPath(source);
+				apply(SyncAction{SyncActionType::createDirectory, from, to, 0},
+					  [&from, &to]()
+					  {
+						  std::filesystem::create_directory(to, from);
+					  });
+			}
+			for (const auto &change : m_renames)
+			{
+				const auto from = destinationPath(change.destination);
+				const auto to = targetPath(change.source);
+				apply(SyncAction{SyncActionType::rename, from, to, 0},
+					  [&from, &to]()
+					  {
+						  std::filesystem::rename(from, to);
+					  });
+			}
+			parallelFor(
+				m_changes.size(),
+				[this](std::size_t i)
+				{
+					applyChange(m_changes[i]);
+				},
+				m_options.threads);
+			parallelFor(
+				m_removals.size(),
+				[this](std::size_t i)
+				{
+					remove(destinationPath(m_removals[i]));
+				},
+				m_options.threads);
+		}
+
+		void applyChange(const Change &change)
+		{
+			const auto &entry = m_sourceEntries[change.source];
+			const auto	from = sourcePath(change.source);
+			const auto	to = targetPath(change.source);
+			switch (change.type)
+			{
+			case SyncActionType::copyFile:
+			case SyncActionType::updateFile:
+				apply(SyncAction{change.type, from, to, entry.size},
+					  [this, &from, &to, &change]()
+					  {
+						  copyFile(from, to, change.source);
+					  });
+				break;
+			case SyncActionType::updateTime:
+				apply(SyncAction{change.type, from, to, 0},
+					  [&from, &to]()
+					  {
+						  std::filesystem::last_write_time(to, std::filesystem::last_write_time(from));
+					  });
+				break;
+			case SyncActionType::createSymlink:
+				apply(SyncAction{change.type, from, to, 0},
+					  [&entry, &to, &change]()
+					  {
+						  if (change.destination != none)
+							  std::filesystem::remove(to);
+						  std::filesystem::create_symlink(entry.target, to);
+					  });
+				break;
+			default:
+				break;
+			}
+		}
+
+		void remove(const std::filesystem::path &path)
+		{
+			apply(SyncAction{SyncActionType::remove, {}, path, 0},
+				  [&path]()
+				  {
+					  std::filesystem::remove_all(path);
+				  });
+		}
+
+		// The copy is written next to the destination and renamed over it, so that an interrupted copy never leaves a truncated file behind. The temporary
+		// file has a name unique to the synchronization and the file, and is created exclusively so that an existing file is never overwritten
+		void copyFile(const std::filesystem::path &from, const std::filesystem::path &to, std::size_t source) const
+		{
+			auto temporary = to.parent_path() / ".";
+			temporary += to.filename();
+			temporary += m_temporarySuffix + std::to_string(source);
+			std::error_code copyError;
+			std::filesystem::copy_file(from, temporary, copyError);
+			if (copyError)
+			{
+				// A file already there is not ours to remove, while a failed copy may leave a partial one
+				if (copyError != std::errc::file_exists)
+				{
+					std::error_code error;
+					std::filesystem::remove(temporary, error);
+				}
+				throw std::filesystem::filesystem_error("copy_file", from, temporary, copyError);
+			}
+			try
+			{
+				std::filesystem::last_write_time(temporary, std::filesystem::last_write_time(from));
+				std::filesystem::rename(temporary, to);
+			}
+			catch (const std::exception &)
+			{
+				std::error_code error;
+				std::filesystem::remove(temporary, error);
+				throw;
+			}
+		}
+
+		template <typename Function>
+		void apply(const SyncAction &action, const Function &function)
+		{
+			checkToken();
+			if (!m_options.dryRun)
+				function();
+			std::lock_guard lock(m_onActionMutex);
+			m_onAction(action);
+		}
+
+		std::filesystem::path sourcePath(std::size_t source) const
+		{
+			return m_source / m_sourceEntries[source].path;
+		}
+
+		// The path in the destination of the file of the source at index source
+		std::filesystem::path targetPath(std::size_t source) const
+		{
+			return m_destination / m_sourceEntries[source].path;
+		}
+
+		std::filesystem::path destinationPath(std::size_t destination) const
+		{
+			return m_destination / m_destinationEntries[destination].path;
+		}
+
+		const std::filesystem::path							 m_source;
+		const std::filesystem::path							 m_destination;
+		const std::function<void(const SyncAction &action)>	&m_onAction;
+		const SyncOptions									&m_options;
+		std::string											 m_temporarySuffix;
+		std::mutex											 m_onActionMutex;
+		std::vector<SnapshotEntry>							 m_sourceEntries;
+		std::vector<SnapshotEntry>							 m_destinationEntries;
+		std::vector<std::size_t>							 m_directories;
+		std::vector<Change>									 m_changes;
+		std::vector<Change>									 m_comparisons;
+		std::vector<Change>									 m_renames;
+		std::vector<std::size_t>							 m_renameCandidates;
+		std::vector<std::size_t>							 m_replacements;
+		std::vector<std::size_t>							 m_removals;
+		std::optional<PathString>							 m_replacedDirectory;
+		std::optional<PathString>							 m_extraneousDirectory;
+	};
+} // namespace
+
+void recpp::filesystem::detail::syncTrees(const std::filesystem::path &source, const std::filesystem::path &destination,
+										  const std::function<void(const SyncAction &action)> &onAction, const SyncOptions &options)
+{
+	Synchronizer(source, destination, onAction, options).run();
+}
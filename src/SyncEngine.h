@@ -0,0 +1,19 @@
+#pragma once
+
+#include <recpp/filesystem/Sync.h>
+
+#include <filesystem>
+#include <functional>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Make the tree rooted at @p destination a copy of the tree rooted at @p source, calling @p onAction with each change once it is made.
+	 * <p>
+	 * Both trees are first listed into snapshots on several threads, the snapshots are compared, and only then are the changes made: directories are
+	 * created, renamed files moved, files copied on several threads and extraneous files removed, in this order. Regular files are compared by size and
+	 * modification time unless @p options asks to compare their contents. @p onAction is called from the worker threads, one change at a time.
+	 */
+	void syncTrees(const std::filesystem::path &source, const std::filesystem::path &destination, const std::function<void(const SyncAction &action)> &onAction,
+				   const SyncOptions &options);
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,360 @@
+#include "TextSearcher.h"
+#include "DirectoryWalker.h"
+#include "File.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	// Size of the head of a file looked at for a NUL byte to tell binary files apart, like grep and ripgrep do
+	constexpr std::size_t binaryProbeSize = 8192;
+
+	char lower(char character)
+	{
+		return static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+	}
+
+	char upper(char character)
+	{
+		return static_cast<char>(std::toupper(static_cast<unsigned char>(character)));
+	}
+
+	// Rough rank of how common a byte is in text, the lower the rarer: memchr stops less often on a rare byte
+	int frequency(char character)
+	{
+		static constexpr char letters[] = "zqjxkvbywgpfmucdlhrsnioate";
+		if (character == ' ')
+			return 100;
+		const auto letter = std::strchr(letters, lower(character));
+		if (character != '\0' && letter)
+			return 50 + static_cast<int>(letter - letters);
+		if (std::isdigit(static_cast<unsigned char>(character)) || std::ispunct(static_cast<unsigned char>(character)))
+			return 25;
+		return 0;
+	}
+
+	// Get the longest run of literal characters every match of the ECMAScript regular expression pattern contains, or an empty string if there is none
+	// or if it cannot be told: the runs inside groups, sets and alternatives are ignored, and so are the characters followed by an optional quantifier
+	std::string requiredLiteral(const std::string &pattern)
+	{
+		if (pattern.find('|') != std::string::npos)
+			return {};
+
+		std::string longest;
+		std::string run;
+		const auto	flush = [&longest, &run]()
+		{
+			if (run.size() > longest.size())
+				longest = run;
+			run.clear();
+		};
+
+		int depth = 0;
+		for (std::size_t i = 0; i < pattern.size(); i++)
+		{
+			const auto character = pattern[i];
+			switch (character)
+			{
+			case '\\':
+				// Escaped punctuation is literal, while escaped letters and digits are classes, assertions, back references or character codes, whose
+				// hexadecimal digits, control letter or further digits are skipped with them
+				if (++i < pattern.size() && std::ispunct(static_cast<unsigned char>(pattern[i])) && depth == 0)
+					run += pattern[i];
+				else
+				{
+					if (i < pattern.size())
+					{
+						if (pattern[i] == 'x')
+							i += 2;
+						else if (pattern[i] == 'u')
+							i += 4;
+						else if (pattern[i] == 'c')
+							i++;
+						else
+						{
+							while (std::isdigit(static_cast<unsigned char>(pattern[i])) && i + 1 < pattern.size() &&
+								   std::isdigit(static_cast<unsigned char>(pattern[i + 1])))
+								i++;
+						}
+					}
+					flush();
+				}
+				break;
+			case '[':
+				for (i += i + 1 < pattern.size() && pattern[i + 1] == ']' ? 2 : 1; i < pattern.size() && pattern[i] != ']'; i++)
+				{
+					if (pattern[i] == '\\')
+						i++;
+				}
+				flush();
+				break;
+			case '(':
+				depth++;
+				flush();
+				break;
+			case ')':
+				depth--;
+				flush();
+				break;
+			case '*':
+			case '?':
+			case '{':
+				if (!run.empty())
+					run.pop_back();
+				flush();
+				if (character == '{')
+					i = std::min(pattern.find('}', i), pattern.size());
+				break;
+			case '+':
+			case '.':
+			case '^':
+			case '$':
+				flush();
+				break;
+			default:
+				if (depth == 0)
+					run += character;
+				else
+					flush();
+			}
+		}
+		flush();
+		return longest;
+	}
+
+	// Size of the chunks the files are read by, the lines crossing the end of a chunk being searched once the next one is read
+	constexpr std::size_t chunkSize = 1 << 18;
+
+	// Read up to size bytes of a file into data, returning the number of bytes read, less than size only at the end of the file
+	using Read = std::function<std::size_t(char *data, std::size_t size)>;
+
+	void searchFile(const TextSearcher &searcher, const std::filesystem::path &path, const Read &read,
+					const std::function<void(const GrepMatch &match)> &onMatch, std::mutex &mutex, const GrepOptions &options)
+	{
+		// The file is read rather than mapped, so that one truncated while it is searched only ends early. The buffer holds the line the previous chunk
+		// ended in, followed by the next chunk, and only the complete lines are searched: it grows when a single line is longer than a chunk
+		std::vector<char> buffer(chunkSize);
+		std::size_t		  size = read(buffer.data(), buffer.size());
+		if (size == 0)
+			return;
+		if (options.skipBinary && std::memchr(buffer.data(), '\0', std::min(size, binaryProbeSize)))
+			return;
+
+		// Lines are only counted up to the matches, which are reported once their chunk is searched, so that only those of a chunk are kept
+		std::vector<GrepMatch> matches;
+		std::size_t			   found = 0;
+		std::uintmax_t		   lineNumber = 1;
+		std::uintmax_t		   base = 0;
+		std::size_t			   counted = 0;
+		bool				   stopped = false;
+		const auto onLine = [&matches, &found, &lineNumber, &base, &counted, &stopped, &buffer, &path, &options](std::size_t offset, std::string_view line)
+		{
+			lineNumber += std::count(buffer.data() + counted, buffer.data() + offset, '\n');
+			counted = offset;
+			matches.push_back(GrepMatch{path, lineNumber, base + offset, std::string(line)});
+			stopped = options.maxMatchesPerFile != 0 && ++found >= options.maxMatchesPerFile;
+			return !stopped;
+		};
+		for (bool end = false; !stopped;)
+		{
+			if (options.token)
+				options.token->throwIfCancelled();
+			if (!end && size < buffer.size())
+			{
+				const auto result = read(buffer.data() + size, buffer.size() - size);
+				end = result < buffer.size() - size;
+				size += result;
+			}
+
+			// Without a line feed in the buffer, the line continues in the next chunk unless the file ends
+			std::size_t complete = size;
+			if (!end)
+			{
+				const auto last = std::find(std::make_reverse_iterator(buffer.data() + size), std::make_reverse_iterator(buffer.data()), '\n').base();
+				complete = static_cast<std::size_t>(last - buffer.data());
+				if (complete == 0)
+				{
+					buffer.resize(buffer.size() * 2);
+					continue;
+				}
+			}
+			searcher.search(std::string_view(buffer.data(), complete), onLine);
+			if (!matches.empty())
+			{
+				std::lock_guard lock(mutex);
+				for (const auto &match : matches)
+					onMatch(match);
+				matches.clear();
+			}
+			if (end)
+				break;
+
+			lineNumber += std::count(buffer.data() + counted, buffer.data() + complete, '\n');
+			std::copy(buffer.data() + complete, buffer.data() + size, buffer.data());
+			base += complete;
+			size -= complete;
+			counted = 0;
+		}
+	}
+
+	// Walk the tree rooted at root with walker, calling search with each regular file
+	template <typename Walker, typename Search>
+	void grepWith(const Walker &walker, const std::filesystem::path &root, const GrepOptions &options, const Search &search)
+	{
+		walker.walk({root},
+					[&options, &search](const std::filesystem::path &directory, const auto &entries)
+					{
+						for (const auto &entry : entries)
+						{
+							// Like the walk, a root is followed when it is a symlink, while the symlinks found on the way are not
+							if (entryType(entry, directory.empty()) != std::filesystem::file_type::regular)
+								continue;
+							if (options.token)
+								options.token->throwIfCancelled();
+							search(entryPath(entry));
+						}
+					});
+	}
+} // namespace
+
+recpp::filesystem::detail::TextSearcher::TextSearcher(const std::string &pattern, bool regex, bool ignoreCase)
+	: m_literal(pattern)
+	, m_ignoreCase(ignoreCase)
+{
+	if (pattern.empty())
+		throw std::invalid_argument("empty search pattern");
+	if (regex && pattern.find_first_of("\\.[](){}*+?^$|") != std::string::npos)
+	{
+		auto flags = std::regex::ECMAScript | std::regex::optimize;
+		if (ignoreCase)
+			flags |= std::regex::icase;
+		m_regex.emplace(pattern, flags);
+		m_literal = requiredLiteral(pattern);
+	}
+	if (m_literal.empty())
+		return;
+
+	if (ignoreCase)
+		std::transform(m_literal.begin(), m_literal.end(), m_literal.begin(), lower);
+	for (std::size_t i = 1; i < m_literal.size(); i++)
+	{
+		if (frequency(m_literal[i]) < frequency(m_literal[m_anchor]))
+			m_anchor = i;
+	}
+	m_anchorCases[0] = m_literal[m_anchor];
+	m_anchorCases[1] = ignoreCase ? upper(m_literal[m_anchor]) : m_literal[m_anchor];
+}
+
+void recpp::filesystem::detail::TextSearcher::search(std::string_view text, const OnLine &onLine) const
+{
+	// A line never contains a line feed, so neither does a match
+	if (m_literal.find('\n') != std::string::npos)
+		return;
+
+	const auto begin = text.data();
+	const auto end = begin + text.size();
+	for (auto position = begin; position < end;)
+	{
+		// Without literal every line is a candidate, otherwise only the lines containing the literal are
+		const auto candidate = m_literal.empty() ? position : find(position, end);
+		if (candidate == end)
+			break;
+		const auto lineBegin = std::find(std::make_reverse_iterator(candidate), std::make_reverse_iterator(position), '\n').base();
+		auto	   lineEnd = static_cast<const char *>(std::memchr(candidate, '\n', end - candidate));
+		if (!lineEnd)
+			lineEnd = end;
+		position = lineEnd + 1;
+
+		const auto lineSize = static_cast<std::size_t>(lineEnd - lineBegin) - (lineEnd > lineBegin && lineEnd[-1] == '\r' ? 1 : 0);
+		const auto line = std::string_view(lineBegin, lineSize);
+		if (m_regex && !std::regex_search(line.begin(), line.end(), *m_regex))
+			continue;
+		if (!onLine(static_cast<std::size_t>(lineBegin - begin), line))
+			break;
+	}
+}
+
+const char *recpp::filesystem::detail::TextSearcher::find(const char *begin, const char *end) const
+{
+	if (static_cast<std::size_t>(end - begin) < m_literal.size())
+		return end;
+
+	// The anchor is at m_anchor in the literal, so that it can only be found in [begin + m_anchor, limit)
+	const auto limit = end - (m_literal.size() - m_anchor) + 1;
+	for (auto from = begin + m_anchor; from < limit;)
+	{
+		auto hit = static_cast<const char *>(std::memchr(from, m_anchorCases[0], limit - from));
+		if (m_anchorCases[1] != m_anchorCases[0])
+		{
+			const auto other = static_cast<const char *>(std::memchr(from, m_anchorCases[1], (hit ? hit : limit) - from));
+			if (other)
+				hit = other;
+		}
+		if (!hit)
+			break;
+		if (equal(hit - m_anchor))
+			return hit - m_anchor;
+		from = hit + 1;
+	}
+	return end;
+}
+
+bool recpp::filesystem::detail::TextSearcher::equal(const char *text) const
+{
+	if (!m_ignoreCase)
+		return std::memcmp(text, m_literal.data(), m_literal.size()) == 0;
+	return std::equal(m_literal.begin(), m_literal.end(), text,
+					  [](char character1, char character2)
+					  {
+						  return character1 == lower(character2);
+					  });
+}
+
+void recpp::filesystem::detail::grep(const std::filesystem::path &root, const std::string &pattern, const std::function<void(const GrepMatch &match)> &onMatch,
+									 const GrepOptions &options)
+{
+	const TextSearcher searcher(pattern, options.regex, options.ignoreCase);
+	std::mutex		   mutex;
+	grepWith(DirectoryWalker(options.threads, options.directoryOptions, options.token), root, options,
+			 [&searcher, &onMatch, &mutex, &options](const std::filesystem::path &path)
+			 {
+				 File file(path);
+				 searchFile(
+					 searcher, path,
+					 [&file](char *data, std::size_t size)
+					 {
+						 return file.read(data, size);
+					 },
+					 onMatch, mutex, options);
+			 });
+}
+
+void recpp::filesystem::detail::grep(const FileSystemBackend &backend, const std::filesystem::path &root, const std::string &pattern,
+									 const std::function<void(const GrepMatch &match)> &onMatch, const GrepOptions &options)
+{
+	const TextSearcher searcher(pattern, options.regex, options.ignoreCase);
+	std::mutex		   mutex;
+	grepWith(BackendWalker(backend, options.threads, options.token), root, options,
+			 [&backend, &searcher, &onMatch, &mutex, &options](const std::filesystem::path &path)
+			 {
+				 std::uintmax_t offset = 0;
+				 searchFile(
+					 searcher, path,
+					 [&backend, &path, &offset](char *data, std::size_t size)
+					 {
+						 const auto count = backend.readFile(path, offset, data, size);
+						 offset += count;
+						 return count;
+					 },
+					 onMatch, mutex, options);
+			 });
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <recpp/filesystem/FileSystemBackend.h>
+#include <recpp/filesystem/Grep.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief TextSearcher finds the lines of a text matching a literal string or a regular expression.
+	 * <p>
+	 * The lines are never split up front: the searcher looks for a literal string every match contains, with memchr on its rarest byte, and only the lines
+	 * around its occurrences are extracted, and matched against the regular expression if there is one. That literal string is the pattern itself when it is
+	 * not a regular expression, or the longest run of literal characters the regular expression requires. Regular expressions without such a run are
+	 * matched against every line.
+	 */
+	class TextSearcher
+	{
+	public:
+		using OnLine = std::function<bool(std::size_t offset, std::string_view line)>;
+
+		/**
+		 * @brief Compile @p pattern, throwing std::invalid_argument if it is empty, or std::regex_error if it is not a valid ECMAScript regular expression.
+		 */
+		TextSearcher(const std::string &pattern, bool regex, bool ignoreCase);
+
+		/**
+		 * @brief Call @p onLine with the offset and the contents without line terminator of each matching line of @p text, in order, until it returns false.
+		 */
+		void search(std::string_view text, const OnLine &onLine) const;
+
+	private:
+		const char *find(const char *begin, const char *end) const;
+		bool		equal(const char *text) const;
+
+		std::string				  m_literal;
+		bool					  m_ignoreCase;
+		std::size_t				  m_anchor = 0;
+		char					  m_anchorCases[2] = {};
+		std::optional<std::regex> m_regex;
+	};
+
+	/**
+	 * @brief Search the regular files under @p root for the lines matching @p pattern, calling @p onMatch for each of them.
+	 * <p>
+	 * The files are read by chunks and searched by the threads of the walk, a line crossing the end of a chunk being searched with the next one. The matches of
+	 * a file are reported in order, those of each chunk as soon as it is searched, and the CancellationToken of @p options is checked before each chunk.
+	 * @p onMatch is called from the worker threads, one match at a time.
+	 */
+	void grep(const std::filesystem::path &root, const std::string &pattern, const std::function<void(const GrepMatch &match)> &onMatch,
+			  const GrepOptions &options);
+
+	/**
+	 * @brief Same as grep(root, pattern, onMatch, options) on the tree of @p backend, each file being read by chunks with FileSystemBackend::readFile, and
+	 * GrepOptions::directoryOptions being ignored.
+	 */
+	void grep(const FileSystemBackend &backend, const std::filesystem::path &root, const std::string &pattern,
+			  const std::function<void(const GrepMatch &match)> &onMatch, const GrepOptions &options);
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,527 @@
+#include "TransactionEngine.h"
+#include "Parallel.h"
+#include "PathKey.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	// An operation, along with what is needed to undo it, which is written to the journal before the operation is applied
+	struct Step
+	{
+		TransactionOperation   operation;
+		/// Where the file replaced by a rename or removed is kept until the transaction is committed, empty if there is none
+		std::filesystem::path  backup;
+		/// The permissions of the file before a permissions operation
+		std::filesystem::perms previousPermissions = std::filesystem::perms::unknown;
+		/// Whether a createDirectory operation created its directory rather than finding it
+		bool				   created = false;
+	};
+
+	bool isPresent(const FileSystemBackend &backend, const std::filesystem::path &path)
+	{
+		try
+		{
+			return std::filesystem::exists(backend.symlinkStatus(path));
+		}
+		catch (const std::filesystem::filesystem_error &)
+		{
+			return false;
+		}
+	}
+
+	bool isPresent(const std::filesystem::path &path)
+	{
+		std::error_code error;
+		return std::filesystem::exists(std::filesystem::symlink_status(path, error));
+	}
+
+	// The absolute and lexically normal form of path, without trailing separator so that it always has a filename
+	std::filesystem::path normalize(const FileSystemBackend &backend, const std::filesystem::path &path)
+	{
+		auto normal = backend.absolute(path).lexically_normal();
+		if (!normal.has_filename() && normal.has_relative_path())
+			normal = normal.parent_path();
+		return normal;
+	}
+
+	// Replace the lexical key by the key of its parent, or return false if it has none
+	bool parentKey(std::string &key)
+	{
+		const auto separator = key.rfind('/');
+		if (separator == std::string::npos || key.size() <= 1)
+			return false;
+		key.resize(separator ? separator : 1);
+		return true;
+	}
+
+	// Group the steps into waves, each step being in the wave following the last one with a step on the same path or on a path under or above it
+	std::vector<std::vector<std::size_t>> schedule(const std::vector<Step> &steps)
+	{
+		// The first wave free for the steps on each path, and for those on each path or under it
+		std::unordered_map<std::string, std::size_t> pathWaves;
+		std::unordered_map<std::string, std::size_t> subtreeWaves;
+		std::vector<std::vector<std::size_t>>		 waves;
+		for (std::size_t i = 0; i < steps.size(); i++)
+		{
+			const auto				&operation = steps[i].operation;
+			std::vector<std::string> keys{lexicalKey(operation.path)};
+			if (operation.type == TransactionOperationType::rename)
+				keys.push_back(lexicalKey(operation.target));
+
+			std::size_t wave = 0;
+			for (const auto &key : keys)
+			{
+				auto prefix = key;
+				do
+				{
+					if (const auto found = pathWaves.find(prefix); found != pathWaves.end())
+						wave = std::max(wave, found->second);
+				} while (parentKey(prefix));
+				if (const auto found = subtreeWaves.find(key); found != subtreeWaves.end())
+					wave = std::max(wave, found->second);
+			}
+
+			for (const auto &key : keys)
+			{
+				pathWaves[key] = wave + 1;
+				auto prefix = key;
+				do
+				{
+					auto &next = subtreeWaves[prefix];
+					next = std::max(next, wave + 1);
+				} while (parentKey(prefix));
+			}
+			if (waves.size() <= wave)
+				waves.resize(wave + 1);
+			waves[wave].push_back(i);
+		}
+		return waves;
+	}
+
+	// Record what is needed to undo the step, before it is journaled
+	void prepare(const FileSystemBackend &backend, Step &step, const std::string &backupSuffix)
+	{
+		const auto &operation = step.operation;
+		const auto	backup = [&backupSuffix](const std::filesystem::path &path)
+		{
+			return path.parent_path() / std::filesystem::u8path("." + path.filename().u8string() + backupSuffix);
+		};
+
+		switch (operation.type)
+		{
+		case TransactionOperationType::createDirectory:
+			step.created = !isPresent(backend, operation.path);
+			break;
+		case TransactionOperationType::rename:
+			if (isPresent(backend, operation.target))
+				step.backup = backup(operation.target);
+			break;
+		case TransactionOperationType::remove:
+			if (isPresent(backend, operation.path))
+				step.backup = backup(operation.path);
+			break;
+		case TransactionOperationType::permissions:
+			step.previousPermissions = backend.status(operation.path).permissions();
+			break;
+		}
+	}
+
+	void apply(FileSystemBackend &backend, Step &step)
+	{
+		const auto &operation = step.operation;
+		switch (operation.type)
+		{
+		case TransactionOperationType::createDirectory:
+			// A directory created by another process since prepare is not ours to remove, even though the journal says it was created
+			if (!backend.createDirectory(operation.path))
+				step.created = false;
+			break;
+		case TransactionOperationType::rename:
+			if (!step.backup.empty())
+				backend.rename(operation.target, step.backup);
+			backend.rename(operation.path, operation.target);
+			break;
+		case TransactionOperationType::remove:
+			if (!step.backup.empty())
+				backend.rename(operation.path, step.backup);
+			break;
+		case TransactionOperationType::permissions:
+			backend.permissions(operation.path, operation.permissions, operation.options);
+			break;
+		}
+	}
+
+	// Undo the step, which may have been interrupted at any point, checking what was done so that undoing it again does nothing
+	void undo(FileSystemBackend &backend, const Step &step)
+	{
+		const auto &operation = step.operation;
+		switch (operation.type)
+		{
+		case TransactionOperationType::createDirectory:
+			if (step.created && isPresent(backend, operation.path))
+				backend.remove(operation.path);
+			break;
+		case TransactionOperationType::rename:
+			if (!isPresent(backend, operation.path) && isPresent(backend, operation.target))
+				backend.rename(operation.target, operation.path);
+			if (!step.backup.empty() && isPresent(backend, step.backup) && !isPresent(backend, operation.target))
+				backend.rename(step.backup, operation.target);
+			break;
+		case TransactionOperationType::remove:
+			if (!step.backup.empty() && isPresent(backend, step.backup) && !isPresent(backend, operation.path))
+				backend.rename(step.backup, operation.path);
+			break;
+		case TransactionOperationType::permissions:
+			if (step.previousPermissions != std::filesystem::perms::unknown && isPresent(backend, operation.path))
+				backend.permissions(operation.path, step.previousPermissions, std::filesystem::perm_options::replace);
+			break;
+		}
+	}
+
+	// Delete the file the step replaced or removed, once the transaction is committed
+	void discard(FileSystemBackend &backend, const Step &step)
+	{
+		if (!step.backup.empty())
+			backend.removeAll(step.backup);
+	}
+
+	std::string serialize(std::size_t index, const Step &step)
+	{
+		std::ostringstream line;
+		line << "apply " << index << ' ' << static_cast<int>(step.operation.type) << ' ' << std::quoted(step.operation.path.u8string()) << ' '
+			 << std::quoted(step.operation.target.u8string()) << ' ' << std::quoted(step.backup.u8string()) << ' '
+			 << static_cast<unsigned>(step.previousPermissions);
+		return line.str();
+	}
+
+	std::filesystem::path directoryOf(const std::filesystem::path &path)
+	{
+		return path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+	}
+
+	// Flush the data of file to disk, once flushed from its stream
+	bool syncFile(std::FILE *file)
+	{
+#ifdef _WIN32
+		return _commit(_fileno(file)) == 0;
+#else
+		return ::fsync(fileno(file)) == 0;
+#endif
+	}
+
+	// Flush the entries of directory to disk, so that a file created in it or removed from it is still there or gone after a crash. Windows has no way to
+	// flush a directory, NTFS journaling the changes of its entries itself
+	void syncDirectory([[maybe_unused]] const std::filesystem::path &directory)
+	{
+#ifndef _WIN32
+		const auto descriptor = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (descriptor < 0)
+			throw std::filesystem::filesystem_error("open", directory, std::error_code(errno, std::generic_category()));
+		const auto result = ::fsync(descriptor);
+		const auto error = errno;
+		::close(descriptor);
+		if (result != 0)
+			throw std::filesystem::filesystem_error("fsync", directory, std::error_code(error, std::generic_category()));
+#endif
+	}
+
+	// The journal of a transaction, to which each step is written before it is applied. Each record is on disk once write returns, and so is the journal
+	// itself once created, so that a crash never leaves an operation applied without its record
+	class Journal
+	{
+	public:
+		explicit Journal(const std::filesystem::path &path)
+			: m_path(path)
+		{
+			if (m_path.empty())
+				return;
+			// An existing journal belongs to a transaction that was not recovered yet
+			if (isPresent(m_path))
+				throw std::filesystem::filesystem_error("journal", m_path, std::make_error_code(std::errc::file_exists));
+#ifdef _WIN32
+			m_file = _wfopen(m_path.c_str(), L"wx");
+#else
+			m_file = std::fopen(m_path.c_str(), "wx");
+#endif
+			if (!m_file)
+				throw std::filesystem::filesystem_error("open", m_path, std::error_code(errno, std::generic_category()));
+			syncDirectory(directoryOf(m_path));
+		}
+
+		Journal(const Journal &) = delete;
+		Journal &operator=(const Journal &) = delete;
+
+		~Journal()
+		{
+			if (m_file)
+				std::fclose(m_file);
+		}
+
+		void write(const std::string &line)
+		{
+			if (m_path.empty())
+				return;
+			std::lock_guard lock(m_mutex);
+			if (std::fputs((line + '\n').c_str(), m_file) == EOF || std::fflush(m_file) != 0 || !syncFile(m_file))
+				throw std::filesystem::filesystem_error("write", m_path, std::error_code(errno, std::generic_category()));
+		}
+
+		void remove()
+		{
+			if (m_path.empty())
+				return;
+			std::fclose(m_file);
+			m_file = nullptr;
+			std::filesystem::remove(m_path);
+			syncDirectory(directoryOf(m_path));
+		}
+
+	private:
+		std::filesystem::path m_path;
+		std::FILE			 *m_file = nullptr;
+		std::mutex			  m_mutex;
+	};
+
+	// The steps recorded in a journal
+	class JournalReader
+	{
+	public:
+		explicit JournalReader(const std::filesystem::path &path)
+		{
+			std::ifstream			 stream(path);
+			std::vector<std::string> lines;
+			for (std::string line; std::getline(stream, line);)
+				lines.push_back(std::move(line));
+			if (stream.bad())
+				throw std::filesystem::filesystem_error("read", path, std::make_error_code(std::errc::io_error));
+
+			// The last line may have been cut by a crash, in which case its step was never applied
+			for (std::size_t i = 0; i < lines.size(); i++)
+			{
+				if (!parse(lines[i]) && i + 1 < lines.size())
+					throw std::runtime_error("invalid transaction journal " + path.u8string());
+			}
+		}
+
+		const std::vector<Step> &steps() const
+		{
+			return m_steps;
+		}
+
+		bool committed() const
+		{
+			return m_committed;
+		}
+
+	private:
+		bool parse(const std::string &text)
+		{
+			std::istringstream line(text);
+			std::string		   kind;
+			line >> kind;
+			if (kind == "commit")
+			{
+				m_committed = true;
+				return true;
+			}
+
+			std::size_t index;
+			line >> index;
+			if (kind == "created")
+			{
+				const auto position = m_positions.find(index);
+				if (!line || position == m_positions.end())
+					return false;
+				m_steps[position->second].created = true;
+				return true;
+			}
+			if (kind != "apply")
+				return false;
+
+			int			type;
+			std::string path;
+			std::string target;
+			std::string backup;
+			unsigned	permissions;
+			line >> type >> std::quoted(path) >> std::quoted(target) >> std::quoted(backup) >> permissions;
+			if (!line || type < 0 || type > static_cast<int>(TransactionOperationType::permissions))
+				return false;
+
+			Step step;
+			step.operation.type = static_cast<TransactionOperationType>(type);
+			step.operation.path = std::filesystem::u8path(path);
+			step.operation.target = std::filesystem::u8path(target);
+			step.backup = std::filesystem::u8path(backup);
+			step.previousPermissions = static_cast<std::filesystem::perms>(permissions);
+			m_positions[index] = m_steps.size();
+			m_steps.push_back(std::move(step));
+			return true;
+		}
+
+		std::vector<Step>							 m_steps;
+		std::unordered_map<std::size_t, std::size_t> m_positions;
+		bool										 m_committed = false;
+	};
+} // namespace
+
+void recpp::filesystem::detail::commitTransaction(const std::vector<TransactionOperation> &operations, const TransactionOptions &options)
+{
+	NativeBackend backend;
+	commitTransaction(backend, operations, options);
+}
+
+void recpp::filesystem::detail::commitTransaction(FileSystemBackend &backend, const std::vector<TransactionOperation> &operations,
+												  const TransactionOptions &options)
+{
+	std::vector<Step> steps(operations.size());
+	for (std::size_t i = 0; i < operations.size(); i++)
+	{
+		steps[i].operation = operations[i];
+		steps[i].operation.path = normalize(backend, operations[i].path);
+		if (operations[i].type == TransactionOperationType::rename)
+			steps[i].operation.target = normalize(backend, operations[i].target);
+	}
+	const auto waves = schedule(steps);
+
+	// The backups of the transaction are told apart from those of others by a random suffix
+	std::random_device random;
+	std::ostringstream suffix;
+	suffix << ".recpp-" << std::hex << random() << random() << '-';
+
+	Journal					 journal(options.journal);
+	std::mutex				 mutex;
+	std::vector<std::size_t> applied;
+	std::exception_ptr		 failure;
+	for (const auto &wave : waves)
+	{
+		try
+		{
+			parallelFor(
+				wave.size(),
+				[&](std::size_t i)
+				{
+					if (options.token)
+						options.token->throwIfCancelled();
+					const auto index = wave[i];
+					auto	  &step = steps[index];
+					prepare(backend, step, suffix.str() + std::to_string(index));
+					journal.write(serialize(index, step));
+					// The directory is recorded as created before it is, so that the journal never misses a directory to remove
+					if (step.created)
+						journal.write("created " + std::to_string(index));
+					{
+						std::lock_guard lock(mutex);
+						applied.push_back(index);
+					}
+					apply(backend, step);
+				},
+				options.threads);
+		}
+		catch (const std::exception &)
+		{
+			failure = std::current_exception();
+			break;
+		}
+	}
+
+	if (!failure)
+	{
+		try
+		{
+			journal.write("commit");
+		}
+		catch (const std::exception &)
+		{
+			failure = std::current_exception();
+		}
+	}
+	if (!failure)
+	{
+		// Once committed, the transaction succeeded whatever happens to its backups: those that cannot be deleted are left with the journal for
+		// recoverTransaction to delete, like after a crash
+		bool discarded = true;
+		for (const auto index : applied)
+		{
+			try
+			{
+				discard(backend, steps[index]);
+			}
+			catch (const std::exception &)
+			{
+				discarded = false;
+			}
+		}
+		try
+		{
+			if (discarded)
+				journal.remove();
+		}
+		catch (const std::exception &)
+		{
+		}
+		return;
+	}
+
+	std::exception_ptr rollbackFailure;
+	for (auto index = applied.rbegin(); index != applied.rend(); ++index)
+	{
+		try
+		{
+			undo(backend, steps[*index]);
+		}
+		catch (const std::exception &)
+		{
+			if (!rollbackFailure)
+				rollbackFailure = std::current_exception();
+		}
+	}
+	if (rollbackFailure)
+		throw TransactionRollbackError(failure, rollbackFailure);
+	journal.remove();
+	std::rethrow_exception(failure);
+}
+
+void recpp::filesystem::detail::recoverTransaction(const std::filesystem::path &journal)
+{
+	if (!isPresent(journal))
+		return;
+
+	NativeBackend		backend;
+	const JournalReader reader(journal);
+	const auto		   &steps = reader.steps();
+	if (reader.committed())
+	{
+		for (const auto &step : steps)
+			discard(backend, step);
+	}
+	else
+	{
+		for (auto step = steps.rbegin(); step != steps.rend(); ++step)
+			undo(backend, *step);
+	}
+	std::filesystem::remove(journal);
+	syncDirectory(directoryOf(journal));
+}
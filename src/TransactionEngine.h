@@ -0,0 +1,35 @@
+#pragma once
+
+#include <recpp/filesystem/FileSystemBackend.h>
+#include <recpp/filesystem/FileSystemTransaction.h>
+
+#include <filesystem>
+#include <vector>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Apply @p operations as a whole, undoing the ones already applied if one of them fails.
+	 * <p>
+	 * Each operation is scheduled in the first wave following every previous operation on the same path, or on a path under or above it, and the
+	 * operations of a wave are applied on several threads. Each operation is written to the journal before it is applied, along with what is needed to
+	 * undo it, and each record is flushed to disk before going on. The journal is removed once the transaction is committed or rolled back, except when
+	 * some of the files replaced or removed by a committed transaction cannot be deleted: the transaction still succeeds, and the journal is left for
+	 * recoverTransaction to delete them.
+	 */
+	void commitTransaction(const std::vector<TransactionOperation> &operations, const TransactionOptions &options);
+
+	/**
+	 * @brief Apply @p operations on @p backend as a whole, like commitTransaction.
+	 * <p>
+	 * The journal is a file of the native file system, so TransactionOptions::journal must be empty: a failed transaction is still rolled back, but a
+	 * crash leaves it half applied.
+	 */
+	void commitTransaction(FileSystemBackend &backend, const std::vector<TransactionOperation> &operations, const TransactionOptions &options);
+
+	/**
+	 * @brief Finish the transaction recorded in @p journal by a process that did not complete it: the files it replaced or removed are deleted if it was
+	 * committed, its operations are undone otherwise. Nothing is done if @p journal does not exist.
+	 */
+	void recoverTransaction(const std::filesystem::path &journal);
+} // namespace recpp::filesystem::detail
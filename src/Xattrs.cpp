@@ -0,0 +1,221 @@
+#include "Xattrs.h"
+#include "Parallel.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <system_error>
+#include <utility>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/types.h>
+#include <sys/xattr.h>
+#define RECPP_FILESYSTEM_XATTRS
+#endif
+
+using namespace recpp::filesystem;
+using namespace recpp::filesystem::detail;
+
+namespace
+{
+	[[noreturn]] void fail(const char *operation, const std::filesystem::path &path, int error)
+	{
+		throw std::filesystem::filesystem_error(operation, path, std::error_code(error, std::generic_category()));
+	}
+
+#ifdef RECPP_FILESYSTEM_XATTRS
+#ifdef __APPLE__
+	constexpr int noAttribute = ENOATTR;
+#else
+	constexpr int noAttribute = ENODATA;
+#endif
+	// Most values fit in this many bytes, which are read right away rather than after asking for the size of the value
+	constexpr std::size_t initialValueSize = 256;
+
+	// The functions of macOS also take a position and options, only meaningful for resource forks
+	ssize_t getAttribute(const char *path, const char *name, void *value, std::size_t size)
+	{
+#ifdef __APPLE__
+		return ::getxattr(path, name, value, size, 0, 0);
+#else
+		return ::getxattr(path, name, value, size);
+#endif
+	}
+
+	ssize_t listAttributes(const char *path, char *names, std::size_t size)
+	{
+#ifdef __APPLE__
+		return ::listxattr(path, names, size, 0);
+#else
+		return ::listxattr(path, names, size);
+#endif
+	}
+
+	// Read the attribute name of the file at path into value, returning false if the file does not have it, or if reading it failed with error
+	bool readAttribute(const char *path, const char *name, std::string &value, std::error_code &error)
+	{
+		value.resize(initialValueSize);
+		for (;;)
+		{
+			auto size = getAttribute(path, name, value.data(), value.size());
+			if (size >= 0)
+			{
+				value.resize(static_cast<std::size_t>(size));
+				return true;
+			}
+			if (errno == ERANGE)
+				size = getAttribute(path, name, nullptr, 0);
+			if (size < 0)
+			{
+				if (errno != noAttribute)
+					error = std::error_code(errno, std::generic_category());
+				return false;
+			}
+
+			// The value may still change before it is read again, an empty buffer only asking for its size again
+			value.resize(static_cast<std::size_t>(size) + 1);
+		}
+	}
+
+	// Read the names of the attributes of the file at path into names, returning false if reading them failed with error
+	bool readNames(const char *path, std::vector<std::string> &names, std::error_code &error)
+	{
+		std::string list(initialValueSize, '\0');
+		for (;;)
+		{
+			auto size = listAttributes(path, list.data(), list.size());
+			if (size >= 0)
+			{
+				list.resize(static_cast<std::size_t>(size));
+				break;
+			}
+			if (errno == ERANGE)
+				size = listAttributes(path, nullptr, 0);
+			if (size < 0)
+			{
+				error = std::error_code(errno, std::generic_category());
+				return false;
+			}
+			list.resize(static_cast<std::size_t>(size) + 1);
+		}
+
+		// The names are each ended by a NUL byte
+		for (std::size_t begin = 0; begin < list.size();)
+		{
+			const auto end = list.find('\0', begin);
+			names.push_back(list.substr(begin, end - begin));
+			begin = end == std::string::npos ? list.size() : end + 1;
+		}
+		return true;
+	}
+
+	void readAttributes(FileXattrs &file, const std::vector<std::string> &names)
+	{
+		const auto path = file.path.c_str();
+		const auto readAll = [&file, path](const std::vector<std::string> &list)
+		{
+			std::string value;
+			for (const auto &name : list)
+			{
+				if (readAttribute(path, name.c_str(), value, file.error))
+					file.attributes.emplace_back(name, value);
+				else if (file.error)
+				{
+					file.attributes.clear();
+					return;
+				}
+			}
+		};
+
+		if (!names.empty())
+			readAll(names);
+		else
+		{
+			std::vector<std::string> list;
+			if (readNames(path, list, file.error))
+				readAll(list);
+		}
+	}
+#endif
+} // namespace
+
+std::string recpp::filesystem::detail::getXattr(const std::filesystem::path &path, [[maybe_unused]] const std::string &name)
+{
+#ifdef RECPP_FILESYSTEM_XATTRS
+	std::string		value;
+	std::error_code error;
+	if (readAttribute(path.c_str(), name.c_str(), value, error))
+		return value;
+	fail("getxattr", path, error ? error.value() : noAttribute);
+#else
+	fail("getxattr", path, static_cast<int>(std::errc::operation_not_supported));
+#endif
+}
+
+void recpp::filesystem::detail::setXattr(const std::filesystem::path &path, [[maybe_unused]] const std::string &name,
+										 [[maybe_unused]] const std::string &value, [[maybe_unused]] XattrMode mode)
+{
+#ifdef RECPP_FILESYSTEM_XATTRS
+	auto flags = 0;
+	if (mode == XattrMode::create)
+		flags = XATTR_CREATE;
+	else if (mode == XattrMode::replace)
+		flags = XATTR_REPLACE;
+#ifdef __APPLE__
+	const auto result = ::setxattr(path.c_str(), name.c_str(), value.data(), value.size(), 0, flags);
+#else
+	const auto result = ::setxattr(path.c_str(), name.c_str(), value.data(), value.size(), flags);
+#endif
+	if (result != 0)
+		fail("setxattr", path, errno);
+#else
+	fail("setxattr", path, static_cast<int>(std::errc::operation_not_supported));
+#endif
+}
+
+void recpp::filesystem::detail::removeXattr(const std::filesystem::path &path, [[maybe_unused]] const std::string &name)
+{
+#ifdef RECPP_FILESYSTEM_XATTRS
+#ifdef __APPLE__
+	const auto result = ::removexattr(path.c_str(), name.c_str(), 0);
+#else
+	const auto result = ::removexattr(path.c_str(), name.c_str());
+#endif
+	if (result != 0)
+		fail("removexattr", path, errno);
+#else
+	fail("removexattr", path, static_cast<int>(std::errc::operation_not_supported));
+#endif
+}
+
+std::vector<std::string> recpp::filesystem::detail::listXattrs(const std::filesystem::path &path)
+{
+#ifdef RECPP_FILESYSTEM_XATTRS
+	std::vector<std::string> names;
+	std::error_code			 error;
+	if (!readNames(path.c_str(), names, error))
+		fail("listxattr", path, error.value());
+	return names;
+#else
+	fail("listxattr", path, static_cast<int>(std::errc::operation_not_supported));
+#endif
+}
+
+std::vector<FileXattrs> recpp::filesystem::detail::getXattrs(std::vector<std::filesystem::path> paths, [[maybe_unused]] const std::vector<std::string> &names,
+															 unsigned threads)
+{
+	std::vector<FileXattrs> files(paths.size());
+	parallelFor(
+		paths.size(),
+		[&files, &paths, &names](std::size_t i)
+		{
+			auto &file = files[i];
+			file.path = std::move(paths[i]);
+#ifdef RECPP_FILESYSTEM_XATTRS
+			readAttributes(file, names);
+#else
+			file.error = std::make_error_code(std::errc::operation_not_supported);
+#endif
+		},
+		threads);
+	return files;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <recpp/filesystem/Xattr.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Get the value of the extended attribute @p name of the file at @p path, following symlinks, as if by getxattr.
+	 */
+	std::string getXattr(const std::filesystem::path &path, const std::string &name);
+
+	/**
+	 * @brief Set the extended attribute @p name of the file at @p path to @p value, following symlinks, as if by setxattr.
+	 */
+	void setXattr(const std::filesystem::path &path, const std::string &name, const std::string &value, XattrMode mode);
+
+	/**
+	 * @brief Remove the extended attribute @p name of the file at @p path, following symlinks, as if by removexattr.
+	 */
+	void removeXattr(const std::filesystem::path &path, const std::string &name);
+
+	/**
+	 * @brief List the names of the extended attributes of the file at @p path, following symlinks, as if by listxattr.
+	 */
+	std::vector<std::string> listXattrs(const std::filesystem::path &path);
+
+	/**
+	 * @brief Get the extended attributes @p names of each of @p paths, or all their attributes if @p names is empty, on up to @p threads threads.
+	 * <p>
+	 * Each attribute is first read into a buffer large enough for most values, so that reading it usually costs a single system call. The errors of a
+	 * file are reported in its FileXattrs rather than thrown, and the attributes a file does not have are left out of its FileXattrs.
+	 */
+	std::vector<FileXattrs> getXattrs(std::vector<std::filesystem::path> paths, const std::vector<std::string> &names, unsigned threads);
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,325 @@
+#include "XxHash3.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RECPP_FILESYSTEM_XXH3_SSE2
+#endif
+
+namespace
+{
+	constexpr std::uint32_t prime32_1 = 0x9E3779B1U;
+	constexpr std::uint32_t prime32_2 = 0x85EBCA77U;
+	constexpr std::uint32_t prime32_3 = 0xC2B2AE3DU;
+	constexpr std::uint64_t prime64_1 = 0x9E3779B185EBCA87ULL;
+	constexpr std::uint64_t prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+	constexpr std::uint64_t prime64_3 = 0x165667B19E3779F9ULL;
+	constexpr std::uint64_t prime64_4 = 0x85EBCA77C2B2AE63ULL;
+	constexpr std::uint64_t prime64_5 = 0x27D4EB2F165667C5ULL;
+	constexpr std::uint64_t primeMx1 = 0x165667919E3779F9ULL;
+	constexpr std::uint64_t primeMx2 = 0x9FB21C651E98DF25ULL;
+
+	constexpr std::size_t stripeSize = 64;
+	constexpr std::size_t secretConsumeRate = 8;
+	constexpr std::size_t secretSize = 192;
+	constexpr std::size_t secretLimit = secretSize - stripeSize;
+	constexpr std::size_t stripesPerBlock = secretLimit / secretConsumeRate;
+	constexpr std::size_t midSizeMax = 240;
+	constexpr std::size_t midSizeStartOffset = 3;
+	constexpr std::size_t midSizeLastOffset = 17;
+	constexpr std::size_t secretSizeMin = 136;
+	constexpr std::size_t lastAccumulatorStart = 7;
+	constexpr std::size_t mergeAccumulatorsStart = 11;
+
+	alignas(64) constexpr std::uint8_t defaultSecret[secretSize] = {
+		0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+		0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+		0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+		0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+		0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+		0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+		0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+		0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+	};
+
+	inline std::uint32_t read32(const std::uint8_t *data)
+	{
+		return static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8 | static_cast<std::uint32_t>(data[2]) << 16 |
+			   static_cast<std::uint32_t>(data[3]) << 24;
+	}
+
+	inline std::uint64_t read64(const std::uint8_t *data)
+	{
+		return static_cast<std::uint64_t>(read32(data)) | static_cast<std::uint64_t>(read32(data + 4)) << 32;
+	}
+
+	inline std::uint32_t swap32(std::uint32_t value)
+	{
+		return (value << 24) | ((value << 8) & 0x00FF0000U) | ((value >> 8) & 0x0000FF00U) | (value >> 24);
+	}
+
+	inline std::uint64_t swap64(std::uint64_t value)
+	{
+		return static_cast<std::uint64_t>(swap32(static_cast<std::uint32_t>(value))) << 32 | swap32(static_cast<std::uint32_t>(value >> 32));
+	}
+
+	inline std::uint64_t rotl64(std::uint64_t value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	inline std::uint64_t mul128Fold64(std::uint64_t lhs, std::uint64_t rhs)
+	{
+#ifdef __SIZEOF_INT128__
+		const auto product = static_cast<unsigned __int128>(lhs) * rhs;
+		return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+#else
+		const auto loLo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+		const auto hiLo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+		const auto loHi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+		const auto hiHi = (lhs >> 32) * (rhs >> 32);
+		const auto cross = (loLo >> 32) + (hiLo & 0xFFFFFFFF) + loHi;
+		const auto upper = (hiLo >> 32) + (cross >> 32) + hiHi;
+		const auto lower = (cross << 32) | (loLo & 0xFFFFFFFF);
+		return lower ^ upper;
+#endif
+	}
+
+	inline std::uint64_t xxh64Avalanche(std::uint64_t hash)
+	{
+		hash ^= hash >> 33;
+		hash *= prime64_2;
+		hash ^= hash >> 29;
+		hash *= prime64_3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	inline std::uint64_t avalanche(std::uint64_t hash)
+	{
+		hash ^= hash >> 37;
+		hash *= primeMx1;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	inline std::uint64_t rrmxmx(std::uint64_t hash, std::uint64_t size)
+	{
+		hash ^= rotl64(hash, 49) ^ rotl64(hash, 24);
+		hash *= primeMx2;
+		hash ^= (hash >> 35) + size;
+		hash *= primeMx2;
+		return hash ^ (hash >> 28);
+	}
+
+	inline std::uint64_t mix16(const std::uint8_t *input, const std::uint8_t *secret)
+	{
+		return mul128Fold64(read64(input) ^ read64(secret), read64(input + 8) ^ read64(secret + 8));
+	}
+
+	std::uint64_t hashShort(const std::uint8_t *input, std::size_t size)
+	{
+		const auto *secret = defaultSecret;
+		if (size > 8)
+		{
+			const auto low = read64(input) ^ (read64(secret + 24) ^ read64(secret + 32));
+			const auto high = read64(input + size - 8) ^ (read64(secret + 40) ^ read64(secret + 48));
+			return avalanche(size + swap64(low) + high + mul128Fold64(low, high));
+		}
+		if (size >= 4)
+		{
+			const auto input64 = read32(input + size - 4) + (static_cast<std::uint64_t>(read32(input)) << 32);
+			return rrmxmx(input64 ^ (read64(secret + 8) ^ read64(secret + 16)), size);
+		}
+		if (size > 0)
+		{
+			const auto combined = static_cast<std::uint32_t>(input[0]) << 16 | static_cast<std::uint32_t>(input[size >> 1]) << 24 |
+								  static_cast<std::uint32_t>(input[size - 1]) | static_cast<std::uint32_t>(size) << 8;
+			return xxh64Avalanche(combined ^ static_cast<std::uint64_t>(read32(secret) ^ read32(secret + 4)));
+		}
+		return xxh64Avalanche(read64(secret + 56) ^ read64(secret + 64));
+	}
+
+	std::uint64_t hashMedium(const std::uint8_t *input, std::size_t size)
+	{
+		const auto *secret = defaultSecret;
+		auto		accumulator = size * prime64_1;
+		if (size <= 128)
+		{
+			const auto rounds = (size - 1) / 32;
+			for (std::size_t i = 0; i <= rounds; i++)
+			{
+				accumulator += mix16(input + 16 * i, secret + 32 * i);
+				accumulator += mix16(input + size - 16 * (i + 1), secret + 32 * i + 16);
+			}
+			return avalanche(accumulator);
+		}
+
+		for (std::size_t i = 0; i < 8; i++)
+			accumulator += mix16(input + 16 * i, secret + 16 * i);
+		auto end = mix16(input + size - 16, secret + secretSizeMin - midSizeLastOffset);
+		accumulator = avalanche(accumulator);
+		for (std::size_t i = 8; i < size / 16; i++)
+			end += mix16(input + 16 * i, secret + 16 * (i - 8) + midSizeStartOffset);
+		return avalanche(accumulator + end);
+	}
+
+	inline void accumulateStripe(std::uint64_t *accumulators, const std::uint8_t *input, const std::uint8_t *secret)
+	{
+#ifdef RECPP_FILESYSTEM_XXH3_SSE2
+		auto *vectors = reinterpret_cast<__m128i *>(accumulators);
+		for (std::size_t i = 0; i < stripeSize / sizeof(__m128i); i++)
+		{
+			const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input) + i);
+			const auto key = _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i *>(secret) + i));
+			const auto product = _mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+			const auto sum = _mm_add_epi64(vectors[i], _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2)));
+			vectors[i] = _mm_add_epi64(product, sum);
+		}
+#else
+		for (std::size_t lane = 0; lane < 8; lane++)
+		{
+			const auto data = read64(input + lane * 8);
+			const auto key = data ^ read64(secret + lane * 8);
+			accumulators[lane ^ 1] += data;
+			accumulators[lane] += (key & 0xFFFFFFFF) * (key >> 32);
+		}
+#endif
+	}
+
+	inline void scramble(std::uint64_t *accumulators, const std::uint8_t *secret)
+	{
+#ifdef RECPP_FILESYSTEM_XXH3_SSE2
+		auto	  *vectors = reinterpret_cast<__m128i *>(accumulators);
+		const auto prime = _mm_set1_epi32(static_cast<int>(prime32_1));
+		for (std::size_t i = 0; i < stripeSize / sizeof(__m128i); i++)
+		{
+			const auto data = _mm_xor_si128(vectors[i], _mm_srli_epi64(vectors[i], 47));
+			const auto key = _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i *>(secret) + i));
+			const auto low = _mm_mul_epu32(key, prime);
+			const auto high = _mm_mul_epu32(_mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+			vectors[i] = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+		}
+#else
+		for (std::size_t lane = 0; lane < 8; lane++)
+		{
+			auto accumulator = accumulators[lane];
+			accumulator ^= accumulator >> 47;
+			accumulator ^= read64(secret + lane * 8);
+			accumulators[lane] = accumulator * prime32_1;
+		}
+#endif
+	}
+
+	inline void accumulate(std::uint64_t *accumulators, const std::uint8_t *input, const std::uint8_t *secret, std::size_t stripes)
+	{
+		for (std::size_t i = 0; i < stripes; i++)
+			accumulateStripe(accumulators, input + i * stripeSize, secret + i * secretConsumeRate);
+	}
+
+	const std::uint8_t *consumeStripes(std::uint64_t *accumulators, std::size_t &stripesSoFar, const std::uint8_t *input, std::size_t stripes)
+	{
+		const auto *secret = defaultSecret + stripesSoFar * secretConsumeRate;
+		if (stripes >= stripesPerBlock - stripesSoFar)
+		{
+			auto stripesThisBlock = stripesPerBlock - stripesSoFar;
+			do
+			{
+				accumulate(accumulators, input, secret, stripesThisBlock);
+				scramble(accumulators, defaultSecret + secretLimit);
+				input += stripesThisBlock * stripeSize;
+				stripes -= stripesThisBlock;
+				stripesThisBlock = stripesPerBlock;
+				secret = defaultSecret;
+			} while (stripes >= stripesPerBlock);
+			stripesSoFar = 0;
+		}
+		if (stripes > 0)
+		{
+			accumulate(accumulators, input, secret, stripes);
+			input += stripes * stripeSize;
+			stripesSoFar += stripes;
+		}
+		return input;
+	}
+} // namespace
+
+recpp::filesystem::detail::XxHash3::XxHash3()
+{
+	reset();
+}
+
+void recpp::filesystem::detail::XxHash3::reset()
+{
+	const std::uint64_t initialAccumulators[8] = {prime32_3, prime64_1, prime64_2, prime64_3, prime64_4, prime32_2, prime64_5, prime32_1};
+	std::memcpy(m_accumulators, initialAccumulators, sizeof(m_accumulators));
+	m_bufferedSize = 0;
+	m_stripesSoFar = 0;
+	m_totalSize = 0;
+}
+
+void recpp::filesystem::detail::XxHash3::update(const std::uint8_t *data, std::size_t size)
+{
+	const auto *end = data + size;
+	m_totalSize += size;
+	if (size <= bufferSize - m_bufferedSize)
+	{
+		std::memcpy(m_buffer + m_bufferedSize, data, size);
+		m_bufferedSize += size;
+		return;
+	}
+
+	if (m_bufferedSize)
+	{
+		const auto loaded = bufferSize - m_bufferedSize;
+		std::memcpy(m_buffer + m_bufferedSize, data, loaded);
+		data += loaded;
+		consumeStripes(m_accumulators, m_stripesSoFar, m_buffer, bufferSize / stripeSize);
+		m_bufferedSize = 0;
+	}
+
+	// Hash the input in place, only keeping its tail and the stripe preceding it, which digest() may need to build the last stripe
+	if (static_cast<std::size_t>(end - data) > bufferSize)
+	{
+		const auto stripes = static_cast<std::size_t>(end - 1 - data) / stripeSize;
+		data = consumeStripes(m_accumulators, m_stripesSoFar, data, stripes);
+		std::memcpy(m_buffer + bufferSize - stripeSize, data - stripeSize, stripeSize);
+	}
+	std::memcpy(m_buffer, data, static_cast<std::size_t>(end - data));
+	m_bufferedSize = static_cast<std::size_t>(end - data);
+}
+
+std::uint64_t recpp::filesystem::detail::XxHash3::digest() const
+{
+	if (m_totalSize <= 16)
+		return hashShort(m_buffer, static_cast<std::size_t>(m_totalSize));
+	if (m_totalSize <= midSizeMax)
+		return hashMedium(m_buffer, static_cast<std::size_t>(m_totalSize));
+
+	alignas(16) std::uint64_t accumulators[8];
+	std::memcpy(accumulators, m_accumulators, sizeof(accumulators));
+	const std::uint8_t *lastStripe;
+	std::uint8_t		stripe[stripeSize];
+	if (m_bufferedSize >= stripeSize)
+	{
+		auto stripesSoFar = m_stripesSoFar;
+		consumeStripes(accumulators, stripesSoFar, m_buffer, (m_bufferedSize - 1) / stripeSize);
+		lastStripe = m_buffer + m_bufferedSize - stripeSize;
+	}
+	else
+	{
+		// The last stripe overlaps the previous update, whose tail was kept at the end of the buffer
+		const auto catchUp = stripeSize - m_bufferedSize;
+		std::memcpy(stripe, m_buffer + bufferSize - catchUp, catchUp);
+		std::memcpy(stripe + catchUp, m_buffer, m_bufferedSize);
+		lastStripe = stripe;
+	}
+	accumulateStripe(accumulators, lastStripe, defaultSecret + secretLimit - lastAccumulatorStart);
+
+	auto		result = m_totalSize * prime64_1;
+	const auto *secret = defaultSecret + mergeAccumulatorsStart;
+	for (std::size_t i = 0; i < 4; i++)
+		result += mul128Fold64(accumulators[2 * i] ^ read64(secret + 16 * i), accumulators[2 * i + 1] ^ read64(secret + 16 * i + 8));
+	return avalanche(result);
+}
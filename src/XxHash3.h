@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace recpp::filesystem::detail
+{
+	/**
+	 * @brief Streaming implementation of the 64 bits variant of XXH3, with the default secret and a null seed, producing the same values as XXH3_64bits()
+	 * from the reference xxHash library.
+	 * <p>
+	 * Stripes are accumulated with SSE2 when the target supports it, and with a portable implementation otherwise.
+	 */
+	class XxHash3
+	{
+	public:
+		/**
+		 * @brief Construct a new XxHash3 object, ready to hash a new input.
+		 */
+		XxHash3();
+
+		/**
+		 * @brief Reset this object to hash a new input.
+		 */
+		void reset();
+
+		/**
+		 * @brief Append @p size bytes from @p data to the hashed input.
+		 */
+		void update(const std::uint8_t *data, std::size_t size);
+
+		/**
+		 * @brief Get the hash of the input appended so far. More input can still be appended afterwards.
+		 */
+		std::uint64_t digest() const;
+
+	private:
+		static constexpr std::size_t bufferSize = 256;
+
+		alignas(16) std::uint64_t m_accumulators[8];
+		alignas(16) std::uint8_t m_buffer[bufferSize];
+		std::size_t	  m_bufferedSize;
+		std::size_t	  m_stripesSoFar;
+		std::uint64_t m_totalSize;
+	};
+} // namespace recpp::filesystem::detail
@@ -0,0 +1,240 @@
+#include <recpp/filesystem/MemoryBackend.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <system_error>
+
+using recpp::filesystem::MemoryBackend;
+
+namespace
+{
+	int failures = 0;
+
+	void expect(bool condition, const std::string &what)
+	{
+		if (!condition)
+		{
+			std::cerr << what << std::endl;
+			failures++;
+		}
+	}
+
+	// The operation must fail with a std::filesystem::filesystem_error of the given code
+	template <typename Operation>
+	void expectError(std::errc code, const Operation &operation, const std::string &what)
+	{
+		try
+		{
+			operation();
+			std::cerr << what << ": no error, expected " << std::make_error_code(code).message() << std::endl;
+			failures++;
+		}
+		catch (const std::filesystem::filesystem_error &error)
+		{
+			if (error.code() != code)
+			{
+				std::cerr << what << ": " << error.code().message() << ", expected " << std::make_error_code(code).message() << std::endl;
+				failures++;
+			}
+		}
+	}
+
+	std::string readDiskFile(const std::filesystem::path &path)
+	{
+		std::ifstream stream(path, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	}
+
+	void testSymlinks()
+	{
+		MemoryBackend backend;
+		backend.createDirectories("/a/b");
+		backend.writeFile("/a/b/file", "contents");
+		backend.createSymlink("b", "/a/relative");
+		backend.createSymlink("/a/b/file", "/absolute");
+
+		expect(backend.readFile("/a/relative/file") == "contents", "a relative symlink is resolved against its directory");
+		expect(backend.canonical("/a/relative/../relative/file") == "/a/b/file", "canonical resolves symlinks and dot-dot components");
+		expect(backend.readFile("/absolute") == "contents", "an absolute symlink is resolved from the root");
+		expect(std::filesystem::is_symlink(backend.symlinkStatus("/absolute")), "symlinkStatus does not follow the symlink");
+		expect(backend.readSymlink("/a/relative") == "b", "readSymlink returns the target as written");
+
+		backend.createSymlink("/loop2", "/loop1");
+		backend.createSymlink("/loop1", "/loop2");
+		expectError(
+			std::errc::too_many_symbolic_link_levels,
+			[&backend]()
+			{
+				backend.status("/loop1");
+			},
+			"status of a symlink loop");
+		expectError(
+			std::errc::too_many_symbolic_link_levels,
+			[&backend]()
+			{
+				backend.readFile("/loop1/file");
+			},
+			"reading through a symlink loop");
+		expect(std::filesystem::is_symlink(backend.symlinkStatus("/loop1")), "a symlink of a loop can still be examined itself");
+
+		backend.createSymlink("/missing", "/dangling");
+		expect(backend.status("/dangling").type() == std::filesystem::file_type::not_found, "a dangling symlink points to nothing");
+	}
+
+	void testRename()
+	{
+		MemoryBackend backend;
+		backend.createDirectories("/d/sub");
+		backend.writeFile("/d/old", "old");
+		backend.writeFile("/d/new", "new");
+
+		backend.rename("/d/new", "/d/old");
+		expect(backend.readFile("/d/old") == "new", "renaming over a file replaces it");
+		expect(backend.status("/d/new").type() == std::filesystem::file_type::not_found, "the renamed file is gone from its former path");
+
+		backend.createHardLink("/d/old", "/d/link");
+		backend.rename("/d/old", "/d/link");
+		expect(backend.readFile("/d/old") == "new" && backend.readFile("/d/link") == "new", "renaming over a hard link of the same file does nothing");
+
+		expectError(
+			std::errc::is_a_directory,
+			[&backend]()
+			{
+				backend.rename("/d/old", "/d/sub");
+			},
+			"renaming a file over a directory");
+		expectError(
+			std::errc::not_a_directory,
+			[&backend]()
+			{
+				backend.rename("/d/sub", "/d/old");
+			},
+			"renaming a directory over a file");
+		expectError(
+			std::errc::invalid_argument,
+			[&backend]()
+			{
+				backend.rename("/d", "/d/sub/d");
+			},
+			"renaming a directory under itself");
+
+		backend.createDirectory("/e");
+		backend.writeFile("/e/file", "");
+		expectError(
+			std::errc::directory_not_empty,
+			[&backend]()
+			{
+				backend.rename("/d/sub", "/e");
+			},
+			"renaming a directory over a non-empty one");
+		backend.remove("/e/file");
+		backend.rename("/d/sub", "/e");
+		expect(backend.isEmpty("/e") && backend.status("/d/sub").type() == std::filesystem::file_type::not_found,
+			   "renaming a directory over an empty one replaces it");
+	}
+
+	void testHardLinks()
+	{
+		MemoryBackend backend;
+		backend.createDirectories("/d/sub1");
+		backend.createDirectory("/d/sub2");
+		backend.writeFile("/d/file", "1");
+		expect(backend.hardLinkCount("/d/file") == 1, "a new file has one link");
+
+		backend.createHardLink("/d/file", "/d/link");
+		expect(backend.hardLinkCount("/d/file") == 2 && backend.hardLinkCount("/d/link") == 2, "both names of a hard linked file count two links");
+		expect(backend.equivalent("/d/file", "/d/link"), "the names of a hard linked file are equivalent");
+		backend.writeFile("/d/link", "2");
+		expect(backend.readFile("/d/file") == "2", "writing a file through one name changes it through the other");
+
+		backend.remove("/d/file");
+		expect(backend.hardLinkCount("/d/link") == 1 && backend.readFile("/d/link") == "2", "removing a name keeps the file under the others");
+		expect(backend.hardLinkCount("/d") == 4, "a directory counts its entry, its own dot and the dot-dot of each subdirectory");
+		expectError(
+			std::errc::operation_not_permitted,
+			[&backend]()
+			{
+				backend.createHardLink("/d/sub1", "/d/sublink");
+			},
+			"hard linking a directory");
+	}
+
+	void testCapacity()
+	{
+		MemoryBackend backend(1000);
+		const auto	  available = [&backend]()
+		{
+			return backend.space("/").available;
+		};
+		expect(backend.space("/").capacity == 1000 && available() == 1000, "an empty backend has its whole capacity available");
+
+		backend.createDirectory("/d");
+		backend.writeFile("/d/file", std::string(300, 'x'));
+		expect(available() == 700, "writing a file uses its size");
+		backend.writeFile("/d/file", std::string(100, 'x'));
+		expect(available() == 900, "overwriting a file uses its new size only");
+		backend.resizeFile("/d/file", 500);
+		expect(available() == 500, "resizing a file uses its new size");
+
+		backend.createHardLink("/d/file", "/d/link");
+		expect(available() == 500, "a hard link does not use space");
+		backend.remove("/d/file");
+		expect(available() == 500, "a file still linked elsewhere keeps its space");
+		backend.copyFile("/d/link", "/d/copy", std::filesystem::copy_options::none);
+		expect(available() == 0, "a copy uses its own space");
+
+		backend.writeFile("/d/more", std::string(200, 'x'));
+		expect(available() == 0, "the capacity is reported, not enforced");
+		backend.removeAll("/d");
+		expect(available() == 1000, "removing a tree releases the space of its files");
+	}
+
+	void testMaterialize()
+	{
+		const auto destination = std::filesystem::temp_directory_path() / "recpp-memory-backend-test";
+		std::filesystem::remove_all(destination);
+
+		MemoryBackend backend;
+		backend.createDirectories("/tree/sub/deep");
+		backend.writeFile("/tree/file", "contents");
+		backend.writeFile("/tree/sub/deep/other", "other");
+		backend.createHardLink("/tree/file", "/tree/sub/link");
+		backend.createSymlink("../file", "/tree/sub/symlink");
+		backend.permissions("/tree/file", std::filesystem::perms::owner_read | std::filesystem::perms::owner_write, std::filesystem::perm_options::replace);
+		const auto time = backend.lastWriteTime("/tree/sub/deep/other") - std::chrono::hours(24);
+		backend.lastWriteTime("/tree/sub", time);
+
+		backend.materialize("/tree", destination, 2);
+		expect(readDiskFile(destination / "file") == "contents", "materialize writes the files");
+		expect(readDiskFile(destination / "sub" / "deep" / "other") == "other", "materialize writes the nested files");
+		expect(std::filesystem::hard_link_count(destination / "file") == 2 && std::filesystem::equivalent(destination / "file", destination / "sub" / "link"),
+			   "materialize writes hard links as hard links");
+		expect(std::filesystem::read_symlink(destination / "sub" / "symlink") == "../file", "materialize writes symlinks as they are");
+		expect(std::filesystem::status(destination / "file").permissions() == (std::filesystem::perms::owner_read | std::filesystem::perms::owner_write),
+			   "materialize applies the permissions of the files");
+		expect(std::filesystem::last_write_time(destination / "sub") == time, "materialize applies the modification times of the directories last");
+
+		// Materializing again replaces the files and merges into the directories
+		backend.writeFile("/tree/file", "changed");
+		backend.materialize("/tree", destination, 2);
+		expect(readDiskFile(destination / "file") == "changed" && readDiskFile(destination / "sub" / "link") == "changed",
+			   "materializing again replaces the files");
+		std::filesystem::remove_all(destination);
+	}
+} // namespace
+
+int main()
+{
+	testSymlinks();
+	testRename();
+	testHardLinks();
+	testCapacity();
+	testMaterialize();
+
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
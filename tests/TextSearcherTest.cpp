@@ -0,0 +1,103 @@
+#include "TextSearcher.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <string_view>
+
+using recpp::filesystem::detail::TextSearcher;
+
+namespace
+{
+	int failures = 0;
+
+	std::size_t countMatches(const std::string &pattern, bool regex, std::string_view text)
+	{
+		std::size_t count = 0;
+		TextSearcher(pattern, regex, false)
+			.search(text,
+					[&count](std::size_t, std::string_view)
+					{
+						count++;
+						return true;
+					});
+		return count;
+	}
+
+	// The searcher must find a line whenever std::regex does, whatever literal it prefilters the lines with
+	void expectSameAsRegex(const std::string &pattern, const std::string &line)
+	{
+		const auto expected = std::regex_search(line, std::regex(pattern, std::regex::ECMAScript)) ? 1U : 0U;
+		const auto found = countMatches(pattern, true, line);
+		if (found != expected)
+		{
+			std::cerr << "pattern \"" << pattern << "\" on \"" << line << "\": " << found << " matches, expected " << expected << std::endl;
+			failures++;
+		}
+	}
+
+	// The matches of a large file must be reported while it is searched, and cancelling the search must stop it before the end of the file
+	void expectStreamedMatches()
+	{
+		const auto	path = std::filesystem::temp_directory_path() / "recpp-text-searcher-test.log";
+		std::size_t lines = 0;
+		{
+			std::ofstream file(path, std::ios::binary);
+			for (; lines < 200000; lines++)
+				file << "line " << lines << " matches\n";
+		}
+
+		recpp::filesystem::CancellationToken token;
+		recpp::filesystem::GrepOptions		 options;
+		options.threads = 1;
+		options.token = token;
+		std::size_t matches = 0;
+		bool		cancelled = false;
+		try
+		{
+			recpp::filesystem::detail::grep(
+				path, "matches",
+				[&matches, &token](const recpp::filesystem::GrepMatch &)
+				{
+					matches++;
+					token.cancel();
+				},
+				options);
+		}
+		catch (const std::exception &)
+		{
+			cancelled = true;
+		}
+		std::filesystem::remove(path);
+		if (!cancelled || matches == 0 || matches >= lines)
+		{
+			std::cerr << "cancelled search of " << lines << " matching lines: " << matches << " matches reported" << std::endl;
+			failures++;
+		}
+	}
+} // namespace
+
+int main()
+{
+	// The characters following a character code escape are not part of it
+	expectSameAsRegex("\\x41BC", "xxABCxx");
+	expectSameAsRegex("A\\x42C", "xxABCxx");
+	expectSameAsRegex("\\u0041BC", "xxABCxx");
+	expectSameAsRegex("a\\cJb", "a\nb");
+	expectSameAsRegex("\\0abc", std::string("x\0abc", 5));
+	expectSameAsRegex("(ab)\\1cd", "xxababcdxx");
+	expectSameAsRegex("\\x41BC", "xxAB");
+
+	// Classes and escaped punctuation
+	expectSameAsRegex("\\d+ items\\.", "found 42 items.");
+	expectSameAsRegex("\\d+ items\\.", "found 42 items!");
+	expectSameAsRegex("\\bword\\b", "a word here");
+
+	expectStreamedMatches();
+
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,174 @@
+#include "TransactionEngine.h"
+
+#include <recpp/filesystem/MemoryBackend.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+using namespace recpp::filesystem;
+
+namespace
+{
+	int failures = 0;
+
+	void expect(bool condition, const std::string &what)
+	{
+		if (!condition)
+		{
+			std::cerr << what << std::endl;
+			failures++;
+		}
+	}
+
+	void writeDiskFile(const std::filesystem::path &path, const std::string &contents)
+	{
+		std::ofstream stream(path, std::ios::binary);
+		stream << contents;
+	}
+
+	std::string readDiskFile(const std::filesystem::path &path)
+	{
+		std::ifstream stream(path, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	}
+
+	// A record of the journal, as written before its step is applied
+	std::string applyRecord(std::size_t index, TransactionOperationType type, const std::filesystem::path &path, const std::filesystem::path &target,
+							const std::filesystem::path &backup)
+	{
+		std::ostringstream line;
+		line << "apply " << index << ' ' << static_cast<int>(type) << ' ' << std::quoted(path.u8string()) << ' ' << std::quoted(target.u8string()) << ' '
+			 << std::quoted(backup.u8string()) << ' ' << static_cast<unsigned>(std::filesystem::perms::unknown) << '\n';
+		return line.str();
+	}
+
+	TransactionOperation operation(TransactionOperationType type, const std::filesystem::path &path, const std::filesystem::path &target = {})
+	{
+		TransactionOperation result;
+		result.type = type;
+		result.path = path;
+		result.target = target;
+		return result;
+	}
+
+	// A crash after a rename replaced its target, before the transaction was committed, is rolled back by the recovery
+	void testRecoverUncommitted(const std::filesystem::path &directory)
+	{
+		const auto journal = directory / "journal";
+		const auto backup = directory / ".target.recpp-test-0";
+		writeDiskFile(directory / "target", "old");
+		writeDiskFile(directory / "source", "new");
+		std::filesystem::create_directory(directory / "created");
+
+		// The state left by the crash: the directory was created, then the target moved to its backup and the source over it, and the record of the
+		// next step was cut short
+		std::filesystem::rename(directory / "target", backup);
+		std::filesystem::rename(directory / "source", directory / "target");
+		writeDiskFile(journal, applyRecord(0, TransactionOperationType::createDirectory, directory / "created", {}, {}) + "created 0\n" +
+								   applyRecord(1, TransactionOperationType::rename, directory / "source", directory / "target", backup) + "apply 2 2 \"");
+
+		detail::recoverTransaction(journal);
+		expect(readDiskFile(directory / "source") == "new", "recovering an uncommitted rename moves the file back");
+		expect(readDiskFile(directory / "target") == "old", "recovering an uncommitted rename restores the replaced file");
+		expect(!std::filesystem::exists(backup), "recovering an uncommitted rename leaves no backup");
+		expect(!std::filesystem::exists(directory / "created"), "recovering an uncommitted transaction removes the directories it created");
+		expect(!std::filesystem::exists(journal), "recovering a transaction removes its journal");
+
+		// Recovering again, or a transaction without journal, does nothing
+		detail::recoverTransaction(journal);
+		expect(readDiskFile(directory / "target") == "old", "recovering a missing journal does nothing");
+	}
+
+	// A crash after the transaction was committed, before its backups were deleted, only deletes them
+	void testRecoverCommitted(const std::filesystem::path &directory)
+	{
+		const auto journal = directory / "journal";
+		const auto backup = directory / ".removed.recpp-test-0";
+		writeDiskFile(backup, "removed");
+		writeDiskFile(directory / "kept", "kept");
+		writeDiskFile(journal, applyRecord(0, TransactionOperationType::remove, directory / "removed", {}, backup) + "commit\n");
+
+		detail::recoverTransaction(journal);
+		expect(!std::filesystem::exists(backup), "recovering a committed transaction deletes its backups");
+		expect(!std::filesystem::exists(directory / "removed"), "recovering a committed transaction does not undo it");
+		expect(readDiskFile(directory / "kept") == "kept", "recovering a transaction leaves the other files alone");
+		expect(!std::filesystem::exists(journal), "recovering a committed transaction removes its journal");
+	}
+
+	// A transaction whose operation fails is rolled back, and its journal removed
+	void testRollback(const std::filesystem::path &directory)
+	{
+		const auto journal = directory / "journal";
+		writeDiskFile(directory / "a", "a");
+		writeDiskFile(directory / "b", "b");
+
+		TransactionOptions options;
+		options.journal = journal;
+		try
+		{
+			detail::commitTransaction({operation(TransactionOperationType::rename, directory / "a", directory / "b"),
+									   operation(TransactionOperationType::createDirectory, directory / "missing" / "child")},
+									  options);
+			expect(false, "a transaction with a failing operation fails");
+		}
+		catch (const std::filesystem::filesystem_error &)
+		{
+		}
+		expect(readDiskFile(directory / "a") == "a" && readDiskFile(directory / "b") == "b", "a failed transaction is rolled back");
+		expect(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()) == 2,
+			   "a failed transaction leaves neither backup nor journal");
+
+		detail::commitTransaction({operation(TransactionOperationType::rename, directory / "a", directory / "b")}, options);
+		expect(!std::filesystem::exists(directory / "a") && readDiskFile(directory / "b") == "a", "a transaction is committed");
+		expect(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()) == 1,
+			   "a committed transaction leaves neither backup nor journal");
+	}
+
+	// Without a journal, a transaction is applied and rolled back on a backend the same way
+	void testBackend()
+	{
+		MemoryBackend backend;
+		backend.createDirectory("/d");
+		backend.writeFile("/d/a", "a");
+		backend.writeFile("/d/b", "b");
+		try
+		{
+			detail::commitTransaction(backend,
+									  {operation(TransactionOperationType::remove, "/d/b"), operation(TransactionOperationType::rename, "/d/missing", "/d/c")},
+									  TransactionOptions());
+			expect(false, "a transaction with a failing operation fails on a backend");
+		}
+		catch (const std::filesystem::filesystem_error &)
+		{
+		}
+		expect(backend.readFile("/d/b") == "b" && backend.directoryEntries("/d").size() == 2, "a failed transaction is rolled back on a backend");
+
+		detail::commitTransaction(backend, {operation(TransactionOperationType::remove, "/d/b"), operation(TransactionOperationType::rename, "/d/a", "/d/c")},
+								  TransactionOptions());
+		expect(backend.directoryEntries("/d").size() == 1 && backend.readFile("/d/c") == "a", "a transaction is committed on a backend");
+	}
+} // namespace
+
+int main()
+{
+	const auto root = std::filesystem::temp_directory_path() / "recpp-transaction-engine-test";
+	const auto run = [&root](void (*test)(const std::filesystem::path &directory))
+	{
+		std::filesystem::remove_all(root);
+		std::filesystem::create_directories(root);
+		test(std::filesystem::canonical(root));
+	};
+	run(testRecoverUncommitted);
+	run(testRecoverCommitted);
+	run(testRollback);
+	std::filesystem::remove_all(root);
+	testBackend();
+
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}